@@ -0,0 +1,432 @@
+#!/usr/bin/env perl
+
+# Simulator throughput benchmark (bench the simulator, not the architecture)
+#
+# Runs every binary in benchmarks/stamp and benchmarks/splash2 with the
+# command lines of their README, a fixed instruction budget (-y) and 1/4/16
+# cores under confs/sesc.conf + confs/trans.conf. For each run it records
+# host wall time, simulated KIPS, peak RSS and the global TM stats (tableG)
+# in a JSON file. With --baseline, the results are compared against a
+# previous JSON file and the script fails if any run is more than
+# --threshold percent slower (KIPS) or bigger (peak RSS).
+#
+# Usually called from "make perfbench" in the build directory.
+
+BEGIN {
+  my $tmp = $0;
+
+  $tmp = readlink($tmp) if( -l $tmp );
+  $tmp =~ s/perfbench.pl//;
+  unshift(@INC, $tmp)
+}
+
+use sesc;
+use strict;
+use Getopt::Long;
+use POSIX qw(:sys_wait_h);
+use Time::HiRes qw(time sleep);
+use File::Path;
+use File::Copy;
+use Cwd qw(getcwd abs_path);
+use JSON::PP;
+
+my $op_sesc="$ENV{'SESCBUILDDIR'}/sesc.trans";
+my $op_bench;
+my $op_confs;
+my $op_ninst=20000000;
+my $op_cores="1,4,16";
+my $op_only;
+my $op_json="perfbench.json";
+my $op_baseline;
+my $op_threshold=5;
+my $op_rundir="perfbench.run";
+my $op_help=0;
+
+my $result = GetOptions("sesc=s",\$op_sesc,
+                        "bench=s",\$op_bench,
+                        "confs=s",\$op_confs,
+                        "ninst=i",\$op_ninst,
+                        "cores=s",\$op_cores,
+                        "only=s",\$op_only,
+                        "json=s",\$op_json,
+                        "baseline=s",\$op_baseline,
+                        "threshold=f",\$op_threshold,
+                        "rundir=s",\$op_rundir,
+                        "help",\$op_help
+                       );
+
+# SPLASH-2 programs that read the thread count from their input file
+# instead of the command line: line (from 0) and field that hold it. The
+# inputs in the tree are for 8 threads.
+my %procsInInput = ( "barnes"         => [11, 0],
+                     "fmm"            => [4, 0],
+                     "water-nsquared" => [2, 0],
+                     "water-spatial"  => [2, 0] );
+
+# Input files that name further files: keywords of the lines that hold
+# them. The raytrace scene in the tree points to an absolute path where the
+# teapot geometry is not shipped.
+my %filesInInput = ( "raytrace" => ["geometry", "rlfile"] );
+
+exit &main();
+
+sub usage {
+  print "usage: perfbench.pl [options]\n";
+  print "\t--sesc=<exe>       Simulator executable [${op_sesc}]\n";
+  print "\t--bench=<dir>      benchmarks directory (with stamp and splash2)\n";
+  print "\t--confs=<dir>      directory with sesc.conf and trans.conf\n";
+  print "\t--ninst=<n>        Instructions to simulate (-y) [${op_ninst}]\n";
+  print "\t--cores=<list>     Core counts [${op_cores}]\n";
+  print "\t--only=<regex>     Only run the benchmarks that match\n";
+  print "\t--json=<file>      Results file [${op_json}]\n";
+  print "\t--baseline=<file>  Compare against a previous results file\n";
+  print "\t--threshold=<pct>  Allowed regression against the baseline [${op_threshold}]\n";
+  print "\t--rundir=<dir>     Scratch directory for the runs [${op_rundir}]\n";
+}
+
+# Command lines from the README of each suite. ${PNUM} and ${BENCHDIR}
+# are replaced, "< file" is the standard input.
+sub readBenchmarks {
+  my $dir    = shift;
+  my $readme = shift;
+
+  my @list;
+
+  open(FH, "<${dir}/${readme}") or return @list;
+  while (<FH>) {
+    chop();
+    next unless (/^([\w\-]+)\.mips\.tm\b\s*(.*)$/);
+
+    push(@list, { name => $1, exe => "${dir}/$1.mips.tm", args => $2, dir => "${dir}/" });
+  }
+  close(FH);
+
+  return @list;
+}
+
+sub expandArgs {
+  my $bench = shift;
+  my $cores = shift;
+
+  my $args = $bench->{args};
+  $args =~ s/\$\{PNUM\}/${cores}/g;
+  $args =~ s/\$\{BENCHDIR\}/$bench->{dir}/g;
+  $args =~ s/\/\//\//g;
+
+  my $stdin;
+  if ($args =~ s/<\s*(\S+)//) {
+    $stdin = $1;
+  }
+
+  my @argv = split(' ', $args);
+
+  return ($stdin, @argv);
+}
+
+# First file named by the input that does not exist
+sub missingInInput {
+  my $bench = shift;
+  my $input = shift;
+
+  my $keys = $filesInInput{$bench->{name}};
+  return undef unless (defined $keys and -f $input);
+
+  my $dir = $input;
+  $dir =~ s/[^\/]*$//;
+
+  open(IN, "<${input}") or return $input;
+  my @lines = <IN>;
+  close(IN);
+
+  foreach my $l (@lines) {
+    my ($k, $f) = split(' ', $l);
+    next unless (defined $f and grep { $_ eq $k } @$keys);
+    $f = "${dir}${f}" unless ($f =~ /^\//);
+    return $f unless (-e $f);
+  }
+
+  return undef;
+}
+
+sub missingInputs {
+  my $bench = shift;
+  my $stdin = shift;
+  my @argv  = @_;
+
+  foreach my $f (defined $stdin ? ($stdin) : (), @argv) {
+    next unless ($f =~ /\//);
+    next if ($f =~ /^-/);
+    if (-e $f) {
+      my $in = missingInInput($bench, $f);
+      return $in if (defined $in);
+      next;
+    }
+    # yada and similar take a prefix of several input files
+    my @prefixed = glob("${f}.*");
+    next if (@prefixed);
+    return $f;
+  }
+
+  return undef;
+}
+
+sub writeConf {
+  my $dir   = shift;
+  my $cores = shift;
+
+  open(IN, "<${op_confs}/sesc.conf") or die "Could not open ${op_confs}/sesc.conf";
+  open(OUT, ">${dir}/sesc.conf") or die "Could not create ${dir}/sesc.conf";
+  while (<IN>) {
+    s/^(\s*procsPerNode\s*=\s*)\d+/${1}${cores}/;
+    print OUT $_;
+  }
+  close(OUT);
+  close(IN);
+
+  copy("${op_confs}/trans.conf", "${dir}/trans.conf") or die "Could not copy trans.conf";
+}
+
+# Copy of the standard input with the thread count set to cores (when the
+# benchmark takes it from there)
+sub writeInput {
+  my $dir   = shift;
+  my $bench = shift;
+  my $stdin = shift;
+  my $cores = shift;
+
+  my $pos = $procsInInput{$bench->{name}};
+  return $stdin unless (defined $stdin and defined $pos);
+
+  my ($line, $field) = @$pos;
+
+  open(IN, "<${stdin}") or die "Could not open ${stdin}";
+  my @lines = <IN>;
+  close(IN);
+
+  die "${stdin}: no thread count at line ${line}" unless ($lines[$line] =~ /\S/);
+
+  my @f = split(' ', $lines[$line]);
+  $f[$field] = $cores;
+  $lines[$line] = join(' ', @f) . "\n";
+
+  my $file = "${dir}/$bench->{name}.input";
+  open(OUT, ">${file}") or die "Could not create ${file}";
+  print OUT @lines;
+  close(OUT);
+
+  return $file;
+}
+
+sub peakRSS {
+  my $pid = shift;
+
+  open(ST, "</proc/${pid}/status") or return 0;
+  my $rss = 0;
+  while (<ST>) {
+    if (/^VmHWM:\s+(\d+)/) {
+      $rss = $1;
+      last;
+    }
+  }
+  close(ST);
+
+  return $rss;
+}
+
+# Runs the simulator and samples its peak RSS (kB) until it exits
+sub runSesc {
+  my $dir   = shift;
+  my $stdin = shift;
+  my @cmd   = @_;
+
+  my $pid = fork();
+  die "fork failed" unless defined $pid;
+
+  if ($pid == 0) {
+    chdir($dir) or die "Could not chdir to ${dir}";
+    open(STDIN, "<" . (defined $stdin ? $stdin : "/dev/null")) or die "Could not open input ${stdin}";
+    open(STDOUT, ">sesc.stdout");
+    open(STDERR, ">sesc.stderr");
+    exec(@cmd) or exit(127);
+  }
+
+  my $rss = 0;
+  while (1) {
+    my $tmp = peakRSS($pid);
+    $rss = $tmp if ($tmp > $rss);
+    last if (waitpid($pid, WNOHANG) == $pid);
+    sleep 0.05;
+  }
+
+  return ($?, $rss);
+}
+
+sub readTMStats {
+  my $dir = shift;
+
+  my %stats;
+
+  my @files = glob("${dir}/perfbench.out*tmDebug");
+  return \%stats unless (@files);
+
+  open(TM, "<$files[0]") or return \%stats;
+  my @header;
+  while (<TM>) {
+    chop();
+    if (/^\#tableG,(.*)$/) {
+      @header = split(/,/, $1);
+    }elsif (/^tableG,(.*)$/ and @header) {
+      my @values = split(/,/, $1);
+      for(my $i=0;$i<@header;$i++) {
+        $stats{$header[$i]} = $values[$i] + 0 if ($values[$i] =~ /^[\d\.]+$/);
+      }
+    }
+  }
+  close(TM);
+
+  # Only the key ones
+  my %key;
+  foreach my $f ("Commit", "Abort", "NTot", "ComCycAvg", "AbortCycAvg", "InstAvgCm") {
+    $key{$f} = $stats{$f} if (defined $stats{$f});
+  }
+
+  return \%key;
+}
+
+sub readReport {
+  my $dir = shift;
+
+  my $file = "${dir}/perfbench.out";
+  return undef unless (-f $file);
+
+  my $cf = sesc->new($file);
+
+  my $nCPUs = $cf->getCkResultField("OSSim","nCPUs");
+  my $nInst = 0;
+  for(my $i=0;$i<$nCPUs;$i++) {
+    foreach my $t ("iBJ", "iLoad", "iStore", "iALU", "iComplex", "fpALU", "fpComplex", "other") {
+      $nInst += $cf->getCkResultField("PendingWindow(${i})_${t}","n");
+    }
+  }
+
+  return { nInst   => $nInst,
+           nCycles => $cf->getCkResultField("OSSim","nCycles") + 0 };
+}
+
+sub runOne {
+  my $bench = shift;
+  my $cores = shift;
+
+  my $key = "$bench->{name}.${cores}p";
+  my %res = (bench => $bench->{name}, cores => $cores + 0, ninst => $op_ninst);
+
+  my ($stdin, @argv) = expandArgs($bench, $cores);
+
+  my $missing = missingInputs($bench, $stdin, @argv);
+  if (defined $missing) {
+    print "${key}: skipped (missing ${missing})\n";
+    $res{status} = "skipped";
+    return ($key, \%res);
+  }
+
+  my $dir = getcwd() . "/${op_rundir}/${key}";
+  rmtree($dir);
+  mkpath($dir);
+  writeConf($dir, $cores);
+  $stdin = writeInput($dir, $bench, $stdin, $cores);
+
+  my @cmd = ($op_sesc, "-csesc.conf", "-y${op_ninst}", "-dperfbench", "-fout", $bench->{exe}, @argv);
+
+  my $start = time();
+  my ($status, $rss) = runSesc($dir, $stdin, @cmd);
+  my $wall = time() - $start;
+
+  my $rep = readReport($dir);
+
+  $res{wallSecs}  = sprintf("%.3f", $wall) + 0;
+  $res{peakRSSkB} = $rss;
+
+  if ($status != 0 or !defined $rep) {
+    print "${key}: failed (status ${status}, see ${dir})\n";
+    $res{status} = "failed";
+    return ($key, \%res);
+  }
+
+  $res{status}  = "ok";
+  $res{nInst}   = $rep->{nInst};
+  $res{nCycles} = $rep->{nCycles};
+  $res{KIPS}    = sprintf("%.3f", $wall > 0 ? $rep->{nInst} / ($wall * 1000) : 0) + 0;
+  $res{tm}      = readTMStats($dir);
+
+  printf "%-24s %8.2f s %10.2f KIPS %8d MB\n", $key, $wall, $res{KIPS}, $rss / 1024;
+
+  return ($key, \%res);
+}
+
+sub compare {
+  my $runs = shift;
+
+  open(BL, "<${op_baseline}") or die "Could not open baseline ${op_baseline}";
+  local $/;
+  my $base = decode_json(<BL>);
+  close(BL);
+
+  my $nRegressions = 0;
+
+  print "\nAgainst ${op_baseline} (threshold ${op_threshold}%):\n";
+  foreach my $key (sort keys %{$runs}) {
+    my $new = $runs->{$key};
+    my $old = $base->{runs}{$key};
+
+    next unless (defined $old);
+    next unless ($new->{status} eq "ok" and $old->{status} eq "ok");
+
+    my $dKIPS = $old->{KIPS}      ? 100 * ($new->{KIPS} - $old->{KIPS}) / $old->{KIPS} : 0;
+    my $dRSS  = $old->{peakRSSkB} ? 100 * ($new->{peakRSSkB} - $old->{peakRSSkB}) / $old->{peakRSSkB} : 0;
+
+    my $bad = ($dKIPS < -$op_threshold or $dRSS > $op_threshold);
+    $nRegressions++ if ($bad);
+
+    printf "%-24s KIPS %+7.2f%%  peakRSS %+7.2f%% %s\n", $key, $dKIPS, $dRSS, $bad ? "REGRESSION" : "";
+  }
+
+  return $nRegressions;
+}
+
+sub main {
+  if ($op_help or !defined $op_bench or !defined $op_confs) {
+    usage();
+    return $op_help ? 0 : 1;
+  }
+
+  die "Simulator ${op_sesc} not found" unless (-x $op_sesc);
+
+  # The runs happen in their own directory
+  $op_sesc  = abs_path($op_sesc);
+  $op_bench = abs_path($op_bench);
+  $op_confs = abs_path($op_confs);
+
+  my @benchs = (readBenchmarks("${op_bench}/stamp", "README.STAMP"),
+                readBenchmarks("${op_bench}/splash2", "README.SPLASH2"));
+
+  @benchs = grep { $_->{name} =~ /${op_only}/ } @benchs if (defined $op_only);
+
+  my %runs;
+  foreach my $cores (split(/,/, $op_cores)) {
+    foreach my $bench (@benchs) {
+      my ($key, $res) = runOne($bench, $cores);
+      $runs{$key} = $res;
+    }
+  }
+
+  my %out = (sesc => $op_sesc, ninst => $op_ninst, cores => $op_cores, runs => \%runs);
+
+  open(JS, ">${op_json}") or die "Could not create ${op_json}";
+  print JS JSON::PP->new->pretty->canonical->encode(\%out);
+  close(JS);
+  print "Results in ${op_json}\n";
+
+  return 0 unless (defined $op_baseline);
+
+  return compare(\%runs) ? 1 : 0;
+}
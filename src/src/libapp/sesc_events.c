@@ -210,6 +210,16 @@ void sesc_fast_sim_end()
 #endif
 }
 
+void sesc_stats_epoch_(const char *name)
+{
+  sesc_stats_epoch(name);
+}
+
+void sesc_stats_epoch(const char *name)
+{
+  notifyEvent("sesc_stats_epoch", 0, 0, 0);
+}
+
 void sesc_sysconf(int tid, int flags)
 {
   notifyEvent("sesc_sysconf", 0, 0, 0);
@@ -67,6 +67,12 @@ void sesc_wait(void){
 void sesc_pseudoreset(void){
 }
 
+void sesc_tm_private(void *addr, int size){
+}
+
+void sesc_tm_shared(void *addr){
+}
+
 int sesc_fetch_op(enum FetchOpType op, volatile int *addr, int val){
   fprintf(stderr,"sesc_fetch_op shouldn't be called without a simulator\n");
   exit(-1);
@@ -381,6 +387,14 @@ void sesc_pseudoreset(void)
   
 }
 
+void sesc_tm_private(void *addr, int size)
+{
+}
+
+void sesc_tm_shared(void *addr)
+{
+}
+
 void sesc_exit(int err)
 {
   if( rootPid == (int)pthread_self() ) {
@@ -188,6 +188,13 @@ extern "C" {
   void sesc_fast_sim_end(void);
   void sesc_fast_sim_end_(void);
 
+  /* Statistics epochs: closes the current one (if any) and begins a
+   * new one. The report has the differences of each statistic during
+   * the epoch (Epoch(name)_...). NULL only closes the current epoch.
+   */
+  void sesc_stats_epoch(const char *name);
+  void sesc_stats_epoch_(const char *name);
+
 #ifndef SESCAPI_NATIVE
   /*
    * LOCK/UNLOCK operation
@@ -227,6 +234,13 @@ extern "C" {
   void sesc_flag_wait_trans(sflag_t *flag, int transID);
   void sesc_flag_wait_lock(sflag_t *flag, slock_t *depLock);
 
+  /* Transactional memory: accesses to [addr, addr+size) are thread private
+     and are not tracked for conflicts (TransactionalMemory:filterPrivate).
+     sesc_tm_shared removes the region that starts at addr.
+  */
+  void sesc_tm_private(void *addr, int size);
+  void sesc_tm_shared(void *addr);
+
 #ifdef VALUEPRED
   int  sesc_get_last_value(int id);
   void sesc_put_last_value(int id, int val);
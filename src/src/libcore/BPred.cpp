@@ -1201,6 +1201,678 @@ void BPOgehl::switchOut(Pid_t pid)
 {
 }
 
+/*****************************************
+ * BPGlobalHistory
+ */
+
+BPGlobalHistory::BPGlobalHistory(int maxHistory)
+  :ptr(0)
+  ,phist(0)
+{
+  uint size = roundUpPower2((uint)maxHistory + 1);
+  if (size <= (uint)maxHistory)
+    size <<= 1;
+
+  ring.resize(size, 0);
+  ringMask = size - 1;
+}
+
+int BPGlobalHistory::addFold(int origLen, int compLen)
+{
+  I(compLen > 0 && compLen < 32);
+  I((uint)origLen <= ringMask);
+
+  Folded f;
+  f.comp     = 0;
+  f.compLen  = compLen;
+  f.origLen  = origLen;
+  f.outPoint = origLen % compLen;
+
+  folds.push_back(f);
+
+  return folds.size() - 1;
+}
+
+/*****************************************
+ * BPTage
+ *
+ * Based on:
+ *
+ * "A case for (partially) TAgged GEometric history length branch
+ * prediction" A. Seznec and P. Michaud
+ *
+ * "TAGE-SC-L branch predictors" A. Seznec (CBP-4)
+ */
+
+BPTage::BPTage(int i, int fetchWidth, const char *section)
+  :BPred(i, fetchWidth, section, "TAGE")
+  ,btb(  i, fetchWidth, section)
+  ,numTables(SescConf->getInt(section,"tageTables"))
+  ,logBimodal(log2i(SescConf->getInt(section,"bimodalSize")))
+  ,logSize(log2i(SescConf->getInt(section,"tageSize")))
+  ,tagBits(SescConf->getInt(section,"tagBits"))
+  ,hist(SescConf->getInt(section,"maxHistory"))
+  ,nLoopUsed("BPred(%d)_TAGE:nLoopUsed", i)
+  ,nSCReverted("BPred(%d)_TAGE:nSCReverted", i)
+{
+  // Constraints
+  SescConf->isInt(section,    "bimodalSize");
+  SescConf->isPower2(section,  "bimodalSize");
+  SescConf->isGT(section,      "bimodalSize", 15);
+
+  SescConf->isInt(section,    "tageTables");
+  SescConf->isBetween(section, "tageTables", 1, 16);
+
+  SescConf->isInt(section,    "tageSize");
+  SescConf->isPower2(section,  "tageSize");
+  SescConf->isGT(section,      "tageSize", 1);
+
+  SescConf->isInt(section,    "tagBits");
+  SescConf->isBetween(section, "tagBits", 4, 16);
+
+  SescConf->isInt(section,    "minHistory");
+  SescConf->isBetween(section, "minHistory", 1, 64);
+  SescConf->isInt(section,    "maxHistory");
+  SescConf->isBetween(section, "maxHistory", SescConf->getInt(section,"minHistory"), 2048);
+
+  int minHistory = SescConf->getInt(section,"minHistory");
+  int maxHistory = SescConf->getInt(section,"maxHistory");
+
+  bimodal = new uint[(1 << logBimodal) / 16];
+  for(int j = 0; j < (1 << logBimodal) / 16; j++)
+    bimodal[j] = 0x55555555; // weakly not taken
+
+  table      = new Entry *[numTables + 1];
+  histLength = new int[numTables + 1];
+  indexFold  = new int[numTables + 1];
+  tagFold0   = new int[numTables + 1];
+  tagFold1   = new int[numTables + 1];
+
+  table[0] = 0;
+  for(int t = 1; t <= numTables; t++) {
+    table[t] = new Entry[1 << logSize];
+    for(int j = 0; j < (1 << logSize); j++) {
+      table[t][j].tag = 0;
+      table[t][j].ctr = 0;
+      table[t][j].u   = 0;
+    }
+
+    // Geometric history lengths
+    if (numTables == 1)
+      histLength[t] = maxHistory;
+    else
+      histLength[t] = (int)(minHistory * pow((double)maxHistory / minHistory
+                                             ,(double)(t - 1) / (numTables - 1)) + 0.5);
+
+    indexFold[t] = hist.addFold(histLength[t], logSize);
+    tagFold0[t]  = hist.addFold(histLength[t], tagBits);
+    tagFold1[t]  = hist.addFold(histLength[t], tagBits - 1);
+  }
+
+  useAltOnNA = 0;
+  tick       = 0;
+  seed       = 0;
+
+  logLoop = 0;
+  loop    = 0;
+  loopUse = 0;
+  if (SescConf->checkInt(section, "loopSize") && SescConf->getInt(section, "loopSize")) {
+    SescConf->isPower2(section, "loopSize");
+    logLoop = log2i(SescConf->getInt(section, "loopSize"));
+
+    loop = new LoopEntry[1 << logLoop];
+    for(int j = 0; j < (1 << logLoop); j++) {
+      loop[j].tag      = 0;
+      loop[j].curIter  = 0;
+      loop[j].pastIter = 0;
+      loop[j].conf     = 0;
+      loop[j].age      = 0;
+      loop[j].dir      = 0;
+    }
+  }
+
+  logSC       = 0;
+  scBias      = 0;
+  scGlobal    = 0;
+  scFold      = 0;
+  scThreshold = 8;
+  scTC        = 0;
+  if (SescConf->checkInt(section, "scSize") && SescConf->getInt(section, "scSize")) {
+    SescConf->isPower2(section, "scSize");
+    SescConf->isGT(section, "scSize", 1);
+    logSC = log2i(SescConf->getInt(section, "scSize"));
+
+    scBias   = new signed char[1 << logSC];
+    scGlobal = new signed char[1 << logSC];
+    for(int j = 0; j < (1 << logSC); j++) {
+      scBias[j]   = 0;
+      scGlobal[j] = 0;
+    }
+    scFold = hist.addFold(histLength[1] < 12 ? histLength[1] : 12, logSC);
+  }
+}
+
+BPTage::~BPTage()
+{
+  for(int t = 1; t <= numTables; t++)
+    delete [] table[t];
+  delete [] table;
+  delete [] bimodal;
+  delete [] histLength;
+  delete [] indexFold;
+  delete [] tagFold0;
+  delete [] tagFold1;
+  delete [] loop;
+  delete [] scBias;
+  delete [] scGlobal;
+}
+
+int BPTage::getBimodal(HistoryType pc) const
+{
+  uint idx = pc & ((1 << logBimodal) - 1);
+
+  return (bimodal[idx >> 4] >> ((idx & 15) * 2)) & 3;
+}
+
+void BPTage::updateBimodal(HistoryType pc, bool taken)
+{
+  uint idx   = pc & ((1 << logBimodal) - 1);
+  uint shift = (idx & 15) * 2;
+  uint c     = (bimodal[idx >> 4] >> shift) & 3;
+
+  if (taken && c < 3)
+    c++;
+  else if (!taken && c > 0)
+    c--;
+
+  bimodal[idx >> 4] = (bimodal[idx >> 4] & ~(3U << shift)) | (c << shift);
+}
+
+uint BPTage::gindex(HistoryType pc, int t) const
+{
+  int pathLen = histLength[t] > 16 ? 16 : histLength[t];
+  HistoryType path = hist.phist & ((1 << pathLen) - 1);
+
+  HistoryType idx = pc ^ (pc >> (logSize + 1)) ^ hist.getFold(indexFold[t])
+    ^ ((path ^ (path >> logSize)) * (2 * t + 1));
+
+  return idx & ((1 << logSize) - 1);
+}
+
+uint BPTage::gtag(HistoryType pc, int t) const
+{
+  HistoryType tag = pc ^ hist.getFold(tagFold0[t]) ^ (hist.getFold(tagFold1[t]) << 1);
+
+  return tag & ((1 << tagBits) - 1);
+}
+
+bool BPTage::loopPredict(HistoryType pc, bool &valid) const
+{
+  valid = false;
+  if (logLoop == 0)
+    return false;
+
+  const LoopEntry &e = loop[pc & ((1 << logLoop) - 1)];
+  if (e.age == 0 || e.tag != ((pc >> logLoop) & 0x3FFF))
+    return false;
+
+  valid = (e.conf == 3);
+
+  // The exit is the iteration after the last one seen
+  return (e.curIter + 1 == e.pastIter) ? !e.dir : e.dir;
+}
+
+void BPTage::loopUpdate(HistoryType pc, bool taken, bool tagePred)
+{
+  if (logLoop == 0)
+    return;
+
+  LoopEntry &e = loop[pc & ((1 << logLoop) - 1)];
+  uint tag = (pc >> logLoop) & 0x3FFF;
+
+  if (e.age && e.tag == tag) {
+    bool valid;
+    bool loopPred = loopPredict(pc, valid);
+
+    if (valid && loopPred != taken) {
+      e.age  = 0; // not a regular loop, free it
+      e.conf = 0;
+      return;
+    }
+
+    if (valid && loopPred != tagePred && e.age < 255)
+      e.age++;
+
+    if (e.curIter == 0x3FFF) {
+      e.age = 0; // too long
+      return;
+    }
+    e.curIter++;
+
+    if (taken != e.dir) {
+      // Loop exit
+      if (e.pastIter == 0) {
+        e.pastIter = e.curIter;
+        if (e.pastIter < 3)
+          e.age = 0; // TAGE handles the short ones
+      }else if (e.curIter == e.pastIter) {
+        if (e.conf < 3)
+          e.conf++;
+      }else{
+        e.age  = 0;
+        e.conf = 0;
+      }
+      e.curIter = 0;
+    }
+    return;
+  }
+
+  if (taken == tagePred)
+    return;
+
+  // Mispredicted, maybe a loop exit
+  if (e.age) {
+    e.age--;
+    return;
+  }
+
+  e.tag      = tag;
+  e.curIter  = 0;
+  e.pastIter = 0;
+  e.conf     = 0;
+  e.age      = 255;
+  e.dir      = !taken;
+}
+
+void BPTage::allocate(int provider, bool taken, const uint *idx, const uint *tag)
+{
+  int start = provider + 1;
+
+  // Spread the allocations over the next two tables
+  seed = seed * 1103515245 + 12345;
+  if (((seed >> 16) & 1) && start < numTables)
+    start++;
+
+  for(int t = start; t <= numTables; t++) {
+    Entry &e = table[t][idx[t]];
+    if (e.u == 0) {
+      e.tag = tag[t];
+      e.ctr = taken ? 0 : -1;
+      return;
+    }
+  }
+
+  for(int t = start; t <= numTables; t++) {
+    if (table[t][idx[t]].u)
+      table[t][idx[t]].u--;
+  }
+}
+
+PredType BPTage::predict(const Instruction *inst, InstID oracleID, bool doUpdate)
+{
+  bpredEnergy->inc();
+
+  if( inst->isBranchTaken() )
+    return btb.predict(inst, oracleID, doUpdate);
+
+  bool taken = (inst->calcNextInstID() != oracleID);
+  HistoryType pc = calcInstID(inst);
+
+  uint idx[17];
+  uint tag[17];
+
+  // Longest and second longest matching tables
+  int provider = 0;
+  int alt      = 0;
+  for(int t = numTables; t > 0; t--) {
+    idx[t] = gindex(pc, t);
+    tag[t] = gtag(pc, t);
+  }
+  for(int t = numTables; t > 0; t--) {
+    if (table[t][idx[t]].tag != tag[t])
+      continue;
+    if (provider == 0) {
+      provider = t;
+    }else{
+      alt = t;
+      break;
+    }
+  }
+
+  int  bim     = getBimodal(pc);
+  bool altPred = alt ? table[alt][idx[alt]].ctr >= 0 : bim >= 2;
+  int  altCtr  = alt ? 2 * table[alt][idx[alt]].ctr + 1 : 2 * bim - 3;
+
+  bool provPred = altPred;
+  bool tagePred = altPred;
+  int  tageCtr  = altCtr;
+  bool weakNew  = false;
+  if (provider) {
+    Entry &e = table[provider][idx[provider]];
+    provPred = e.ctr >= 0;
+    weakNew  = e.u == 0 && (e.ctr == 0 || e.ctr == -1);
+    if (!weakNew || useAltOnNA < 0) {
+      tagePred = provPred;
+      tageCtr  = 2 * e.ctr + 1;
+    }
+  }
+
+  // Statistical corrector: reverts TAGE when the bias tables disagree strongly
+  bool scPred = tagePred;
+  int  scSum  = 0;
+  uint scI0   = 0;
+  uint scI1   = 0;
+  if (logSC) {
+    scI0  = ((pc << 1) | tagePred) & ((1 << logSC) - 1);
+    scI1  = (((pc ^ hist.getFold(scFold)) << 1) | tagePred) & ((1 << logSC) - 1);
+    scSum = 8 * tageCtr + (2 * scBias[scI0] + 1) + (2 * scGlobal[scI1] + 1);
+    scPred = scSum >= 0;
+  }
+
+  bool loopValid;
+  bool loopPred = loopPredict(pc, loopValid);
+
+  bool ptaken = scPred;
+  if (loopValid && loopUse >= 0)
+    ptaken = loopPred;
+
+  if (doUpdate) {
+    nLoopUsed.cinc(loopValid && loopUse >= 0);
+    nSCReverted.cinc(scPred != tagePred);
+
+    // Loop predictor
+    if (loopValid && loopPred != scPred) {
+      if (loopPred == taken) {
+        if (loopUse < 63)
+          loopUse++;
+      }else if (loopUse > -64) {
+        loopUse--;
+      }
+    }
+    loopUpdate(pc, taken, scPred);
+
+    // Statistical corrector
+    if (logSC) {
+      int mag = scSum < 0 ? -scSum : scSum;
+      if (scPred != taken) {
+        scTC++;
+        if (scTC >= 32) {
+          scThreshold++;
+          scTC = 0;
+        }
+      }else if (mag < scThreshold) {
+        scTC--;
+        if (scTC <= -32) {
+          if (scThreshold > 0)
+            scThreshold--;
+          scTC = 0;
+        }
+      }
+
+      if (scPred != taken || mag < scThreshold) {
+        if (taken) {
+          if (scBias[scI0] < 31)   scBias[scI0]++;
+          if (scGlobal[scI1] < 31) scGlobal[scI1]++;
+        }else{
+          if (scBias[scI0] > -32)   scBias[scI0]--;
+          if (scGlobal[scI1] > -32) scGlobal[scI1]--;
+        }
+      }
+    }
+
+    // TAGE
+    if (provider && weakNew && provPred != altPred) {
+      if (altPred == taken) {
+        if (useAltOnNA < 7)
+          useAltOnNA++;
+      }else if (useAltOnNA > -8) {
+        useAltOnNA--;
+      }
+    }
+
+    if (tagePred != taken && provider < numTables)
+      allocate(provider, taken, idx, tag);
+
+    if (provider) {
+      Entry &e = table[provider][idx[provider]];
+
+      if (taken) {
+        if (e.ctr < 3)
+          e.ctr = e.ctr + 1;
+      }else if (e.ctr > -4) {
+        e.ctr = e.ctr - 1;
+      }
+
+      // A new entry does not know yet, train the alternate too
+      if (e.u == 0) {
+        if (alt) {
+          Entry &a = table[alt][idx[alt]];
+          if (taken) {
+            if (a.ctr < 3)
+              a.ctr = a.ctr + 1;
+          }else if (a.ctr > -4) {
+            a.ctr = a.ctr - 1;
+          }
+        }else{
+          updateBimodal(pc, taken);
+        }
+      }
+
+      if (provPred != altPred) {
+        if (provPred == taken) {
+          if (e.u < 3)
+            e.u = e.u + 1;
+        }else if (e.u > 0) {
+          e.u = e.u - 1;
+        }
+      }
+    }else{
+      updateBimodal(pc, taken);
+    }
+
+    // Age the useful bits
+    tick++;
+    if ((tick & ((1 << 18) - 1)) == 0) {
+      for(int t = 1; t <= numTables; t++) {
+        for(int j = 0; j < (1 << logSize); j++)
+          table[t][j].u = table[t][j].u >> 1;
+      }
+    }
+
+    hist.push(taken, pc);
+  }
+
+  if (taken != ptaken) {
+    if (doUpdate)
+      btb.updateOnly(inst,oracleID);
+    return MissPrediction;
+  }
+
+  return ptaken ? btb.predict(inst, oracleID, doUpdate) : CorrectPrediction;
+}
+
+void BPTage::switchIn(Pid_t pid)
+{
+  HASH_MAP<Pid_t, BPGlobalHistory>::iterator it = savedHist.find(pid);
+  if (it == savedHist.end())
+    return; // First time, it starts with the current history
+
+  hist = it->second;
+  savedHist.erase(it);
+}
+
+void BPTage::switchOut(Pid_t pid)
+{
+  savedHist.erase(pid);
+  savedHist.insert(std::make_pair(pid, hist));
+}
+
+/*****************************************
+ * BPPerceptron
+ *
+ * Based on:
+ *
+ * "Merging path and gshare indexing in perceptron branch prediction"
+ * D. Tarjan and K. Skadron
+ *
+ * "Dynamic branch prediction with perceptrons" D. Jimenez and C. Lin
+ */
+
+BPPerceptron::BPPerceptron(int i, int fetchWidth, const char *section)
+  :BPred(i, fetchWidth, section, "Perceptron")
+  ,btb(  i, fetchWidth, section)
+  ,numTables(SescConf->getInt(section,"perceptronTables"))
+  ,logSize(log2i(SescConf->getInt(section,"perceptronSize")))
+  ,weightMax((1 << (SescConf->getInt(section,"weightBits") - 1)) - 1)
+  ,weightMin(-(1 << (SescConf->getInt(section,"weightBits") - 1)))
+  ,hist(SescConf->getInt(section,"maxHistory"))
+{
+  // Constraints
+  SescConf->isInt(section,    "perceptronTables");
+  SescConf->isBetween(section, "perceptronTables", 1, 32);
+
+  SescConf->isInt(section,    "perceptronSize");
+  SescConf->isPower2(section,  "perceptronSize");
+  SescConf->isGT(section,      "perceptronSize", 1);
+
+  SescConf->isInt(section,    "weightBits");
+  SescConf->isBetween(section, "weightBits", 2, 8);
+
+  SescConf->isInt(section,    "minHistory");
+  SescConf->isBetween(section, "minHistory", 1, 64);
+  SescConf->isInt(section,    "maxHistory");
+  SescConf->isBetween(section, "maxHistory", SescConf->getInt(section,"minHistory"), 2048);
+
+  int minHistory = SescConf->getInt(section,"minHistory");
+  int maxHistory = SescConf->getInt(section,"maxHistory");
+
+  weights    = new signed char *[numTables + 1];
+  histLength = new int[numTables + 1];
+  indexFold  = new int[numTables + 1];
+
+  for(int t = 0; t <= numTables; t++) {
+    weights[t] = new signed char[1 << logSize];
+    for(int j = 0; j < (1 << logSize); j++)
+      weights[t][j] = 0;
+  }
+
+  histLength[0] = 0;
+  indexFold[0]  = 0;
+  for(int t = 1; t <= numTables; t++) {
+    if (numTables == 1)
+      histLength[t] = maxHistory;
+    else
+      histLength[t] = (int)(minHistory * pow((double)maxHistory / minHistory
+                                             ,(double)(t - 1) / (numTables - 1)) + 0.5);
+
+    indexFold[t] = hist.addFold(histLength[t], logSize);
+  }
+
+  if (SescConf->checkInt(section, "theta"))
+    theta = SescConf->getInt(section, "theta");
+  else
+    theta = (int)(2.14 * (numTables + 1) + 20.58);
+
+  thetaTC = 0;
+}
+
+BPPerceptron::~BPPerceptron()
+{
+  for(int t = 0; t <= numTables; t++)
+    delete [] weights[t];
+  delete [] weights;
+  delete [] histLength;
+  delete [] indexFold;
+}
+
+uint BPPerceptron::index(HistoryType pc, int t) const
+{
+  HistoryType idx = pc ^ (pc >> logSize);
+
+  if (t)
+    idx ^= hist.getFold(indexFold[t]);
+
+  return idx & ((1 << logSize) - 1);
+}
+
+PredType BPPerceptron::predict(const Instruction *inst, InstID oracleID, bool doUpdate)
+{
+  bpredEnergy->inc();
+
+  if( inst->isBranchTaken() )
+    return btb.predict(inst, oracleID, doUpdate);
+
+  bool taken = (inst->calcNextInstID() != oracleID);
+  HistoryType pc = calcInstID(inst);
+
+  uint *idx = (uint *)alloca((numTables + 1) * sizeof(uint));
+
+  int sum = 0;
+  for(int t = 0; t <= numTables; t++) {
+    idx[t] = index(pc, t);
+    sum += weights[t][idx[t]];
+  }
+  bool ptaken = (sum >= 0);
+
+  if (doUpdate) {
+    int mag = sum < 0 ? -sum : sum;
+
+    // Update theta (threshold)
+    if (taken != ptaken) {
+      thetaTC++;
+      if (thetaTC >= 64) {
+        theta++;
+        thetaTC = 0;
+      }
+    }else if (mag <= theta) {
+      thetaTC--;
+      if (thetaTC <= -64) {
+        if (theta > 0)
+          theta--;
+        thetaTC = 0;
+      }
+    }
+
+    if (taken != ptaken || mag <= theta) {
+      for(int t = 0; t <= numTables; t++) {
+        signed char &w = weights[t][idx[t]];
+        if (taken) {
+          if (w < weightMax)
+            w++;
+        }else if (w > weightMin) {
+          w--;
+        }
+      }
+    }
+
+    hist.push(taken, pc);
+  }
+
+  if (taken != ptaken) {
+    if (doUpdate)
+      btb.updateOnly(inst,oracleID);
+    return MissPrediction;
+  }
+
+  return ptaken ? btb.predict(inst, oracleID, doUpdate) : CorrectPrediction;
+}
+
+void BPPerceptron::switchIn(Pid_t pid)
+{
+  HASH_MAP<Pid_t, BPGlobalHistory>::iterator it = savedHist.find(pid);
+  if (it == savedHist.end())
+    return; // First time, it starts with the current history
+
+  hist = it->second;
+  savedHist.erase(it);
+}
+
+void BPPerceptron::switchOut(Pid_t pid)
+{
+  savedHist.erase(pid);
+  savedHist.insert(std::make_pair(pid, hist));
+}
+
 /*****************************************
  * BPredictor
  */
@@ -1233,6 +1905,10 @@ BPred *BPredictor::getBPred(int id, int fetchWidth, const char *sec)
     pred = new BPyags(id, fetchWidth, sec);
   } else if (strcasecmp(type, "ogehl") == 0) {
     pred = new BPOgehl(id, fetchWidth, sec);
+  } else if (strcasecmp(type, "TAGE") == 0) {
+    pred = new BPTage(id, fetchWidth, sec);
+  } else if (strcasecmp(type, "Perceptron") == 0) {
+    pred = new BPPerceptron(id, fetchWidth, sec);
   } else {
     MSG("BPredictor::BPredictor Invalid branch predictor type [%s] in section [%s]", type,sec);
     exit(0);
@@ -30,10 +30,13 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
  *
  * Supported branch predictors models:
  *
- * Oracle, NotTaken, Taken, 2bit, 2Level, 2BCgSkew
+ * Oracle, NotTaken, Taken, 2bit, 2Level, 2BCgSkew, Hybrid, yags, ogehl,
+ * TAGE, Perceptron
  *
  */
 
+#include <vector>
+
 #include "nanassert.h"
 #include "estl.h"
 
@@ -389,6 +392,172 @@ public:
   void switchOut(Pid_t pid);
 };
 
+// Global branch/path history for the long history predictors. The
+// history is a bit ring, the folded (compressed) versions used for the
+// table indexes and tags are updated with each new outcome. Saving the
+// object saves the history of a thread (switchIn/switchOut).
+class BPGlobalHistory {
+private:
+  class Folded {
+  public:
+    uint comp;
+    int  compLen;
+    int  origLen;
+    int  outPoint;
+  };
+
+  std::vector<uchar>  ring;
+  uint                ringMask;
+  uint                ptr;   // newest outcome
+  std::vector<Folded> folds;
+
+public:
+  BPred::HistoryType phist; // path history (one bit per branch)
+
+  BPGlobalHistory(int maxHistory);
+
+  // Returns the id of a history of origLen folded to compLen bits
+  int addFold(int origLen, int compLen);
+
+  uint getFold(int id) const { return folds[id].comp; }
+
+  void push(bool taken, BPred::HistoryType pc) {
+    ptr = (ptr - 1) & ringMask;
+    ring[ptr] = taken ? 1 : 0;
+
+    for(size_t i = 0; i < folds.size(); i++) {
+      Folded &f = folds[i];
+      f.comp  = (f.comp << 1) | ring[ptr];
+      f.comp ^= ring[(ptr + f.origLen) & ringMask] << f.outPoint;
+      f.comp ^= f.comp >> f.compLen;
+      f.comp &= (1 << f.compLen) - 1;
+    }
+
+    phist = (phist << 1) | (pc & 1);
+  }
+};
+
+// TAGE with a loop predictor and a statistical corrector (TAGE-SC-L
+// class). Based on "A case for (partially) TAgged GEometric history
+// length branch prediction" and "TAGE-SC-L branch predictors" by André
+// Seznec. Simplified: the update is done at prediction time (the outcome
+// is known), so there is no speculative history to repair.
+class BPTage : public BPred {
+private:
+  BPBTB btb;
+
+  // Tagged entry, 4 bytes
+  class Entry {
+  public:
+    uint tag:16;
+    signed int ctr:3;
+    uint u:2;
+  };
+
+  // Loop predictor entry, 8 bytes
+  class LoopEntry {
+  public:
+    unsigned long long tag:14;
+    unsigned long long curIter:14;
+    unsigned long long pastIter:14;
+    unsigned long long conf:2;
+    unsigned long long age:8;
+    unsigned long long dir:1;
+  };
+
+  const int numTables;
+  const int logBimodal;
+  const int logSize;
+  const int tagBits;
+
+  uint *bimodal;          // 2 bit counters, 16 per word
+  Entry **table;          // [1..numTables]
+
+  BPGlobalHistory hist;
+  int *histLength;
+  int *indexFold;
+  int *tagFold0;
+  int *tagFold1;
+
+  int useAltOnNA;         // 4 bit counter
+  uint tick;              // u aging
+  uint seed;
+
+  int logLoop;            // 0 disables the loop predictor
+  LoopEntry *loop;
+  int loopUse;
+
+  int logSC;              // 0 disables the statistical corrector
+  signed char *scBias;
+  signed char *scGlobal;
+  int scFold;
+  int scThreshold;
+  int scTC;
+
+  HASH_MAP<Pid_t, BPGlobalHistory> savedHist;
+
+  GStatsCntr nLoopUsed;
+  GStatsCntr nSCReverted;
+
+  int  getBimodal(HistoryType pc) const;
+  void updateBimodal(HistoryType pc, bool taken);
+
+  uint gindex(HistoryType pc, int t) const;
+  uint gtag(HistoryType pc, int t) const;
+
+  bool loopPredict(HistoryType pc, bool &valid) const;
+  void loopUpdate(HistoryType pc, bool taken, bool tagePred);
+
+  void allocate(int provider, bool taken, const uint *idx, const uint *tag);
+
+protected:
+public:
+  BPTage(int i, int fetchWidth, const char *section);
+  ~BPTage();
+
+  PredType predict(const Instruction * inst, InstID oracleID, bool doUpdate);
+
+  void switchIn(Pid_t pid);
+  void switchOut(Pid_t pid);
+};
+
+// Hashed perceptron: the weights of a bias table and of tables indexed
+// with the PC and geometric lengths of global history are added. Based
+// on "Merging path and gshare indexing in perceptron branch prediction"
+// (Tarjan and Skadron) with the O-GEHL threshold adaptation.
+class BPPerceptron : public BPred {
+private:
+  BPBTB btb;
+
+  const int numTables;    // without the bias table
+  const int logSize;
+  const int weightMax;
+  const int weightMin;
+
+  signed char **weights;  // [0] is the bias table
+
+  BPGlobalHistory hist;
+  int *histLength;
+  int *indexFold;
+
+  int theta;
+  int thetaTC;
+
+  HASH_MAP<Pid_t, BPGlobalHistory> savedHist;
+
+  uint index(HistoryType pc, int t) const;
+
+protected:
+public:
+  BPPerceptron(int i, int fetchWidth, const char *section);
+  ~BPPerceptron();
+
+  PredType predict(const Instruction * inst, InstID oracleID, bool doUpdate);
+
+  void switchIn(Pid_t pid);
+  void switchOut(Pid_t pid);
+};
+
 class BPredictor {
 private:
   const int id;
@@ -282,6 +282,7 @@ DInst *DInst::createDInst(const Instruction *inst, VAddr va, int cId)
 
 #if (defined TM)
   i->transType = transNT;
+  i->utid = -1;
   i->synchType = none;
 #endif
   
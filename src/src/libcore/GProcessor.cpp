@@ -551,6 +551,8 @@ void GProcessor::retire()
 
 //BEGIN STAT --------------------------------------------------------------------------------------------------------
 #if defined(STAT)
+   {
+   SELFPROF_PHASE(ProfHooks);
 
    ConfObject* statConf = new ConfObject;
    THREAD_ID threadID = dinst->get_threadID();
@@ -582,11 +584,15 @@ void GProcessor::retire()
    }
 
    delete statConf;
+   }
 #endif
 //END STAT ----------------------------------------------------------------------------------------------------------
 
 //BEGIN PROFILING --------------------------------------------------------------------------------------------------------
 #if defined(PROFILE)
+   {
+   SELFPROF_PHASE(ProfHooks);
+
    ConfObject *statConf = new ConfObject;
    THREAD_ID threadID = dinst->get_threadID();
    if(statConf->return_enableProfiling() == 1)
@@ -687,6 +693,7 @@ void GProcessor::retire()
       }
    }
    delete statConf;
+   }
 #endif
 //END PROFILING --------------------------------------------------------------------------------------------------------
 
@@ -710,6 +717,8 @@ void GProcessor::retire()
     // dinst CAN NOT be used beyond this point
 
 #if (defined TM)
+    {
+      SELFPROF_PHASE(TransReport);
       instCountTM++;
       // Call the proper reporting function based on the type of instruction
       switch(tempTransType){
@@ -747,6 +756,7 @@ void GProcessor::retire()
     {
       tmReport->reportBarrier ( this->Id);
     }
+    }
 #endif
 
     if (!fake)
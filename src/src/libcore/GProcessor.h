@@ -42,6 +42,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "Pipeline.h"
 #include "Resource.h"
 #include "Snippets.h"
+#include "SelfProf.h"
 #include "LDSTQ.h"
 
 #if defined(STAT)
@@ -151,6 +152,7 @@ protected:
 
   void addStatsRetire(ushort index) {
     retired.sample(index);
+    SELFPROF_RETIRED(index);
   }
 
   void addStatsNoRetire(ushort index, DInst *dinst, RetOutcome cause) {
@@ -28,6 +28,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 LDSTBuffer::EntryType      LDSTBuffer::stores;
 LDSTBuffer::FenceEntryType LDSTBuffer::fences;
+size_t                     LDSTBuffer::nReserved=0;
 
 DInst *LDSTBuffer::pendingBarrier=0;
 
@@ -85,16 +86,16 @@ void LDSTBuffer::getFenceEntry(DInst *dinst)
   return;
 #endif
 
-  fences[cid] = dinst;
+  fences.insert(cid) = dinst;
 }
 
 void LDSTBuffer::fenceLocallyPerformed(DInst *dinst)
 {
   int cid = dinst->getContextId();
-  FenceEntryType::iterator it = fences.find(cid);
+  DInst **fdinst = fences.find(cid);
 
-  if (it->second == dinst)
-    fences.erase(it);
+  if (fdinst && *fdinst == dinst)
+    fences.erase(cid);
 }
 
 
@@ -106,15 +107,15 @@ void LDSTBuffer::getStoreEntry(DInst *dinst)
   return;
 #endif
 
-  EntryType::iterator sit = stores.find(calcWord(dinst));
-  if (sit != stores.end()) {
-    DInst *pdinst = sit->second;
+  DInst *&sdinst = stores.insert(calcWord(dinst));
+  if (sdinst) {
+    DInst *pdinst = sdinst;
     I(pdinst->getInst()->isStore());
     if (!pdinst->hasPending() && dinst->getContextId() == pdinst->getContextId())
       pdinst->setDeadStore();
   }
 
-  stores[calcWord(dinst)] = dinst;
+  sdinst = dinst;
 }
 
 void LDSTBuffer::getLoadEntry(DInst *dinst) 
@@ -126,11 +127,11 @@ void LDSTBuffer::getLoadEntry(DInst *dinst)
 #endif
     
   // LOAD
-  EntryType::iterator sit = stores.find(calcWord(dinst));
-  if (sit == stores.end())
+  DInst **sdinst = stores.find(calcWord(dinst));
+  if (sdinst == 0)
     return;
 
-  DInst *pdinst = sit->second;
+  DInst *pdinst = *sdinst;
   I(pdinst->getInst()->isStore());
 
 #if defined(TASKSCALAR) && !defined(TS_CAVA)
@@ -181,29 +182,28 @@ void LDSTBuffer::storeLocallyPerformed(DInst *dinst)
   return;
 #endif
 
-  EntryType::iterator sit = stores.find(calcWord(dinst));
-  if (sit == stores.end()) 
+  DInst **sdinst = stores.find(calcWord(dinst));
+  if (sdinst == 0) 
     return; // accross processors stores can be removed out-of-order
  
-  if (sit->second == dinst)
-    stores.erase(sit);
+  if (*sdinst == dinst)
+    stores.erase(calcWord(dinst));
 }
 
 void LDSTBuffer::dump(const char *str)
 {
-  EntryType::const_iterator sit;
-
   fprintf(stderr,"LDSTBuffer %s @%d:",str,(int)globalClock);
 
   fprintf(stderr,"pendingStores ");
-  for( sit = stores.begin();
-       sit != stores.end();
-       sit++ ) {
+  for(size_t i=0;i<stores.getSlots();i++) {
+    if (!stores.isUsed(i))
+      continue;
 
+    const DInst *sdinst = stores.getData(i);
     fprintf(stderr,": pc=0x%x, addr=0x%x %d"
-            ,(int)(sit->second->getInst()->getAddr())
-            ,(int)((sit->first)<<2)
-            ,sit->second->getContextId()
+            ,(int)(sdinst->getInst()->getAddr())
+            ,(int)((stores.getKey(i))<<2)
+            ,sdinst->getContextId()
       );
   }
   fprintf(stderr,"\n");
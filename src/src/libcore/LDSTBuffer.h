@@ -22,7 +22,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #ifndef LDSTBUFFER_H
 #define LDSTBUFFER_H
 
-#include "estl.h"
+#include "FixedHashMap.h"
 #include "nanassert.h"
 
 #include "Snippets.h"
@@ -40,10 +40,11 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 class LDSTBuffer {
 private:
-  typedef HASH_MAP<VAddr,DInst *> EntryType;
-  typedef HASH_MAP<int, DInst*>   FenceEntryType;
+  typedef FixedHashMap<VAddr,DInst *> EntryType;
+  typedef FixedHashMap<int, DInst*>   FenceEntryType;
   static EntryType stores;
   static FenceEntryType fences;
+  static size_t nReserved;
 
   // pendingBarrier can be an Acquire or a MemFence, NOT a Release. Releases are
   // like a store.
@@ -55,6 +56,14 @@ private:
   }
 public:
 
+  /* Each FUStore reserves room for its stores (the table is shared by
+   * all the processors)
+   */
+  static void reserveStores(size_t n) {
+    nReserved += n;
+    stores.reserve(nReserved);
+  }
+
   /* Get an entry from the LDSTQueue
    *
    * Store, Acquire, MemFence would occupy an entry in this
@@ -21,22 +21,80 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #include "LDSTQ.h"
 #include "GProcessor.h"
+#include "SescConf.h"
 
 LDSTQ::LDSTQ(GProcessor *gp, const int id) 
-  :ldldViolations("LDSTQ(%d)_ldldViolations", id)
+  :freeNode(-1)
+  ,ldldViolations("LDSTQ(%d)_ldldViolations", id)
   ,stldViolations("LDSTQ(%d)_stldViolations", id)
   ,ststViolations("LDSTQ(%d)_ststViolations", id)
   ,stldForwarding("LDSTQ(%d)_stldForwarding", id)
   ,gproc(gp)
 {
+  // Loads and stores stay in the queue from issue to retirement, so
+  // there are at most maxLoads+maxStores of them (0 is unlimited), and
+  // never more than the ROB. Misspeculated (fake) ones may need more:
+  // the pool grows if that happens.
+  size_t robSize = SescConf->getInt("cpucore", "robSize", id);
+  size_t size = robSize;
+  if (SescConf->checkInt("cpucore", "maxLoads", id)
+      && SescConf->checkInt("cpucore", "maxStores", id)) {
+    size_t maxLoads  = SescConf->getInt("cpucore", "maxLoads", id);
+    size_t maxStores = SescConf->getInt("cpucore", "maxStores", id);
+    if (maxLoads && maxStores && maxLoads + maxStores < robSize)
+      size = maxLoads + maxStores;
+  }
+
+  nodes.reserve(size);
+  instMap.reserve(size);
+}
+
+int LDSTQ::allocNode(DInst *dinst)
+{
+  int n = freeNode;
+  if (n >= 0) {
+    freeNode = nodes[n].next;
+  }else{
+    n = nodes.size();
+    nodes.push_back(Node());
+  }
+
+  nodes[n].dinst = dinst;
+  nodes[n].prev  = -1;
+  nodes[n].next  = -1;
+
+  return n;
+}
+
+bool LDSTQ::isInflight(DInst *dinst)
+{
+  DInstList *l = instMap.find(calcWord(dinst));
+  if (l == 0)
+    return false;
+
+  for(int n = l->head; n >= 0; n = nodes[n].next) {
+    if (nodes[n].dinst == dinst)
+      return true;
+  }
+
+  return false;
 }
 
 void LDSTQ::insert(DInst *dinst)
 {
-  I(inflightInsts.find(dinst) == inflightInsts.end());
-  instMap[calcWord(dinst)].push_back(dinst);
-  
-  inflightInsts.insert(dinst);
+  I(!isInflight(dinst));
+
+  int n = allocNode(dinst);
+
+  DInstList *l = instMap.find(calcWord(dinst));
+  if (l == 0) {
+    l = &instMap.insert(calcWord(dinst));
+    l->head = n;
+  }else{
+    nodes[l->tail].next = n;
+    nodes[n].prev = l->tail;
+  }
+  l->tail = n;
 }
 
 bool LDSTQ::executed(DInst *dinst)
@@ -45,21 +103,21 @@ bool LDSTQ::executed(DInst *dinst)
     return false;
 
   bool doReplay = false;
-  I(inflightInsts.find(dinst) != inflightInsts.end());
+  I(isInflight(dinst));
 
   const Instruction *inst = dinst->getInst();
-  AddrDInstQMap::iterator addrIt = instMap.find(calcWord(dinst));
+  DInstList *l = instMap.find(calcWord(dinst));
   
-  I(addrIt != instMap.end());
+  I(l);
 
   dinst->markResolved();
 
   bool beforeInst = true;
 
-  DInstQueue::iterator instIt = addrIt->second.end();
-  instIt--;
-  while(instIt != addrIt->second.begin()) {
-    DInst *qdinst = *instIt;
+  // From the youngest to the second oldest
+  int n = l->tail;
+  while(n != l->head) {
+    DInst *qdinst = nodes[n].dinst;
     if(qdinst == dinst) 
       beforeInst = false;
 
@@ -91,7 +149,7 @@ bool LDSTQ::executed(DInst *dinst)
 	break; // found if forwarded no need to check the rest of the entries
     }
     
-    instIt--;
+    n = nodes[n].prev;
   }
 
   return doReplay;
@@ -99,23 +157,34 @@ bool LDSTQ::executed(DInst *dinst)
 
 void LDSTQ::remove(DInst *dinst)
 {
-  I(inflightInsts.find(dinst) != inflightInsts.end());
-  AddrDInstQMap::iterator addrIt = instMap.find(calcWord(dinst));
+  I(isInflight(dinst));
+  DInstList *l = instMap.find(calcWord(dinst));
   
-  I(addrIt != instMap.end());
+  I(l);
 
-  DInstQueue::iterator instIt = addrIt->second.begin();
-  while(instIt != addrIt->second.end()) {
-    if(*instIt == dinst)
+  int n = l->head;
+  while(n >= 0) {
+    if(nodes[n].dinst == dinst)
       break;
-    instIt++;
+    n = nodes[n].next;
   }
 
-  I(instIt != addrIt->second.end());
-  addrIt->second.erase(instIt);
+  I(n >= 0);
 
-  if(addrIt->second.size() == 0)
-    instMap.erase(addrIt);
-  
-  inflightInsts.erase(dinst);
+  if (nodes[n].prev >= 0)
+    nodes[nodes[n].prev].next = nodes[n].next;
+  else
+    l->head = nodes[n].next;
+
+  if (nodes[n].next >= 0)
+    nodes[nodes[n].next].prev = nodes[n].prev;
+  else
+    l->tail = nodes[n].prev;
+
+  nodes[n].dinst = 0;
+  nodes[n].next  = freeNode;
+  freeNode = n;
+
+  if(l->head < 0)
+    instMap.erase(calcWord(dinst));
 }
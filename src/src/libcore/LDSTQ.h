@@ -24,8 +24,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #define LDSTQ_H
 
 #include <vector>
-#include <set>
-#include "estl.h"
+#include "FixedHashMap.h"
 #include "GStats.h"
 
 #include "DInst.h"
@@ -34,13 +33,27 @@ class GProcessor;
 
 class LDSTQ {
  private:
-  typedef std::set<DInst *> DInstSet;
-  DInstSet inflightInsts;
-
-  typedef std::vector<DInst *> DInstQueue;
-  typedef HASH_MAP<PAddr, DInstQueue> AddrDInstQMap;
+  // The in-flight instructions of each word are a list (in insertion
+  // order) of nodes from a preallocated pool. Nothing is allocated
+  // per instruction.
+  struct Node {
+    DInst *dinst;
+    int    prev;
+    int    next;
+  };
+  std::vector<Node> nodes;
+  int freeNode;
+
+  struct DInstList {
+    int head;
+    int tail;
+  };
+  typedef FixedHashMap<VAddr, DInstList> AddrDInstQMap;
   AddrDInstQMap instMap;
 
+  int allocNode(DInst *dinst);
+  bool isInflight(DInst *dinst);
+
   GStatsCntr ldldViolations;
   GStatsCntr stldViolations;
   GStatsCntr ststViolations;
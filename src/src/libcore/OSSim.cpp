@@ -43,6 +43,8 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "GMemorySystem.h"
 #include "GProcessor.h"
 #include "FetchEngine.h"
+#include "SelfProf.h"
+#include "HugePage.h"
 
 #ifdef SESC_THERM
 #include "ReportTherm.h"
@@ -73,6 +75,9 @@ namespace Profiling
 #include <ctime>
 #include "transReport.h"
 #include "transCoherence.h"
+#include "transElision.h"
+#include "transHotSpot.h"
+#include "transBreakdown.h"
 #endif
 
 #ifdef TASKSCALAR
@@ -151,6 +156,9 @@ void OSSim::reportOnTheFly(const char *file)
 OSSim::OSSim(int argc, char **argv, char **envp)
   : traceFile(0) 
     ,snapshotGlobalClock(0)    
+    ,epochName(0)
+    ,epochBegin(0)
+    ,epochMarks(false)
     ,finishWorkNowCB(&cpus)
 { 
   I(osSim == 0);
@@ -234,6 +242,12 @@ void OSSim::processParams(int argc, char **argv, char **envp)
   nInst2Skip=0;
   nInst2Sim=0;
 
+#if (defined TM)
+  nTMBegins2Skip   = 0;
+  tmSkipPerThread  = false;
+  nTMBeginsSkipped = 0;
+#endif
+
   bool useMTMarks = false;
   int  mtId=0;
 
@@ -264,6 +278,10 @@ void OSSim::processParams(int argc, char **argv, char **envp)
 #else
     fprintf(stderr,"\t-wINT       ; Number of instructions to skip in Rabbit Mode (-w1 means forever)\n");
     fprintf(stderr,"\t-1INT -2INT ; Simulate between marks -1 and -2 (start in rabbitmode)\n");
+#if (defined TM)
+    fprintf(stderr,"\t-gINT       ; Rabbit mode until INT tm_begins (all threads) have executed\n");
+    fprintf(stderr,"\t-GINT       ; Rabbit mode until INT tm_begins of each thread have executed\n");
+#endif
 #ifdef TS_PROFILING
     fprintf(stderr,"\t-rINT       ; Define the profiling phase\n");
     fprintf(stderr,"\t-STEXT      ; The section in configuration file should be used\n");
@@ -297,6 +315,18 @@ void OSSim::processParams(int argc, char **argv, char **envp)
         }
       }
 
+#if (defined TM)
+      else if( argv[i][1] == 'g' || argv[i][1] == 'G' ) {
+        tmSkipPerThread = argv[i][1] == 'G';
+        if( isdigit(argv[i][2]) )
+          nTMBegins2Skip = strtoll(&argv[i][2], 0, 0 );
+        else {
+          i++;
+          nTMBegins2Skip = strtoll(argv[i], 0, 0 );
+        }
+      }
+#endif
+
       else if( argv[i][1] == 'm' ) {
         useMTMarks=true;
         simMarks.mtMarks=true;
@@ -496,7 +526,10 @@ void OSSim::processParams(int argc, char **argv, char **envp)
                                   SescConf->getInt("TransactionalMemory","conflictDetect"),
                                   SescConf->getInt("TransactionalMemory","versioning"),
                                   SescConf->getInt("TransactionalMemory","cacheLineSize"));
-    
+
+  transLE = new transElision();
+  transHS = new transHotSpot();
+  transBD = new transBreakdown();
 #endif
 
   
@@ -588,6 +621,10 @@ void OSSim::eventSpawn(Pid_t ppid, Pid_t fid, int flags, bool stopped)
   LOG("OSSim::spawn(%d,%d,0x%lx,%d)", ppid, fid, flags,stopped);
   ProcessId *procId = ProcessId::create(ppid, fid, flags);
 
+#if (defined TM)
+  transBD->spawn(fid);
+#endif
+
   if(!stopped)
     cpus.makeRunnable(procId);
 }
@@ -694,6 +731,9 @@ void OSSim::eventExit(Pid_t cpid, int err)
     cpus.makeNonRunnable(proc);
   // Try to wakeup parent
   tryWakeupParent(cpid);
+#if (defined TM)
+  transBD->exit(cpid);
+#endif
   // Destroy the process
   proc->destroy();
   // Free the ThreadContext  
@@ -965,6 +1005,9 @@ void OSSim::initBoot()
   else
     NoMigration = false;
 
+  if (SescConf->checkBool("","statsEpochMarks"))
+    epochMarks = SescConf->getBool("","statsEpochMarks");
+
 #ifndef TRACE_DRIVEN
   // this is only necessary when running execution-driven
 
@@ -1005,6 +1048,11 @@ void OSSim::preBoot()
   if( nInst2Skip ) 
     Report::field("OSSim:rabbit=%lld",nInst2Skip);
 
+#if (defined TM)
+  if( nTMBegins2Skip )
+    Report::field("OSSim:tmBegins2Skip=%lld:perThread=%d",nTMBegins2Skip,tmSkipPerThread);
+#endif
+
   if( nInst2Sim )
     Report::field("OSSim:nInst2Sim=%lld",nInst2Sim);
   else{// 0 would never stop 
@@ -1085,9 +1133,70 @@ void OSSim::preBoot()
     //proc->goRabbitMode(1);
     //MSG("...End Skipping Initialization (Rabbit mode)");
   }
+#if (defined TM)
+  else if( nTMBegins2Skip ) {
+    MSG("Start Skipping Initialization (%lld tm_begins%s)...", nTMBegins2Skip
+        ,tmSkipPerThread ? " per thread" : "");
+    skipTMBegins();
+    MSG("...End Skipping Initialization (Rabbit mode, %lld tm_begins)", nTMBeginsSkipped);
+  }
+#endif
 #endif // Else of (defined MIPS_EMUL)
 }
 
+#if (defined TM)
+void OSSim::skipTMBegins()
+{
+  // Each processor runs a rabbit mode quantum in turn. A quantum does
+  // not end inside a transaction, so the transactions run one after
+  // the other and go through transGCM without conflicts: the
+  // transCoherence state is consistent when the detailed simulation
+  // starts. A flow that does not execute anything is parked at the
+  // tm_begin where its detailed simulation starts.
+  //
+  // A thread can wait (spin) for a parked one forever. Once some flow is
+  // parked, the skipping also ends after maxIdle instructions without a
+  // tm_begin.
+  const long long maxIdle = 16*1024*1024;
+
+  long long idle = 0;
+  long long lastSkipped = 0;
+  int noProgress = 0;
+
+  while(noProgress < 8) {
+    bool progress = false;
+    bool parked   = false;
+
+    for(size_t i=0;i<cpus.size();i++) {
+      GProcessor *proc = cpus.getProcessor(i);
+      if( proc == 0 || !proc->hasWork() )
+        continue;
+
+      proc->goRabbitMode(1);
+
+      if( GFlow::getnExecRabbit() ) {
+        progress = true;
+        idle += GFlow::getnExecRabbit();
+      }else
+        parked = true;
+    }
+
+    if( nTMBeginsSkipped != lastSkipped ) {
+      lastSkipped = nTMBeginsSkipped;
+      idle = 0;
+    }
+
+    if( parked && idle > maxIdle ) {
+      MSG("TM fast-forward: no tm_begin in %lld instructions, parked threads wait", idle);
+      break;
+    }
+
+    // SMT processors take several rounds to visit all the flows
+    noProgress = progress ? 0 : noProgress + 1;
+  }
+}
+#endif
+
 void OSSim::postBoot()
 {
   // Launch threads
@@ -1119,6 +1228,10 @@ void OSSim::simFinish()
 #if (defined TM)
   tmReport->transactionalComplete();
   tmReport->summaryComplete();
+  transLE->report(tmReport->getOutfile());
+  transGCM->report(tmReport->getOutfile());
+  transHS->report(tmReport->getOutfile());
+  transBD->report(tmReport->getOutfile());
 #endif
 
   // hein? what is this? merge problems?
@@ -1156,6 +1269,10 @@ void OSSim::report(const char *str)
 
   Report::field("OSSim:pseudoreset=%lld",snapshotGlobalClock);
 
+  HugePage::report();
+
+  SELFPROF_REPORT();
+
 #ifdef SESC_ENERGY
   const char *procName = SescConf->getCharPtr("","cpucore",0);
   double totPower      = 0.0;
@@ -1197,6 +1314,10 @@ void OSSim::report(const char *str)
   TaskContext::report();
 #endif
 
+  // The open epoch so far (it is not closed)
+  if (epochName)
+    reportStatsEpoch();
+
   // GStats must be the last to be called because previous ::report
   // can update statistics
   GStats::report(str);
@@ -1206,6 +1327,75 @@ void OSSim::report(const char *str)
 #endif
 }
 
+void OSSim::reportStatsEpoch()
+{
+  I(epochName);
+
+  Report::field("Epoch(%s):begin=%lld:end=%lld:cycles=%lld"
+                ,epochName
+                ,(long long)epochBegin
+                ,(long long)globalClock
+                ,(long long)(globalClock - epochBegin));
+
+#if (defined TM)
+  Time_t onCommit = 0;
+  Time_t onAbort  = 0;
+  for(size_t i=0;i<epochCyclesOnCommit.size();i++) {
+    onCommit += transGCM->getCyclesOnCommit(i) - epochCyclesOnCommit[i];
+    onAbort  += transGCM->getCyclesOnAbort(i)  - epochCyclesOnAbort[i];
+  }
+  Report::field("Epoch(%s)_TM:cyclesOnCommit=%lld:cyclesOnAbort=%lld"
+                ,epochName
+                ,(long long)onCommit
+                ,(long long)onAbort);
+  tmReport->summaryReportEpoch(epochName);
+#endif
+
+  GStats::reportEpoch(epochName);
+}
+
+void OSSim::eventStatsEpoch(const char *name)
+{
+  if (epochName) {
+    reportStatsEpoch();
+    free(epochName);
+    epochName = 0;
+  }
+
+  if (name == 0)
+    return;
+
+  // Repeated names get a suffix (parallel, parallel.1, ...). The name
+  // is part of the report keys, keep it to [A-Za-z0-9_.]
+  int n = epochCount[name]++;
+
+  epochName = (char *)malloc(strlen(name) + 16);
+  if (n)
+    sprintf(epochName, "%s.%d", name, n);
+  else
+    strcpy(epochName, name);
+
+  for(char *c = epochName; *c; c++) {
+    if (!isalnum(*c) && *c != '_' && *c != '.')
+      *c = '_';
+  }
+
+  epochBegin = globalClock;
+
+#if (defined TM)
+  // The TM state is indexed by pid, not by processor
+  epochCyclesOnCommit.resize(tmProcCount());
+  epochCyclesOnAbort.resize(tmProcCount());
+  for(size_t i=0;i<epochCyclesOnCommit.size();i++) {
+    epochCyclesOnCommit[i] = transGCM->getCyclesOnCommit(i);
+    epochCyclesOnAbort[i]  = transGCM->getCyclesOnAbort(i);
+  }
+  tmReport->summarySnapshotEpoch();
+#endif
+
+  GStats::snapshotEpoch();
+}
+
 GProcessor *OSSim::pid2GProcessor(Pid_t pid)
 {
   I(ProcessId::getProcessId(pid));
@@ -36,6 +36,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include <vector>
 #include <map>
 #include <queue>
+#include <string>
 
 #include "nanassert.h"
 #include "Snippets.h"
@@ -102,6 +103,31 @@ private:
   int waitBeginIdSimMarks;
   int waitEndIdSimMarks;
 
+  // Statistics epochs (sesc_stats_epoch, or each simulation mark if
+  // statsEpochMarks is set). Only one epoch is open at a time
+  char  *epochName;
+  Time_t epochBegin;
+  bool   epochMarks;
+  std::map<std::string,int> epochCount;
+#if (defined TM)
+  std::vector<Time_t> epochCyclesOnCommit;
+  std::vector<Time_t> epochCyclesOnAbort;
+#endif
+
+  void reportStatsEpoch();
+
+#if (defined TM)
+  // TM fast-forward (-g): the first nTMBegins2Skip outermost tm_begins
+  // (of all the threads, or of each thread with -G) run in rabbit
+  // mode. Detailed simulation starts at the next tm_begin of each thread
+  long long nTMBegins2Skip;
+  bool      tmSkipPerThread;
+  long long nTMBeginsSkipped;
+  std::map<Pid_t,long long> tmBeginsSkipped;
+
+  void skipTMBegins();
+#endif
+
 #ifdef TS_PROFILING
   Profile *profiler;
   int profPhase;
@@ -178,6 +204,25 @@ public:
   void eventSimulationMark() {
     simMarks.total++;
   }
+  // Closes the current epoch (if any) and opens a new one (if name is not 0)
+  void eventStatsEpoch(const char *name);
+  bool statsEpochMarks() const { return epochMarks; }
+
+#if (defined TM)
+  bool skippingTMBegins() const { return nTMBegins2Skip != 0; }
+  bool enoughTMBegins(Pid_t pid) const {
+    if (!tmSkipPerThread)
+      return nTMBeginsSkipped >= nTMBegins2Skip;
+
+    std::map<Pid_t,long long>::const_iterator it = tmBeginsSkipped.find(pid);
+    return it != tmBeginsSkipped.end() && (*it).second >= nTMBegins2Skip;
+  }
+  void eventTMBeginSkipped(Pid_t pid) {
+    nTMBeginsSkipped++;
+    tmBeginsSkipped[pid]++;
+  }
+#endif
+
   void eventSimulationMark(int id,Pid_t pid) {
     if(idSimMarks.find(id)==idSimMarks.end()) {
       idSimMarks[id].total = 0;
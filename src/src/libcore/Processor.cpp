@@ -32,6 +32,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "GMemorySystem.h"
 #include "ExecutionFlow.h"
 #include "OSSim.h"
+#include "SelfProf.h"
 
 #if (defined TM)
 #include "transReport.h"
@@ -161,6 +162,7 @@ void Processor::advanceClock()
 
   // Fetch Stage
   if (IFID.hasWork() ) {
+    SELFPROF_PHASE(Fetch);
     IBucket *bucket = pipeQ.pipeLine.newItem();
     if( bucket ) {
       IFID.fetch(bucket);
@@ -189,11 +191,15 @@ void Processor::advanceClock()
 
   // RENAME Stage
   if ( !pipeQ.instQueue.empty() ) {
+    SELFPROF_PHASE(Issue);
     spaceInInstQueue += issue(pipeQ);
     //    spaceInInstQueue += issue(pipeQ);
   }
   
-  retire();
+  {
+    SELFPROF_PHASE(Retire);
+    retire();
+  }
 }
 
 
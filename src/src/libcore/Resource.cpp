@@ -332,6 +332,10 @@ FUStore::FUStore(Cluster *cls, PortGeneric *aGen
 {
 
   I(freeStores>0);
+
+  // Bounded by the ROB too (maxStores 0 is 256K)
+  size_t robSize = SescConf->getInt("cpucore", "robSize", id);
+  LDSTBuffer::reserveStores(maxStores < robSize ? maxStores : robSize);
 }
 
 StallCause FUStore::canIssue(DInst *dinst)
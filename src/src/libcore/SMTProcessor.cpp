@@ -28,6 +28,11 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #include "FetchEngine.h"
 #include "ExecutionFlow.h"
+#include "SelfProf.h"
+
+#if (defined TM)
+#include "transCoherence.h"
+#endif
 
 SMTProcessor::Fetch::Fetch(GMemorySystem *gm, CPU_t cpuID, int cid, GProcessor *gproc, FetchEngine *fe)
   : IFID(cpuID, cid, gm, gproc, fe)
@@ -47,6 +52,7 @@ SMTProcessor::SMTProcessor(GMemorySystem *gm, CPU_t i)
   ,smtIssues4Clk(SescConf->getInt("cpucore", "smtIssues4Clk",i))
   ,firstContext(i*smtContexts)
   ,fetchDist("Processor(%d)_fetchDist", i) // noFetch is on GProcessor
+  ,tmDeprioritized("Processor(%d)_tmDeprioritized", i)
 #ifdef TASKSCALAR
   ,fetchFromSafe("Processor(%d)_fetchFromSafe", i)
   ,fetchFromSpec("Processor(%d)_fetchFromSpec", i)
@@ -79,6 +85,43 @@ SMTProcessor::SMTProcessor(GMemorySystem *gm, CPU_t i)
     bzero(gRAT[i],sizeof(DInst*)*NumArchRegs);
   }
 
+  fetchPolicy = RoundRobin;
+  if (SescConf->checkCharPtr("cpucore", "smtFetchPolicy", Id)) {
+    const char *pol = SescConf->getCharPtr("cpucore", "smtFetchPolicy", Id);
+    if (strcasecmp(pol, "ICOUNT") == 0) {
+      fetchPolicy = ICount;
+    }else if (strcasecmp(pol, "BRCOUNT") == 0) {
+      fetchPolicy = BrCount;
+    }else if (strcasecmp(pol, "MISSCOUNT") == 0) {
+      fetchPolicy = MissCount;
+    }else if (strcasecmp(pol, "TMAWARE") == 0) {
+      fetchPolicy = TMAware;
+    }else if (strcasecmp(pol, "RR") != 0) {
+      MSG("SMTProcessor: unknown smtFetchPolicy [%s]", pol);
+      SescConf->notCorrect();
+    }
+  }
+
+  smtAbortThreshold = 2;
+  if (SescConf->checkInt("cpucore", "smtAbortThreshold", Id))
+    smtAbortThreshold = SescConf->getInt("cpucore", "smtAbortThreshold", Id);
+
+  frontCount.resize(smtContexts, 0);
+  pendCount.resize(smtContexts, 0);
+  brCount.resize(smtContexts, 0);
+  missCount.resize(smtContexts, 0);
+  fetchPrio.resize(smtContexts, 0);
+  fetchOrder.reserve(smtContexts);
+  fetchPos = 0;
+  fetchRot = 0;
+
+  ctxFetched = new GStatsCntr *[smtContexts];
+  ctxFirst   = new GStatsCntr *[smtContexts];
+  for(int i = 0; i < smtContexts; i++) {
+    ctxFetched[i] = new GStatsCntr("Processor(%d)_ctx(%d)_fetched", Id, i);
+    ctxFirst[i]   = new GStatsCntr("Processor(%d)_ctx(%d)_fetchFirst", Id, i);
+  }
+
   cFetchId =0;
   cDecodeId=0;
   cIssueId =0;
@@ -88,6 +131,13 @@ SMTProcessor::SMTProcessor(GMemorySystem *gm, CPU_t i)
 
 SMTProcessor::~SMTProcessor()
 {
+  for(int i = 0; i < smtContexts; i++) {
+    delete ctxFetched[i];
+    delete ctxFirst[i];
+  }
+  delete [] ctxFetched;
+  delete [] ctxFirst;
+
   for(FetchContainer::iterator it = flow.begin();
       it != flow.end();
       it++) {
@@ -170,6 +220,7 @@ void SMTProcessor::switchIn(Pid_t pid)
     if( (*it)->IFID.getPid() < 0 ) {
       // Free FetchEngine
       (*it)->IFID.switchIn(pid);
+      resyncFrontCount(it - flow.begin());
       return;
     }
   }
@@ -184,6 +235,11 @@ void SMTProcessor::switchOut(Pid_t pid)
   I(fetch); // Not found??
 
   fetch->IFID.switchOut(pid);
+
+  for(int i = 0; i < smtContexts; i++) {
+    if (flow[i] == fetch)
+      resyncFrontCount(i);
+  }
 }
 
 size_t SMTProcessor::availableFlows() const 
@@ -230,8 +286,130 @@ void SMTProcessor::goRabbitMode(long long n2Skip)
   selectFetchFlow();
 }
 
+// Instructions of each context in the ROB that did not execute yet,
+// and how many of them are branches or loads sent to memory
+void SMTProcessor::countInFlight()
+{
+  for(int i = 0; i < smtContexts; i++) {
+    pendCount[i] = 0;
+    brCount[i]   = 0;
+    missCount[i] = 0;
+  }
+
+  if (ROB.empty())
+    return;
+
+  unsigned int robPos = ROB.getIdFromTop(0);
+  while(1) {
+    DInst *dinst = ROB.getData(robPos);
+
+    if (!dinst->isExecuted()) {
+      int c = dinst->getContextId() - firstContext;
+      I(c >= 0 && c < smtContexts);
+
+      const Instruction *inst = dinst->getInst();
+      pendCount[c]++;
+      if (inst->isBranch())
+	brCount[c]++;
+      else if (inst->isLoad() && dinst->isIssued())
+	missCount[c]++;
+    }
+
+    robPos = ROB.getNextId(robPos);
+    if (ROB.isEnd(robPos))
+      break;
+  }
+}
+
+// frontCount is only decremented at issue. After a flush or a thread
+// switch it is recomputed from the instruction queue, the buckets
+// still in the fetch pipeline are dropped (the count saturates at 0)
+void SMTProcessor::resyncFrontCount(int c)
+{
+  FastQueue<IBucket *> &q = flow[c]->pipeQ.instQueue;
+
+  frontCount[c] = 0;
+  for(size_t i = 0; i < q.size(); i++)
+    frontCount[c] += q.getData(q.getIdFromTop(i))->size();
+}
+
+// Lower goes first
+long SMTProcessor::fetchPriority(int c) const
+{
+  if (fetchPolicy == BrCount)
+    return brCount[c];
+  if (fetchPolicy == MissCount)
+    return missCount[c];
+
+  long icount = frontCount[c] + pendCount[c];
+
+#if (defined TM)
+  if (fetchPolicy == TMAware) {
+    const long tier = 1 << 16;
+    Pid_t pid = flow[c]->IFID.getPid();
+
+    // Whatever it fetches now is thrown away or waits
+    if (transGCM->checkStall(pid) || transGCM->checkStallState(pid))
+      return 2 * tier + icount;
+
+    // Likely to abort again
+    if (transGCM->getTransDepth(pid) > 0
+	&& transGCM->getAbortCount(pid) >= smtAbortThreshold)
+      return tier + icount;
+  }
+#endif
+
+  return icount;
+}
+
+// Once per cycle, the order in which the contexts fetch
+void SMTProcessor::sortFetchFlows()
+{
+  fetchOrder.clear();
+  fetchPos = 0;
+
+  if (fetchPolicy == RoundRobin)
+    return;
+
+  countInFlight();
+
+  fetchRot = (fetchRot + 1) % smtContexts;
+  for(int k = 0; k < smtContexts; k++) {
+    int c = (fetchRot + k) % smtContexts;
+    if (flow[c]->IFID.getPid() < 0)
+      continue;
+
+    fetchPrio[c] = fetchPriority(c);
+    if (fetchPolicy == TMAware && fetchPrio[c] >= (1 << 16))
+      tmDeprioritized.inc();
+
+    // Insertion sort, stable so that the ties keep the rotation
+    size_t pos = fetchOrder.size();
+    fetchOrder.push_back(c);
+    while (pos > 0 && fetchPrio[fetchOrder[pos-1]] > fetchPrio[c]) {
+      fetchOrder[pos] = fetchOrder[pos-1];
+      pos--;
+    }
+    fetchOrder[pos] = c;
+  }
+}
+
 void SMTProcessor::selectFetchFlow()
 {
+  if (fetchPolicy != RoundRobin) {
+    // Next one in priority order, wraps around while there is bandwidth
+    for(size_t i = 0; i < fetchOrder.size(); i++) {
+      cFetchId = fetchOrder[fetchPos % fetchOrder.size()];
+      fetchPos++;
+      if( flow[cFetchId]->IFID.getPid() >= 0 )
+	return;
+    }
+
+    cFetchId = -1;
+    I(hasWork());
+    return;
+  }
+
   // ROUND-ROBIN POLICY
   for(int i=0;i<smtContexts;i++){
     cFetchId = (cFetchId+1) % smtContexts;
@@ -269,6 +447,8 @@ void SMTProcessor::advanceClock()
   int tries = 0;
 #endif
 
+  sortFetchFlows();
+
   for(int i = 0; i < smtContexts && nFetched < FetchWidth; i++) {
     selectFetchFlow();
     if (cFetchId >=0) {
@@ -306,8 +486,15 @@ void SMTProcessor::advanceClock()
 
       IBucket *bucket = flow[cFetchId]->pipeQ.pipeLine.newItem();
       if( bucket ) {
-	flow[cFetchId]->IFID.fetch(bucket, fetchMax);
+	{
+	  SELFPROF_PHASE(Fetch);
+	  flow[cFetchId]->IFID.fetch(bucket, fetchMax);
+	}
 	// readyItem will be called once the bucket is fetched
+	if (nFetched == 0 && !bucket->empty())
+	  ctxFirst[cFetchId]->inc();
+	ctxFetched[cFetchId]->add(bucket->size());
+	frontCount[cFetchId] += bucket->size();
 	nFetched += bucket->size();
 	fetchDist.sample(cFetchId, bucket->size()); 
 #ifdef TASKSCALAR
@@ -351,13 +538,21 @@ void SMTProcessor::advanceClock()
     if( flow[cIssueId]->pipeQ.instQueue.empty() )
       continue;
     
+    SELFPROF_PHASE(Issue);
     int issuedInsts = issue(flow[cIssueId]->pipeQ);
+
+    frontCount[cIssueId] -= issuedInsts;
+    if (frontCount[cIssueId] < 0)
+      frontCount[cIssueId] = 0;
     
     totalIssuedInsts += issuedInsts;
   }
   spaceInInstQueue += totalIssuedInsts;
   
-  retire();
+  {
+    SELFPROF_PHASE(Retire);
+    retire();
+  }
 }
 
 StallCause SMTProcessor::addInst(DInst *dinst) 
@@ -425,11 +620,10 @@ void SMTProcessor::misBranchRestore(DInst *dinst)
   for (unsigned i = 0 ; i < INSTRUCTION_MAX_DESTPOOL; i++)
     misRegPool[i] = 0;
 
-  for(FetchContainer::const_iterator it = flow.begin();
-      it != flow.end();
-      it++) {
-    if( &(*it)->IFID == dinst->getFetch() ) {
-      (*it)->pipeQ.pipeLine.cleanMark();
+  for(int i = 0; i < smtContexts; i++) {
+    if( &flow[i]->IFID == dinst->getFetch() ) {
+      flow[i]->pipeQ.pipeLine.cleanMark();
+      resyncFrontCount(i);
       break;
     }
   }
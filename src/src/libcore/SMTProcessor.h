@@ -35,6 +35,22 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 class SMTProcessor:public GProcessor {
 private:
+  // Fetch policies (cpucore smtFetchPolicy). Except RR, the contexts
+  // are sorted once per cycle and fetched in that order:
+  // ICOUNT:    fewest instructions in the front-end and not executed yet
+  // BRCOUNT:   fewest unresolved branches
+  // MISSCOUNT: fewest loads waiting for memory
+  // TMAWARE:   ICOUNT, but NACK stalled/backing off contexts go last and
+  //            transactions that aborted smtAbortThreshold times in a row
+  //            go after the rest
+  enum FetchPolicy {
+    RoundRobin = 0,
+    ICount,
+    BrCount,
+    MissCount,
+    TMAware
+  };
+
   int cFetchId;
   int cDecodeId;
   int cIssueId;
@@ -45,7 +61,23 @@ private:
   const int smtIssues4Clk;
   const int firstContext;
 
+  FetchPolicy fetchPolicy;
+  int smtAbortThreshold;
+
+  std::vector<int> fetchOrder;
+  size_t fetchPos;
+  int    fetchRot;   // rotates the ties
+
+  std::vector<int> frontCount; // fetched, not issued yet
+  std::vector<int> pendCount;  // in the ROB, not executed
+  std::vector<int> brCount;
+  std::vector<int> missCount;
+  std::vector<long> fetchPrio;
+
   GStatsHist fetchDist;
+  GStatsCntr **ctxFetched;
+  GStatsCntr **ctxFirst;      // fetched first in the cycle
+  GStatsCntr tmDeprioritized;
 #ifdef TASKSCALAR
   GStatsAvg fetchFromSafe;
   GStatsAvg fetchFromSpec;
@@ -69,6 +101,11 @@ private:
 
   Fetch *findFetch(Pid_t pid) const;
 
+  void countInFlight();
+  void resyncFrontCount(int c);
+  long fetchPriority(int c) const;
+  void sortFetchFlows();
+
   void selectFetchFlow();
   void selectDecodeFlow();
   void selectIssueFlow();
@@ -259,6 +259,12 @@ void rsesc_simulation_mark(int pid)
 
   osSim->eventSimulationMark();
 
+  if (osSim->statsEpochMarks()) {
+    char name[32];
+    sprintf(name, "mark%d", osSim->getSimulationMark());
+    osSim->eventStatsEpoch(name);
+  }
+
 #ifdef TS_PROFILING
   if (ExecutionFlow::isGoingRabbit()) {
     if (osSim->enoughMarks1() && osSim->getProfiler()->notStart()) {
@@ -283,6 +289,12 @@ void rsesc_simulation_mark_id(int pid, int id)
 
   osSim->eventSimulationMark(id,pid);
 
+  if (osSim->statsEpochMarks()) {
+    char name[32];
+    sprintf(name, "mark%d_%d", id, osSim->getSimulationMark(id));
+    osSim->eventStatsEpoch(name);
+  }
+
 #ifdef TS_PROFILING
   if (ExecutionFlow::isGoingRabbit()) {
     if (osSim->enoughMarks1() && osSim->getProfiler()->notStart()) {
@@ -303,6 +315,11 @@ void rsesc_fast_sim_end(int pid)
   LOG("End Rabbit mode (embeded)");
 }
 
+void rsesc_stats_epoch(int pid, const char *name)
+{
+  osSim->eventStatsEpoch(name);
+}
+
 int rsesc_fetch_op(int pid, enum FetchOpType op, int vaddr, int *data, int val)
 {
   I(vaddr);
@@ -160,6 +160,18 @@ int ExecutionFlow::exeInst(void)
     thread.setRAddr(dAddrR);
   }
 
+#if (defined TM)
+  // Outside transactions there are no stalls to check for, and the memory
+  // instructions run without the transactional code
+  if(thread.tmDispatch) {
+    do{
+      picodePC=(picodePC->tmFunc)(picodePC, &thread);
+      I(picodePC);
+      if(transGCM->checkStall(thread.getPid()))
+        break;
+    }while(picodePC->addr==iAddr);
+  }else
+#endif
   do{
 #if (defined TLS)
     if(thread.getPid()!=currPid)
@@ -173,7 +185,8 @@ int ExecutionFlow::exeInst(void)
 #endif
     I(picodePC);
 #if (defined TM)
-    if(transGCM->checkStall(thread.getPid()))
+    // tm_begin switched to the transactional ops (and may be stalled)
+    if(thread.tmDispatch)
       break;
 #endif
   }while(picodePC->addr==iAddr);
@@ -255,6 +268,13 @@ void ExecutionFlow::exeInstFast()
 #endif    
   }
 
+#if (defined TM)
+  if(thread.tmDispatch) {
+    do{
+      picodePC=(picodePC->tmFunc)(picodePC, &thread);
+    }while(picodePC->addr==iAddr);
+  }else
+#endif
   do{
     picodePC=(picodePC->func)(picodePC, &thread);
   }while(picodePC->addr==iAddr);
@@ -482,7 +502,7 @@ DInst *ExecutionFlow::executePC()
 
 #if (defined TM)
   // If we are stalled, we do not want to propogate the rest of the instruction
-  if(transGCM->checkStall(thread.getPid()))
+  if(thread.tmDispatch && transGCM->checkStall(thread.getPid()))
     return 0;
 #endif
 
@@ -563,6 +583,7 @@ DInst *ExecutionFlow::executePC()
       }
 
       dinst->transPid = thread.pid;
+      dinst->utid = (int)transGCM->getUtid(thread.pid);
       dinst->transTid = thread.tmTid;
     }
 #endif
@@ -697,6 +718,7 @@ DInst *ExecutionFlow::executePC()
       }
 
       dinst->transPid = thread.pid;
+      dinst->utid = (int)transGCM->getUtid(thread.pid);
       dinst->transTid = thread.tmTid;
     }
 #endif
@@ -881,6 +903,7 @@ DInst *ExecutionFlow::executePC()
       }
 
       dinst->transPid = thread.pid;
+      dinst->utid = (int)transGCM->getUtid(thread.pid);
       dinst->transTid = thread.tmTid;
     }
 #endif
@@ -981,6 +1004,15 @@ void ExecutionFlow::goRabbitMode(long long n2skip)
   nExec=0;
   
   do {
+#if (defined TM)
+    // TM fast-forward: the outermost tm_begin where the detailed
+    // simulation starts is not executed
+    bool tmBegin = picodePC->opnum == tmBegin_opn && thread.getTMdepth() == 0
+      && osSim->skippingTMBegins();
+    if( tmBegin && osSim->enoughTMBegins(thread.getPid()) )
+      break;
+#endif
+
     ev=NoEvent;
     if( n2skip > 0 )
       n2skip--;
@@ -1001,6 +1033,11 @@ void ExecutionFlow::goRabbitMode(long long n2skip)
     }
 #endif // For else of (defined MIPS_EMUL)
 
+#if (defined TM)
+    if( tmBegin && thread.getTMdepth() )
+      osSim->eventTMBeginSkipped(thread.getPid());
+#endif
+
 #ifdef SESC_SIMPOINT
     const Instruction *inst = Instruction::getInst(picodePC->instID);
     if (inst->isBranch())
@@ -1056,6 +1093,11 @@ void ExecutionFlow::goRabbitMode(long long n2skip)
     if( osSim->enoughMTMarks1(thread.getPid(),true) )
 #endif // For else of (defined MIPS_EMUL)
       break;
+#if (defined TM)
+    // Never leave rabbit mode in the middle of a transaction
+    if( thread.getTMdepth() )
+      continue;
+#endif
     if( n2skip == 0 && goingRabbit && osSim->enoughMarks1() && nFastSims == 0 )
       break;
 
@@ -0,0 +1,124 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2006 University California, Santa Cruz.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "nanassert.h"
+#include "MappedTrace.h"
+
+MappedTrace::MappedTrace()
+  : fd(-1)
+  , base(0)
+  , cur(0)
+  , end(0)
+  , prefetched(0)
+  , trigger(0)
+  , dropped(0)
+  , mapSize(0)
+{
+}
+
+MappedTrace::~MappedTrace()
+{
+  close();
+}
+
+bool MappedTrace::open(const char *filename)
+{
+  I(base == 0);
+
+  fd = ::open(filename, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    fd = -1;
+    return false;
+  }
+  mapSize = st.st_size;
+
+  void *m = mmap(0, mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (m == MAP_FAILED) {
+    ::close(fd);
+    fd = -1;
+    return false;
+  }
+
+  base = static_cast<const char *>(m);
+  cur  = base;
+  end  = base + mapSize;
+
+  madvise(m, mapSize, MADV_SEQUENTIAL);
+  prefetched = base;
+  dropped    = base;
+  prefetch();
+
+  return true;
+}
+
+void MappedTrace::close()
+{
+  if (base == 0)
+    return;
+
+  munmap(const_cast<char *>(base), mapSize);
+  ::close(fd);
+
+  fd         = -1;
+  base       = 0;
+  cur        = 0;
+  end        = 0;
+  prefetched = 0;
+  trigger    = 0;
+  dropped    = 0;
+  mapSize    = 0;
+}
+
+void MappedTrace::prefetch()
+{
+  static const size_t pageSize = sysconf(_SC_PAGESIZE);
+
+  // Release what was consumed, a window behind the cursor
+  const char *done = base + ((cur - base) / pageSize) * pageSize;
+  if (done > dropped + Window_Size) {
+    madvise(const_cast<char *>(dropped), done - dropped, MADV_DONTNEED);
+    dropped = done;
+  }
+
+  // Ask for the next window. prefetched stays page aligned because
+  // Window_Size is a multiple of the page size.
+  size_t len = Window_Size;
+  if ((size_t)(end - prefetched) < len)
+    len = end - prefetched;
+  if (len)
+    madvise(const_cast<char *>(prefetched), len, MADV_WILLNEED);
+  prefetched += len;
+
+  if (prefetched == end)
+    trigger = end; // cur never goes past the end
+  else
+    trigger = prefetched - Window_Size/2;
+}
@@ -0,0 +1,82 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2006 University California, Santa Cruz.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef MAPPED_TRACE_H
+#define MAPPED_TRACE_H
+
+#include <string.h>
+#include <sys/types.h>
+
+// Read only view of a whole trace file. The file is mmap-ed and walked
+// sequentially: the kernel is told so (MADV_SEQUENTIAL), the next window
+// is requested ahead of the cursor (MADV_WILLNEED), and pages already
+// consumed are dropped so long traces do not fill the page cache.
+class MappedTrace {
+ private:
+  static const size_t Window_Size = 4*1024*1024;
+
+  int         fd;
+  const char *base;
+  const char *cur;
+  const char *end;
+  const char *prefetched; // readahead issued up to here
+  const char *trigger;    // issue the next readahead when cur passes this
+  const char *dropped;    // pages below this were released
+  size_t      mapSize;
+
+  void prefetch();
+
+ public:
+  MappedTrace();
+  ~MappedTrace();
+
+  // Returns false if the file can not be opened or mapped
+  bool open(const char *filename);
+  void close();
+
+  bool isOpen() const { return base != 0; }
+
+  size_t getSize() const { return mapSize; }
+  size_t remaining() const { return end - cur; }
+
+  // Pointer to the next sz bytes (no copy), or 0 if the file is shorter.
+  // The data stays valid until close.
+  const void *get(size_t sz) {
+    if ((size_t)(end - cur) < sz)
+      return 0;
+    const char *p = cur;
+    cur += sz;
+    if (cur > trigger)
+      prefetch();
+    return p;
+  }
+
+  // Copy the next sz bytes into dst (the trace fields are not aligned)
+  bool read(void *dst, size_t sz) {
+    const void *p = get(sz);
+    if (p == 0)
+      return false;
+    memcpy(dst, p, sz);
+    return true;
+  }
+};
+
+#endif
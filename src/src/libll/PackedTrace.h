@@ -0,0 +1,49 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2006 University California, Santa Cruz.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef PACKED_TRACE_H
+#define PACKED_TRACE_H
+
+#include <stdint.h>
+
+// Pre-decoded, fixed-width trace format (see misc/tt6pack.cpp). The file
+// is a header followed by nRecords PackedTraceRecord, in host byte order,
+// so a reader can walk the mmap-ed file without copying or decoding.
+
+#define PACKED_TRACE_MAGIC   "SESCPKT"
+#define PACKED_TRACE_VERSION 1
+
+typedef struct {
+  char     magic[8];      // PACKED_TRACE_MAGIC, zero terminated
+  uint32_t version;
+  uint32_t recordSize;    // sizeof(PackedTraceRecord)
+  uint64_t nRecords;
+  uint32_t pad[2];        // keeps the records 16 byte aligned
+} PackedTraceHeader;
+
+typedef struct {
+  uint32_t iAddr;
+  uint32_t nextIAddr;
+  uint32_t dAddr;
+  uint32_t rawInst;
+} PackedTraceRecord;
+
+#endif
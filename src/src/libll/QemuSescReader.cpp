@@ -29,80 +29,46 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "QemuSescTrace.h"
 
 QemuSescReader::QemuSescReader() {
-  trace = 0;
-  PC = 0;
-
-  tracEof = true;
-  qst = (QemuSescTrace*)malloc(sizeof(QemuSescTrace));  
+  qst = 0;
 }
 
 void QemuSescReader::openTrace(const char *filename) {
 
-  trace = fopen(filename, "rb");
-
-  if (trace == NULL){
+  if (!map.open(filename)){
     MSG("QemuSescReader::Can't open the trace file [%s].", filename); 
     exit(-1);
   }
 
-  tracEof = false;
-
-  readInst();   //for first instruction
-
-  if(tracEof) {
+  if (map.getSize() < sizeof(QemuSescTrace)) {
     MSG("QemuSescReader::Bad trace file."); 
     exit(-1);
   }
+  if (map.getSize() % sizeof(QemuSescTrace))
+    MSG("QemuSescReader::Trace file [%s] truncated, last record ignored.", filename);
 }
 
 void QemuSescReader::closeTrace() {
-  fclose(trace);
-}
-
-void QemuSescReader::advancePC() {
-
-  if (tracEof) {
-    PC =  0xffffffff;
-    return;
-  }
-
-  readInst();
-}
-
-void QemuSescReader::readInst() { 
-
-  if (fread(qst, sizeof(QemuSescTrace), 1, trace) !=1){
-    MSG("Size of each structure is %lu", sizeof(qst));
-    if (feof(trace))
-      tracEof = true;
-    else {
-      MSG("QemuSescReader: Error while reading TraceFile");
-      exit(1);
-    }
-  } 
-
-  PC = qst->pc;
-
-  MSG("PC 0x%x r%d <- r%d %u r%d",PC, qst->dest, qst->src1, qst->opc, qst->src2);
-
-  if (feof(trace)) {
-    tracEof = true; 
-    closeTrace();
-  }
-      
+  map.close();
+  qst = 0;
 }
 
 void QemuSescReader::fillTraceEntry(TraceEntry *te, int id) {
   I(id == 0); // multi-threaded TT6 not supported yet;
 
-  if(getCurrentPC() == 0xffffffff) {
+  // mmap returns page aligned memory and the records are word sized, so
+  // they can be used in place
+  const QemuSescTrace *r = 
+    static_cast<const QemuSescTrace *>(map.get(sizeof(QemuSescTrace)));
+  if (r == 0) {
     te->eot = true;
+    return;
   }
-  
+  qst = r;
+
+  LOG("PC 0x%x r%d <- r%d %u r%d",qst->pc, qst->dest, qst->src1, qst->opc, qst->src2);
+
   te->rawInst = 0;
-  te->iAddr     = getCurrentPC();  
+  te->iAddr     = qst->pc;  
 
   te->nextIAddr = qst->npc;
-  
-  advancePC();   
 }
@@ -30,22 +30,18 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "TraceEntry.h"
 #include "TraceReader.h"
 #include "QemuSescTrace.h"
+#include "MappedTrace.h"
 
+// The trace is a sequence of fixed size QemuSescTrace records. The file is
+// mmap-ed and the records are handed out in place, without copying.
 class QemuSescReader : public TraceReader {
  private:
-  FILE* trace;
-  unsigned int  PC;
-  
-  bool tracEof;
-  void readPC();
-  void readInst();
+  MappedTrace map;
 
-  unsigned int  getCurrentPC() { return PC; }
-  void advancePC();
+  const QemuSescTrace *qst; // record of the last filled entry
 
-  QemuSescTrace *qst;
  public:
-  QemuSescTrace *currentInst() { return qst; }
+  QemuSescTrace *currentInst() { return const_cast<QemuSescTrace *>(qst); }
   QemuSescReader();
 
   void openTrace(const char* basename);
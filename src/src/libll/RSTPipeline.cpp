@@ -0,0 +1,270 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2006 University California, Santa Cruz.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nanassert.h"
+#include "RSTPipeline.h"
+
+RSTPipeline::RSTPipeline(Rstzip *r, int nf, int nc, int cr)
+  : rz(r)
+  , nFlows(nf)
+  , nChunks(nc)
+  , chunkRecs(cr)
+{
+  I(nFlows > 0);
+  I(nChunks > 1);
+  I(chunkRecs > 0);
+
+  ring = new Chunk[nChunks];
+  for(int i = 0; i < nChunks; i++) {
+    ring[i].seq     = -1;
+    ring[i].ready   = false;
+    ring[i].pending = 0;
+    ring[i].begin   = (int *)malloc(sizeof(int)*(nFlows+1));
+    ring[i].instr   = (rstf_instrT *)malloc(sizeof(rstf_instrT)*chunkRecs);
+  }
+
+  rawBuf   = (rstf_unionT *)malloc(sizeof(rstf_unionT)*chunkRecs);
+  rawCount = (int *)malloc(sizeof(int)*nFlows);
+
+  pthread_mutex_init(&mutex, 0);
+  pthread_cond_init(&notFull, 0);
+  pthread_cond_init(&notEmpty, 0);
+
+  running      = false;
+  stopping     = false;
+  producerDone = false;
+  produced     = 0;
+  released     = 0;
+
+  nRecords    = 0;
+  nInstr      = 0;
+  nDropped    = 0;
+  maxCpuFound = -1;
+
+  flowChunk    = (long long *)malloc(sizeof(long long)*nFlows);
+  flowPos      = (int *)malloc(sizeof(int)*nFlows);
+  flowEnd      = (int *)malloc(sizeof(int)*nFlows);
+  flowAcquired = (bool *)malloc(sizeof(bool)*nFlows);
+  for(int i = 0; i < nFlows; i++) {
+    flowChunk[i]    = 0;
+    flowPos[i]      = 0;
+    flowEnd[i]      = 0;
+    flowAcquired[i] = false;
+  }
+  maxSeen = 0;
+}
+
+RSTPipeline::~RSTPipeline()
+{
+  stop();
+
+  pthread_cond_destroy(&notEmpty);
+  pthread_cond_destroy(&notFull);
+  pthread_mutex_destroy(&mutex);
+
+  for(int i = 0; i < nChunks; i++) {
+    free(ring[i].begin);
+    free(ring[i].instr);
+  }
+  delete [] ring;
+
+  free(rawBuf);
+  free(rawCount);
+  free(flowChunk);
+  free(flowPos);
+  free(flowEnd);
+  free(flowAcquired);
+}
+
+void RSTPipeline::start()
+{
+  I(!running);
+
+  running = true;
+  if (pthread_create(&producer, 0, producerEntry, this)) {
+    MSG("ERROR: RSTPipeline::start() unable to create the decompression thread");
+    exit(1);
+  }
+}
+
+void RSTPipeline::stop()
+{
+  if (!running)
+    return;
+
+  pthread_mutex_lock(&mutex);
+  stopping = true;
+  pthread_cond_broadcast(&notFull);
+  pthread_mutex_unlock(&mutex);
+
+  pthread_join(producer, 0);
+  running = false;
+}
+
+void *RSTPipeline::producerEntry(void *arg)
+{
+  static_cast<RSTPipeline *>(arg)->producerLoop();
+  return 0;
+}
+
+void RSTPipeline::split(Chunk *c, int nrecs)
+{
+  // Counting sort by cpuid: count, prefix sum, scatter. Keeps the trace
+  // order within each flow.
+  bzero(rawCount, sizeof(int)*nFlows);
+
+  for(int i = 0; i < nrecs; i++) {
+    const rstf_unionT *rp = &rawBuf[i];
+    if (rp->proto.rtype != INSTR_T)
+      continue;
+
+    int cpu = rstf_instrT_get_cpuid(&(rp->instr));
+    if (cpu >= nFlows)
+      continue;
+
+    rawCount[cpu]++;
+  }
+
+  int pos = 0;
+  for(int f = 0; f < nFlows; f++) {
+    c->begin[f] = pos;
+    pos += rawCount[f];
+    rawCount[f] = c->begin[f];
+  }
+  c->begin[nFlows] = pos;
+
+  for(int i = 0; i < nrecs; i++) {
+    const rstf_unionT *rp = &rawBuf[i];
+    if (rp->proto.rtype != INSTR_T)
+      continue;
+
+    nInstr++;
+    int cpu = rstf_instrT_get_cpuid(&(rp->instr));
+    if (cpu >= nFlows) {
+      nDropped++;
+      if (cpu > maxCpuFound)
+        maxCpuFound = cpu;
+      continue;
+    }
+
+    c->instr[rawCount[cpu]++] = rp->instr;
+  }
+
+  nRecords += nrecs;
+}
+
+void RSTPipeline::producerLoop()
+{
+  while(1) {
+    pthread_mutex_lock(&mutex);
+    while(produced - released >= nChunks && !stopping)
+      pthread_cond_wait(&notFull, &mutex);
+    if (stopping) {
+      pthread_mutex_unlock(&mutex);
+      return;
+    }
+    Chunk *c = &ring[produced % nChunks];
+    pthread_mutex_unlock(&mutex);
+
+    // The slot is free, so no consumer looks at it until it is published
+    int nrecs = rz->decompress(rawBuf, chunkRecs);
+    if (nrecs > 0)
+      split(c, nrecs);
+
+    pthread_mutex_lock(&mutex);
+    if (nrecs == 0) {
+      producerDone = true;
+      pthread_cond_broadcast(&notEmpty);
+      pthread_mutex_unlock(&mutex);
+      return;
+    }
+    c->seq     = produced;
+    c->pending = nFlows;
+    c->ready   = true;
+    produced++;
+    pthread_cond_broadcast(&notEmpty);
+    pthread_mutex_unlock(&mutex);
+  }
+}
+
+RSTPipeline::Status RSTPipeline::advance(int fid, bool wait)
+{
+  I(fid < nFlows);
+
+  pthread_mutex_lock(&mutex);
+
+  while(1) {
+    if (flowAcquired[fid]) {
+      // Done with the current chunk, walk past it
+      Chunk *c = &ring[flowChunk[fid] % nChunks];
+      I(c->ready && c->seq == flowChunk[fid]);
+      flowAcquired[fid] = false;
+      flowChunk[fid]++;
+
+      c->pending--;
+      if (c->pending == 0) {
+        I(c->seq == released);
+        c->ready = false;
+        released++;
+        pthread_cond_signal(&notFull);
+      }
+    }
+
+    Chunk *c = &ring[flowChunk[fid] % nChunks];
+    if (c->ready && c->seq == flowChunk[fid]) {
+      flowAcquired[fid] = true;
+      flowPos[fid] = c->begin[fid];
+      flowEnd[fid] = c->begin[fid+1];
+      if (flowChunk[fid] >= maxSeen)
+        maxSeen = flowChunk[fid] + 1;
+
+      if (flowPos[fid] < flowEnd[fid]) {
+        pthread_mutex_unlock(&mutex);
+        return Ready;
+      }
+      continue; // nothing for this flow in the chunk
+    }
+
+    I(flowChunk[fid] == produced);
+
+    if (producerDone) {
+      pthread_mutex_unlock(&mutex);
+      return EndOfTrace;
+    }
+
+    if (produced - released >= nChunks) {
+      // Another flow lags behind and holds the whole ring
+      pthread_mutex_unlock(&mutex);
+      return Blocked;
+    }
+
+    if (!wait) {
+      pthread_mutex_unlock(&mutex);
+      return Pending;
+    }
+
+    pthread_cond_wait(&notEmpty, &mutex);
+  }
+}
@@ -0,0 +1,131 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2006 University California, Santa Cruz.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef RST_PIPELINE_H
+#define RST_PIPELINE_H
+
+#include <pthread.h>
+
+#include "rstf.h"
+#include "Rstzip.h"
+
+// Decompresses an rstzip trace on a background thread.
+//
+// The producer fills a ring of chunks. Each chunk holds the INSTR_T records
+// of one rstzip buffer, already split per cpuid (counting sort), so a flow
+// walks a contiguous array of its own records. A chunk is recycled once
+// every flow has walked past it. Flows always traverse chunks in order, so
+// chunks are released in order too.
+//
+// Only the consumer slow path (crossing a chunk boundary) takes the lock.
+// All the consumer side is called from the simulation thread.
+class RSTPipeline {
+ public:
+  enum Status {
+    Ready,      // record returned
+    Pending,    // producer still working on the next chunk (only if !wait)
+    Blocked,    // ring full, some other flow must consume first
+    EndOfTrace
+  };
+
+ private:
+  class Chunk {
+  public:
+    long long   seq;
+    bool        ready;
+    int         pending;  // flows that did not walk past this chunk yet
+    int        *begin;    // nFlows+1 offsets into instr
+    rstf_instrT *instr;
+  };
+
+  Rstzip *const rz;
+  const int nFlows;
+  const int nChunks;
+  const int chunkRecs;
+
+  Chunk *ring;
+  rstf_unionT *rawBuf;    // producer private
+  int *rawCount;          // producer private, per flow record count
+
+  // Shared state (protected by mutex)
+  pthread_mutex_t mutex;
+  pthread_cond_t  notFull;
+  pthread_cond_t  notEmpty;
+  pthread_t       producer;
+  bool            running;
+  bool            stopping;
+  bool            producerDone;
+  long long       produced;
+  long long       released;
+
+  // Statistics (producer side, read after join or under lock)
+  long long nRecords;
+  long long nInstr;
+  long long nDropped;
+  int       maxCpuFound;
+
+  // Consumer side (simulation thread only)
+  long long *flowChunk;
+  int       *flowPos;
+  int       *flowEnd;
+  bool      *flowAcquired;
+  long long  maxSeen;
+
+  static void *producerEntry(void *arg);
+  void producerLoop();
+  void split(Chunk *c, int nrecs);
+
+  Status advance(int fid, bool wait);
+
+ public:
+  RSTPipeline(Rstzip *rz, int nFlows, int nChunks, int chunkRecs);
+  ~RSTPipeline();
+
+  void start();
+  void stop();
+
+  // Returns the next record for flow fid (or 0, and st says why). The
+  // returned pointer stays valid until the next call for the same flow.
+  const rstf_instrT *next(int fid, Status &st, bool wait=true) {
+    if (flowAcquired[fid] && flowPos[fid] < flowEnd[fid]) {
+      st = Ready;
+      return &ring[flowChunk[fid] % nChunks].instr[flowPos[fid]++];
+    }
+
+    st = advance(fid, wait);
+    if (st != Ready)
+      return 0;
+
+    return &ring[flowChunk[fid] % nChunks].instr[flowPos[fid]++];
+  }
+
+  // Number of chunks the consumer side has seen so far. Changes when any
+  // flow crosses into a chunk no flow has visited before, which is when
+  // idle flows may have something new to do.
+  long long getSeenChunks() const { return maxSeen; }
+
+  long long getRecords() const { return nRecords; }
+  long long getInstructions() const { return nInstr; }
+  long long getDropped() const { return nDropped; }
+  int getMaxCpuFound() const { return maxCpuFound; }
+};
+
+#endif
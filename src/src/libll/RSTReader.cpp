@@ -31,21 +31,32 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "rstf.h"
 #include "Rstzip.h"
 
-void RSTReader::addInstruction(const rstf_unionT *rp) {
+const Instruction *RSTReader::getInst(VAddr PC, uint rawInst) {
 
-  int fid       = rstf_instrT_get_cpuid(&(rp->instr));
- 
-  VAddr PC      = rp->instr.pc_va;
-  uint  rawInst = rp->instr.instr;
-  VAddr address = rp->instr.ea_va;
+  int idx = (PC>>2) & (PCCache_Size-1);
+  if (pcInst[idx] && pcTag[idx] == PC)
+    return pcInst[idx];
 
   const Instruction *inst = Instruction::getSharedInstByPC(PC);
-  if (inst == 0) {
+  if (inst == 0)
     inst = Instruction::getRSTInstByPC(PC, rawInst);
-    GI(inst->isMemory(), address>1024 || address==0);
-  }
   I(inst);
 
+  pcTag[idx]  = PC;
+  pcInst[idx] = inst;
+
+  return inst;
+}
+
+void RSTReader::addInstruction(int fid, const rstf_instrT *ip) {
+
+  VAddr PC      = ip->pc_va;
+  uint  rawInst = ip->instr;
+  VAddr address = ip->ea_va;
+
+  const Instruction *inst = getInst(PC, rawInst);
+  GI(inst->isMemory(), address>1024 || address==0);
+
   DInst *dinst=DInst::createDInst(inst, address , fid
 #ifdef TLS
                                   ,0 // This will break things (epoch can't be 0)
@@ -59,65 +70,58 @@ void RSTReader::addInstruction(const rstf_unionT *rp) {
   head_size[fid]++;
 }
 
-void RSTReader::advancePC(int fid) { 
+void RSTReader::advancePC(int fid, bool wait) { 
 
-  while(!end_of_trace) {
-    while (buf_pos < buf_end) {
-      rstf_unionT *rp = &buf[buf_pos++];
+  // The records are already decompressed and split per flow by the
+  // pipeline, so refill the whole head in one go
+  while(head_size[fid] < Max_Head_Size) {
+    RSTPipeline::Status st;
+    const rstf_instrT *ip = pipe->next(fid, st, wait);
 
-      // skip markers, only INSTR_T
-      if (rp->proto.rtype != INSTR_T)
-        continue;
+    if (ip) {
+      addInstruction(fid, ip);
+      continue;
+    }
 
-      int inst_fid       = rstf_instrT_get_cpuid(&(rp->instr));
-      if (inst_fid >= nFlows) {
-        static int max_flow_found = nFlows;
-        if(max_flow_found < inst_fid) {
-          MSG("More Flows (%d) than thread contexts (%d)",inst_fid, nFlows);
-          max_flow_found = inst_fid;
-        }
-        continue;
-      }
-      if( head_size[inst_fid] > Max_Head_Size) {
-        buf_pos--;
-        // Too many instruction on the other context
-
-        if(head_size[fid]==0) {
-          // stop current fid (stopcpu)
-          osSim->stopProcessor(fid);
-        }
-        return;
+    if (st == RSTPipeline::EndOfTrace) {
+      if (idle[fid]) {
+        idle[fid] = false;
+        nIdle--;
       }
+    }else if (head_size[fid] == 0 && !idle[fid]) {
+      // Too many instructions on the other contexts (or nothing decoded
+      // yet). Wait until another flow moves the trace forward.
+      idle[fid] = true;
+      nIdle++;
+    }
+    return;
+  }
+}
 
-      addInstruction(rp);
+void RSTReader::pollIdle() {
 
-      // if instruction from another thread add it to the list
-      if(rstf_instrT_get_cpuid(&(rp->instr))!=fid && head_size[inst_fid]==1) {
-        osSim->restartProcessor(inst_fid);
-        continue;
-      }
-      
-      return;
-    }
+  lastPolled = pipe->getSeenChunks();
+
+  for(int f = 0; f < nFlows; f++) {
+    if (!idle[f])
+      continue;
 
-    // Fill Buffer
-    I(buf_pos == buf_end);
+    advancePC(f, false);
 
-    buf_end = rz->decompress(buf, Max_Num_Recs);
-    buf_pos = 0;
-    if (buf_end == 0) {
-      end_of_trace = true;
+    if (head_size[f]) {
+      idle[f] = false;
+      nIdle--;
+      osSim->restartProcessor(f);
     }
   }
 }
 
 RSTReader::RSTReader()
-  : Max_Num_Recs(128)
-  , Max_Head_Size(32) {
+  : Max_Head_Size(32)
+  , PCCache_Size(4096) {
 
-  buf = (rstf_unionT *)malloc(sizeof(rstf_unionT)*Max_Num_Recs);
-  buf_pos = 0;
-  buf_end = 0;
+  rz   = 0;
+  pipe = 0;
 
   int nProcs = SescConf->getRecordSize("","cpucore");
   nFlows = 0;
@@ -132,6 +136,19 @@ RSTReader::RSTReader()
   head = new DInst [nFlows];
   head_size = (char *)malloc(sizeof(char)*nFlows);
   bzero(head_size, sizeof(char)*nFlows);
+
+  idle = (bool *)malloc(sizeof(bool)*nFlows);
+  for(int i = 0; i < nFlows; i++)
+    idle[i] = false;
+  nIdle      = 0;
+  lastPolled = 0;
+
+  pcTag  = (VAddr *)malloc(sizeof(VAddr)*PCCache_Size);
+  pcInst = (const Instruction **)malloc(sizeof(const Instruction *)*PCCache_Size);
+  for(int i = 0; i < PCCache_Size; i++) {
+    pcTag[i]  = 0;
+    pcInst[i] = 0;
+  }
 }
 
 void RSTReader::openTrace(const char *filename) {
@@ -143,56 +160,40 @@ void RSTReader::openTrace(const char *filename) {
     exit(1);
   }
 
-  end_of_trace = false;
-
-  while(!end_of_trace) {
-    while (buf_pos < buf_end) {
-      rstf_unionT *rp = &buf[buf_pos++];
-
-      // skip markers, only INSTR_T
-      if (rp->proto.rtype != INSTR_T)
-        continue;
-
-      int fid       = rstf_instrT_get_cpuid(&(rp->instr));
-
-      VAddr PC      = rp->instr.pc_va;
-      uint  rawInst = rp->instr.instr;
-      VAddr address = rp->instr.ea_va;
-
-      const Instruction *inst = Instruction::getSharedInstByPC(PC);
-      if (inst == 0) {
-        inst = Instruction::getRSTInstByPC(PC, rawInst);
-        GI(inst->isMemory(), address>1024 || address==0);
-      }
-      I(inst);
+  // Number of decompressed rstzip buffers in flight between the
+  // decompression thread and the simulation thread
+  int depth = 4;
+  if (SescConf->checkInt("","rstPipelineDepth"))
+    depth = SescConf->getInt("","rstPipelineDepth");
+  if (depth < 2) {
+    MSG("ERROR: RSTReader::openTrace rstPipelineDepth must be at least 2");
+    exit(1);
+  }
 
-      DInst *dinst=DInst::createDInst(inst, address , fid
-#ifdef TLS
-                                  ,0 // This will break things (epoch can't be 0)
-#endif
-                                  );
+  pipe = new RSTPipeline(rz, nFlows, depth, rstzip_opt_buffersize);
+  pipe->start();
 
-      fid = fid % nFlows;
-      head[fid].addSrc1(dinst);
+  // Preload every flow. Flows without records yet stay idle until the
+  // others move the trace forward.
+  for(int fid = 0; fid < nFlows; fid++)
+    advancePC(fid, fid == 0);
 
-      head_size[fid]++;
+  lastPolled = pipe->getSeenChunks();
+}
 
-      return; // one instruction added :)
-    }
+void RSTReader::closeTrace() {
+  pipe->stop();
 
-    // Fill Buffer
-    I(buf_pos == buf_end);
+  if (pipe->getDropped())
+    MSG("More Flows (%d) than thread contexts (%d): %lld instructions skipped"
+        ,pipe->getMaxCpuFound()+1, nFlows, pipe->getDropped());
 
-    buf_end = rz->decompress(buf, Max_Num_Recs);
-    buf_pos = 0;
-    if (buf_end == 0)
-      end_of_trace = true;
-  }
-}
+  delete pipe;
+  pipe = 0;
 
-void RSTReader::closeTrace() {
   rz->close();
   delete rz;
+  rz = 0;
 }
 
 DInst *RSTReader::executePC(int fid) {
@@ -206,8 +207,16 @@ DInst *RSTReader::executePC(int fid) {
   if (head_size[fid] < (Max_Head_Size/4))
     advancePC(fid);
 
-  if (head_size[fid]==0)
+  if (nIdle && lastPolled != pipe->getSeenChunks())
+    pollIdle();
+
+  if (head_size[fid]==0) {
+    if (idle[fid]) {
+      // stop current fid (stopcpu)
+      osSim->stopProcessor(fid);
+    }
     return 0;
+  }
 
   head_size[fid]--;
   DInst *dinst = head[fid].getNextPending();
@@ -28,27 +28,36 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "DInst.h"
 #include "rstf.h"
 #include "Rstzip.h"
+#include "RSTPipeline.h"
+
+class Instruction;
 
 class RSTReader {
  private:
-  const int Max_Num_Recs;
   const int Max_Head_Size;
+  const int PCCache_Size;
 
   Rstzip *rz;
+  RSTPipeline *pipe;
   
   int nFlows;
   DInst *head;
   char *head_size;
 
-  // Decompressed buffer
-  bool end_of_trace;
-  int  buf_pos;
-  int  buf_end;
-  rstf_unionT *buf;
+  // Flows with an empty head that are waiting for the trace to catch up
+  bool *idle;
+  int   nIdle;
+  long long lastPolled;
+
+  // Direct mapped PC -> Instruction cache in front of the instHash lookups
+  VAddr *pcTag;
+  const Instruction **pcInst;
 
-  void addInstruction(const rstf_unionT *rp);
+  const Instruction *getInst(VAddr PC, uint rawInst);
+  void addInstruction(int fid, const rstf_instrT *ip);
 
-  void advancePC(int fid);
+  void advancePC(int fid, bool wait=true);
+  void pollIdle();
 
  public:
   RSTReader();
@@ -30,130 +30,156 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "TT6Reader.h"
 
 TT6Reader::TT6Reader() {
-  trace = 0;
-  PC = 0;
-  inst = 0;
+  PC      = 0;
   address = 0;
-  count = 0;
   tracEof = true;
+
+  batch    = new Entry[Batch_Size+1];
+  batchPos = 0;
+  batchEnd = 0;
+  hasCarry = false;
+
+  packedPos = 0;
+  packedEnd = 0;
+}
+
+TT6Reader::~TT6Reader() {
+  delete [] batch;
 }
 
 void TT6Reader::openTrace(const char* basename) {
-  char filename[80];
+  char filename[1024];
 
-  strcpy(filename, basename);
-  strcat(filename, "/thread_001.tt6");
-  trace = fopen(filename, "r");
+  snprintf(filename, sizeof(filename), "%s/thread_001.tt6p", basename);
+  if (openPacked(filename)) {
+    MSG("TT6Reader::using packed trace [%s]", filename);
+    return;
+  }
+
+  snprintf(filename, sizeof(filename), "%s/thread_001.tt6", basename);
+  openTT6(filename);
+}
 
-  if (trace == NULL){
-    MSG("TT6Reader::Can't open the trace file."); 
+void TT6Reader::openTT6(const char *filename) {
+  if (!map.open(filename)) {
+    MSG("TT6Reader::Can't open the trace file [%s].", filename); 
     exit(-1);
   }
 
   tracEof = false;
 
-  readPC();
-  if(tracEof) {
+  // The first instruction has no payload, its PC comes first
+  Entry *e = &batch[Batch_Size];
+  if (!map.read(&PC, sizeof(PC)) || !map.read(&e->inst, sizeof(e->inst))) {
     MSG("TT6Reader::Bad trace file."); 
     exit(-1);
   }
-  readInst();
-}
+  e->pc    = PC;
+  e->dAddr = address;
 
-void TT6Reader::closeTrace(){
-  fclose(trace);
+  hasCarry = true;
+  batchPos = 0;
+  batchEnd = 0;
 }
 
-void TT6Reader::advancePC() {
-  if (tracEof) {
-    PC =  0xffffffff;
-    return;
-  }
+bool TT6Reader::openPacked(const char *filename) {
+  if (!map.open(filename))
+    return false;
+
+  const PackedTraceHeader *h = 
+    static_cast<const PackedTraceHeader *>(map.get(sizeof(PackedTraceHeader)));
 
-  readInst();
-  if (isBranch()) {
-    readPC();
-    I(!isMemory());
-    IS(address = count = 0);
+  if (h == 0 
+      || strncmp(h->magic, PACKED_TRACE_MAGIC, sizeof(h->magic)) != 0
+      || h->version != PACKED_TRACE_VERSION
+      || h->recordSize != sizeof(PackedTraceRecord)
+      || map.remaining() < h->nRecords*sizeof(PackedTraceRecord)) {
+    MSG("TT6Reader::Bad packed trace file [%s].", filename); 
+    exit(-1);
   }
-  else {
-    PC += 4;
 
-    if (isMemory()) {
-      readAddress();
-      I(!isBranch());
-      IS(count = 0);
-    }
-    else if (isMemoryExtended()) {
-      readCount();
-    }
-    else { /* arithmetic/regular inst */
-      IS(address = count = 0);
-    }
+  packedPos = static_cast<const PackedTraceRecord *>(map.get(0));
+  packedEnd = packedPos + h->nRecords;
+  tracEof   = false;
 
-  }
+  return true;
 }
 
-void TT6Reader::readPC() { 
-  if (fread(&PC, sizeof(PC), 1, trace) != 1)
-    if (feof(trace))
-      tracEof=true;
-    else{
-      MSG("Error while reading the trace file.");
-      exit(1);
-    }
-  //MSG("TT6Reader: readPC() currentPC = %08x", (unsigned int) PC);
+void TT6Reader::closeTrace(){
+  map.close();
+  packedPos = 0;
+  packedEnd = 0;
+  tracEof   = true;
 }
 
-void TT6Reader::readInst() { 
-        
-  if (fread(&inst, sizeof(inst), 1,trace)!=1)
-    if (feof(trace))
-      tracEof=true;             
-    else{
-      MSG("Error while reading the trace file.");
-      exit(1);
+bool TT6Reader::decodeNext(Entry *e) {
+  // Each record is the instruction followed by its payload: the PC for
+  // flow altering instructions, the data address for memory ones.
+  uint inst;
+  if (!map.read(&inst, sizeof(inst)))
+    return false;
+
+  if (isBranch(inst)) {
+    if (!map.read(&PC, sizeof(PC)))
+      return false;
+  }else{
+    PC += 4;
+    if (isMemory(inst)) {
+      if (!map.read(&address, sizeof(address)))
+        return false;
     }
-        
-}
+  }
 
-void TT6Reader::readAddress() { 
-        
-  if (fread(&address, sizeof(address), 1,trace)!=1)             
-    if (feof(trace))
-      tracEof=true;             
-    else{
-      MSG("Error while reading the trace file.");
-      exit(1);
-    }
+  e->pc    = PC;
+  e->dAddr = address;
+  e->inst  = inst;
+
+  return true;
 }
 
-void TT6Reader::readCount() { 
-  if (fread(&count, sizeof(count), 1,trace)!=1) 
-    if (feof(trace))
-      tracEof=true;             
-    else{
-      MSG("Error while reading the trace file.");
-      exit(1);
-    }
+void TT6Reader::refill() {
+  I(batchPos == batchEnd);
+
+  batchPos = 0;
+  batchEnd = 0;
+  if (!hasCarry)
+    return;
+
+  // The carry (kept in batch[Batch_Size]) is the last decoded
+  // instruction. Its nextPC is the PC of the one decoded after it.
+  batch[0] = batch[Batch_Size];
+  int n = 1;
+  while(n <= Batch_Size && decodeNext(&batch[n])) {
+    batch[n-1].nextPC = batch[n].pc;
+    n++;
+  }
+
+  if (n <= Batch_Size) {
+    // End of the trace (a truncated last record is ignored)
+    batch[n-1].nextPC = 0xffffffff;
+    hasCarry = false;
+    tracEof  = true;
+    batchEnd = n;
+  }else{
+    batchEnd = Batch_Size;
+  }
 }
 
-void TT6Reader::fillTraceEntry(TraceEntry *te, int id) {
-  I(id == 0); // multi-threaded TT6 not supported yet;
-  
-  if(getCurrentPC() == 0xffffffff) { // end of trace
+void TT6Reader::fillPackedEntry(TraceEntry *te) {
+  if (packedPos == packedEnd) {
     te->eot = true;
     return;
   }
-  
-  te->rawInst = getCurrentInst();
-  te->iAddr   = getCurrentPC();
-  
-  if(isMemory()) {
-    te->dAddr = getCurrentDataAddress();
-  }
-  
-  advancePC();
 
-  te->nextIAddr = getCurrentPC();
+  // Through the map, so that the readahead window moves forward
+  const PackedTraceRecord *r =
+    static_cast<const PackedTraceRecord *>(map.get(sizeof(PackedTraceRecord)));
+  I(r == packedPos);
+  packedPos++;
+
+  te->rawInst   = r->rawInst;
+  te->iAddr     = r->iAddr;
+  if (isMemory(r->rawInst))
+    te->dAddr   = r->dAddr;
+  te->nextIAddr = r->nextIAddr;
 }
@@ -30,43 +30,91 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "minidecoder.h"
 #include "TraceEntry.h"
 #include "TraceReader.h"
+#include "MappedTrace.h"
+#include "PackedTrace.h"
 
+// The trace file is mmap-ed and decoded Batch_Size instructions at a
+// time. If basename/thread_001.tt6p exists (produced by tt6pack) it is
+// used instead: the records are already decoded and are read in place.
 class TT6Reader : public TraceReader {
  private:
-  FILE* trace;
+  static const int Batch_Size = 1024;
+
+  class Entry {
+  public:
+    VAddr pc;
+    VAddr nextPC;
+    VAddr dAddr;
+    uint  inst;
+  };
+
+  MappedTrace map;
+
+  // TT6 decoder state
   VAddr PC;
-  uint inst;
   VAddr address;
-  int   count;
-  
+
+  Entry *batch;    // Batch_Size decoded entries, plus one (carry)
+  int    batchPos;
+  int    batchEnd;
+  bool   hasCarry; // batch[batchEnd] decoded, its nextPC still unknown
+
   bool tracEof;
 
-  void readPC();
-  void readInst();
-  void readAddress();
-  void readCount();
-
-  VAddr getCurrentPC()    const { return PC; }
-  int   getCurrentInst()  const { return inst; }
-  int   getCurrentCount() const { return count;}
-  VAddr getCurrentDataAddress() const { return address; }
-  
-  bool  isBranch()  { return tt6_isFlowAltering(inst>>26, (inst>>1) & 0x3FF);};
-  
-  bool  isMemory() { return (tt6_isMemory(inst>>26, (inst>>1) & 0x3FF) 
-			     || tt6_isMemoryExtended(inst>>26, (inst>>1) & 0x3FF));}
-
-  bool  isMemoryExtended() {return tt6_isMemoryExtended(inst>>26, (inst>>1) & 0x3FF);}
-  
-  void advancePC();
+  // Packed format
+  const PackedTraceRecord *packedPos;
+  const PackedTraceRecord *packedEnd;
+
+  static bool isBranch(uint inst) { 
+    return tt6_isFlowAltering(inst>>26, (inst>>1) & 0x3FF);
+  }
+  static bool isMemory(uint inst) { 
+    return (tt6_isMemory(inst>>26, (inst>>1) & 0x3FF) 
+            || tt6_isMemoryExtended(inst>>26, (inst>>1) & 0x3FF));
+  }
+
+  bool decodeNext(Entry *e);
+  void refill();
+
+  void fillPackedEntry(TraceEntry *te);
 
  public:
   TT6Reader();
+  ~TT6Reader();
 
   void openTrace(const char* basename);
   void closeTrace();
 
-  void fillTraceEntry(TraceEntry *te, int id);
+  // Open a given file in one format (openTrace picks one)
+  void openTT6(const char *filename);
+  bool openPacked(const char *filename);
+
+  bool isPacked() const { return packedEnd != 0; }
+
+  void fillTraceEntry(TraceEntry *te, int id) {
+    I(id == 0); // multi-threaded TT6 not supported yet;
+
+    if (packedEnd) {
+      fillPackedEntry(te);
+      return;
+    }
+
+    if (batchPos == batchEnd) {
+      refill();
+      if (batchPos == batchEnd) { // end of trace
+        te->eot = true;
+        return;
+      }
+    }
+
+    const Entry *e = &batch[batchPos++];
+
+    te->rawInst   = e->inst;
+    te->iAddr     = e->pc;
+    if (isMemory(e->inst))
+      te->dAddr   = e->dAddr;
+    te->nextIAddr = e->nextPC;
+  }
 };
 
 #endif
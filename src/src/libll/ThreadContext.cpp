@@ -511,6 +511,7 @@ void ThreadContext::init()
   tmAborting=0;
   tmNacking = 0;
   tmDepth = 0;
+  tmDispatch = 0;
   tmTid = 0;
 #endif
 
@@ -575,6 +576,9 @@ void ThreadContext::initMainThread()
   /* set up this picode so that terminator1() gets called */
   Idone1 = Itext[Text_size + DONE_ICODE];
   Idone1->func = terminator1;
+#if (defined TM)
+  Idone1->tmFunc = terminator1;
+#endif
   Idone1->opnum = terminate_opn;
 
   /* Set up the return address so that terminator1() gets called.
@@ -145,6 +145,7 @@ class ThreadContext {
   int tmAbortMax;       // Maximum Number of Aborts Allowed (after which aborts are just ignored)
   int tmAborting;       // Flag to Indicate Abort Initiated
   int tmNacking;        // Flag to Indicate NACK state
+  int tmDispatch;       // Run the transactional versions of the ops (icode::tmFunc)
   transactionContext *transContext; // Transactional Context
 
   /*
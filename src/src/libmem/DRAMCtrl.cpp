@@ -0,0 +1,343 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2003 University of Illinois.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+#include <string.h>
+
+#include "SescConf.h"
+#include "Snippets.h"
+#include "DRAMCtrl.h"
+
+DRAMCtrl::DRAMCtrl(MemorySystem* current, const char *section,
+		   const char *name)
+  : MemObj(section, name)
+  ,nReads("%s:reads", name)
+  ,nWrites("%s:writes", name)
+  ,rowHits("%s:rowHits", name)
+  ,rowMisses("%s:rowMisses", name)
+  ,rowConflicts("%s:rowConflicts", name)
+  ,writeDrains("%s:writeDrains", name)
+  ,queueFull("%s:queueFull", name)
+  ,readLat("%s:readLat", name)
+  ,writeLat("%s:writeLat", name)
+  ,readQOcc("%s:readQOcc", name)
+{
+  SescConf->isInt(section, "numChannels");
+  SescConf->isInt(section, "numRanks");
+  SescConf->isInt(section, "numBanks");
+  SescConf->isInt(section, "rowSize");
+
+  SescConf->isGT(section, "numChannels", 0);
+  SescConf->isGT(section, "numRanks", 0);
+  SescConf->isGT(section, "numBanks", 0);
+  SescConf->isPower2(section, "rowSize");
+
+  numChannels = SescConf->getInt(section, "numChannels");
+  numRanks    = SescConf->getInt(section, "numRanks");
+  numBanks    = SescConf->getInt(section, "numBanks");
+  rowSize     = SescConf->getInt(section, "rowSize");
+
+  SescConf->isInt(section, "tRCD");
+  SescConf->isInt(section, "tCAS");
+  SescConf->isInt(section, "tRP");
+  SescConf->isInt(section, "tRAS");
+  SescConf->isInt(section, "tBurst");
+
+  tRCD   = SescConf->getInt(section, "tRCD");
+  tCAS   = SescConf->getInt(section, "tCAS");
+  tRP    = SescConf->getInt(section, "tRP");
+  tRAS   = SescConf->getInt(section, "tRAS");
+  tBurst = SescConf->getInt(section, "tBurst");
+
+  ctrlDelay = 0;
+  if (SescConf->checkInt(section, "ctrlDelay"))
+    ctrlDelay = SescConf->getInt(section, "ctrlDelay");
+
+  policy = FRFCFS;
+  if (SescConf->checkCharPtr(section, "scheduler")) {
+    const char *sched = SescConf->getCharPtr(section, "scheduler");
+    if (strcasecmp(sched, "FCFS") == 0) {
+      policy = FCFS;
+    }else if (strcasecmp(sched, "FRFCFS") != 0) {
+      MSG("DRAMCtrl: unknown scheduler [%s] in section [%s]", sched, section);
+      SescConf->notCorrect();
+    }
+  }
+
+  readQueueSize = 32;
+  if (SescConf->checkInt(section, "readQueueSize"))
+    readQueueSize = SescConf->getInt(section, "readQueueSize");
+
+  writeQueueSize = 32;
+  if (SescConf->checkInt(section, "writeQueueSize"))
+    writeQueueSize = SescConf->getInt(section, "writeQueueSize");
+
+  writeHighMark = (3 * writeQueueSize) / 4;
+  if (SescConf->checkInt(section, "writeHighMark"))
+    writeHighMark = SescConf->getInt(section, "writeHighMark");
+
+  writeLowMark = writeQueueSize / 4;
+  if (SescConf->checkInt(section, "writeLowMark"))
+    writeLowMark = SescConf->getInt(section, "writeLowMark");
+
+  if (readQueueSize == 0 || writeQueueSize == 0
+      || writeLowMark >= writeHighMark || writeHighMark > writeQueueSize) {
+    MSG("DRAMCtrl: invalid queue sizes or write watermarks in section [%s]", section);
+    SescConf->notCorrect();
+  }
+
+  BankState b;
+  b.openRow = -1;
+  b.readyAt = 0;
+  b.actAt   = 0;
+
+  channels.resize(numChannels);
+  for(int i = 0; i < numChannels; i++) {
+    channels[i].banks.resize(numRanks * numBanks, b);
+    channels[i].busFree  = 0;
+    channels[i].wakeAt   = 0;
+    channels[i].draining = false;
+  }
+
+  I(current);
+}
+
+void DRAMCtrl::decode(PAddr paddr, int &ch, DRAMReq &r) const
+{
+  unsigned long blk = paddr / rowSize;
+
+  ch   = blk % numChannels;
+  blk /= numChannels;
+
+  int bank = blk % numBanks;
+  blk /= numBanks;
+
+  int rank = blk % numRanks;
+  blk /= numRanks;
+
+  r.bank = rank * numBanks + bank;
+  r.row  = blk;
+}
+
+void DRAMCtrl::enqueue(int ch, ReqQueue &q, ReqQueue &wait, size_t size, const DRAMReq &r)
+{
+  if (q.size() < size && wait.empty()) {
+    q.push_back(r);
+    return;
+  }
+
+  queueFull.inc();
+  wait.push_back(r);
+}
+
+// First cycle the request could start its command sequence
+Time_t DRAMCtrl::canIssueAt(const Channel &c, const DRAMReq &r) const
+{
+  const BankState &b = c.banks[r.bank];
+
+  Time_t t = b.readyAt > globalClock ? b.readyAt : globalClock;
+  if (b.openRow != -1 && b.openRow != r.row) {
+    // Precharge, the row must have been open for tRAS
+    if (b.actAt + tRAS > t)
+      t = b.actAt + tRAS;
+  }
+
+  return t;
+}
+
+// Returns the position of the request to issue now, or -1 and in next
+// the first cycle a request of q can issue
+int DRAMCtrl::pick(Channel &c, ReqQueue &q, Time_t &next)
+{
+  next = 0;
+  if (q.empty())
+    return -1;
+
+  if (policy == FCFS) {
+    next = canIssueAt(c, q[0]);
+    return next <= globalClock ? 0 : -1;
+  }
+
+  // FR-FCFS: ready row hits first, then the oldest ready request
+  int oldest = -1;
+  for(size_t i = 0; i < q.size(); i++) {
+    Time_t t = canIssueAt(c, q[i]);
+    if (t <= globalClock) {
+      if (c.banks[q[i].bank].openRow == q[i].row)
+	return i;
+      if (oldest == -1)
+	oldest = i;
+    }else if (next == 0 || t < next) {
+      next = t;
+    }
+  }
+
+  return oldest;
+}
+
+void DRAMCtrl::issue(int ch, const DRAMReq &r)
+{
+  Channel &c = channels[ch];
+  BankState &b = c.banks[r.bank];
+  Time_t cas;
+
+  if (b.openRow == r.row) {
+    rowHits.inc();
+    cas = globalClock;
+  }else if (b.openRow == -1) {
+    rowMisses.inc();
+    b.actAt = globalClock;
+    cas = b.actAt + tRCD;
+  }else{
+    rowConflicts.inc();
+    b.actAt = globalClock + tRP;
+    cas = b.actAt + tRCD;
+  }
+
+  b.openRow = r.row;
+  b.readyAt = cas + tBurst;
+
+  Time_t data = cas + tCAS;
+  if (data < c.busFree)
+    data = c.busFree;
+  c.busFree = data + tBurst;
+
+  if (r.mreq) {
+    readLat.sample(c.busFree + ctrlDelay - r.arrival);
+    r.mreq->goUpAbs(c.busFree + ctrlDelay);
+  }else{
+    writeLat.sample(c.busFree - r.arrival);
+  }
+}
+
+void DRAMCtrl::wake(int ch, Time_t when)
+{
+  Channel &c = channels[ch];
+
+  if (when < globalClock)
+    when = globalClock;
+
+  if (c.wakeAt != 0 && c.wakeAt <= when)
+    return; // An earlier event looks at the queues again
+
+  c.wakeAt = when;
+  scheduleCB::scheduleAbs(when, this, ch);
+}
+
+void DRAMCtrl::schedule(int ch)
+{
+  Channel &c = channels[ch];
+
+  if (c.wakeAt != globalClock)
+    return; // Superseded by an earlier wake up
+
+  c.wakeAt = 0;
+
+  size_t nWr = c.writeQ.size() + c.writeWait.size();
+  bool   rd  = !c.readQ.empty();
+
+  if (!c.draining && nWr && (nWr >= writeHighMark || !rd)) {
+    c.draining = true;
+    writeDrains.inc();
+  }else if (c.draining && (nWr == 0 || (nWr <= writeLowMark && rd))) {
+    c.draining = false;
+  }
+
+  bool wr = c.draining;
+
+  Time_t next;
+  int pos = pick(c, wr ? c.writeQ : c.readQ, next);
+  if (pos < 0) {
+    // Nothing ready in the preferred queue, do not leave the bus idle
+    Time_t otherNext;
+    pos = pick(c, wr ? c.readQ : c.writeQ, otherNext);
+    if (pos < 0) {
+      if (otherNext && (next == 0 || otherNext < next))
+        next = otherNext;
+      if (next)
+        wake(ch, next);
+      return;
+    }
+    wr = !wr;
+  }
+
+  ReqQueue &q    = wr ? c.writeQ    : c.readQ;
+  ReqQueue &wait = wr ? c.writeWait : c.readWait;
+  size_t    size = wr ? writeQueueSize : readQueueSize;
+
+  DRAMReq r = q[pos];
+  q.erase(q.begin() + pos);
+  while (q.size() < size && !wait.empty()) {
+    q.push_back(wait.front());
+    wait.pop_front();
+  }
+
+  issue(ch, r);
+
+  // One command sequence per cycle and channel
+  if (!c.readQ.empty() || !c.writeQ.empty())
+    wake(ch, globalClock + 1);
+}
+
+void DRAMCtrl::access(MemRequest *mreq)
+{
+  DRAMReq r;
+  int ch;
+
+  decode(mreq->getPAddr(), ch, r);
+  r.arrival = globalClock;
+
+  Channel &c = channels[ch];
+
+  if (mreq->getMemOperation() == MemWrite || mreq->getMemOperation() == MemPush) {
+    // Posted write, the data is in the controller
+    nWrites.inc();
+    r.mreq = 0;
+    enqueue(ch, c.writeQ, c.writeWait, writeQueueSize, r);
+    mreq->goUp(ctrlDelay);
+  }else{
+    nReads.inc();
+    readQOcc.sample(c.readQ.size() + c.readWait.size());
+    r.mreq = mreq;
+    enqueue(ch, c.readQ, c.readWait, readQueueSize, r);
+  }
+
+  wake(ch, globalClock);
+}
+
+void DRAMCtrl::returnAccess(MemRequest *mreq)
+{
+  I(0); // Last level, nothing below
+  mreq->goUp(0);
+}
+
+Time_t DRAMCtrl::getNextFreeCycle() const
+{
+  return globalClock;
+}
+
+void DRAMCtrl::invalidate(PAddr addr,ushort size,MemObj *oc)
+{
+  invUpperLevel(addr,size,oc);
+}
+
+bool DRAMCtrl::canAcceptStore(PAddr addr)
+{
+  return true;
+}
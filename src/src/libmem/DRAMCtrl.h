@@ -0,0 +1,142 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2003 University of Illinois.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+#ifndef DRAMCTRL_H
+#define DRAMCTRL_H
+
+#include "nanassert.h"
+
+#include <deque>
+#include <vector>
+
+#include "GStats.h"
+#include "callback.h"
+#include "MemRequest.h"
+#include "MemObj.h"
+#include "MemorySystem.h"
+
+// DRAM controller with open row buffers. It is the last level (in place
+// of MemCtrl or the niceCache memory).
+//
+// Each channel has a read and a write queue. Only the first
+// readQueueSize/writeQueueSize requests can be scheduled, the rest wait
+// in arrival order. Every cycle at most one request issues per channel
+// (its PRE/ACT/CAS sequence is timed when it issues): with FR-FCFS the
+// oldest row hit whose bank is ready, otherwise the oldest request whose
+// bank is ready; with FCFS the oldest request. Writes are acknowledged
+// when queued and drained from writeHighMark down to writeLowMark (or
+// when there is nothing to read).
+//
+// The channel is only woken up when a queued request can issue (bank
+// ready, tRAS met for a conflict), there are no per cycle events.
+//
+// Address map: row | rank | bank | channel | column (rowSize bytes)
+
+class DRAMCtrl: public MemObj {
+protected:
+  enum SchedPolicy {
+    FCFS = 0,
+    FRFCFS
+  };
+
+  struct DRAMReq {
+    MemRequest *mreq;     // 0 for writes (already acknowledged)
+    Time_t      arrival;
+    int         bank;     // rank * numBanks + bank
+    long        row;
+  };
+
+  typedef std::deque<DRAMReq> ReqQueue;
+
+  struct BankState {
+    long   openRow;       // -1 if precharged
+    Time_t readyAt;       // next command
+    Time_t actAt;         // last activate (tRAS)
+  };
+
+  struct Channel {
+    ReqQueue  readQ;
+    ReqQueue  writeQ;
+    ReqQueue  readWait;   // beyond readQueueSize
+    ReqQueue  writeWait;  // beyond writeQueueSize
+    std::vector<BankState> banks;
+    Time_t    busFree;    // data bus
+    Time_t    wakeAt;     // scheduled event (0 if none)
+    bool      draining;
+  };
+
+  std::vector<Channel> channels;
+
+  SchedPolicy policy;
+
+  int numChannels;
+  int numRanks;
+  int numBanks;
+  int rowSize;
+
+  TimeDelta_t tRCD;
+  TimeDelta_t tCAS;
+  TimeDelta_t tRP;
+  TimeDelta_t tRAS;
+  TimeDelta_t tBurst;
+  TimeDelta_t ctrlDelay;
+
+  size_t readQueueSize;
+  size_t writeQueueSize;
+  size_t writeHighMark;
+  size_t writeLowMark;
+
+  GStatsCntr nReads;
+  GStatsCntr nWrites;
+  GStatsCntr rowHits;
+  GStatsCntr rowMisses;
+  GStatsCntr rowConflicts;
+  GStatsCntr writeDrains;
+  GStatsCntr queueFull;
+  GStatsAvg  readLat;
+  GStatsAvg  writeLat;
+  GStatsAvg  readQOcc;
+
+  void decode(PAddr paddr, int &ch, DRAMReq &r) const;
+  void enqueue(int ch, ReqQueue &q, ReqQueue &wait, size_t size, const DRAMReq &r);
+
+  Time_t canIssueAt(const Channel &c, const DRAMReq &r) const;
+  int    pick(Channel &c, ReqQueue &q, Time_t &next);
+  void   issue(int ch, const DRAMReq &r);
+
+  void wake(int ch, Time_t when);
+  void schedule(int ch);
+  typedef CallbackMember1<DRAMCtrl, int, &DRAMCtrl::schedule> scheduleCB;
+
+public:
+  DRAMCtrl(MemorySystem* current, const char *device_descr_section,
+	   const char *device_name=NULL);
+  ~DRAMCtrl() {};
+
+  void access(MemRequest *mreq);
+  void returnAccess(MemRequest *mreq);
+
+  Time_t getNextFreeCycle() const;
+
+  virtual void invalidate(PAddr addr,ushort size,MemObj *oc);
+  bool canAcceptStore(PAddr addr);
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include "Bus.h"
 #include "PriorityBus.h"
 #include "MemCtrl.h"
+#include "DRAMCtrl.h"
 #include "Bank.h"
 #include "StridePrefetcher.h"
 #include "AddressPrefetcher.h"
@@ -26,6 +27,7 @@
 #define k_bus          "bus"
 #define k_priobus      "prioritybus"
 #define k_memctrl      "memctrl"
+#define k_dramctrl     "dramctrl"
 #define k_bank         "bank"
 #define k_niceCache    "niceCache"
 #define k_WB           "WB"
@@ -125,6 +127,10 @@ MemObj *MemorySystem::buildMemoryObj(const char *device_type,
 
     new_memory_device = new MemCtrl(this, device_descr_section, device_name);
 
+  } else if (!strcasecmp(device_type, k_dramctrl)) {
+
+    new_memory_device = new DRAMCtrl(this, device_descr_section, device_name);
+
   } else if (!strcasecmp(device_type, k_void)) {      // For testing purposes
 
     return NULL; 
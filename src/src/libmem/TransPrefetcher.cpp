@@ -0,0 +1,249 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2003 University of Illinois.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include "nanassert.h"
+#include "SescConf.h"
+
+#include "TransPrefetcher.h"
+#include "GMemorySystem.h"
+#include "ThreadContext.h"
+#include "OSSim.h"
+#include "GProcessor.h"
+
+std::vector<TransPrefetcher *> TransPrefetcher::instances;
+std::vector<TransPrefetcher::Attempt> TransPrefetcher::attempt;
+TransPrefetcher::HistoryMap TransPrefetcher::history;
+
+TransPrefetcher::TransPrefetcher(MemObj *cache
+	 ,const char *cacheSection
+	 ,const char *name)
+  : l1(cache)
+  ,issued("%s_TP:issued", name)
+  ,issuedExcl("%s_TP:issuedExcl", name)
+  ,filled("%s_TP:filled", name)
+  ,untranslated("%s_TP:untranslated", name)
+  ,retries("%s_TP:retries", name)
+  ,commits("%s_TP:commits", name)
+  ,retryLat("%s_TP:retryLat", name)
+{
+  I(l1);
+
+  const char *section = SescConf->getCharPtr(cacheSection, "transPref");
+
+  SescConf->isInt(section, "depth");
+  depth = SescConf->getInt(section, "depth");
+
+  prefetchDelay = 0;
+  if (SescConf->checkInt(section, "prefetchDelay"))
+    prefetchDelay = SescConf->getInt(section, "prefetchDelay");
+
+  I(depth >= 0);
+
+  SescConf->isInt(cacheSection, "bsize");
+  defaultMask = ~(SescConf->getInt(cacheSection, "bsize")-1);
+
+  instances.push_back(this);
+}
+
+TransPrefetcher::Attempt &TransPrefetcher::getAttempt(int pid)
+{
+  if ((size_t)pid >= attempt.size()) {
+    Attempt a;
+    a.pc       = 0;
+    a.begin    = 0;
+    a.replay   = false;
+    a.conflict = false;
+    attempt.resize(pid + 1, a);
+  }
+
+  return attempt[pid];
+}
+
+// Prefetcher of the L1 the thread runs on
+TransPrefetcher *TransPrefetcher::getInstance(int pid)
+{
+  if (instances.empty())
+    return 0;
+
+  GProcessor *gproc = osSim->pid2GProcessor(pid);
+  if (gproc == 0)
+    return 0;
+
+  MemObj *dl1 = gproc->getMemorySystem()->getDataSource();
+  for(size_t i = 0; i < instances.size(); i++) {
+    if (instances[i]->l1 == dl1)
+      return instances[i];
+  }
+  return 0;
+}
+
+// The line goes to the L1 as the physical line the memory system sees,
+// translated with the DTLB of the thread's processor (no page walk)
+void TransPrefetcher::prefetch(int pid, RAddr caddr, bool write, Time_t lat)
+{
+  ThreadContext *context = ThreadContext::getContext(pid);
+  GProcessor *gproc = osSim->pid2GProcessor(pid);
+  if (context == 0 || gproc == 0)
+    return;
+
+  int paddr = gproc->getMemorySystem()->getMemoryOS()->TLBTranslate(context->real2virt(caddr));
+  if (paddr == -1) {
+    untranslated.inc();
+    return;
+  }
+
+  PAddr addr = ((PAddr)paddr) & defaultMask;
+
+  CBMemRequest *r;
+  r = CBMemRequest::create(lat, l1, write ? MemReadW : MemRead, addr,
+                           processAckCB::create(this, addr));
+  if(lat != 0) { // if lat=0, the req might not exist anymore at this point
+    r->markPrefetch();
+  }
+
+  if (write)
+    issuedExcl.inc();
+  else
+    issued.inc();
+}
+
+void TransPrefetcher::processAck(PAddr addr)
+{
+  filled.inc();
+}
+
+void TransPrefetcher::begin(int pid, RAddr pc)
+{
+  Attempt &a = getAttempt(pid);
+
+  a.pc       = pc;
+  a.begin    = globalClock;
+  a.replay   = false;
+  a.conflict = false;
+  a.lines.clear();
+
+  HistoryMap::iterator it = history.find(std::make_pair(pid, pc));
+  if (it == history.end())
+    return;
+
+  a.replay = true;
+  retries.inc();
+
+  Time_t lat = prefetchDelay;
+  for(size_t i = 0; i < it->second.size(); i++) {
+    prefetch(pid, it->second[i].caddr, it->second[i].write, lat);
+    lat++; // one request per cycle
+  }
+}
+
+// The history of an aborted attempt is the line it aborted on followed
+// by the most recently added ones, depth lines at most
+void TransPrefetcher::end(int pid, bool aborted)
+{
+  Attempt &a = getAttempt(pid);
+  if (a.pc == 0)
+    return;
+
+  if (a.replay)
+    retryLat.sample(globalClock - a.begin);
+
+  if (aborted) {
+    LineList &h = history[std::make_pair(pid, a.pc)];
+    h.clear();
+    if (a.conflict && depth > 0)
+      h.push_back(a.conflictLine);
+
+    for(size_t i = a.lines.size(); i > 0; i--) {
+      const LineRef &l = a.lines[i - 1];
+      size_t j;
+      for(j = 0; j < h.size(); j++) {
+        if (h[j].caddr == l.caddr)
+          break;
+      }
+      if (j < h.size())
+        h[j].write = h[j].write || l.write; // read and written
+      else if (h.size() < (size_t)depth)
+        h.push_back(l);
+    }
+  }else{
+    commits.inc();
+    history.erase(std::make_pair(pid, a.pc));
+  }
+
+  a.pc       = 0;
+  a.conflict = false;
+  a.lines.clear();
+}
+
+void TransPrefetcher::txBegin(int pid, RAddr pc)
+{
+  TransPrefetcher *p = getInstance(pid);
+  if (p)
+    p->begin(pid, pc);
+}
+
+// First access of the line by the attempt. Only the newest lines can
+// make it to the history, the oldest ones are dropped as it grows
+void TransPrefetcher::txLine(int pid, RAddr caddr, bool write)
+{
+  TransPrefetcher *p = getInstance(pid);
+  Attempt &a = getAttempt(pid);
+  if (p == 0 || a.pc == 0 || p->depth == 0)
+    return;
+
+  if (a.lines.size() >= 2 * (size_t)p->depth)
+    a.lines.erase(a.lines.begin(), a.lines.begin() + p->depth);
+
+  LineRef l;
+  l.caddr = caddr;
+  l.write = write;
+  a.lines.push_back(l);
+}
+
+// The attempt is aborting on caddr (conflict or overflow), it is the
+// first line prefetched by the retry
+void TransPrefetcher::txConflict(int pid, RAddr caddr, bool write)
+{
+  if (instances.empty())
+    return;
+
+  Attempt &a = getAttempt(pid);
+  if (a.pc == 0)
+    return;
+
+  a.conflict           = true;
+  a.conflictLine.caddr = caddr;
+  a.conflictLine.write = write;
+}
+
+void TransPrefetcher::txAbort(int pid)
+{
+  TransPrefetcher *p = getInstance(pid);
+  if (p)
+    p->end(pid, true);
+}
+
+void TransPrefetcher::txCommit(int pid)
+{
+  TransPrefetcher *p = getInstance(pid);
+  if (p)
+    p->end(pid, false);
+}
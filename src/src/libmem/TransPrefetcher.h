@@ -0,0 +1,114 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2003 University of Illinois.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef TRANS_PREFETCHER_H
+#define TRANS_PREFETCHER_H
+
+#include <vector>
+#include <map>
+
+#include "callback.h"
+#include "GStats.h"
+#include "MemObj.h"
+#include "MemRequest.h"
+
+// Abort-replay prefetcher. An aborted transaction re-executes the same
+// code and touches almost the same lines, but the retry takes the misses
+// again (the conflicting writer took some lines away, others were
+// displaced during the abort stall). The TM layer (transCoherence) tells
+// the prefetcher every line a transaction adds to its read/write set and
+// the line it aborted on. The lines of an aborted attempt are kept by
+// (thread, begin PC); when that transaction begins again, the
+// conflicting line and the most recent ones (up to depth) are requested
+// from the thread's L1, the write set as MemReadW, so the L1 gets the
+// lines with ownership before the retry needs them.
+//
+// It hooks on the private L1 (the smpcache section names the prefetcher
+// with transPref), one per L1. The history is shared, a thread that
+// migrates still finds its lines.
+//
+// The prefetched lines are not tagged in the L1, the benefit shows as
+// retryLat (begin to commit/abort of the retries) and the L1 misses.
+
+class TransPrefetcher {
+private:
+  struct LineRef {
+    RAddr caddr;       // transCoherence line, translated when prefetched
+    bool  write;
+  };
+  typedef std::vector<LineRef> LineList;
+
+  // Attempt of a thread running a transaction
+  struct Attempt {
+    RAddr    pc;       // begin PC, 0 if not in a transaction
+    Time_t   begin;
+    bool     replay;   // prefetched at its begin
+    bool     conflict; // aborted on conflictLine
+    LineRef  conflictLine;
+    LineList lines;    // read/write set, in access order
+  };
+
+  typedef std::map<std::pair<int, RAddr>, LineList> HistoryMap;
+
+  static std::vector<TransPrefetcher *> instances;
+  static std::vector<Attempt> attempt; // indexed by pid
+  static HistoryMap history;
+
+  MemObj *l1;
+
+  int depth;
+  int prefetchDelay;
+
+  PAddr defaultMask;
+
+  GStatsCntr issued;
+  GStatsCntr issuedExcl;
+  GStatsCntr filled;
+  GStatsCntr untranslated;
+  GStatsCntr retries;
+  GStatsCntr commits;
+  GStatsAvg  retryLat;
+
+  static Attempt &getAttempt(int pid);
+  static TransPrefetcher *getInstance(int pid);
+
+  void prefetch(int pid, RAddr caddr, bool write, Time_t lat);
+
+  void begin(int pid, RAddr pc);
+  void end(int pid, bool aborted);
+
+public:
+  TransPrefetcher(MemObj *cache, const char *cacheSection, const char *name);
+  ~TransPrefetcher() {}
+
+  void processAck(PAddr addr);
+  typedef CallbackMember1<TransPrefetcher, PAddr, &TransPrefetcher::processAck> processAckCB;
+
+  // TM events (transCoherence). Cheap when no transPref is configured.
+  static bool isActive() { return !instances.empty(); }
+  static void txBegin(int pid, RAddr pc);
+  static void txLine(int pid, RAddr caddr, bool write);
+  static void txConflict(int pid, RAddr caddr, bool write);
+  static void txAbort(int pid);
+  static void txCommit(int pid);
+};
+
+#endif // TRANS_PREFETCHER_H
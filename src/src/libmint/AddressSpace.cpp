@@ -1,4 +1,5 @@
 #include "AddressSpace.h"
+#include "HugePage.h"
 
 AddressSpace::AddressSpace(void)
   // Allocate the entire page table and zero it out  
@@ -21,8 +22,8 @@ void AddressSpace::delReference(void){
 void AddressSpace::newRMem(VAddr begVAddr, VAddr endVAddr){
   begVAddr=alignDown(begVAddr,getPageSize());
   endVAddr=alignUp(endVAddr,getPageSize());
-  void *realMem;
-  if(posix_memalign(&realMem,getPageSize(),endVAddr-begVAddr))
+  void *realMem=HugePage::alloc(endVAddr-begVAddr,"addrSpace",getPageSize());
+  if(!realMem)
     fatal("AddressSpace::newRMem could not allocate memory\n");
   for(size_t pageNum=getVPage(begVAddr);pageNum!=getVPage(endVAddr);pageNum++){
     if(pageTable[pageNum])
@@ -35,7 +36,7 @@ void AddressSpace::delRMem(VAddr begVAddr, VAddr endVAddr){
   begVAddr=alignDown(begVAddr,getPageSize());
   endVAddr=alignUp(endVAddr,getPageSize());
   RAddr begRAddr=pageTable[getVPage(begVAddr)];
-  free((void *)begRAddr);
+  HugePage::free((void *)begRAddr);
   for(VAddr pageNum=getVPage(begVAddr);pageNum!=getVPage(endVAddr);pageNum++){
     if(pageTable[pageNum]!=begRAddr+(pageNum*getPageSize()-begVAddr))
       fatal("AddressSpace::delRMem region not allocated contiguously");
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include "icode.h"
@@ -92,6 +93,25 @@ OP(mint_sesc_fast_sim_end)
   return pthread->getRetIcode();
 }
 
+OP(mint_sesc_stats_epoch)
+{
+  VAddr addr = pthread->getIntReg(IntArg1Reg);
+  char name[64];
+
+  // NULL closes the current epoch
+  if (addr) {
+    strncpy(name, (const char *)pthread->virt2real(addr), sizeof(name) - 1);
+    name[sizeof(name) - 1] = 0;
+  }
+
+  // Do the actual call (should not context-switch)
+  ID(Pid_t thePid=pthread->getPid());
+  rsesc_stats_epoch(pthread->getPid(), addr ? name : 0);
+  I(pthread->getPid()==thePid);
+  // Return from the call
+  return pthread->getRetIcode();
+}
+
 #include "OSSim.h"
 
 OP(mint_sesc_suspend)
@@ -77,6 +77,9 @@ class icode {
 public:
   unsigned int instID;
   PFPI func;			/* function that simulates this instruction */
+#if (defined TM)
+  PFPI tmFunc;			/* same, inside a transaction (see m4.macros) */
+#endif
   int addr;			/* text address of this instruction */
   short args[4];		/* the non-shifted register args */
   short immed;		/* bits 0 - 15 */
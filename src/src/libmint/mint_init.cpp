@@ -51,6 +51,7 @@
 #include "mendian.h"
 
 #include "nanassert.h"
+#include "HugePage.h"
 
 #ifdef DARWIN
 #include <fenv.h>
@@ -138,6 +139,8 @@ void mint_init(int argc, char **argv, char **envp)
   copy_argv(argc-next_arg,argv+next_arg,envp);
   subst_functions();
 
+  HugePage::dump(stderr);
+
   ThreadContext::initMainThread();
   
 #ifdef DARWIN
@@ -303,7 +306,9 @@ void *allocate2(int nbytes)
   // Milos: align to a 16-megabyte boundary so small
   // changes to the simulator are unlikely to change the
   // starting address of the allocated block of memory
-  status = posix_memalign(&ptr,0x1000000,nbytes);
+  // The data, heap and stacks are accessed at random: use huge pages
+  ptr = HugePage::alloc(nbytes,"mint",0x1000000);
+  status = (ptr == NULL);
 #else
   ptr = malloc(size2);
   status = (ptr == NULL);
@@ -388,7 +393,11 @@ static void create_addr_space()
     RAddr oldSpace = Private_start;
     Private_start = (MINTAddrType)allocate2(Mem_size);
     fprintf(stderr,"Overlap: Shifting address space [0x%p] -> [0x%p]\n",(void*)oldSpace, (void*)Private_start);
+#if (defined SUNOS) || !(defined POSIX_MEMALIGN)
     free((void *)oldSpace);
+#else
+    HugePage::free((void *)oldSpace);
+#endif
     Private_end   = Private_start + Mem_size;
   }
 
@@ -499,6 +508,9 @@ icode_ptr newcopy_icode(icode_ptr picode){
   }
   inew = &Icode_free[--Nicode];
   inew->func = picode->func;
+#if (defined TM)
+  inew->tmFunc = picode->tmFunc;
+#endif
   inew->addr = picode->addr;
   inew->instr = picode->instr;
   for (i = 0; i < 4; i++)
@@ -562,7 +574,7 @@ read_text()
 	  (num_pointers + 1) * sizeof(icode_ptr));
 
   /* Allocate space for the icode structures */
-  picode = (icode_ptr) calloc(num_pointers, sizeof(struct icode));
+  picode = (icode_ptr) HugePage::alloc(num_pointers * sizeof(struct icode), "icode");
   icodeArray=picode;
   icodeArraySize=num_pointers;
   if (picode == NULL)
@@ -762,6 +774,13 @@ read_text()
       picode->func = pfunc[voffset];
     else
       picode->func = pfunc[0];
+#if (defined TM)
+    /* Only memory instructions have transactional versions */
+    if( opflags & E_MEM_REF )
+      picode->tmFunc = pfunc[voffset+2];
+    else
+      picode->tmFunc = picode->func;
+#endif
 	
     dslot = NULL;
     if (prev_was_branch) {
@@ -783,6 +802,12 @@ read_text()
 	dslot->func = pfunc[voffset+1];
       else
 	dslot->func = pfunc[1];
+#if (defined TM)
+      if( opflags & E_MEM_REF )
+	dslot->tmFunc = pfunc[voffset+3];
+      else
+	dslot->tmFunc = dslot->func;
+#endif
     }
 
     /* Set or clear the "prev_was_branch" flag so that the next instruction
@@ -15,6 +15,7 @@ void rsesc_simulation_mark(int pid);
 void rsesc_simulation_mark_id(int pid,int id);
 void rsesc_fast_sim_begin(int pid);
 void rsesc_fast_sim_end(int pid);
+void rsesc_stats_epoch(int pid, const char *name);
 int  rsesc_suspend(int pid, int tid);
 int  rsesc_resume(int pid, int tid);
 int  rsesc_yield(int pid, int tid);
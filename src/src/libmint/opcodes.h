@@ -187,6 +187,7 @@ typedef enum ud_class_e {
   OP(mint_sesc_simulation_mark_id);
   OP(mint_sesc_fast_sim_begin);
   OP(mint_sesc_fast_sim_end);
+  OP(mint_sesc_stats_epoch);
   OP(mint_sesc_preevent);
   OP(mint_sesc_postevent);
   OP(mint_sesc_memfence);
@@ -455,7 +455,7 @@ M4_IN(jr_op,
 
 M4_BREAD(lb_op, pthread->getREG(picode, RT),
 {
-#if (defined TM)
+#if TM_OPS
 
   if(pthread->tmDepth > 0)
   {
@@ -488,7 +488,7 @@ M4_BREAD(lb_op, pthread->getREG(picode, RT),
 
 #endif
 
-#if (defined TM)
+#if TM_OPS
     if(pthread->tmAborting)
     {
       pthread->tmAborting = 0;
@@ -504,7 +504,7 @@ M4_BREAD(lb_op, pthread->getREG(picode, RT),
 
 M4_BREAD(lbu_op, pthread->getREG(picode, RT),
 {
-#if (defined TM)
+#if TM_OPS
 
   if(pthread->tmDepth > 0)
   {
@@ -539,7 +539,7 @@ M4_BREAD(lbu_op, pthread->getREG(picode, RT),
 
 #endif
 
-#if (defined TM)
+#if TM_OPS
     if(pthread->tmAborting)
     {
       pthread->tmAborting = 0;
@@ -560,7 +560,7 @@ M4_DREAD(ldc1_op, pthread->getDP(picode, ICODEFT),
         address_exception_op(picode, pthread);
 #endif
 
-#if (defined TM)
+#if TM_OPS
   if(pthread->tmDepth > 0)
   {
 
@@ -602,7 +602,7 @@ M4_DREAD(ldc1_op, pthread->getDP(picode, ICODEFT),
 #endif
 
 
-#if (defined TM)
+#if TM_OPS
     if(pthread->tmAborting)
     {
       pthread->tmAborting = 0;
@@ -632,7 +632,7 @@ M4_SREAD(lh_op, pthread->getREG(picode, RT),
     address_exception_op(picode, pthread);
 #endif
 
-#if (defined TM)
+#if TM_OPS
   if(pthread->tmDepth > 0)
   {
     
@@ -691,7 +691,7 @@ M4_SREAD(lh_op, pthread->getREG(picode, RT),
 #endif
 
 
-#if (defined TM)
+#if TM_OPS
     if(pthread->tmAborting)
     {
       pthread->tmAborting = 0;
@@ -712,7 +712,7 @@ M4_SREAD(lhu_op, pthread->getREG(picode, RT),
 #endif
 
 
-#if (defined TM)
+#if TM_OPS
 
   if(pthread->tmDepth > 0)
   {
@@ -751,7 +751,7 @@ M4_SREAD(lhu_op, pthread->getREG(picode, RT),
 #endif
 #endif
 
-#if (defined TM)
+#if TM_OPS
     if(pthread->tmAborting)
     {
       pthread->tmAborting = 0;
@@ -771,7 +771,7 @@ M4_READ(ll_op, pthread->getREG(picode, RT),
     address_exception_op(picode, pthread);
 #endif
 
-  #if (defined TM)
+  #if TM_OPS
   if(pthread->tmDepth > 0)
   {
     fprintf(tmReport->getOutfile(),"!!!!!!!!!!! WE HAVE A LL HERE!!\n");
@@ -795,7 +795,7 @@ M4_READ(lw_op, pthread->getREG(picode, RT),
     address_exception_op(picode, pthread);
 #endif
 
-#if (defined TM)
+#if TM_OPS
   if (pthread->tmDepth > 0){
 
     ID(
@@ -824,7 +824,7 @@ M4_READ(lw_op, pthread->getREG(picode, RT),
   pthread->setREGFromMem(picode, RT, (int *) raddr);
 #endif
 
-#if (defined TM)
+#if TM_OPS
     if(pthread->tmAborting)
     {
       pthread->tmAborting = 0;
@@ -845,7 +845,7 @@ M4_FREAD(lwc1_op, pthread->getFP(picode, ICODEFT),
     address_exception_op(picode, pthread);
 #endif
 
-#if (defined TM)
+#if TM_OPS
 {
 
  if (pthread->tmDepth > 0){
@@ -885,7 +885,7 @@ M4_FREAD(lwc1_op, pthread->getFP(picode, ICODEFT),
   pthread->setFPFromMem(picode, ICODEFT, (float *) raddr);
 #endif
 
-#if (defined TM)
+#if TM_OPS
     if(pthread->tmAborting)
     {
       pthread->tmAborting = 0;
@@ -911,7 +911,7 @@ M4_READ(lwc3_op, pthread->getWFP(picode, ICODEFT),
 
 M4_BREAD(lwl_op, pthread->getREG(picode, RT),
 {
-#if (defined TM)
+#if TM_OPS
   if(pthread->tmDepth > 0)
   {
     fprintf(tmReport->getOutfile(),"!!!!!!!!!!! WE HAVE A LWL HERE!!\n");
@@ -928,7 +928,7 @@ M4_BREAD(lwl_op, pthread->getREG(picode, RT),
 
 M4_BREAD(lwr_op, pthread->getREG(picode, RT),
 {
-  #if (defined TM)
+  #if TM_OPS
   if(pthread->tmDepth > 0)
   {
     fprintf(tmReport->getOutfile(),"!!!!!!!!!!! WE HAVE A LWR HERE!!\n");
@@ -995,7 +995,7 @@ M4_IN(ori_op,
 
 M4_WRITE(sb_op,
 {
-#if (defined TM)
+#if TM_OPS
   if(pthread->tmDepth > 0)
   {
 
@@ -1030,7 +1030,7 @@ M4_WRITE(sb_op,
 #endif
 
 
-#if (defined TM)
+#if TM_OPS
     if(pthread->tmAborting)
     {
       pthread->tmAborting = 0;
@@ -1052,7 +1052,7 @@ M4_WRITE(sc_op,
         address_exception_op(picode, pthread);
 #endif
 
-    #if (defined TM)
+    #if TM_OPS
   if(pthread->tmDepth > 0)
   {
     fprintf(tmReport->getOutfile(),"!!!!!!!!!!! WE HAVE A SC HERE!!\n");
@@ -1088,7 +1088,7 @@ M4_WRITE(sdc1_op,
 
 
 
-#if (defined TM)
+#if TM_OPS
   if(pthread->tmDepth > 0)
   {
     ID(
@@ -1119,7 +1119,7 @@ M4_WRITE(sdc1_op,
  *((double *)raddr)=pthread->getDP(picode, ICODEFT);
 #endif
 
-#if (defined TM)
+#if TM_OPS
     if(pthread->tmAborting)
     {
       pthread->tmAborting = 0;
@@ -1150,7 +1150,7 @@ M4_WRITE(sh_op,
         address_exception_op(picode, pthread);
 #endif
 
-#if (defined TM)
+#if TM_OPS
   if(pthread->tmDepth > 0)
   {
 
@@ -1188,7 +1188,7 @@ M4_WRITE(sh_op,
 #endif
 #endif
 
-#if (defined TM)
+#if TM_OPS
     if(pthread->tmAborting)
     {
       pthread->tmAborting = 0;
@@ -1272,7 +1272,7 @@ M4_WRITE(sw_op,
     address_exception_op(picode, pthread);
 #endif
 
-#if (defined TM)
+#if TM_OPS
   if(pthread->tmDepth > 0){
 
     ID(
@@ -1309,7 +1309,7 @@ M4_WRITE(sw_op,
 #endif
 
 
-#if (defined TM)
+#if TM_OPS
     if(pthread->tmAborting)
     {
       pthread->tmAborting = 0;
@@ -1337,7 +1337,7 @@ M4_WRITE(swc1_op,
   v1 = SWAP_WORD(v1);
   
 
-#if (defined TM)
+#if TM_OPS
   if(pthread->tmDepth > 0){
 
     ID(
@@ -1369,7 +1369,7 @@ M4_WRITE(swc1_op,
 
 #endif
 
-#if (defined TM)
+#if TM_OPS
     if(pthread->tmAborting)
     {
       pthread->tmAborting = 0;
@@ -1405,7 +1405,7 @@ M4_WRITE(swl_op,
     address_exception_op(picode, pthread);
 #endif
 
-#if (defined TM)
+#if TM_OPS
   if(pthread->tmDepth > 0)
   {
     fprintf(tmReport->getOutfile(),"!!!!!!!!!!! WE HAVE A SWL HERE!!\n");
@@ -1429,7 +1429,7 @@ M4_WRITE(swr_op,
     address_exception_op(picode, pthread);
 #endif
 
-#if (defined TM)
+#if TM_OPS
   if(pthread->tmDepth > 0)
   {
     fprintf(tmReport->getOutfile(),"!!!!!!!!!!! WE HAVE A SWR HERE!!\n");
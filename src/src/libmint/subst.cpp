@@ -98,6 +98,8 @@ typedef __off64_t off64_t;
 #include "transContext.h"
 #include "transReport.h"
 #include "transCoherence.h"
+#include "transElision.h"
+#include "transBreakdown.h"
 #endif
 
 struct glibc_stat64 {
@@ -257,6 +259,10 @@ OP(return1); OP(mint_exit);
 OP(mint_finish); 
 OP(mint_printf);        /* not used */
 OP(mint_sesc_get_num_cpus);
+#if (defined TM)
+OP(mint_sesc_tm_private);
+OP(mint_sesc_tm_shared);
+#endif
 #ifdef TLS
 //OP(mint_sesc_begin_epochs);
 OP(mint_sesc_future_epoch);
@@ -461,6 +467,8 @@ func_desc_t Func_subst[] = {
   {"sesc_fast_sim_begin_",    mint_sesc_fast_sim_begin,        1, OpExposed},
   {"sesc_fast_sim_end",       mint_sesc_fast_sim_end,          1, OpExposed},
   {"sesc_fast_sim_end_",      mint_sesc_fast_sim_end,          1, OpExposed},
+  {"sesc_stats_epoch",        mint_sesc_stats_epoch,           1, OpExposed},
+  {"sesc_stats_epoch_",       mint_sesc_stats_epoch,           1, OpExposed},
   {"sesc_preevent",           mint_sesc_preevent,              1, OpExposed},
   {"sesc_preevent_",          mint_sesc_preevent,              1, OpExposed},
   {"sesc_postevent",          mint_sesc_postevent,             1, OpExposed},
@@ -476,6 +484,10 @@ func_desc_t Func_subst[] = {
   //  {"printf",                      mint_printf,                     1, OpExposed},
   //  {"IO_printf",                   mint_printf,                     1, OpExposed},
   {"sesc_get_num_cpus",       mint_sesc_get_num_cpus,          0, OpInternal},
+#if (defined TM)
+  {"sesc_tm_private",         mint_sesc_tm_private,            0, OpInternal},
+  {"sesc_tm_shared",          mint_sesc_tm_shared,             0, OpInternal},
+#endif
 #if (defined TLS)
   //  {"sesc_begin_epochs",       mint_sesc_begin_epochs,          0, OpExposed},
   {"sesc_future_epoch",       mint_sesc_future_epoch,          0, OpExposed},
@@ -539,18 +551,27 @@ void subst_init()
   FILE *fdummy;
 
   Iterminator1.func = terminator1;
+#if (defined TM)
+  Iterminator1.tmFunc = terminator1;
+#endif
   Iterminator1.opnum = 0;
   Iterminator1.next = NULL;
   Iterminator1.instID = 0;
 
   invalidIcode.addr = 0;
   invalidIcode.func = NULL;
+#if (defined TM)
+  invalidIcode.tmFunc = NULL;
+#endif
   invalidIcode.opnum = 0;
   invalidIcode.next = NULL;
   invalidIcode.instID = 8;
 
 #ifdef TASKSCALAR
   TerminatePicode.func   = mint_exit;
+#if (defined TM)
+  TerminatePicode.tmFunc = mint_exit;
+#endif
   TerminatePicode.addr   = 8; /* Invalid addr */
   TerminatePicode.opnum  = 0;
   TerminatePicode.next   = NULL;
@@ -662,6 +683,9 @@ void subst_functions()
     picode = addr2icode(psym->n_value);
     /* replace the first instruction in this routine with my function */
     picode->func = pfname->func;
+#if (defined TM)
+    picode->tmFunc = pfname->func;
+#endif
 #if (defined TASKSCALAR)
     if (pfname->no_spec == 1)
       picode->opflags = E_NO_SPEC;
@@ -844,6 +868,10 @@ void mint_sesc_die(thread_ptr pthread)
 
 OP(tmBegin_op_0){
  
+  // Memory instructions use the transactional versions from now on. This is
+  // set before the begin so that a backoff stall is also seen.
+  pthread->tmDispatch = 1;
+
   new transactionContext(pthread,picode);
 
   return pthread->getPCIcode();
@@ -885,6 +913,25 @@ OP(tmCommit_op_0){
 }
 PFPI tmCommit_op[] = { tmCommit_op_0, 0};
 
+OP(mint_sesc_tm_private)
+{
+  RAddr begin = pthread->virt2real(pthread->getIntArg1());
+  int   size  = pthread->getIntArg2();
+
+  transGCM->addPrivate(begin, begin + size);
+
+  // Return from the call
+  return pthread->getRetIcode();
+}
+
+OP(mint_sesc_tm_shared)
+{
+  transGCM->removePrivate(pthread->virt2real(pthread->getIntArg1()));
+
+  // Return from the call
+  return pthread->getRetIcode();
+}
+
 #endif
 
 #if (defined TLS)
@@ -1303,7 +1350,28 @@ OP(mint_sesc_fetch_op)
   int val   = pthread->getIntArg3();
   int *data = (int *)pthread->virt2real(addr);
 
-  pthread->setRetVal(rsesc_fetch_op(pthread->getPid(),(enum FetchOpType)op,addr,data,val));
+#if (defined TM)
+  if(op == FetchSwapOp && val == LOCKED && transLE->isEnabled()) {
+    icode_ptr next = transLE->lock(pthread, picode, addr);
+    if(next)
+      return next;
+  }
+#endif
+
+  int ret = rsesc_fetch_op(pthread->getPid(),(enum FetchOpType)op,addr,data,val);
+  pthread->setRetVal(ret);
+
+#if (defined TM)
+  //  Barrier arrivals (sesc_barrier counts them with FetchIncOp) and lock spins
+  if(op == FetchIncOp)
+    transBD->barrierArrive(pthread->getPid(), addr, ret);
+  else if(op == FetchSwapOp && val == LOCKED) {
+    if(ret == LOCKED)
+      transBD->lockWait(pthread->getPid());
+    else
+      transBD->lockAcquire(pthread->getPid());
+  }
+#endif
   
   return pthread->getRetIcode();
 }
@@ -1314,6 +1382,15 @@ OP(mint_sesc_unlock_op)
   int addr  = pthread->getIntArg1();
   int val   = pthread->getIntArg2();
   int *data = (int *)pthread->virt2real(addr);
+
+#if (defined TM)
+  if(val == UNLOCKED && transLE->isEnabled()) {
+    icode_ptr next = transLE->unlock(pthread, picode, addr);
+    if(next)
+      return next;
+  }
+#endif
+
   rsesc_unlock_op(pthread->getPid(), addr, data, val);
   return pthread->getRetIcode();
 }
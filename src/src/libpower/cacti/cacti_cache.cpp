@@ -0,0 +1,267 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2005 University of California, Santa Cruz
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "cacti_cache.h"
+
+// Bump when the CACTI model or the file format changes
+#define CACTI_CACHE_VERSION "cacti42-v1"
+
+CactiCache::EntryMap        CactiCache::entries;
+std::vector<CactiCache::Key> CactiCache::requested;
+const char *CactiCache::dir         = 0;
+int         CactiCache::nJobs       = 1;
+bool        CactiCache::collecting  = false;
+int         CactiCache::savedStdout = -1;
+
+void CactiCache::init()
+{
+  dir = getenv("CACTICACHE");
+  if (dir && dir[0] == 0)
+    dir = 0;
+
+  if (dir) {
+    mkdir(dir, 0755);
+    struct stat st;
+    if (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+      fprintf(stderr,"CACTICACHE=%s is not a directory, cache disabled\n", dir);
+      dir = 0;
+    }
+  }
+
+  nJobs = sysconf(_SC_NPROCESSORS_ONLN);
+  if (getenv("CACTIJOBS"))
+    nJobs = atoi(getenv("CACTIJOBS"));
+  if (nJobs < 1)
+    nJobs = 1;
+}
+
+std::string CactiCache::getName(const Key &key)
+{
+  char str[256];
+
+  // tech is in um, derived from an integer number of nm
+  sprintf(str, "%s size=%d bsize=%d assoc=%d rw=%d rd=%d wr=%d banks=%d bits=%d tag=%d tech=%.4f"
+          ,CACTI_CACHE_VERSION
+          ,key.size, key.bsize, key.assoc
+          ,key.rwPorts, key.rdPorts, key.wrPorts
+          ,key.subBanks, key.bits, key.useTag, key.tech);
+
+  return str;
+}
+
+std::string CactiCache::getPath(const std::string &name)
+{
+  // FNV-1a of the normalized inputs
+  unsigned long long h = 14695981039346656037ULL;
+  for(size_t i=0;i<name.size();i++) {
+    h ^= (unsigned char)name[i];
+    h *= 1099511628211ULL;
+  }
+
+  char file[32];
+  sprintf(file, "/%016llx.cacti", h);
+
+  return std::string(dir) + file;
+}
+
+bool CactiCache::readFile(const std::string &name, Entry &entry)
+{
+  FILE *fp = fopen(getPath(name).c_str(), "r");
+  if (fp == 0)
+    return false;
+
+  char line[512];
+  bool ok = false;
+
+  // The first line has the full key (hash collisions are a miss)
+  if (fgets(line, sizeof(line), fp) && strncmp(line, name.c_str(), name.size()) == 0
+      && line[name.size()] == '\n') {
+    xcacti_flp *x = &entry.xflp;
+    int n = fscanf(fp, "%lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %d %d"
+                   ,&entry.energy
+                   ,&x->bank_ctrl_a, &x->decode_a, &x->tag_array_a, &x->tag_ctrl_a
+                   ,&x->data_array_a, &x->data_ctrl_a, &x->total_a
+                   ,&x->bank_ctrl_e, &x->decode_e, &x->tag_array_e, &x->tag_ctrl_e
+                   ,&x->data_array_e, &x->data_ctrl_e
+                   ,&x->NSubbanks, &x->assoc);
+    ok = (n == 16);
+  }
+
+  fclose(fp);
+  return ok;
+}
+
+void CactiCache::writeFile(const std::string &name, const Entry &entry)
+{
+  std::string path = getPath(name);
+
+  // Write and rename, so that concurrent runs never see a partial file
+  char tmp[32];
+  sprintf(tmp, ".%d.tmp", (int)getpid());
+  std::string tmpPath = path + tmp;
+
+  FILE *fp = fopen(tmpPath.c_str(), "w");
+  if (fp == 0)
+    return;
+
+  const xcacti_flp *x = &entry.xflp;
+  fprintf(fp, "%s\n", name.c_str());
+  fprintf(fp, "%.17g\n", entry.energy);
+  fprintf(fp, "%.17g %.17g %.17g %.17g %.17g %.17g %.17g\n"
+          ,x->bank_ctrl_a, x->decode_a, x->tag_array_a, x->tag_ctrl_a
+          ,x->data_array_a, x->data_ctrl_a, x->total_a);
+  fprintf(fp, "%.17g %.17g %.17g %.17g %.17g %.17g\n"
+          ,x->bank_ctrl_e, x->decode_e, x->tag_array_e, x->tag_ctrl_e
+          ,x->data_array_e, x->data_ctrl_e);
+  fprintf(fp, "%d %d\n", x->NSubbanks, x->assoc);
+
+  if (fclose(fp) != 0 || rename(tmpPath.c_str(), path.c_str()) != 0)
+    unlink(tmpPath.c_str());
+}
+
+bool CactiCache::lookup(const Key &key, Entry &entry)
+{
+  std::string name = getName(key);
+
+  EntryMap::const_iterator it = entries.find(name);
+  if (it != entries.end()) {
+    entry = it->second;
+    return true;
+  }
+
+  if (dir == 0 || !readFile(name, entry))
+    return false;
+
+  entries[name] = entry;
+  return true;
+}
+
+void CactiCache::store(const Key &key, const Entry &entry)
+{
+  std::string name = getName(key);
+
+  entries[name] = entry;
+  if (dir)
+    writeFile(name, entry);
+}
+
+void CactiCache::beginCollect()
+{
+  collecting = true;
+  requested.clear();
+
+  // The collect pass prints the same report as the real one
+  fflush(stdout);
+  savedStdout = dup(1);
+  int fd = open("/dev/null", O_WRONLY);
+  if (fd >= 0) {
+    dup2(fd, 1);
+    close(fd);
+  }
+}
+
+void CactiCache::endCollect()
+{
+  fflush(stdout);
+  if (savedStdout >= 0) {
+    dup2(savedStdout, 1);
+    close(savedStdout);
+    savedStdout = -1;
+  }
+  collecting = false;
+}
+
+void CactiCache::request(const Key &key)
+{
+  requested.push_back(key);
+}
+
+void CactiCache::evaluate(ComputeFunc compute)
+{
+  // Missing entries, each one once
+  std::vector<Key> missing;
+  std::map<std::string, bool> seen;
+  for(size_t i=0;i<requested.size();i++) {
+    std::string name = getName(requested[i]);
+    if (seen.find(name) != seen.end())
+      continue;
+    seen[name] = true;
+
+    Entry entry;
+    if (!lookup(requested[i], entry))
+      missing.push_back(requested[i]);
+  }
+  requested.clear();
+
+  fprintf(stderr,"cacti cache: %d structures, %d to compute\n", (int)seen.size(), (int)missing.size());
+  if (missing.empty())
+    return;
+
+  int jobs = nJobs;
+  if (jobs > (int)missing.size())
+    jobs = missing.size();
+
+  if (dir == 0 || jobs == 1) {
+    for(size_t i=0;i<missing.size();i++)
+      store(missing[i], compute(missing[i]));
+    return;
+  }
+
+  // Each child computes every jobs-th entry and leaves it in the
+  // directory. The real pass reads them back.
+  fflush(stdout);
+  fflush(stderr);
+
+  std::vector<pid_t> pids;
+  for(int j=0;j<jobs;j++) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      int fd = open("/dev/null", O_WRONLY);
+      if (fd >= 0) {
+        dup2(fd, 1);
+        close(fd);
+      }
+      for(size_t i=j;i<missing.size();i+=jobs)
+        store(missing[i], compute(missing[i]));
+      fflush(stdout);
+      _exit(0);
+    }
+    if (pid < 0) {
+      // No more processes. The real pass computes what is still missing
+      break;
+    }
+    pids.push_back(pid);
+  }
+
+  for(size_t j=0;j<pids.size();j++) {
+    int status;
+    waitpid(pids[j], &status, 0);
+  }
+}
@@ -0,0 +1,97 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2005 University of California, Santa Cruz
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef CACTI_CACHE_H
+#define CACTI_CACHE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "cacti_interface.h"
+}
+
+// Memoization of cacti_interface results. Every CACTI run is keyed by its
+// normalized inputs. Results are kept in memory for the run and, if the
+// CACTICACHE environment variable names a directory, stored there as one
+// file per key (content addressed), so configurations in a sweep share
+// them. The cache directory also enables parallel evaluation: a first
+// pass over the configuration only records the keys, and the missing
+// ones are computed by CACTIJOBS (default: one per cpu) child processes.
+class CactiCache {
+public:
+  struct Key {
+    int    size;
+    int    bsize;
+    int    assoc;
+    int    rwPorts;
+    int    rdPorts;
+    int    wrPorts;
+    int    subBanks;
+    int    bits;
+    int    useTag;
+    double tech;
+  };
+
+  struct Entry {
+    double     energy; // before the wattch correction factor
+    xcacti_flp xflp;
+  };
+
+  typedef Entry (*ComputeFunc)(const Key &key);
+
+private:
+  typedef std::map<std::string, Entry> EntryMap;
+
+  static EntryMap    entries;
+  static std::vector<Key> requested;
+  static const char *dir;
+  static int         nJobs;
+  static bool        collecting;
+  static int         savedStdout;
+
+  static std::string getName(const Key &key);
+  static std::string getPath(const std::string &name);
+  static bool readFile(const std::string &name, Entry &entry);
+  static void writeFile(const std::string &name, const Entry &entry);
+
+public:
+  static void init();
+
+  // true if the entries are shared through a directory (and can be
+  // evaluated in parallel)
+  static bool isPersistent() { return dir != 0; }
+
+  static bool lookup(const Key &key, Entry &entry);
+  static void store(const Key &key, const Entry &entry);
+
+  // Collect pass: getEnergy only records the key (stdout is muted)
+  static bool isCollecting() { return collecting; }
+  static void beginCollect();
+  static void endCollect();
+  static void request(const Key &key);
+
+  // Compute the requested entries that are not cached yet
+  static void evaluate(ComputeFunc compute);
+};
+
+#endif
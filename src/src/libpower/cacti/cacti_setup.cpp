@@ -21,6 +21,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #include <stdio.h>
 #include <ctype.h>
+#include <string.h>
 #include <math.h>
 
 //#include "nanassert.h"
@@ -36,6 +37,7 @@ extern "C" {
 #include "cacti42_def.h"
 #include "cacti42_io.h"
 }
+#include "cacti_cache.h"
 
 #ifdef SESC_SESCTHERM
 #include "ThermTrace.h"
@@ -322,6 +324,36 @@ char *strfy(double v){
 }
 
 
+static CactiCache::Entry computeEnergy(const CactiCache::Key &key)
+{
+  CactiCache::Entry entry;
+  total_result_type result2;
+
+  BITOUT = key.bits;
+
+  result2 = cacti_interface(key.size, key.bsize, key.assoc, 
+			    key.rwPorts, key.rdPorts, key.wrPorts, 
+			    0, key.subBanks, key.tech, key.bits, 
+			    0, 0,  // custom tag
+			    0, 
+			    key.useTag);
+
+#ifdef DEBUG
+  //output_data(&result,&arearesult,&arearesult_subbanked,&parameters);
+  output_data(&result2.result,&result2.area,&result2.params);
+#endif
+
+  //xcacti_power_flp(&result,&arearesult,&arearesult_subbanked,&parameters, xflp);
+  xcacti_power_flp(&result2.result, &result2.area, &result2.arearesult_subbanked,
+	               &result2.params, &entry.xflp);
+
+  //return wattch2cactiFactor * 1e9*(result.total_power_without_routing/subBanks + result.total_routing_power);
+  entry.energy = 1e9*(result2.result.total_power_without_routing.readOp.dynamic / key.subBanks + 
+                      result2.result.total_routing_power.readOp.dynamic);
+
+  return entry;
+}
+
 double getEnergy(int size
                  ,int bsize
                  ,int assoc
@@ -335,7 +367,6 @@ double getEnergy(int size
   int nsets = size/(bsize*assoc);
   int fully_assoc, associativity;
   int rwPorts = 0;
-  double ret;
 
   if (nsets == 0) {
     printf("Invalid cache parameters size[%d], bsize[%d], assoc[%d]\n", size, bsize, assoc);
@@ -364,8 +395,6 @@ double getEnergy(int size
   if (bsize*8 < bits)
     bsize = bits/8;
 
-  BITOUT = bits;
-
   if (size == bsize * assoc) {
     fully_assoc = 1;
   }else{
@@ -385,7 +414,24 @@ double getEnergy(int size
 
   nsets = size/(bsize*associativity);
 
-  total_result_type result2;
+  // Normalized CACTI inputs
+  CactiCache::Key key;
+  key.size     = size;
+  key.bsize    = bsize;
+  key.assoc    = associativity;
+  key.rwPorts  = rwPorts;
+  key.rdPorts  = rdPorts;
+  key.wrPorts  = wrPorts;
+  key.subBanks = subBanks;
+  key.bits     = bits;
+  key.useTag   = useTag;
+  key.tech     = tech;
+
+  if (CactiCache::isCollecting()) {
+    CactiCache::request(key);
+    memset(xflp, 0, sizeof(xcacti_flp));
+    return 1;
+  }
 
   printf("\n\n\n########################################################");
   printf("\nInput to Cacti_Interface...");
@@ -393,26 +439,16 @@ double getEnergy(int size
 	 size, bsize, associativity, rdPorts, wrPorts);
   printf("\n subBanks = %d, tech = %f, bits = %d", 
 	 subBanks, tech, bits);
-  
-  result2 = cacti_interface(size, bsize, associativity, 
-			    rwPorts, rdPorts, wrPorts, 
-			    0, subBanks, tech, bits, 
-			    0, 0,  // custom tag
-			    0, 
-			    useTag);
 
-#ifdef DEBUG
-  //output_data(&result,&arearesult,&arearesult_subbanked,&parameters);
-  output_data(&result2.result,&result2.area,&result2.params);
-#endif
+  CactiCache::Entry entry;
+  if (!CactiCache::lookup(key, entry)) {
+    entry = computeEnergy(key);
+    CactiCache::store(key, entry);
+  }
 
-  //xcacti_power_flp(&result,&arearesult,&arearesult_subbanked,&parameters, xflp);
-  xcacti_power_flp(&result2.result, &result2.area, &result2.arearesult_subbanked,
-	               &result2.params, xflp);
+  *xflp = entry.xflp;
 
-  //return wattch2cactiFactor * 1e9*(result.total_power_without_routing/subBanks + result.total_routing_power);
-  return wattch2cactiFactor * 1e9*(result2.result.total_power_without_routing.readOp.dynamic / subBanks + 
-	  result2.result.total_routing_power.readOp.dynamic);
+  return wattch2cactiFactor * entry.energy;
 }
 
 
@@ -549,7 +585,8 @@ void processBranch(const char *proc)
 void processorCore()
 {
   const char *proc = SescConf->getCharPtr("","cpucore",0) ;
-  fprintf(stderr,"proc = [%s]\n",proc);
+  if (!CactiCache::isCollecting())
+    fprintf(stderr,"proc = [%s]\n",proc);
 
   xcacti_flp xflp;
 
@@ -761,17 +798,9 @@ void processorCore()
   }
 }
 
-void cacti_setup()
+static void cacti_pass()
 {
-  const char *technology = SescConf->getCharPtr("","technology");
-  fprintf(stderr,"technology = [%s]\n",technology);
-  tech = SescConf->getInt(technology,"tech");
-  fprintf(stderr, "tech : %9.0fnm\n" , tech);
-  tech /= 1000;
-
-#ifdef SESC_SESCTHERM
-  sescTherm = new ThermTrace(0); // No input trace, just read conf
-#endif
+  wattch2cactiFactor = 1;
 
   const char *proc    = SescConf->getCharPtr("","cpucore",0);
   const char *l1Cache = SescConf->getCharPtr(proc,"dataSource");
@@ -790,8 +819,9 @@ void cacti_setup()
 
   if (WattchL1Energy) {
     wattch2cactiFactor = WattchL1Energy/l1Energy;
-    fprintf(stderr,"wattch2cacti Factor %g\n", wattch2cactiFactor);
-  }else{
+    if (!CactiCache::isCollecting())
+      fprintf(stderr,"wattch2cacti Factor %g\n", wattch2cactiFactor);
+  }else if (!CactiCache::isCollecting()) {
     fprintf(stderr,"-----WARNING: No wattch correction factor\n");
   }
 
@@ -799,3 +829,34 @@ void cacti_setup()
 
   iterate();
 }
+
+void cacti_setup()
+{
+  const char *technology = SescConf->getCharPtr("","technology");
+  fprintf(stderr,"technology = [%s]\n",technology);
+  tech = SescConf->getInt(technology,"tech");
+  fprintf(stderr, "tech : %9.0fnm\n" , tech);
+  tech /= 1000;
+
+#ifdef SESC_SESCTHERM
+  sescTherm = new ThermTrace(0); // No input trace, just read conf
+#endif
+
+  CactiCache::init();
+
+#ifndef SESC_SESCTHERM2
+  // With a cache directory, a first pass only collects the CACTI inputs
+  // so that the missing ones are computed in parallel. The records it
+  // updates are overwritten by the real pass. (The layout pass appends
+  // records, so it is never run twice.)
+  if (CactiCache::isPersistent()) {
+    CactiCache::beginCollect();
+    cacti_pass();
+    CactiCache::endCollect();
+
+    CactiCache::evaluate(computeEnergy);
+  }
+#endif
+
+  cacti_pass();
+}
@@ -62,6 +62,12 @@ thermal_config_t default_thermal_config(void)
 	 * grid cells as that of the entire block
 	 */
 	strcpy(config.grid_map_mode, GRID_AVG_STR);
+	/* original (serial) transient sweep	*/
+	config.grid_threads = 0;
+	/* original iterative steady state solver	*/
+	strcpy(config.grid_steady_solver, GRID_ITER_STR);
+	config.grid_solver_tol = 1e-6;
+	config.grid_steady_check = 0;
 
 	return config;
 }
@@ -142,6 +148,18 @@ void thermal_config_add_from_strs(thermal_config_t *config, str_pair *table, int
 	if ((idx = get_str_index(table, size, "grid_map_mode")) >= 0)
 		if(sscanf(table[idx].value, "%s", config->grid_map_mode) != 1)
 			fatal("invalid format for configuration  parameter grid_map_mode");
+	if ((idx = get_str_index(table, size, "grid_threads")) >= 0)
+		if(sscanf(table[idx].value, "%d", &config->grid_threads) != 1)
+			fatal("invalid format for configuration  parameter grid_threads");
+	if ((idx = get_str_index(table, size, "grid_steady_solver")) >= 0)
+		if(sscanf(table[idx].value, "%s", config->grid_steady_solver) != 1)
+			fatal("invalid format for configuration  parameter grid_steady_solver");
+	if ((idx = get_str_index(table, size, "grid_solver_tol")) >= 0)
+		if(sscanf(table[idx].value, "%lf", &config->grid_solver_tol) != 1)
+			fatal("invalid format for configuration  parameter grid_solver_tol");
+	if ((idx = get_str_index(table, size, "grid_steady_check")) >= 0)
+		if(sscanf(table[idx].value, "%lf", &config->grid_steady_check) != 1)
+			fatal("invalid format for configuration  parameter grid_steady_check");
 	
 	if ((config->t_chip <= 0) || (config->s_sink <= 0) || (config->t_sink <= 0) || 
 		(config->s_spreader <= 0) || (config->t_spreader <= 0) || 
@@ -161,6 +179,13 @@ void thermal_config_add_from_strs(thermal_config_t *config, str_pair *table, int
 		strcasecmp(config->grid_map_mode, GRID_MAX_STR) &&
 		strcasecmp(config->grid_map_mode, GRID_CENTER_STR))
 		fatal("invalid mapping mode. use 'avg', 'min', 'max' or 'center'\n");
+	if (config->grid_threads < 0)
+		fatal("grid_threads should not be negative\n");
+	if (strcasecmp(config->grid_steady_solver, GRID_ITER_STR) &&
+		strcasecmp(config->grid_steady_solver, GRID_PCG_STR))
+		fatal("invalid steady state solver. use 'iter' or 'pcg'\n");
+	if (config->grid_solver_tol <= 0 || config->grid_steady_check < 0)
+		fatal("invalid grid solver tolerances\n");
 }
 
 /* 
@@ -169,7 +194,7 @@ void thermal_config_add_from_strs(thermal_config_t *config, str_pair *table, int
  */
 int thermal_config_to_strs(thermal_config_t *config, str_pair *table, int max_entries)
 {
-	if (max_entries < 23)
+	if (max_entries < 27)
 		fatal("not enough entries in table\n");
 
 	sprintf(table[0].name, "t_chip");
@@ -195,6 +220,10 @@ int thermal_config_to_strs(thermal_config_t *config, str_pair *table, int max_en
 	sprintf(table[20].name, "grid_layer_file");
 	sprintf(table[21].name, "grid_steady_file");
 	sprintf(table[22].name, "grid_map_mode");
+	sprintf(table[23].name, "grid_threads");
+	sprintf(table[24].name, "grid_steady_solver");
+	sprintf(table[25].name, "grid_solver_tol");
+	sprintf(table[26].name, "grid_steady_check");
 
 	sprintf(table[0].value, "%lg", config->t_chip);
 	sprintf(table[1].value, "%lg", config->thermal_threshold);
@@ -219,8 +248,12 @@ int thermal_config_to_strs(thermal_config_t *config, str_pair *table, int max_en
 	sprintf(table[20].value, "%s", config->grid_layer_file);
 	sprintf(table[21].value, "%s", config->grid_steady_file);
 	sprintf(table[22].value, "%s", config->grid_map_mode);
+	sprintf(table[23].value, "%d", config->grid_threads);
+	sprintf(table[24].value, "%s", config->grid_steady_solver);
+	sprintf(table[25].value, "%lg", config->grid_solver_tol);
+	sprintf(table[26].value, "%lg", config->grid_steady_check);
 
-	return 23;
+	return 27;
 }
 
 /* 
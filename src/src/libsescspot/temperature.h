@@ -20,6 +20,10 @@
 #define	GRID_MAX_STR	"max"
 #define	GRID_CENTER_STR	"center"
 
+/* grid model steady state solvers	*/
+#define	GRID_ITER_STR	"iter"
+#define	GRID_PCG_STR	"pcg"
+
 /* number of extra nodes due to the model	*/
 /* 5 spreader and 5 heat sink nodes (north, south, east, west and bottom)	*/
 #define EXTRA	10
@@ -106,6 +110,14 @@ typedef struct thermal_config_t_st
 	char grid_steady_file[STR_SIZE];
 	/* mapping mode between grid and block models	*/
 	char grid_map_mode[STR_SIZE];
+	/* threads of the vectorized transient solver (0: original sweep)	*/
+	int grid_threads;
+	/* steady state solver - iterative or pcg	*/
+	char grid_steady_solver[STR_SIZE];
+	/* pcg convergence: largest correction in kelvin	*/
+	double grid_solver_tol;
+	/* compare pcg with the iterative solver, max difference in kelvin (0: off)	*/
+	double grid_steady_check;
 }thermal_config_t;
 
 /* defaults	*/
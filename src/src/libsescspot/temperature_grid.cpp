@@ -27,6 +27,7 @@ grid_model_t *alloc_grid_model(thermal_config_t *config, flp_t *flp_default)
 	model->row = config->grid_rows;
 	model->col = config->grid_cols;
 	model->mv_level = 0;
+	model->solver = NULL;
 
 	if(!strcasecmp(model->config.grid_map_mode, GRID_AVG_STR))
 		model->map_mode = GRID_AVG;
@@ -467,6 +468,7 @@ double find_avg_temp_grid(grid_model_t *model, double *temp)
 
 void delete_grid_model(grid_model_t *model)
 {
+	free_grid_solver(model);
 	delete model;
 }
 
@@ -755,6 +757,12 @@ void compute_tran_temp(double time_elapsed, grid_model_t *model, vector<double>
 	cout << "Iterations: " << no_of_iter << endl;
 	//	#endif
 	delta_t = time_elapsed / no_of_iter;
+
+	/* vectorized and multithreaded, all the nodes from the previous step	*/
+	if (model->config.grid_threads > 0) {
+		compute_tran_steps_fast(model, temp, power, delta_t, (int) no_of_iter);
+		return;
+	}
 	
 	// dT for heat spreader peripheral nodes and heat sink nodes
 	vector<double> delta_temp_extra(EXTRA);
@@ -2075,5 +2083,28 @@ void fast_tran_solver(double sampling_intvl, grid_model_t *model)
 /* dummy transient temperature solver in the grid model */
 void fast_steady_solver(grid_model_t *model) 
 {
+	if (strcasecmp(model->config.grid_steady_solver, GRID_PCG_STR)) {
 		compute_steady_temp(model, model->steady_g_temp, model->g_power);
+		return;
+	}
+
+	vector<double> reference;
+	if (model->config.grid_steady_check > 0)
+		reference = model->steady_g_temp;
+
+	compute_steady_temp_pcg(model, model->steady_g_temp, model->g_power);
+
+	/* validate against the iterative solver, from the same starting point	*/
+	if (model->config.grid_steady_check > 0) {
+		compute_steady_temp(model, reference, model->g_power);
+
+		double max_diff = 0.0;
+		for (unsigned int i = 0; i < reference.size(); i++)
+			if (fabs(reference[i] - model->steady_g_temp[i]) > max_diff)
+				max_diff = fabs(reference[i] - model->steady_g_temp[i]);
+
+		cout << "pcg vs iterative steady state: max difference " << max_diff << " K" << endl;
+		if (max_diff > model->config.grid_steady_check)
+			fatal("pcg steady state differs from the iterative solver\n");
+	}
 }
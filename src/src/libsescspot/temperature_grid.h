@@ -62,6 +62,9 @@ struct TempDetail {
 	bool IsRed;
 };
 
+/* conductances and worker threads of the fast grid solvers	*/
+struct grid_solver_t_st;
+
 /* grid thermal model	*/
 typedef struct grid_model_t_st
 {
@@ -122,6 +125,9 @@ typedef struct grid_model_t_st
 	vector <double> steady_g_temp, g_temp;
 	/* grid power	*/
 	vector <double> g_power;
+
+	/* fast solvers, set up on first use	*/
+	struct grid_solver_t_st *solver;
 }grid_model_t;
 
 /* constructor/destructor	*/
@@ -166,6 +172,11 @@ void compute_tran_temp(double time_elapsed, grid_model_t *model, vector<double>
 //Calculates the steady-state temperature, called by fast_steady_solver()
 void compute_steady_temp(grid_model_t *model, vector<double> &steady_temp, vector<double> &power);
 
+//Vectorized/multithreaded transient steps and pcg steady state (temperature_grid_solver.cpp)
+void compute_tran_steps_fast(grid_model_t *model, vector<double> &temp, vector<double> &power, double delta_t, int no_of_iter);
+void compute_steady_temp_pcg(grid_model_t *model, vector<double> &steady_temp, vector<double> &power);
+void free_grid_solver(grid_model_t *model);
+
 //Solve transient temperature (fast solver)
 void fast_tran_solver(double sampling_intvl, grid_model_t *model);
 
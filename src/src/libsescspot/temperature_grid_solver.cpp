@@ -0,0 +1,526 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2006 University California, Santa Cruz.
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <assert.h>
+#include <pthread.h>
+#include <vector>
+#include <iostream>
+
+#include "temperature_grid.h"
+#include "util.h"
+
+/*
+ * fast solvers for the grid model. the grid equations are kept as
+ * per-layer conductances, so that every cell of the chip interior is
+ * updated by the same stencil (no corner/edge/layer branches) and the
+ * compiler can vectorize it. rows are split in bands among worker
+ * threads. all the cells of a step are computed from the temperatures
+ * of the previous step (jacobi order), so the bands are independent.
+ */
+
+/* partial sums of the spreader layer per band, one cache line each	*/
+#define PART_W		0
+#define PART_E		1
+#define PART_B		2
+#define PART_SIZE	8
+
+struct grid_solver_t_st;
+
+typedef struct grid_worker_t_st
+{
+	struct grid_solver_t_st *solver;
+	int id;
+}grid_worker_t;
+
+typedef struct grid_solver_t_st
+{
+	/* shortcuts	*/
+	int nl, row, col, g_n;
+	/* total number of nodes including the extra ones	*/
+	int n;
+
+	/* per layer conductances. zero where there is no link, so that
+	 * a missing neighbour costs nothing in the interior kernel
+	 */
+	vector<double> gx, gy, gup, gdown;
+	/* spreader edge cells to the peripheral spreader nodes	*/
+	double g_spx, g_spy;
+	/* package: spreader periphery to sink, spreader to its center,
+	 * sink periphery to its center, spreader center to sink center,
+	 * convection
+	 */
+	double g_spl, g_spv, g_si, g_sicv, g_conv;
+	double Tamb;
+
+	/* thermal capacitance per layer, followed by the extra nodes	*/
+	vector<double> cap;
+	/* diagonal of the conductance matrix (jacobi preconditioner)	*/
+	vector<double> diag;
+	/* largest diagonal entry per layer, followed by the extra nodes	*/
+	vector<double> diag_max;
+
+	/* no source (all the nodes), and the bottom spreader node as a row	*/
+	vector<double> zero, sink_row;
+
+	/* worker threads. band 0 is done by the caller	*/
+	int n_threads;
+	vector<pthread_t> threads;
+	vector<grid_worker_t> workers;
+	vector<double> partial;
+	pthread_barrier_t start, done;
+	int quit;
+
+	/* current job: y = a*x + k .* (src - A*x)	*/
+	const double *x;
+	const double *src;
+	double *y;
+	double a;
+	const double *k;	/* per layer, followed by the extra nodes	*/
+	double amb;	/* ambient source term of the sink (Tamb/Rconv or 0)	*/
+}grid_solver_t;
+
+/* interior row of a layer: n cells, t points at the first one	*/
+static void stencil_row(double * __restrict y, const double * __restrict t,
+						const double * __restrict tu, const double * __restrict td,
+						const double * __restrict p, int n, int col,
+						double gx, double gy, double gu, double gd, double a, double k)
+{
+	for (int c = 0; c < n; c++) {
+		double lap = gx * (2.0*t[c] - t[c-1] - t[c+1]) +
+					 gy * (2.0*t[c] - t[c-col] - t[c+col]) +
+					 gu * (t[c] - tu[c]) + gd * (t[c] - td[c]);
+		y[c] = a * t[c] + k * (p[c] - lap);
+	}
+}
+
+/* A*x for a single cell on the boundary of a layer	*/
+static double stencil_cell(grid_solver_t *s, const double *x, int l, int r, int c)
+{
+	int col = s->col;
+	int i = l*s->g_n + r*col + c;
+	double t = x[i];
+	double lap = 0.0;
+
+	if (c > 0)
+		lap += s->gx[l] * (t - x[i-1]);
+	if (c < col-1)
+		lap += s->gx[l] * (t - x[i+1]);
+	if (r > 0)
+		lap += s->gy[l] * (t - x[i-col]);
+	if (r < s->row-1)
+		lap += s->gy[l] * (t - x[i+col]);
+	if (l > 0)
+		lap += s->gup[l] * (t - x[i-s->g_n]);
+
+	if (l < s->nl-1) {
+		lap += s->gdown[l] * (t - x[i+s->g_n]);
+	}
+	else {	/* spreader: bottom and peripheral spreader nodes	*/
+		const double *e = x + s->nl*s->g_n;
+		lap += s->gdown[l] * (t - e[SP_B]);
+		if (c == 0)
+			lap += s->g_spx * (t - e[SP_W]);
+		if (c == col-1)
+			lap += s->g_spx * (t - e[SP_E]);
+		if (r == 0)
+			lap += s->g_spy * (t - e[SP_N]);
+		if (r == s->row-1)
+			lap += s->g_spy * (t - e[SP_S]);
+	}
+
+	return lap;
+}
+
+/* grid cells of rows [r0, r1) in all the layers	*/
+static void stencil_band(grid_solver_t *s, int r0, int r1, double *part)
+{
+	int row = s->row;
+	int col = s->col;
+	int g_n = s->g_n;
+	int l, r, c, i;
+
+	for (l = 0; l < s->nl; l++) {
+		double k = s->k[l];
+
+		for (r = r0; r < r1; r++) {
+			i = l*g_n + r*col;
+			if (r == 0 || r == row-1) {
+				for (c = 0; c < col; c++)
+					s->y[i+c] = s->a * s->x[i+c] + k * (s->src[i+c] - stencil_cell(s, s->x, l, r, c));
+				continue;
+			}
+
+			/* first and last column	*/
+			s->y[i] = s->a * s->x[i] + k * (s->src[i] - stencil_cell(s, s->x, l, r, 0));
+			s->y[i+col-1] = s->a * s->x[i+col-1] + k * (s->src[i+col-1] - stencil_cell(s, s->x, l, r, col-1));
+
+			/* interior. the top layer has gup == 0, so any row will do
+			 * for 'tu'; the spreader sees the bottom spreader node below
+			 */
+			const double *tu = (l > 0) ? s->x + i - g_n + 1 : s->x + i + 1;
+			const double *td = (l < s->nl-1) ? s->x + i + g_n + 1 : &s->sink_row[0];
+			stencil_row(s->y + i + 1, s->x + i + 1, tu, td, s->src + i + 1,
+						col-2, col, s->gx[l], s->gy[l], s->gup[l], s->gdown[l], s->a, k);
+		}
+	}
+
+	/* spreader sums needed by the extra nodes	*/
+	double sum_w = 0.0, sum_e = 0.0, sum_b = 0.0;
+	const double *sp = s->x + (s->nl-1)*g_n;
+	for (r = r0; r < r1; r++) {
+		sum_w += sp[r*col];
+		sum_e += sp[r*col+col-1];
+		for (c = 0; c < col; c++)
+			sum_b += sp[r*col+c];
+	}
+	part[PART_W] = sum_w;
+	part[PART_E] = sum_e;
+	part[PART_B] = sum_b;
+}
+
+/* the ten spreader and sink nodes, same equations as compute_tran_temp	*/
+static void stencil_extra(grid_solver_t *s)
+{
+	int t, c;
+	int off = s->nl*s->g_n;
+	const double *e = s->x + off;
+	const double *sp = s->x + (s->nl-1)*s->g_n;
+	double sum_w = 0.0, sum_e = 0.0, sum_b = 0.0, sum_n = 0.0, sum_s = 0.0;
+	double lap[EXTRA];
+
+	for (t = 0; t < s->n_threads; t++) {
+		sum_w += s->partial[t*PART_SIZE+PART_W];
+		sum_e += s->partial[t*PART_SIZE+PART_E];
+		sum_b += s->partial[t*PART_SIZE+PART_B];
+	}
+	for (c = 0; c < s->col; c++) {
+		sum_n += sp[c];
+		sum_s += sp[(s->row-1)*s->col+c];
+	}
+
+	lap[SP_W] = s->g_spx * (s->row*e[SP_W] - sum_w) + s->g_spl * (e[SP_W] - e[SINK_W]) + s->g_spv * (e[SP_W] - e[SP_B]);
+	lap[SP_E] = s->g_spx * (s->row*e[SP_E] - sum_e) + s->g_spl * (e[SP_E] - e[SINK_E]) + s->g_spv * (e[SP_E] - e[SP_B]);
+	lap[SP_N] = s->g_spy * (s->col*e[SP_N] - sum_n) + s->g_spl * (e[SP_N] - e[SINK_N]) + s->g_spv * (e[SP_N] - e[SP_B]);
+	lap[SP_S] = s->g_spy * (s->col*e[SP_S] - sum_s) + s->g_spl * (e[SP_S] - e[SINK_S]) + s->g_spv * (e[SP_S] - e[SP_B]);
+	lap[SP_B] = s->gdown[s->nl-1] * (s->g_n*e[SP_B] - sum_b) +
+				s->g_spv * (4.0*e[SP_B] - e[SP_W] - e[SP_E] - e[SP_N] - e[SP_S]) +
+				s->g_sicv * (e[SP_B] - e[SINK_B]);
+	for (t = SINK_W; t <= SINK_S; t++)
+		lap[t] = s->g_spl * (e[t] - e[t-SINK_W]) + s->g_si * (e[t] - e[SINK_B]);
+	lap[SINK_B] = s->g_si * (4.0*e[SINK_B] - e[SINK_W] - e[SINK_E] - e[SINK_N] - e[SINK_S]) +
+				  s->g_sicv * (e[SINK_B] - e[SP_B]) + s->g_conv * e[SINK_B];
+
+	for (t = 0; t < EXTRA; t++) {
+		double src = s->src[off+t] + (t == SINK_B ? s->amb : 0.0);
+		s->y[off+t] = s->a * e[t] + s->k[s->nl+t] * (src - lap[t]);
+	}
+}
+
+static void stencil_worker_band(grid_solver_t *s, int id)
+{
+	int r0 = (int) ((long) s->row * id / s->n_threads);
+	int r1 = (int) ((long) s->row * (id+1) / s->n_threads);
+	stencil_band(s, r0, r1, &s->partial[id*PART_SIZE]);
+}
+
+static void *grid_worker_loop(void *arg)
+{
+	grid_worker_t *w = (grid_worker_t *) arg;
+	grid_solver_t *s = w->solver;
+
+	while (1) {
+		pthread_barrier_wait(&s->start);
+		if (s->quit)
+			break;
+		stencil_worker_band(s, w->id);
+		pthread_barrier_wait(&s->done);
+	}
+	return NULL;
+}
+
+/* y = a*x + k .* (src - A*x) over the whole model	*/
+static void stencil_run(grid_solver_t *s, double *y, const double *x, const double *src,
+						double a, const double *k, double amb)
+{
+	s->y = y;
+	s->x = x;
+	s->src = src ? src : &s->zero[0];
+	s->a = a;
+	s->k = k;
+	s->amb = amb;
+
+	/* spreader cells see the bottom spreader node as their layer below	*/
+	double sp_b = x[s->nl*s->g_n+SP_B];
+	for (int c = 0; c < s->col; c++)
+		s->sink_row[c] = sp_b;
+
+	if (s->n_threads > 1) {
+		pthread_barrier_wait(&s->start);
+		stencil_worker_band(s, 0);
+		pthread_barrier_wait(&s->done);
+	}
+	else {
+		stencil_worker_band(s, 0);
+	}
+
+	stencil_extra(s);
+}
+
+/* set up the conductances and the worker threads	*/
+static grid_solver_t *grid_solver(grid_model_t *model)
+{
+	if (model->solver)
+		return model->solver;
+
+	if (!model->r_ready)
+		fatal("R model not ready\n");
+
+	grid_solver_t *s = new grid_solver_t;
+	vector<LayerDetails> &L = model->Layers[0];
+	int l, r, c;
+
+	s->nl = L.size();
+	s->row = model->row;
+	s->col = model->col;
+	s->g_n = s->row * s->col;
+	s->n = s->nl * s->g_n + EXTRA;
+
+	s->gx.resize(s->nl, 0.0);
+	s->gy.resize(s->nl, 0.0);
+	s->gup.resize(s->nl, 0.0);
+	s->gdown.resize(s->nl, 0.0);
+	s->cap.resize(s->nl + EXTRA, 0.0);
+	for (l = 0; l < s->nl; l++) {
+		/* the spreader (last layer) is always lateral	*/
+		if (L[l].Lateral || l == s->nl-1) {
+			s->gx[l] = 1.0 / L[l].Rx;
+			s->gy[l] = 1.0 / L[l].Ry;
+		}
+		if (l > 0)
+			s->gup[l] = 1.0 / L[l-1].Rz;
+		/* to the next layer, or to the bottom spreader node	*/
+		s->gdown[l] = 1.0 / L[l].Rz;
+		if (model->c_ready)
+			s->cap[l] = L[l].Cap;
+	}
+	s->g_spx = 1.0 / model->Rsplex;
+	s->g_spy = 1.0 / model->Rspley;
+	s->g_spl = 1.0 / model->Rspl;
+	s->g_spv = 1.0 / model->Rspv;
+	s->g_si = 1.0 / model->Rsi;
+	s->g_sicv = 1.0 / model->Rsicv;
+	s->g_conv = 1.0 / model->Rconv;
+	s->Tamb = model->Tamb;
+
+	if (model->c_ready) {
+		for (l = SP_W; l <= SP_S; l++)
+			s->cap[s->nl+l] = model->Csp;
+		s->cap[s->nl+SP_B] = model->Csic;
+		for (l = SINK_W; l <= SINK_S; l++)
+			s->cap[s->nl+l] = model->Csi;
+		s->cap[s->nl+SINK_B] = model->Cconv;
+	}
+
+	/* diagonal: A applied to a unit vector, one cell at a time is the
+	 * sum of the conductances around the cell
+	 */
+	s->diag.resize(s->n, 0.0);
+	for (l = 0; l < s->nl; l++)
+		for (r = 0; r < s->row; r++)
+			for (c = 0; c < s->col; c++) {
+				double d = s->gup[l] + s->gdown[l];
+				if (c > 0) d += s->gx[l];
+				if (c < s->col-1) d += s->gx[l];
+				if (r > 0) d += s->gy[l];
+				if (r < s->row-1) d += s->gy[l];
+				if (l == s->nl-1) {
+					if (c == 0) d += s->g_spx;
+					if (c == s->col-1) d += s->g_spx;
+					if (r == 0) d += s->g_spy;
+					if (r == s->row-1) d += s->g_spy;
+				}
+				s->diag[l*s->g_n + r*s->col + c] = d;
+			}
+	double *dx = &s->diag[s->nl*s->g_n];
+	dx[SP_W] = dx[SP_E] = s->row*s->g_spx + s->g_spl + s->g_spv;
+	dx[SP_N] = dx[SP_S] = s->col*s->g_spy + s->g_spl + s->g_spv;
+	dx[SP_B] = s->g_n*s->gdown[s->nl-1] + 4.0*s->g_spv + s->g_sicv;
+	for (l = SINK_W; l <= SINK_S; l++)
+		dx[l] = s->g_spl + s->g_si;
+	dx[SINK_B] = 4.0*s->g_si + s->g_sicv + s->g_conv;
+
+	s->diag_max.resize(s->nl + EXTRA, 0.0);
+	for (int i = 0; i < s->n; i++) {
+		int b = i < s->nl*s->g_n ? i / s->g_n : i - s->nl*s->g_n + s->nl;
+		if (s->diag[i] > s->diag_max[b])
+			s->diag_max[b] = s->diag[i];
+	}
+
+	s->zero.resize(s->n, 0.0);
+	s->sink_row.resize(s->col, 0.0);
+
+	/* worker threads	*/
+	s->n_threads = model->config.grid_threads;
+	if (s->n_threads < 1)
+		s->n_threads = 1;
+	if (s->n_threads > s->row)
+		s->n_threads = s->row;
+	s->partial.resize(s->n_threads * PART_SIZE, 0.0);
+	s->quit = FALSE;
+	if (s->n_threads > 1) {
+		pthread_barrier_init(&s->start, NULL, s->n_threads);
+		pthread_barrier_init(&s->done, NULL, s->n_threads);
+		s->threads.resize(s->n_threads);
+		s->workers.resize(s->n_threads);
+		for (int t = 1; t < s->n_threads; t++) {
+			s->workers[t].solver = s;
+			s->workers[t].id = t;
+			if (pthread_create(&s->threads[t], NULL, grid_worker_loop, &s->workers[t]))
+				fatal("unable to create grid solver threads\n");
+		}
+	}
+
+	model->solver = s;
+	return s;
+}
+
+void free_grid_solver(grid_model_t *model)
+{
+	grid_solver_t *s = model->solver;
+	if (!s)
+		return;
+
+	if (s->n_threads > 1) {
+		s->quit = TRUE;
+		pthread_barrier_wait(&s->start);
+		for (int t = 1; t < s->n_threads; t++)
+			pthread_join(s->threads[t], NULL);
+		pthread_barrier_destroy(&s->start);
+		pthread_barrier_destroy(&s->done);
+	}
+
+	delete s;
+	model->solver = NULL;
+}
+
+/* 'no_of_iter' forward euler steps of 'delta_t' for all the nodes	*/
+void compute_tran_steps_fast(grid_model_t *model, vector<double> &temp, vector<double> &power,
+							 double delta_t, int no_of_iter)
+{
+	if (!model->c_ready)
+		fatal("C model not ready\n");
+
+	grid_solver_t *s = grid_solver(model);
+
+	/* forward euler is stable while delta_t * diag / cap <= 1 for every
+	 * node (the eigenvalues of the step matrix stay in [-1, 1] because
+	 * the conductance matrix is diagonally dominant). longer steps are
+	 * split in as many sub-steps as needed.
+	 */
+	double worst = 0.0;
+	for (int i = 0; i < s->nl + EXTRA; i++)
+		if (delta_t * s->diag_max[i] / s->cap[i] > worst)
+			worst = delta_t * s->diag_max[i] / s->cap[i];
+	if (worst > 1.0) {
+		int sub = (int) ceil(worst);
+		delta_t /= sub;
+		no_of_iter *= sub;
+	}
+
+	vector<double> k(s->nl + EXTRA);
+	for (int i = 0; i < s->nl + EXTRA; i++) {
+		k[i] = delta_t / s->cap[i];
+		assert(k[i] * s->diag_max[i] <= 1.0 + 1e-9);
+	}
+
+	vector<double> next(temp.size(), 0.0);
+	for (int n = 0; n < no_of_iter; n++) {
+		stencil_run(s, &next[0], &temp[0], &power[0], 1.0, &k[0], s->Tamb * s->g_conv);
+		temp.swap(next);
+	}
+}
+
+/*
+ * steady state with a jacobi preconditioned conjugate gradient. the
+ * conductance matrix is symmetric positive definite (every node has a
+ * path to the ambient through the convection resistance). iterates
+ * until the jacobi correction of every node is below grid_solver_tol
+ * kelvin.
+ */
+void compute_steady_temp_pcg(grid_model_t *model, vector<double> &steady_temp, vector<double> &power)
+{
+	grid_solver_t *s = grid_solver(model);
+	int n = s->n;
+	int i, iter;
+	double tol = model->config.grid_solver_tol;
+
+	vector<double> minus_one(s->nl + EXTRA, -1.0), one(s->nl + EXTRA, 1.0);
+	vector<double> r(n), z(n), p(n), q(n);
+	double *x = &steady_temp[0];
+
+	/* r = b - A*x, b is the power plus the ambient through the convection	*/
+	stencil_run(s, &r[0], x, &power[0], 0.0, &one[0], s->Tamb * s->g_conv);
+
+	double rz = 0.0, err = 0.0;
+	for (i = 0; i < n; i++) {
+		z[i] = r[i] / s->diag[i];
+		p[i] = z[i];
+		rz += r[i] * z[i];
+		if (fabs(z[i]) > err)
+			err = fabs(z[i]);
+	}
+
+	int max_iter = 10 * n;
+	for (iter = 0; iter < max_iter && err > tol; iter++) {
+		/* q = A*p	*/
+		stencil_run(s, &q[0], &p[0], NULL, 0.0, &minus_one[0], 0.0);
+
+		double pq = 0.0;
+		for (i = 0; i < n; i++)
+			pq += p[i] * q[i];
+		double alpha = rz / pq;
+
+		double rz_new = 0.0;
+		err = 0.0;
+		for (i = 0; i < n; i++) {
+			x[i] += alpha * p[i];
+			r[i] -= alpha * q[i];
+			z[i] = r[i] / s->diag[i];
+			rz_new += r[i] * z[i];
+			if (fabs(z[i]) > err)
+				err = fabs(z[i]);
+		}
+
+		double beta = rz_new / rz;
+		rz = rz_new;
+		for (i = 0; i < n; i++)
+			p[i] = z[i] + beta * p[i];
+	}
+
+	if (err > tol)
+		cerr << "warning: pcg steady state solver did not converge (" << err << " K after " << iter << " iterations)" << endl;
+	#if VERBOSE > 2
+	fprintf(stdout, "pcg iterations to converge: %d\n", iter);
+	#endif
+}
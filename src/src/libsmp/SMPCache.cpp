@@ -25,6 +25,12 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #include "MESIProtocol.h"
 
+#if (defined TM)
+#include "DInst.h"
+#include "transCoherence.h"
+#include "TransPrefetcher.h"
+#endif
+
 // This cache works under the assumption that caches above it in the memory
 // hierarchy are write-through caches
 
@@ -64,6 +70,9 @@ SMPCache::SMPCache(SMemorySystem *dms, const char *section, const char *name)
   , writeRetry("%s:writeRetry", name)
   , invalDirty("%s:invalDirty", name)
   , allocDirty("%s:allocDirty", name)
+#if (defined TM)
+  , tmOverflow("%s:tmOverflow", name)
+#endif
 {
   MemObj *lowerLevel = NULL;
 
@@ -112,6 +121,16 @@ SMPCache::SMPCache(SMemorySystem *dms, const char *section, const char *name)
   SescConf->isInt(section, "missDelay");
   missDelay = SescConf->getInt(section, "missDelay");
 
+#if (defined TM)
+  trackTM = false;
+  if (SescConf->checkInt("TransactionalMemory", "boundedCache"))
+    trackTM = SescConf->getInt("TransactionalMemory", "boundedCache") != 0;
+
+  // abort-replay prefetcher of the threads running on this cache
+  if (SescConf->checkCharPtr(section, "transPref"))
+    new TransPrefetcher(this, section, name);
+#endif
+
 #ifdef SESC_ENERGY
 
   myID = cacheID;
@@ -210,6 +229,9 @@ void SMPCache::doRead(MemRequest *mreq)
 #ifdef SESC_ENERGY
     rdEnergy[0]->inc();
 #endif    
+#if (defined TM)
+    tmMark(mreq, l);
+#endif
     outsReq->retire(addr);
     mreq->goUp(hitDelay);
     return;
@@ -271,6 +293,9 @@ void SMPCache::doWrite(MemRequest *mreq)
     wrEnergy[0]->inc();
 #endif
     protocol->makeDirty(l);
+#if (defined TM)
+    tmMark(mreq, l);
+#endif
     outsReq->retire(addr);
     mreq->goUp(hitDelay);  
     return;
@@ -493,6 +518,12 @@ void SMPCache::concludeAccess(MemRequest *mreq)
 {
   PAddr addr = mreq->getPAddr();
 
+#if (defined TM)
+  Line *l = cache->findLine(addr);
+  if (l)
+    tmMark(mreq, l);
+#endif
+
   mreq->mutateReadToWrite(); /*
                               Hack justification: It makes things much
                               nicer if we can call mutateWriteToRead()
@@ -536,6 +567,10 @@ SMPCache::Line *SMPCache::allocateLine(PAddr addr, CallbackBase *cb,
     l->setTag(cache->calcTag(addr));
     return l;
   }
+
+#if (defined TM)
+  tmDisplace(l, rpl_addr);
+#endif
   
   if(isHighestLevel()) {
     if(l->isDirty()) {
@@ -636,6 +671,82 @@ void SMPCache::invalidateLine(PAddr addr, CallbackBase *cb, bool writeBack)
   doInvalidate(addr, cache->getLineSize());
 }
 
+#if (defined TM)
+void SMPCache::tmMark(MemRequest *mreq, Line *l)
+{
+  if (!trackTM || !isHighestLevel())
+    return;
+
+  DInst *dinst = mreq->getDInst();
+  if (dinst == 0)
+    return;
+  if (dinst->transType != transLoad && dinst->transType != transStore)
+    return;
+  if (!transGCM->tracksOverflow(dinst->transPid, dinst->utid))
+    return;
+
+  // slot of the context, or one whose transaction is over
+  size_t slot;
+  size_t freeSlot = tmCtx.size();
+  for(slot = 0; slot < tmCtx.size(); slot++) {
+    if (tmCtx[slot].pid == dinst->transPid)
+      break;
+    if (freeSlot == tmCtx.size()
+        && !transGCM->tracksOverflow(tmCtx[slot].pid, tmCtx[slot].utid))
+      freeSlot = slot;
+  }
+  if (slot == tmCtx.size()) {
+    slot = freeSlot;
+    if (slot == tmCtx.size()) {
+      if (slot == SMP_TM_MAX_CTX)
+        return; // every slot runs a transaction
+      TMContext c;
+      tmCtx.push_back(c);
+    }
+    tmCtx[slot].pid  = dinst->transPid;
+    tmCtx[slot].utid = -1;
+  }
+
+  TMContext &c = tmCtx[slot];
+  uint bits = tmSlotBits(slot);
+
+  if (dinst->utid != c.utid) {
+    // new transaction in the slot, the marks of the previous one are stale
+    for(size_t i=0;i<c.lines.size();i++)
+      c.lines[i]->clearTM(bits);
+    c.lines.clear();
+    c.utid = dinst->utid;
+  }
+
+  if (!(l->getTMBits() & bits))
+    c.lines.push_back(l);
+
+  l->markTM((dinst->transType == transStore ? SMP_TM_WRITE_BIT : SMP_TM_READ_BIT) << (slot * SMP_TM_CTX_SHIFT));
+}
+
+// l (holding addr) is about to be replaced. The running transactions
+// that read or wrote it do not fit in the cache
+void SMPCache::tmDisplace(Line *l, PAddr addr)
+{
+  if (!l->isTMMarked())
+    return;
+
+  for(size_t slot = 0; slot < tmCtx.size(); slot++) {
+    uint bits = tmSlotBits(slot);
+    if (!(l->getTMBits() & bits))
+      continue;
+
+    l->clearTM(bits);
+
+    if (!transGCM->tracksOverflow(tmCtx[slot].pid, tmCtx[slot].utid))
+      continue;
+
+    tmOverflow.inc();
+    transGCM->overflow(tmCtx[slot].pid, tmCtx[slot].utid, addr);
+  }
+}
+#endif
+
 #ifdef SESC_SMP_DEBUG
 void SMPCache::inclusionCheck(PAddr addr) {
   const LevelType* la = getUpperLevel();
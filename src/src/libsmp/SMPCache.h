@@ -90,6 +90,10 @@ protected:
   GStatsCntr invalDirty;
   GStatsCntr allocDirty;
 
+#if (defined TM)
+  GStatsCntr tmOverflow;
+#endif
+
 #ifdef SESC_ENERGY
   static unsigned cacheID;
   unsigned myID;
@@ -101,6 +105,27 @@ protected:
 
   SMPProtocol *protocol;
 
+#if (defined TM)
+  // bounded TM (TransactionalMemory:boundedCache): lines read or
+  // written by the running transactions of this (private) cache, one
+  // slot per context. Displacing one of them aborts the transaction
+  // (overflow)
+  struct TMContext {
+    int pid;
+    int utid;
+    std::vector<Line *> lines;
+  };
+  bool trackTM;
+  std::vector<TMContext> tmCtx;
+
+  uint tmSlotBits(size_t slot) const {
+    return ((uint)SMP_TM_CTX_MASK) << (slot * SMP_TM_CTX_SHIFT);
+  }
+
+  void tmMark(MemRequest *mreq, Line *l);
+  void tmDisplace(Line *l, PAddr addr);
+#endif
+
   // interface with upper level
   void read(MemRequest *mreq);
   void write(MemRequest *mreq);
@@ -45,15 +45,29 @@ enum SMPState_t {
   SMP_WRITEABLE_BIT = 0x00200000  // has permission to be written
 };
 
+// bounded TM: the running transaction read/wrote the line. These are
+// kept apart from the state because protocols compare whole states.
+// Each context (SMT) sharing the cache has its own pair of bits,
+// shifted by SMP_TM_CTX_SHIFT times its slot
+enum SMPTMBit_t {
+  SMP_TM_READ_BIT   = 0x00000001,
+  SMP_TM_WRITE_BIT  = 0x00000002,
+  SMP_TM_CTX_MASK   = 0x00000003,
+  SMP_TM_CTX_SHIFT  = 2,
+  SMP_TM_MAX_CTX    = 16
+};
+
 class SMPCacheState : public StateGeneric<> {
 
 private:
 protected:
   uint state;
+  uint tmBits;
 public:
   SMPCacheState() 
       : StateGeneric<>() {
       state = SMP_INVALID;
+      tmBits = 0;
     }
 
     // BEGIN CacheCore interface 
@@ -67,6 +81,7 @@ public:
       GI(isLocked(), (state & SMP_TRANS_BIT) && (state & SMP_INV_BIT));
       clearTag();
       state = SMP_INVALID;
+      tmBits = 0;
     }
     
     bool isLocked() const {
@@ -100,6 +115,26 @@ public:
     bool canBeWritten() const {
       return (state & SMP_WRITEABLE_BIT);
     }
+
+    bool isTMMarked() const {
+      return tmBits != 0;
+    }
+
+    uint getTMBits() const {
+      return tmBits;
+    }
+
+    void markTM(uint bits) {
+      tmBits |= bits;
+    }
+
+    void clearTM() {
+      tmBits = 0;
+    }
+
+    void clearTM(uint bits) {
+      tmBits &= ~bits;
+    }
 };
 
 #endif //SMPCACHESTATE_H
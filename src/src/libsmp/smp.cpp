@@ -95,8 +95,8 @@ int main(int argc, char**argv, char **envp)
 
   for(int i = 0; i < nProcs; i++) {
 
-	fprintf (tmReport->getOutfile(), "core %d, cyclesOnCommit = %llu\n", i, transGCM->cyclesOnCommit[i]);
-	fprintf (tmReport->getOutfile(), "core %d, cyclesOnAbort = %llu\n", i, transGCM->cyclesOnAbort[i]);
+	fprintf (tmReport->getOutfile(), "core %d, cyclesOnCommit = %llu\n", i, transGCM->getCyclesOnCommit(i));
+	fprintf (tmReport->getOutfile(), "core %d, cyclesOnAbort = %llu\n", i, transGCM->getCyclesOnAbort(i));
     delete pr[i];
     delete ms[i];
   }
@@ -0,0 +1,162 @@
+//
+// C++ Implementation: CompactSFG
+//
+// Description:
+//
+//
+/// @author: hughes  <hughes@fraidy2-uf>, (C) 2008
+///
+/// @date:          08/02/08
+/// Last Modified:  08/02/08
+//
+// Copyright: See COPYING file that comes with this distribution
+//
+//
+
+#include "CompactSFG.h"
+
+/**
+ * @name update
+ *
+ * @param basicBlockIn
+ * @param bbAddress
+ * @param isShared
+ * @return
+   Same rules as the old per-edge Boost updates: a new address (or any
+   thread event) gets a new node, otherwise the node count and the edge
+   from the previous node are incremented.
+**/
+void CompactSFG::update(const BasicBlock &basicBlockIn, ADDRESS_INT bbAddress, BOOL isShared)
+{
+   NodeIDMap::iterator nodeMapIterator = nodeMap.find(bbAddress);
+
+   //NOTE Even if the node exists, we need to keep track of all synch events and need to insert another node
+   if(nodeMapIterator == nodeMap.end() || basicBlockIn.return_isThreadEvent())
+   {
+      UINT_32 nodeID = addNode(basicBlockIn, bbAddress, isShared);
+
+      //need to check corner case (is there another node to link it to?)
+      if(nodes.size() > 1)
+      {
+         edges.push_back(Edge());
+         edges.back().source = lastNode;
+         edges.back().target = nodeID;
+         edges.back().weight = 1;
+         outEdges[lastNode].push_back(edges.size() - 1);
+      }
+
+      nodeMap[bbAddress] = nodeID;
+      lastNode = nodeID;
+   }
+   else
+   {
+      UINT_32 nodeID = nodeMapIterator->second;
+
+      nodes[nodeID].update_bbCount(nodes[nodeID].return_bbCount() + 1);
+
+      if(basicBlockIn.return_isWait() == 1)
+      {
+         nodes[nodeID].update_isWait(1);
+      }
+
+      addEdge(lastNode, nodeID);
+      lastNode = nodeID;
+   }
+}//---------------------------------------------------------------------	// End update //
+
+/**
+ * @name addNode
+ *
+ * @param basicBlockIn
+ * @param bbAddress
+ * @param isShared
+ * @return ID of the new node
+**/
+UINT_32 CompactSFG::addNode(const BasicBlock &basicBlockIn, ADDRESS_INT bbAddress, BOOL isShared)
+{
+   nodes.push_back(basicBlockIn);
+   outEdges.push_back(std::vector < UINT_32 >());
+
+   BasicBlock &newBB = nodes.back();
+   if(isShared)
+   {
+      newBB.update_isShared(1);
+   }
+   newBB.update_bbAddress(bbAddress);
+   newBB.update_bbCount(1);                            //set count to one, only stored if first instance
+
+   return nodes.size() - 1;
+}
+
+/**
+ * @name addEdge
+ *
+ * @param source
+ * @param target
+ * @return
+**/
+void CompactSFG::addEdge(UINT_32 source, UINT_32 target)
+{
+   std::vector < UINT_32 > &out = outEdges[source];
+   for(UINT_32 counter = 0; counter < out.size(); counter++)
+   {
+      if(edges[out[counter]].target == target)
+      {
+         edges[out[counter]].weight = edges[out[counter]].weight + 1;
+         return;
+      }
+   }
+
+   edges.push_back(Edge());
+   edges.back().source = source;
+   edges.back().target = target;
+   edges.back().weight = 1;
+   out.push_back(edges.size() - 1);
+}
+
+/**
+ * @name build
+ *
+ * @param graph
+ * @return
+   Vertices and edges are added in creation order, so the out-edge lists
+   (and any walk over them) match the graph updateGraph used to build.
+**/
+void CompactSFG::build(BBGraph &graph)
+{
+   basicBlock_name_map_t basicBlock = get(basicBlock_t(), graph);
+   edgeWeight_name_map_t edgeWeight = get(edge_weight, graph);
+
+   std::vector < BBVertex > vertexList(nodes.size());
+   for(UINT_32 nodeID = 0; nodeID < nodes.size(); nodeID++)
+   {
+      vertexList[nodeID] = add_vertex(graph);
+      basicBlock[vertexList[nodeID]] = nodes[nodeID];
+   }
+
+   for(UINT_32 edgeID = 0; edgeID < edges.size(); edgeID++)
+   {
+      graph_traits <BBGraph>::edge_descriptor edgeDesc;
+      BOOL inserted;
+
+      tie(edgeDesc, inserted) = add_edge(vertexList[edges[edgeID].source], vertexList[edges[edgeID].target], graph);
+      if(inserted)
+      {
+         edgeWeight[edgeDesc] = edges[edgeID].weight;
+      }
+   }
+}//---------------------------------------------------------------------	// End build //
+
+/**
+ * @name clear
+ *
+ * @return
+**/
+void CompactSFG::clear()
+{
+   std::vector < BasicBlock >().swap(nodes);
+   std::vector < std::vector < UINT_32 > >().swap(outEdges);
+   std::vector < Edge >().swap(edges);
+   nodeMap.clear();
+   lastNode = -1;
+}
@@ -0,0 +1,72 @@
+//
+// C++ Interface: CompactSFG
+//
+// Description:
+//
+//
+/// @author: hughes  <hughes@fraidy2-uf>, (C) 2008
+///
+/// @date:          08/02/08
+/// Last Modified:  08/02/08
+//
+// Copyright: See COPYING file that comes with this distribution
+//
+//
+
+#ifndef COMPACT_SFG_H
+#define COMPACT_SFG_H
+
+#include <vector>
+
+#include "estl.h"
+#include "stat-types.h"
+#include "stat-boost-types.h"
+#include "BasicBlock.h"
+
+/**
+ * @short Per-thread SFG used while the simulation runs.
+ *
+ * Basic blocks are interned by ID (insertion order) and edges live in a
+ * flat vector, with a small per-node list of out-edges for the lookup.
+ * Nothing is copied for a basic block that is already in the graph.
+ * build() turns it into the Boost BBGraph used by the synthesis passes,
+ * adding vertices and edges in the same order updateGraph used to.
+ */
+class CompactSFG
+{
+public:
+   /* Constructor */
+   CompactSFG() : lastNode(-1) { }
+
+   /* Functions */
+   void     update(const BasicBlock &basicBlockIn, ADDRESS_INT bbAddress, BOOL isShared);
+   void     build(BBGraph &graph);
+   void     clear(void);
+
+   UINT_32  return_numNodes(void) const { return nodes.size(); }
+   UINT_32  return_numEdges(void) const { return edges.size(); }
+
+protected:
+private:
+   typedef HASH_MAP< ADDRESS_INT, UINT_32 > NodeIDMap;
+
+   struct Edge
+   {
+      UINT_32  source;
+      UINT_32  target;
+      float    weight;
+   };
+
+   /* Variables */
+   std::vector < BasicBlock >                nodes;       //node ID -> basic block
+   std::vector < std::vector < UINT_32 > >   outEdges;    //node ID -> edge IDs
+   std::vector < Edge >                      edges;       //edge ID -> edge, in insertion order
+   NodeIDMap                                 nodeMap;     //BB address -> latest node ID
+   INT_32                                    lastNode;    //previous node of the thread
+
+   /* Functions */
+   UINT_32  addNode(const BasicBlock &basicBlockIn, ADDRESS_INT bbAddress, BOOL isShared);
+   void     addEdge(UINT_32 source, UINT_32 target);
+};
+
+#endif
@@ -22,7 +22,7 @@ class ConfObject
 {
    public:
       /* Constructor */
-      ConfObject() : printContents(0),verboseOutput(0),debugAll(0),debugUniqueBB(0),debugPrintDOTs(0),debugPrintGraph(0),debugPrintGraphStructure(0),enableSynth(0),synthOverride(0), reduceGraph(0),reductionFactor(0),maxBasicBlocks(0),cacheLineSize(0),enableProfiling(0), enablePerThreadProfiling(0), enablePerTransProfiling(0), windowSize(0), dumpType(0) { readFile(); }
+      ConfObject() : printContents(0),verboseOutput(0),debugAll(0),debugUniqueBB(0),debugPrintDOTs(0),debugPrintGraph(0),debugPrintGraphStructure(0),enableSynth(0),synthOverride(0), reduceGraph(0),reductionFactor(0),maxBasicBlocks(0),numWorkers(0),randomSeed(0),cacheLineSize(0),enableProfiling(0), enablePerThreadProfiling(0), enablePerTransProfiling(0), windowSize(0), dumpType(0) { readFile(); }
 
       /* Variables */
 
@@ -44,6 +44,11 @@ class ConfObject
          update_reduceGraph(SescConf->getBool("StatisticalModel","stat_reduceGraph"));
          update_reductionFactor(SescConf->getInt("StatisticalModel","stat_reductionFactor"));
          update_maxBasicBlocks(SescConf->getInt("StatisticalModel","stat_maxBasicBlocks"));
+         //optional: worker threads for the SFG passes (0 = all CPUs), seed for the walks (0 = time)
+         if(SescConf->checkInt("StatisticalModel","stat_numWorkers"))
+            update_numWorkers(SescConf->getInt("StatisticalModel","stat_numWorkers"));
+         if(SescConf->checkInt("StatisticalModel","stat_randomSeed"))
+            update_randomSeed(SescConf->getInt("StatisticalModel","stat_randomSeed"));
 
          update_cacheLineSize(SescConf->getInt("","cacheLineSize"));
 
@@ -74,6 +79,8 @@ class ConfObject
          std::cout << "\treduceGraph " << return_reduceGraph() << "\n";
          std::cout << "\treductionFactor " << return_reductionFactor() << "\n";
          std::cout << "\tmaxBasicBlocks " << return_maxBasicBlocks() << "\n";
+         std::cout << "\tnumWorkers " << return_numWorkers() << "\n";
+         std::cout << "\trandomSeed " << return_randomSeed() << "\n";
 
          //Profiling
          std::cout << "\tenableProfiling " << return_enableProfiling() << "\n";
@@ -100,6 +107,8 @@ class ConfObject
       UINT_8   update_reduceGraph(UINT_32 reduceGraph) { this->reduceGraph = reduceGraph; return 1; }
       UINT_8   update_reductionFactor(UINT_32 reductionFactor) { this->reductionFactor = reductionFactor; return 1; }
       UINT_8   update_maxBasicBlocks(UINT_32 maxBasicBlocks) { this->maxBasicBlocks = maxBasicBlocks; return 1; }
+      UINT_8   update_numWorkers(UINT_32 numWorkers) { this->numWorkers = numWorkers; return 1; }
+      UINT_8   update_randomSeed(UINT_32 randomSeed) { this->randomSeed = randomSeed; return 1; }
 
       UINT_8   update_cacheLineSize(UINT_32 cacheLineSize) { this->cacheLineSize = cacheLineSize; return 1; }
 
@@ -125,6 +134,8 @@ class ConfObject
       BOOL     return_reduceGraph(void) { return this->reduceGraph; }
       INT_32   return_reductionFactor(void) { return this->reductionFactor; }
       INT_32   return_maxBasicBlocks(void) { return this->maxBasicBlocks; }
+      UINT_32  return_numWorkers(void) { return this->numWorkers; }
+      UINT_32  return_randomSeed(void) { return this->randomSeed; }
 
       INT_32   return_cacheLineSize(void) { return this->cacheLineSize; }
 
@@ -156,6 +167,8 @@ class ConfObject
       BOOL     reduceGraph;
       INT_32   reductionFactor;
       INT_32   maxBasicBlocks;
+      UINT_32  numWorkers;
+      UINT_32  randomSeed;
 
       INT_32   cacheLineSize;
 
@@ -33,9 +33,7 @@ extern UINT_32 totalNumThreads;
 
 // SFG
 extern std::deque  < BBGraph * > myCFG;                                  //SFG graph container, type BBGraph
-extern std::vector < BBVertex > myCFG_VertexA;                           //used to ID the vertices
-extern std::vector < BBVertex > myCFG_VertexB;                           //used to ID the vertices
-extern std::vector < BBVertexMap > vertexMap;                            //map container, type BBVertexMap
+extern std::vector < CompactSFG * > compactSFG;                         //SFG while the simulation runs
 
 // PCFG
 extern PCFG myPCFG;                                                      //PCFG graph container, type PCFG
@@ -56,6 +54,86 @@ namespace GraphManipulation
 {
 ofstream uniqueBBOutputFile("/home/hughes/Benchies/MIPS/asmTesting/raw/unique.out", ios::trunc);         //open a file for writing (truncate the current contents)
 
+//per-thread state for the SFG walks, so threads can be walked in parallel
+std::vector < boost::lagged_fibonacci1279 * > walkGenerator;             //uniform RV source, one per thread
+std::vector < std::vector < graph_traits <BBGraph>::vertex_iterator > > vertexTable;   //vertex_index -> vertex iterator
+
+/**
+ * @name getStatConf
+ *
+ * @short The configuration does not change once the simulation starts, read it once.
+ * @return
+**/
+static ConfObject *getStatConf()
+{
+   static ConfObject statConf;
+
+   return &statConf;
+}
+
+struct ParallelJob
+{
+   void     (*work)(UINT_32 item, void *arg);
+   void     *arg;
+   UINT_32  numItems;
+   UINT_32  nextItem;
+};
+
+static void *parallelWorker(void *argIn)
+{
+   ParallelJob *job = static_cast<ParallelJob *>(argIn);
+
+   while(1)
+   {
+      UINT_32 item = __sync_fetch_and_add(&job->nextItem, 1);
+      if(item >= job->numItems)
+         break;
+
+      job->work(item, job->arg);
+   }
+
+   return 0;
+}
+
+/**
+ * @name parallelFor
+ *
+ * @short Runs work(0..numItems-1) on a pool of worker threads.
+ * @param numItems 
+ * @param work 
+ * @param arg 
+ * @return 
+ * @note  stat_numWorkers (StatisticalModel) sets the pool size, 0 uses every online CPU.
+**/
+static void parallelFor(UINT_32 numItems, void (*work)(UINT_32 item, void *arg), void *arg)
+{
+   ParallelJob job;
+   job.work     = work;
+   job.arg      = arg;
+   job.numItems = numItems;
+   job.nextItem = 0;
+
+   UINT_32 numWorkers = getStatConf()->return_numWorkers();
+   if(numWorkers == 0)
+      numWorkers = sysconf(_SC_NPROCESSORS_ONLN);
+   if(numWorkers > numItems)
+      numWorkers = numItems;
+
+   std::vector < pthread_t > workers;
+   for(UINT_32 counter = 1; counter < numWorkers; counter++)
+   {
+      pthread_t worker;
+      if(pthread_create(&worker, 0, parallelWorker, &job) != 0)
+         break;                                     //the calling thread does the rest
+      workers.push_back(worker);
+   }
+
+   parallelWorker(&job);
+
+   for(UINT_32 counter = 0; counter < workers.size(); counter++)
+      pthread_join(workers[counter], 0);
+}
+
 
 /**
  * @name generateSFGNodeIDs
@@ -94,7 +172,7 @@ void generateSFGNodeIDs()
 **/
 void writeSFGDots(string name)
 {
-   ConfObject *statConf = new ConfObject;
+   ConfObject *statConf = getStatConf();
    UINT_32 numThreads = totalNumThreads;
    INT_32 rSize = statConf->return_reductionFactor();
    UINT_32 threadCounter = 0;
@@ -116,8 +194,6 @@ void writeSFGDots(string name)
       outputFile.close();
    }
 
-   delete statConf;
-
    std::cout << "...Finished" << std::flush;
 }
 
@@ -130,28 +206,25 @@ void writeSFGDots(string name)
    This function is used to update the graph.  It checks to see if a node is present, using the map.
    If not, it inserts it into the graph and inserts an edge between it and its parent.  If the node
    was already present, it simply increments the basic block and edge counts (these are used later).
+   The nodes go to the thread's CompactSFG; buildSFGs() creates the Boost graphs at the end.
 **/
 void updateGraph(BasicBlock *basicBlockIn, THREAD_ID threadID)
 {
    /* Variable Declaration */
-   BOOL found;
-   BOOL inserted;
    BOOL unique;
-   ConfObject *statConf = new ConfObject;
+   ConfObject *statConf = getStatConf();
    ADDRESS_INT basicBlockAddress;
-   BasicBlock localBBObject;
-   BBVertexMap::iterator masterMapIterator;
    AddressMap::iterator bbMapIterator;
 
-   graph_traits <BBGraph>::edge_descriptor edgeDesc;
-   basicBlock_name_map_t basicBlock = get(basicBlock_t(), *myCFG[threadID]);
-   edgeWeight_name_map_t edgeWeight = get(edge_weight, *myCFG[threadID]);
-
    /* Processes */
    basicBlockAddress = (ADDRESS_INT)basicBlockIn->return_front_of_instructionList().return_instructionID();
-   localBBObject = *basicBlockIn;
 
    boost::tie(bbMapIterator, unique) = uniqueBBMap.insert(make_pair(basicBlockAddress, 1));
+
+   //the basic block is only copied if it becomes a new node
+   compactSFG[threadID]->update(*basicBlockIn, basicBlockAddress, unique != 1 && bbMapIterator->second != threadID);
+
+   //NOTE this drains currBB, so it has to go after the graph update
    if(unique == 1)
    {
       if(statConf->return_debugUniqueBB() == 1 || statConf->return_debugAll() == 1)
@@ -169,99 +242,27 @@ void updateGraph(BasicBlock *basicBlockIn, THREAD_ID threadID)
          uniqueBBOutputFile << endl;
       }
    }
+}//---------------------------------------------------------------------	// End updateGraph //
 
-   if(unique != 1 && bbMapIterator->second != threadID)
-   {
-      localBBObject.update_isShared(1);
-      //cout << "Address-  " << bbAddress << "   Current-  " << threadID << "   Owner-  " << bbMapIterator->second << endl;
-   }
-
-   tie(masterMapIterator, inserted) = vertexMap[threadID].insert(make_pair(basicBlockAddress, BBVertex()));
-   //If the address was not in the map, that means there was no vertex associated with it
-   if(inserted == 1)
-   {
-      localBBObject.update_bbAddress(basicBlockAddress);
-      localBBObject.update_bbCount(1);                            //set count to one, only stored if first instance
-
-      myCFG_VertexA[threadID] = add_vertex(*myCFG[threadID]);     //place the node
-      basicBlock[myCFG_VertexA[threadID]] = localBBObject;        //assign the value
-
-      //need to check corner case (is there another node to link it to?)
-      if(num_vertices(*myCFG[threadID]) > 1)
-      {
-         //create an edge for the new node if it isn't the first node of the graph			
-         tie(edgeDesc, inserted) = add_edge(myCFG_VertexB[threadID], myCFG_VertexA[threadID], *myCFG[threadID]);
-         if(inserted)
-         {
-            edgeWeight[edgeDesc] = 1;
-         }
-      }
-
-      myCFG_VertexB[threadID] = myCFG_VertexA[threadID];          //set up for next iteration
-
-      masterMapIterator->second = myCFG_VertexA[threadID];        //assign the correct vertex to the map
-
-   }
-   //NOTE Even if the node exists, we need to keep track of all synch events and need to insert another node
-   //  ------REASSIGNING THE NODE IN THE MAP MAY PRODUCE ERRONEOUS RESULTS------
-   else if(localBBObject.return_isThreadEvent())
-   {
-      localBBObject.update_bbAddress(basicBlockAddress);
-      localBBObject.update_bbCount(1);                                 //set count to one, only stored if first instance
-
-      myCFG_VertexA[threadID] = add_vertex(*myCFG[threadID]);                //place the node
-
-      basicBlock[myCFG_VertexA[threadID]] = localBBObject;                  //assign the value
-
-      //TODO Need to check corner case (is there another node to link it to?)
-      if(num_vertices(*myCFG[threadID]) > 1)
-      {
-         //create an edge for the new node if it isn't the first node of the graph			
-         tie(edgeDesc, inserted) = add_edge(myCFG_VertexB[threadID], myCFG_VertexA[threadID], *myCFG[threadID]);
-         if(inserted)
-         {
-            edgeWeight[edgeDesc] = 1;
-         }
-      }
-
-      myCFG_VertexB[threadID] = myCFG_VertexA[threadID];									//set up for next iteration
-
-      masterMapIterator->second = myCFG_VertexA[threadID];				//assign the correct vertex to the map
-
-   }
-   else
+/**
+ * @name buildSFGs
+ *
+ * @short Turns the per-thread CompactSFGs into the Boost graphs (myCFG).
+ * @return
+**/
+void buildSFGs()
+{
+   std::cout << "\nBuilding SFGs" << std::flush;
+   for(UINT_32 threadCounter = 0; threadCounter < compactSFG.size() && threadCounter < myCFG.size(); threadCounter++)
    {
-      myCFG_VertexA[threadID] = masterMapIterator->second;                                                        //the node exists, so we just need to point to it to set up edge
-
-      basicBlock[myCFG_VertexA[threadID]].update_bbCount(basicBlock[myCFG_VertexA[threadID]].return_bbCount() + 1);     //increment the count
-
-      if(localBBObject.return_isWait() == 1)
-      {
-         basicBlock[myCFG_VertexA[threadID]].update_isWait(1);
-      }
-
-      tie(edgeDesc, found) = edge(myCFG_VertexB[threadID], myCFG_VertexA[threadID], *myCFG[threadID]);                   //now check to see if an edge already exists
-      if(found)
-      {
-         edgeWeight[edgeDesc] = edgeWeight[edgeDesc] + 1;
-      }
-      else
-      {
-         tie(edgeDesc, inserted) = add_edge(myCFG_VertexB[threadID], myCFG_VertexA[threadID], *myCFG[threadID]);
-         if(inserted)
-         {
-            edgeWeight[edgeDesc] = 1;
-         }
-      }
+      std::cout << "..." << threadCounter << std::flush;
 
-      myCFG_VertexB[threadID] = myCFG_VertexA[threadID];
+      compactSFG[threadCounter]->build(*myCFG[threadCounter]);
+      compactSFG[threadCounter]->clear();
    }
 
-   localBBObject.update_isSpawn(0);                                 //only set at thread generation
-   localBBObject.update_isDestroy(0);                               //only set at thread generation
-
-   delete statConf;
-}//---------------------------------------------------------------------	// End updateGraph //
+   std::cout << "...Finished" << std::flush;
+}
 
 /**
  * @name getBasicBlockSize
@@ -293,103 +294,126 @@ UINT_32 getBasicBlockSize(THREAD_ID threadID, UINT_32 totalInstructions)
  * @return 
  * @note  Transactions and critical sections are kept intact.
 **/
+static void reduceSFGWork(UINT_32 threadID, void *arg)
+{
+   reduceSFG(threadID);
+}
+
 void reduceSFG()
 {
    /* Variable Declaration */
-   ConfObject *statConf = new ConfObject;
-   float BBCount;
+   ConfObject *statConf = getStatConf();
    UINT_32 numThreads = totalNumThreads;
    UINT_64 reductionFactor = (UINT_32)statConf->return_reductionFactor();
-   graph_traits <BBGraph>::vertex_iterator vertexIterator, vertexStart, vertexEnd, nextVertex;
 
    /* Processes */
    cout << "\nReducing SFG with R = " << reductionFactor << flush;
+
+   //each thread has its own graph
+   parallelFor(numThreads, reduceSFGWork, 0);
+
    for(UINT_32 counter = 0; counter < numThreads; counter++)
    {
       cout << "..." << counter << flush;
-      basicBlock_name_map_t basicBlockLocal = get(basicBlock_t(), *myCFG[counter]);
+   }
 
-      tie(vertexIterator, vertexEnd) = vertices(*myCFG[counter]);
-      ++vertexIterator;
-      for(nextVertex = vertexIterator; vertexIterator != vertexEnd; vertexIterator = nextVertex)
-      {
-         ++nextVertex;
+   std::cout << "...Finished" << std::flush;
+}//---------------------------------------------------------------------	// End reduceSFG //
 
-         BBCount = (float)basicBlockLocal[*vertexIterator].return_bbCount() / (float)reductionFactor;
+/**
+ * @name reduceSFG 
+ * 
+ * @short Reduction of one thread's SFG.
+ * @param counter 
+ * @return 
+**/
+void reduceSFG(THREAD_ID counter)
+{
+   /* Variable Declaration */
+   ConfObject *statConf = getStatConf();
+   float BBCount;
+   UINT_64 reductionFactor = (UINT_32)statConf->return_reductionFactor();
+   graph_traits <BBGraph>::vertex_iterator vertexIterator, vertexStart, vertexEnd, nextVertex;
 
-         //If the basic block is not a critical section or only contains a branch instruction, remove it
-         if(basicBlockLocal[*vertexIterator].return_isTrans() != 1 && basicBlockLocal[*vertexIterator].return_isCritical() != 1 && basicBlockLocal[*vertexIterator].return_isSpawn() != 1)
-         {
-            if(BBCount < 1.0)
-            {
-               clear_vertex(*vertexIterator, *myCFG[counter]);                      //clear all edges
-               remove_vertex(*vertexIterator, *myCFG[counter]);                     //plop
-            }
-            else if(basicBlockLocal[*vertexIterator].return_instructionListSize() <= 1)
-            {
-               clear_vertex(*vertexIterator, *myCFG[counter]);                      //clear all edges
-               remove_vertex(*vertexIterator, *myCFG[counter]);                     //plop
-            }
-            else
-            {
-               basicBlockLocal[*vertexIterator].update_bbCount((UINT_32)BBCount);   //set new count
-            }
-         }
-         else
-         {
-            //Even though we didn't remove the node, it still needs a number <= 1
-            if(BBCount < 1.0)
-            {
-               basicBlockLocal[*vertexIterator].update_bbCount(1);                  //set new count
-            }
-            else
-            {
-               basicBlockLocal[*vertexIterator].update_bbCount((UINT_32)BBCount);   //set new count
-            }
-         }
-      }//end for
+   /* Processes */
+   basicBlock_name_map_t basicBlockLocal = get(basicBlock_t(), *myCFG[counter]);
 
-      //Now we want to see if the thread is comprised *solely* of critical sections
-      BOOL clearGraph  = 0;
-      BOOL isCritical  = 0;
-      BOOL wasCritical = 1;
-      for(tie(vertexIterator, vertexEnd) = vertices(*myCFG[counter]); vertexIterator != vertexEnd; vertexIterator++)
+   tie(vertexIterator, vertexEnd) = vertices(*myCFG[counter]);
+   ++vertexIterator;
+   for(nextVertex = vertexIterator; vertexIterator != vertexEnd; vertexIterator = nextVertex)
+   {
+      ++nextVertex;
+
+      BBCount = (float)basicBlockLocal[*vertexIterator].return_bbCount() / (float)reductionFactor;
+
+      //If the basic block is not a critical section or only contains a branch instruction, remove it
+      if(basicBlockLocal[*vertexIterator].return_isTrans() != 1 && basicBlockLocal[*vertexIterator].return_isCritical() != 1 && basicBlockLocal[*vertexIterator].return_isSpawn() != 1)
       {
-         if(basicBlockLocal[*vertexIterator].return_isTrans() != 1 && basicBlockLocal[*vertexIterator].return_isCritical() != 1)
+         if(BBCount < 1.0)
          {
-            isCritical = 0;
+            clear_vertex(*vertexIterator, *myCFG[counter]);                      //clear all edges
+            remove_vertex(*vertexIterator, *myCFG[counter]);                     //plop
          }
-         else
+         else if(basicBlockLocal[*vertexIterator].return_instructionListSize() <= 1)
          {
-            isCritical = 1;
+            clear_vertex(*vertexIterator, *myCFG[counter]);                      //clear all edges
+            remove_vertex(*vertexIterator, *myCFG[counter]);                     //plop
          }
-
-         if(wasCritical == 1 && isCritical == 0)
+         else
          {
-            clearGraph = 0;
-            break;
+            basicBlockLocal[*vertexIterator].update_bbCount((UINT_32)BBCount);   //set new count
          }
-         else if(basicBlockLocal[*vertexIterator].return_bbCount() >= 25)
+      }
+      else
+      {
+         //Even though we didn't remove the node, it still needs a number <= 1
+         if(BBCount < 1.0)
          {
-            clearGraph = 0;
-            break;
+            basicBlockLocal[*vertexIterator].update_bbCount(1);                  //set new count
          }
          else
          {
-            clearGraph = 1;
+            basicBlockLocal[*vertexIterator].update_bbCount((UINT_32)BBCount);   //set new count
          }
-      }//end for
+      }
+   }//end for
 
-      if(clearGraph == 1 || num_vertices(*myCFG[counter]) < 2)
+   //Now we want to see if the thread is comprised *solely* of critical sections
+   BOOL clearGraph  = 0;
+   BOOL isCritical  = 0;
+   BOOL wasCritical = 1;
+   for(tie(vertexIterator, vertexEnd) = vertices(*myCFG[counter]); vertexIterator != vertexEnd; vertexIterator++)
+   {
+      if(basicBlockLocal[*vertexIterator].return_isTrans() != 1 && basicBlockLocal[*vertexIterator].return_isCritical() != 1)
       {
-         delete myCFG[counter];
-         myCFG[counter] = new BBGraph();
+         isCritical = 0;
+      }
+      else
+      {
+         isCritical = 1;
       }
-   }
 
-   delete statConf;
+      if(wasCritical == 1 && isCritical == 0)
+      {
+         clearGraph = 0;
+         break;
+      }
+      else if(basicBlockLocal[*vertexIterator].return_bbCount() >= 25)
+      {
+         clearGraph = 0;
+         break;
+      }
+      else
+      {
+         clearGraph = 1;
+      }
+   }//end for
 
-   std::cout << "...Finished" << std::flush;
+   if(clearGraph == 1 || num_vertices(*myCFG[counter]) < 2)
+   {
+      delete myCFG[counter];
+      myCFG[counter] = new BBGraph();
+   }
 }//---------------------------------------------------------------------	// End reduceSFG //
 
 /**
@@ -403,7 +427,7 @@ void reduceSFG()
 void walkSFG(THREAD_ID threadID, Synthetic *syntheticThreads[], UINT_32 arraySize)
 {
    /* Variable Declaraion */
-   ConfObject *statConf = new ConfObject;
+   ConfObject *statConf = getStatConf();
    float edgeTransit = 0;
    UINT_32 bbcount_out = 0;
 
@@ -420,7 +444,7 @@ void walkSFG(THREAD_ID threadID, Synthetic *syntheticThreads[], UINT_32 arraySiz
    Synthetic *tempSynth = new Synthetic;
 
    //initialize uniform RV over [0,1)
-   static boost::lagged_fibonacci1279 generator(static_cast<unsigned> (std::time(0)));
+   boost::lagged_fibonacci1279 &generator = *walkGenerator[threadID];
    boost::uniform_real<double> uniformDistribution(0, 1);
    boost::variate_generator<boost::lagged_fibonacci1279&, boost::uniform_real<double> >  uniformReal(generator, uniformDistribution);
 
@@ -463,9 +487,7 @@ void walkSFG(THREAD_ID threadID, Synthetic *syntheticThreads[], UINT_32 arraySiz
                {
                   //need to point the current iterator to the next one based on the target node
                   BBVertex nextVertex = target(*outEdgeIterator, *myCFG[threadID]);
-                  for(tie(vertexIterator, vertexEnd) = vertices(*myCFG[threadID]); *vertexIterator != nextVertex; ++vertexIterator)
-                  {
-                  }
+                  vertexIterator = vertexTable[threadID][nodeIndex[nextVertex]];
 
                   break;
                }
@@ -482,7 +504,6 @@ void walkSFG(THREAD_ID threadID, Synthetic *syntheticThreads[], UINT_32 arraySiz
    }while(bbcount_out < maxBB && num_vertices(*myCFG[threadID]) > 0);
 
    syntheticThreads[threadID] = tempSynth;
-   delete statConf;
 }//---------------------------------------------------------------------	// End walkSFG //
 
 /**
@@ -496,7 +517,7 @@ void walkSFG(THREAD_ID threadID, Synthetic *syntheticThreads[], UINT_32 arraySiz
 float walkSFG(THREAD_ID threadID, Synthetic *tempSynth, float numInstructions)
 {
    /* Variable Declaraion */
-   ConfObject *statConf = new ConfObject;
+   ConfObject *statConf = getStatConf();
    UINT_32 iterations = 0;
    float edgeTransit = 0;
    UINT_32 bbcount_out = 0;
@@ -514,7 +535,7 @@ float walkSFG(THREAD_ID threadID, Synthetic *tempSynth, float numInstructions)
    nodeIndex_name_map_t nodeIndex = get(vertex_index, *myCFG[threadID]);
 
    //initialize uniform RV over [0,1)
-   static boost::lagged_fibonacci1279 generator(static_cast<unsigned> (std::time(0)));
+   boost::lagged_fibonacci1279 &generator = *walkGenerator[threadID];
    boost::uniform_real<double> uniformDistribution(0, 1);
    boost::variate_generator<boost::lagged_fibonacci1279&, boost::uniform_real<double> >  uniformReal(generator, uniformDistribution);
 
@@ -656,9 +677,7 @@ float walkSFG(THREAD_ID threadID, Synthetic *tempSynth, float numInstructions)
                {
                   //need to point the current iterator to the next one based on the target node
                   BBVertex nextVertex = target(*outEdgeIterator, *myCFG[threadID]);
-                  for(tie(vertexIterator, vertexEnd) = vertices(*myCFG[threadID]); *vertexIterator != nextVertex; ++vertexIterator)
-                  {
-                  }
+                  vertexIterator = vertexTable[threadID][nodeIndex[nextVertex]];
 
                   break;
                }
@@ -681,8 +700,6 @@ float walkSFG(THREAD_ID threadID, Synthetic *tempSynth, float numInstructions)
    std::cout << "+Added " << instructions_out << " to T" << threadID << "  with weight of " << numInstructions << std::endl;
    #endif
 
-   delete statConf;
-
    return instructions_out;
 }//---------------------------------------------------------------------	// End walkSFG //
 
@@ -698,7 +715,7 @@ float walkSFG(THREAD_ID threadID, Synthetic *tempSynth, float numInstructions)
 float walkSFG(THREAD_ID threadID, ADDRESS_INT startPC, Synthetic *tempSynth, float numInstructions)
 {
    /* Variable Declaraion */
-   ConfObject *statConf = new ConfObject;
+   ConfObject *statConf = getStatConf();
    float edgeTransit = 0;
    UINT_32 bbcount_out = 0;
    float instructions_out = 0;
@@ -716,7 +733,7 @@ float walkSFG(THREAD_ID threadID, ADDRESS_INT startPC, Synthetic *tempSynth, flo
    nodeIndex_name_map_t nodeIndex = get(vertex_index, *myCFG[threadID]);
 
    //initialize uniform RV over [0,1)
-   static boost::lagged_fibonacci1279 generator(static_cast<unsigned> (std::time(0)));
+   boost::lagged_fibonacci1279 &generator = *walkGenerator[threadID];
    boost::uniform_real<double> uniformDistribution(0, 1);
    boost::variate_generator<boost::lagged_fibonacci1279&, boost::uniform_real<double> >  uniformReal(generator, uniformDistribution);
 
@@ -871,9 +888,7 @@ float walkSFG(THREAD_ID threadID, ADDRESS_INT startPC, Synthetic *tempSynth, flo
                {
                   //need to point the current iterator to the next one based on the target node
                   BBVertex nextVertex = target(*outEdgeIterator, *myCFG[threadID]);
-                  for(tie(vertexIterator, vertexEnd) = vertices(*myCFG[threadID]); *vertexIterator != nextVertex; ++vertexIterator)
-                  {
-                  }
+                  vertexIterator = vertexTable[threadID][nodeIndex[nextVertex]];
 
                   break;
                }
@@ -899,8 +914,6 @@ float walkSFG(THREAD_ID threadID, ADDRESS_INT startPC, Synthetic *tempSynth, flo
    std::cout << "*Added " << instructions_out << " to T" << threadID << "  with weight of " << numInstructions << std::endl;
    #endif
 
-   delete statConf;
-
    return instructions_out;
 }//---------------------------------------------------------------------	// End walkSFG //
 
@@ -917,7 +930,7 @@ float walkSFG(THREAD_ID threadID, ADDRESS_INT startPC, Synthetic *tempSynth, flo
 float walkSFG(THREAD_ID threadID, Synthetic *tempSynth, float numInstructions, FlowNode flowNodeIn, std::vector< FlowVertex > foundNodes)
 {
    /* Variable Declaraion */
-   ConfObject *statConf = new ConfObject;
+   ConfObject *statConf = getStatConf();
    float edgeTransit = 0;
    UINT_32 bbcount_out = 0;
    float instructions_out = 0;
@@ -940,7 +953,7 @@ float walkSFG(THREAD_ID threadID, Synthetic *tempSynth, float numInstructions, F
    flowName_name_map_t  flowNodeName  = get(vertex_name, myPCFG);
 
    //initialize uniform RV over [0,1)
-   static boost::lagged_fibonacci1279 generator(static_cast<unsigned> (std::time(0)));
+   boost::lagged_fibonacci1279 &generator = *walkGenerator[threadID];
    boost::uniform_real<double> uniformDistribution(0, 1);
    boost::variate_generator<boost::lagged_fibonacci1279&, boost::uniform_real<double> >  uniformReal(generator, uniformDistribution);
 
@@ -970,9 +983,7 @@ float walkSFG(THREAD_ID threadID, Synthetic *tempSynth, float numInstructions, F
                {
                   //need to point the current iterator to the next one based on the target node
                   BBVertex nextVertex = target(*outEdgeIterator, *myCFG[threadID]);
-                  for(tie(vertexIterator, vertexEnd) = vertices(*myCFG[threadID]); *vertexIterator != nextVertex; ++vertexIterator)
-                  {
-                  }
+                  vertexIterator = vertexTable[threadID][nodeIndex[nextVertex]];
 
                   break;
                }
@@ -1109,9 +1120,7 @@ float walkSFG(THREAD_ID threadID, Synthetic *tempSynth, float numInstructions, F
                {
                   //need to point the current iterator to the next one based on the target node
                   BBVertex nextVertex = target(*outEdgeIterator, *myCFG[threadID]);
-                  for(tie(vertexIterator, vertexEnd) = vertices(*myCFG[threadID]); *vertexIterator != nextVertex; ++vertexIterator)
-                  {
-                  }
+                  vertexIterator = vertexTable[threadID][nodeIndex[nextVertex]];
 
                   break;
                }
@@ -1181,8 +1190,6 @@ float walkSFG(THREAD_ID threadID, Synthetic *tempSynth, float numInstructions, F
    std::cout << "Added " << instructions_out << " to T" << threadID << "  with weight of " << numInstructions << std::endl;
    #endif
 
-   delete statConf;
-
    return instructions_out;
 }//---------------------------------------------------------------------	// End walkSFG //
 
@@ -1216,7 +1223,7 @@ float accumulatorDump(THREAD_ID threadID, ADDRESS_INT address, Synthetic *tempSy
    flowName_name_map_t  flowNodeName  = get(vertex_name, myPCFG);
 
    //initialize uniform RV over [0,1)
-   static boost::lagged_fibonacci1279 generator(static_cast<unsigned> (std::time(0)));
+   boost::lagged_fibonacci1279 &generator = *walkGenerator[threadID];
    boost::uniform_real<double> uniformDistribution(0, 1);
    boost::variate_generator<boost::lagged_fibonacci1279&, boost::uniform_real<double> >  uniformReal(generator, uniformDistribution);
 
@@ -1250,9 +1257,7 @@ float accumulatorDump(THREAD_ID threadID, ADDRESS_INT address, Synthetic *tempSy
             {
                //need to point the current iterator to the next one based on the target node
                BBVertex nextVertex = target(*outEdgeIterator, *myCFG[threadID]);
-               for(tie(vertexIterator, vertexEnd) = vertices(*myCFG[threadID]); *vertexIterator != nextVertex; ++vertexIterator)
-               {
-               }
+               vertexIterator = vertexTable[threadID][nodeIndex[nextVertex]];
 
                break;
             }
@@ -1284,9 +1289,7 @@ float accumulatorDump(THREAD_ID threadID, ADDRESS_INT address, Synthetic *tempSy
             {
                //need to point the current iterator to the next one based on the target node
                BBVertex nextVertex = target(*outEdgeIterator, *myCFG[threadID]);
-               for(tie(vertexIterator, vertexEnd) = vertices(*myCFG[threadID]); *vertexIterator != nextVertex; ++vertexIterator)
-               {
-               }
+               vertexIterator = vertexTable[threadID][nodeIndex[nextVertex]];
 
                break;
             }
@@ -1402,7 +1405,7 @@ void generatePCFGNodeIDs()
 **/
 void writePCFGDots(string name)
 {
-   ConfObject *statConf = new ConfObject;
+   ConfObject *statConf = getStatConf();
    UINT_32 numThreads = totalNumThreads;
    INT_32 rSize = statConf->return_reductionFactor();
    UINT_32 threadCounter = 0;
@@ -1421,8 +1424,6 @@ void writePCFGDots(string name)
    write_graphviz(outputFile, myPCFG, make_label_writer(nodeName), make_label_writer(edgeWeight));
    outputFile.close();
 
-   delete statConf;
-
    std::cout << "...Finished" << std::flush;
 }
 
@@ -1435,7 +1436,7 @@ void writePCFGDots(string name)
 void reducePCFG(const std::vector < UINT_64 > &numInstructions)
 {
    /* Variable Declaraion */
-   ConfObject *statConf = new ConfObject;
+   ConfObject *statConf = getStatConf();
    float minInstructionCount = MAX_INSTRUCTIONS;
    std::vector< UINT_64 > newInstructionCount (totalNumThreads,0);
 
@@ -1480,8 +1481,6 @@ void reducePCFG(const std::vector < UINT_64 > &numInstructions)
 
    std::cout << minInstructionCount << flush;
 
-   delete statConf;
-
    std::cout << "...Finished" << std::flush;
 }//---------------------------------------------------------------------	// End reducePCFG //
 
@@ -1490,13 +1489,16 @@ void reducePCFG(const std::vector < UINT_64 > &numInstructions)
  * 
  * @short 
  * @return 
+ * @param log progress messages
  * @note This takes care of zero-nodes by passing the weighted instruction count to the SFG or
  *       by using the JUNKYARD define.
+ * @note Only this thread's SFG is touched, and the PCFG is only read, so threads can be walked
+ *       in parallel (see walkPCFGs).
 **/
-void walkPCFG(THREAD_ID threadID, Synthetic *syntheticThreads[], const UINT_32 &arraySize)
+void walkPCFG(THREAD_ID threadID, Synthetic *syntheticThreads[], const UINT_32 &arraySize, std::ostream &log)
 {
    /* Variable Declaraion */
-   ConfObject *statConf = new ConfObject;
+   ConfObject *statConf = getStatConf();
    UINT_32 maxBB = statConf->return_maxBasicBlocks();
    UINT_32 bbcount_out = 0;
    float   totalInstructions = 0;
@@ -1517,26 +1519,34 @@ void walkPCFG(THREAD_ID threadID, Synthetic *syntheticThreads[], const UINT_32 &
 
    /* Processes */
    if(threadID == 0)
-      std::cout << "\nPopulating Synthetic Backbone..." << std::flush;
+      log << "\nPopulating Synthetic Backbone..." << std::flush;
 
-   std::cout << "\n\t-T" << threadID << ":  " << std::flush;
+   log << "\n\t-T" << threadID << ":  " << std::flush;
 
    if(num_vertices(*myCFG[threadID]) > 0)
    {
       //BFS on PCFG -- build a vector of the nodes as they appear in the graph
       std::vector< FlowVertex > nameList;
 
-      std::cout << "Building node list..." << std::flush;
+      log << "Building node list..." << std::flush;
+
+      //private color map, the one in myPCFG is shared by all the walkers
+      std::vector< default_color_type > colorMap(num_vertices(myPCFG));
+      flowIndex_name_map_t flowNodeIndex = get(vertex_index, myPCFG);
 
       bfs_thread_visitor nodeVisitor(threadID, nameList);
-      breadth_first_search(myPCFG, vertex(0, myPCFG), visitor(nodeVisitor));
+      breadth_first_search(myPCFG, vertex(0, myPCFG), visitor(nodeVisitor).color_map(make_iterator_property_map(colorMap.begin(), flowNodeIndex)));
+
+      //nodes of the other threads, same for every transaction so only searched once
+      std::vector< std::list < FlowVertex > > depthList (totalNumThreads);
+      BOOL depthListReady = 0;
 
       for(UINT_32 counter = 0; counter < totalNumThreads; counter++)
       {
          inscount_low[counter] = inscount_high[counter] = 0;
       }
 
-      std::cout << "Iterating through PCFG..." << std::flush;
+      log << "Iterating through PCFG..." << std::flush;
 
       //Iterate through the vector of vertices, for each node add the appropriate
       //number of instructions to the synthetic buffer
@@ -1574,9 +1584,14 @@ void walkPCFG(THREAD_ID threadID, Synthetic *syntheticThreads[], const UINT_32 &
             //Need to check if there is another node at the same depth.
             //If there is a node, push it to the foundNode list which can be passed to the SFG population function.
             float instructionCount[totalNumThreads];
-            std::vector< std::list < FlowVertex > > depthList (totalNumThreads);
-            bfs_depth_finder depthVisitor(threadID, depthList);
-            breadth_first_search(myPCFG, vertex(0, myPCFG), visitor(depthVisitor));
+            if(depthListReady == 0)
+            {
+               std::fill(colorMap.begin(), colorMap.end(), white_color);
+
+               bfs_depth_finder depthVisitor(threadID, depthList);
+               breadth_first_search(myPCFG, vertex(0, myPCFG), visitor(depthVisitor).color_map(make_iterator_property_map(colorMap.begin(), flowNodeIndex)));
+               depthListReady = 1;
+            }
 
             for(UINT_32 counter = 0; counter < totalNumThreads; counter++)
             {
@@ -1593,14 +1608,14 @@ void walkPCFG(THREAD_ID threadID, Synthetic *syntheticThreads[], const UINT_32 &
 
             #if defined(JUNKYARD)
                #if defined(DEBUG)
-               std::cout << "T" << threadID << " ";
-               std::cout << "Map Size (" << flowNode[*itBegin].return_transID() << ") is " << transactionAccumulator[flowNode[*itBegin].return_transID()] << " adding " << flowNode[*itBegin].return_weighted_numInstructions();
+               log << "T" << threadID << " ";
+               log << "Map Size (" << flowNode[*itBegin].return_transID() << ") is " << transactionAccumulator[flowNode[*itBegin].return_transID()] << " adding " << flowNode[*itBegin].return_weighted_numInstructions();
                #endif
 
                transactionAccumulator[flowNode[*itBegin].return_transID()] = transactionAccumulator[flowNode[*itBegin].return_transID()] + flowNode[*itBegin].return_weighted_numInstructions();
 
                #if defined(DEBUG)
-               std::cout << " New Map Size (" << flowNode[*itBegin].return_transID() << ") is " << transactionAccumulator[flowNode[*itBegin].return_transID()] << std::endl;
+               log << " New Map Size (" << flowNode[*itBegin].return_transID() << ") is " << transactionAccumulator[flowNode[*itBegin].return_transID()] << std::endl;
                #endif
 
                if(flowNode[*itBegin].return_weighted_numInstructions() >= ACC_MAX)
@@ -1622,14 +1637,14 @@ void walkPCFG(THREAD_ID threadID, Synthetic *syntheticThreads[], const UINT_32 &
          {
             #if defined(JUNKYARD)
                #if defined(DEBUG)
-               std::cout << "*T" << threadID << " ";
-               std::cout << "Map Size (" << flowNode[*itBegin].return_transID() << ") is " << transactionAccumulator[SEQUENTIAL] << " adding " << flowNode[*itBegin].return_weighted_numInstructions();
+               log << "*T" << threadID << " ";
+               log << "Map Size (" << flowNode[*itBegin].return_transID() << ") is " << transactionAccumulator[SEQUENTIAL] << " adding " << flowNode[*itBegin].return_weighted_numInstructions();
                #endif
 
                transactionAccumulator[SEQUENTIAL] = transactionAccumulator[SEQUENTIAL] + flowNode[*itBegin].return_weighted_numInstructions();
 
                #if defined(DEBUG)
-               std::cout << " New Map Size (" << flowNode[*itBegin].return_transID() << ") is " << transactionAccumulator[SEQUENTIAL] << std::endl;
+               log << " New Map Size (" << flowNode[*itBegin].return_transID() << ") is " << transactionAccumulator[SEQUENTIAL] << std::endl;
                #endif
 
                if(flowNode[*itBegin].return_weighted_numInstructions() >= ACC_MAX)
@@ -1662,18 +1677,91 @@ void walkPCFG(THREAD_ID threadID, Synthetic *syntheticThreads[], const UINT_32 &
    }
    else
    {
-      std::cout << "Empty...";
+      log << "Empty...";
    }
 
-   std::cout << "Total Instructions:  " << totalInstructions << "...";
+   log << "Total Instructions:  " << totalInstructions << "...";
 
    if(threadID == totalNumThreads - 1)
-      std::cout << "Finished" << std::flush;
+      log << "Finished" << std::flush;
 
    syntheticThreads[threadID] = tempSynth;
-   delete statConf;
 }//---------------------------------------------------------------------	// End walkPCFG //
 
+struct WalkPCFGJob
+{
+   Synthetic                     **syntheticThreads;
+   UINT_32                       arraySize;
+   std::vector< ostringstream * > *logs;
+};
+
+static void walkPCFGWork(UINT_32 threadID, void *arg)
+{
+   WalkPCFGJob *job = static_cast<WalkPCFGJob *>(arg);
+
+   walkPCFG(threadID, job->syntheticThreads, job->arraySize, *(*job->logs)[threadID]);
+}
+
+/**
+ * @name walkPCFGs 
+ * 
+ * @short Walks the PCFG for every thread, in parallel.
+ * @param syntheticThreads[] 
+ * @param arraySize 
+ * @return 
+ * @note Each thread draws from its own generator, seeded with stat_randomSeed + threadID
+ *       (time based if stat_randomSeed is not set), so the synthetic does not depend on
+ *       the number of workers.
+**/
+void walkPCFGs(Synthetic *syntheticThreads[], const UINT_32 &arraySize)
+{
+   ConfObject *statConf = getStatConf();
+   UINT_32 seed = statConf->return_randomSeed();
+   if(seed == 0)
+      seed = static_cast<unsigned> (std::time(0));
+
+   walkGenerator.resize(totalNumThreads, 0);
+   vertexTable.resize(totalNumThreads);
+   for(UINT_32 threadID = 0; threadID < totalNumThreads; threadID++)
+   {
+      delete walkGenerator[threadID];
+      walkGenerator[threadID] = new boost::lagged_fibonacci1279(seed + threadID);
+
+      //walks jump to a target vertex through its index instead of searching the vertex list
+      graph_traits <BBGraph>::vertex_iterator vertexIterator, vertexEnd;
+      nodeIndex_name_map_t nodeIndex = get(vertex_index, *myCFG[threadID]);
+
+      vertexTable[threadID].clear();
+      UINT_32 c = 0;
+      for(tie(vertexIterator, vertexEnd) = vertices(*myCFG[threadID]); vertexIterator != vertexEnd; ++vertexIterator, ++c)
+      {
+         nodeIndex[*vertexIterator] = c;
+         vertexTable[threadID].push_back(vertexIterator);
+      }
+   }
+
+   std::vector< ostringstream * > logs(totalNumThreads);
+   for(UINT_32 threadID = 0; threadID < totalNumThreads; threadID++)
+      logs[threadID] = new ostringstream;
+
+   WalkPCFGJob job;
+   job.syntheticThreads = syntheticThreads;
+   job.arraySize        = arraySize;
+   job.logs             = &logs;
+
+   parallelFor(totalNumThreads, walkPCFGWork, &job);
+
+   for(UINT_32 threadID = 0; threadID < totalNumThreads; threadID++)
+   {
+      std::cout << logs[threadID]->str() << std::flush;
+      delete logs[threadID];
+
+      delete walkGenerator[threadID];
+      walkGenerator[threadID] = 0;
+   }
+}//---------------------------------------------------------------------	// End walkPCFGs //
+
+
 
 /**
  * @name   addPCFGNode
@@ -1688,7 +1776,7 @@ FlowVertex addPCFGNode(const FlowNode &flowNodeIn)
    BOOL found;
    BOOL inserted;
    BOOL unique;
-   ConfObject *statConf = new ConfObject;
+   ConfObject *statConf = getStatConf();
    THREAD_ID threadID = flowNodeIn.return_threadID();
 
    graph_traits <PCFG>::edge_descriptor edgeDesc;
@@ -1714,8 +1802,6 @@ FlowVertex addPCFGNode(const FlowNode &flowNodeIn)
 
    lastInsertedNode[threadID] = myPCFG_VertexA;       //set up for next iteration -- need per-thread
 
-   delete statConf;
-
    return myPCFG_VertexA;
 }
 
@@ -1733,7 +1819,7 @@ void finalizePCFG()
    BOOL found;
    BOOL inserted;
    BOOL unique;
-   ConfObject *statConf = new ConfObject;
+   ConfObject *statConf = getStatConf();
 
    graph_traits <PCFG>::edge_descriptor edgeDesc;
    flowNode_name_map_t flowNode = get(flowNode_t(), myPCFG);
@@ -1795,8 +1881,6 @@ std::cerr << "---------->   parentThreadID:  " << parentThreadID << "(" << threa
 //       lastInsertedNode[threadID] = myPCFG_VertexA;       //set up for next iteration -- need per-thread
    }
 
-   delete statConf;
-
 }
 //END PCFG--------------------------------------------------------------------------------------------------
 
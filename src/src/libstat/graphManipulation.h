@@ -17,6 +17,8 @@
 #define GRAPH_MANIPULATION_H
 
 #include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
 
 #include <boost/config.hpp>
 #include <boost/random.hpp>
@@ -35,6 +37,7 @@
 #include "stat-boost-types.h"
 #include "statPaths.h"
 #include "memoryOperations.h"
+#include "CompactSFG.h"
 
 //set the maximum number of instructions in each thread
 #define MAX_INSTRUCTIONS 5000
@@ -131,8 +134,10 @@ namespace GraphManipulation
 void        generateSFGNodeIDs(void);
 void        writeSFGDots(string name);
 void        updateGraph(BasicBlock *basicBlockIn, THREAD_ID threadID);
+void        buildSFGs(void);
 UINT_32     getBasicBlockSize(THREAD_ID threadID, UINT_32 totalInstructions);
 void        reduceSFG(void);
+void        reduceSFG(THREAD_ID threadID);
 void        walkSFG(THREAD_ID threadID, Synthetic *syntheticThreads[], UINT_32 arraySize);
 float       walkSFG(THREAD_ID threadID, Synthetic *tempSynth, float numInstructions);
 float       walkSFG(THREAD_ID threadID, ADDRESS_INT startPC, Synthetic *tempSynth, float numInstructions);
@@ -144,7 +149,8 @@ void        identifyDuplicateThreads(void);
 void        generatePCFGNodeIDs(void);
 void        writePCFGDots(string name);
 void        reducePCFG(const std::vector < UINT_64 > &numInstructions);
-void        walkPCFG(THREAD_ID threadID, Synthetic *syntheticThreads[], const UINT_32 &arraySize);
+void        walkPCFG(THREAD_ID threadID, Synthetic *syntheticThreads[], const UINT_32 &arraySize, std::ostream &log);
+void        walkPCFGs(Synthetic *syntheticThreads[], const UINT_32 &arraySize);
 
 FlowVertex  addPCFGNode(const FlowNode &flowNodeIn);
 void        finalizePCFG(void);
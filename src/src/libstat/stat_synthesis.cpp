@@ -33,10 +33,8 @@ std::vector < ADDRESS_INT > lastReadAddress (MAX_NUM_THREADS, 0);             //
 std::vector < ADDRESS_INT > lastWriteAddress (MAX_NUM_THREADS, 0);            //the last write effective address for each thread
 
 //NOTE SFG
-std::deque  < BBGraph * > myCFG;                                  //SFG graph container, type BBGraph
-std::vector < BBVertex >  myCFG_VertexA;                          //used to ID the vertices
-std::vector < BBVertex >  myCFG_VertexB;                          //used to ID the vertices
-std::vector < BBVertexMap > vertexMap;                            //map container, type BBVertexMap
+std::deque  < BBGraph * > myCFG;                                  //SFG graph container, type BBGraph (built at the end)
+std::vector < CompactSFG * > compactSFG;                          //SFG while the simulation runs
 
 //NOTE PCFG
 PCFG myPCFG;                                                      //PCFG graph container, type PCFG
@@ -116,6 +114,7 @@ void init(void)
    for(UINT_32 counter = 0; counter < startingGraphs; counter++)
    {
       myCFG.push_back(new BBGraph());
+      compactSFG.push_back(new CompactSFG());
    }
 
    baseOffset = (STREAM_SIZE * MEM_MULTIPLIER) >> 1;
@@ -131,6 +130,8 @@ void cleanup(void)
    std::cout << "\nCleaning" << flush;
    for(UINT_32 counter = 0; counter < myCFG.size(); counter++)
       delete myCFG[counter];
+   for(UINT_32 counter = 0; counter < compactSFG.size(); counter++)
+      delete compactSFG[counter];
 
    std::cout << "...Finished" << flush;
 }
@@ -786,6 +787,7 @@ void finished(void)
    {
       analysisCleanup(0);
       GraphManipulation::finalizePCFG();
+      GraphManipulation::buildSFGs();
 
       Synthetic *syntheticThreads[totalNumThreads];
 
@@ -838,10 +840,7 @@ void finished(void)
 //       StatMemory::buildGlobalMemoryMap(tmReport->return_globalReadSet(), tmReport->return_globalReadSet());
 //       StatMemory::buildGlobalMemoryMap();
 
-      for(UINT_8 threadID = 0; threadID < totalNumThreads; threadID++)
-      {
-         GraphManipulation::walkPCFG(threadID, syntheticThreads, totalNumThreads);
-      }
+      GraphManipulation::walkPCFGs(syntheticThreads, totalNumThreads);
 
       //Analyze current spine
       CodeGenerator::anaylzeSynthetic(syntheticThreads, totalNumThreads);
@@ -1137,100 +1136,28 @@ void checkContainerSizes(THREAD_ID threadID)
          #endif
       }
    }
-   if(threadID >= myCFG_VertexA.size())
-   {
-      BBVertex temp_1;
-      if(threadID == myCFG_VertexA.size())
-      {
-         #ifdef DEBUG
-         std::cerr << "Synthesis::myCFG_VertexA.push_back with " << threadID;
-         #endif
-         myCFG_VertexA.push_back(temp_1);
-         #ifdef DEBUG
-         std::cerr << " and new size of " << myCFG_VertexA.size() << "*" << std::endl;
-         #endif
-      }
-      else
-      {
-         #ifdef DEBUG
-         std::cerr << "Synthesis::myCFG_VertexA.resize with " << threadID;
-         #endif
-         myCFG_VertexA.resize(threadID + 1, temp_1);
-         #ifdef DEBUG
-         std::cerr << " and new size of " << myCFG_VertexA.size() << std::endl;
-         #endif
-      }
-   }
-   if(threadID >= myCFG_VertexB.size())
-   {
-      BBVertex temp_1;
-      if(threadID == myCFG_VertexB.size())
-      {
-         #ifdef DEBUG
-         std::cerr << "Synthesis::myCFG_VertexB.push_back with " << threadID;
-         #endif
-         myCFG_VertexB.push_back(temp_1);
-         #ifdef DEBUG
-         std::cerr << " and new size of " << myCFG_VertexB.size() << "*" << std::endl;
-         #endif
-      }
-      else
-      {
-         #ifdef DEBUG
-         std::cerr << "Synthesis::myCFG_VertexB.resize with " << threadID;
-         #endif
-         myCFG_VertexB.resize(threadID + 1, temp_1);
-         #ifdef DEBUG
-         std::cerr << " and new size of " << myCFG_VertexB.size() << std::endl;
-         #endif
-      }
-   }
-   if(threadID >= vertexMap.size())
-   {
-      BBVertexMap temp_1;
-      if(threadID == vertexMap.size())
-      {
-         #ifdef DEBUG
-         std::cerr << "Synthesis::vertexMap.push_back with " << threadID;
-         #endif
-         vertexMap.push_back(temp_1);
-         #ifdef DEBUG
-         std::cerr << " and new size of " << vertexMap.size() << "*" << std::endl;
-         #endif
-      }
-      else
-      {
-         #ifdef DEBUG
-         std::cerr << "Synthesis::vertexMap.resize with " << threadID;
-         #endif
-         vertexMap.resize(threadID + 1, temp_1);
-         #ifdef DEBUG
-         std::cerr << " and new size of " << vertexMap.size() << std::endl;
-         #endif
-      }
-   }
    if(threadID >= myCFG.size())
    {
-      if(threadID == myCFG.size())
-      {
-         #ifdef DEBUG
-         std::cerr << "Synthesis::myCFG.push_back with " << threadID;
-         #endif
+      #ifdef DEBUG
+      std::cerr << "Synthesis::myCFG.resize with " << threadID;
+      #endif
+      //one graph per new thread (the graphs are deleted one by one)
+      while(myCFG.size() <= threadID)
          myCFG.push_back(new BBGraph());
-         #ifdef DEBUG
-         std::cerr << " and new size of " << myCFG.size() << "*" << std::endl;
-         #endif
-      }
-      else
-      {
-         #ifdef DEBUG
-         std::cerr << "Synthesis::myCFG.resize with " << threadID;
-         #endif
-         myCFG.resize(threadID + 1, new BBGraph());
-         #ifdef DEBUG
-         std::cerr << " and new size of " << myCFG.size() << std::endl;
-         #endif
-      }
+      #ifdef DEBUG
+      std::cerr << " and new size of " << myCFG.size() << std::endl;
+      #endif
+   }
+   if(threadID >= compactSFG.size())
+   {
+      #ifdef DEBUG
+      std::cerr << "Synthesis::compactSFG.resize with " << threadID;
+      #endif
+      while(compactSFG.size() <= threadID)
+         compactSFG.push_back(new CompactSFG());
+      #ifdef DEBUG
+      std::cerr << " and new size of " << compactSFG.size() << std::endl;
+      #endif
    }
    if(threadID >= Synthesis::wasSpawn.size())
    {
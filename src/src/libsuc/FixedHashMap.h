@@ -0,0 +1,157 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2003 University of Illinois.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef FIXEDHASHMAP_H
+#define FIXEDHASHMAP_H
+
+#include <stdlib.h>
+
+#include "nanassert.h"
+
+// Open addressed (linear probing) map for integer keys. The table is
+// allocated once for the expected number of entries (it is at most
+// half full), so insert and erase do not allocate. Erase shifts the
+// following entries back instead of leaving tombstones.
+//
+// If more entries than expected are inserted the table doubles, so
+// the capacity is a performance hint, not a limit.
+template<class Key, class Data>
+class FixedHashMap {
+private:
+  struct Entry {
+    Key  key;
+    Data data;
+    bool used;
+  };
+
+  Entry *table;
+  size_t mask;
+  size_t nUsed;
+
+  size_t home(Key key) const {
+    unsigned long h = (unsigned long)key * 0x9E3779B1UL;
+    return (size_t)(h ^ (h >> 16)) & mask;
+  }
+
+  size_t findSlot(Key key) const {
+    size_t i = home(key);
+    while(table[i].used && table[i].key != key)
+      i = (i + 1) & mask;
+    return i;
+  }
+
+  void allocTable(size_t size) {
+    table = (Entry *)calloc(size, sizeof(Entry));
+    mask  = size - 1;
+    nUsed = 0;
+  }
+
+  void grow() {
+    Entry *old  = table;
+    size_t size = mask + 1;
+
+    allocTable(2 * size);
+    for(size_t i=0;i<size;i++) {
+      if (old[i].used)
+        insert(old[i].key) = old[i].data;
+    }
+    free(old);
+  }
+
+public:
+  FixedHashMap(size_t capacity = 32) {
+    size_t size = 2;
+    while(size < 2 * capacity)
+      size <<= 1;
+    allocTable(size);
+  }
+
+  ~FixedHashMap() {
+    free(table);
+  }
+
+  // Makes room for capacity entries (the contents are kept)
+  void reserve(size_t capacity) {
+    while(mask + 1 < 2 * capacity)
+      grow();
+  }
+
+  size_t size() const { return nUsed; }
+
+  Data *find(Key key) {
+    size_t i = findSlot(key);
+    return table[i].used ? &table[i].data : 0;
+  }
+
+  // Returns the entry for key, a new one (zeroed) if it was not there
+  Data &insert(Key key) {
+    size_t i = findSlot(key);
+    if (table[i].used)
+      return table[i].data;
+
+    if (2 * (nUsed + 1) > mask + 1) {
+      grow();
+      i = findSlot(key);
+    }
+
+    table[i].key  = key;
+    table[i].used = true;
+    nUsed++;
+    return table[i].data;
+  }
+
+  void erase(Key key) {
+    size_t i = findSlot(key);
+    if (!table[i].used)
+      return;
+
+    I(nUsed);
+    nUsed--;
+
+    // Move back the entries of the cluster that cannot be reached
+    // from their home slot once i is empty
+    size_t j = i;
+    while(true) {
+      j = (j + 1) & mask;
+      if (!table[j].used)
+        break;
+
+      size_t h = home(table[j].key);
+      bool stays = i <= j ? (i < h && h <= j) : (i < h || h <= j);
+      if (stays)
+        continue;
+
+      table[i] = table[j];
+      i = j;
+    }
+
+    table[i].used = false;
+    table[i].data = Data();
+  }
+
+  // Iteration (slow, for dumps): slots 0..getSlots()-1
+  size_t getSlots() const { return mask + 1; }
+  bool isUsed(size_t i) const { return table[i].used; }
+  Key getKey(size_t i) const { return table[i].key; }
+  const Data &getData(size_t i) const { return table[i].data; }
+};
+
+#endif // FIXEDHASHMAP_H
@@ -56,6 +56,7 @@ GStatsCntr::GStatsCntr(const char *format,...)
   va_end(ap);
 
   data = 0;
+  epochData = 0;
 
   name = str;
   subscribe();
@@ -71,6 +72,19 @@ void GStatsCntr::reportValue() const
   Report::field("%s=%lld", name, data);
 }
 
+void GStatsCntr::snapshot()
+{
+  epochData = data;
+}
+
+void GStatsCntr::reportEpochValue(const char *epoch) const
+{
+  if (data == epochData)
+    return;
+
+  Report::field("Epoch(%s)_%s=%lld", epoch, name, data - epochData);
+}
+
 
 /*********************** GStatsAvg */
 
@@ -85,6 +99,8 @@ GStatsAvg::GStatsAvg(const char *format,...)
 
   data = 0;
   nData = 0;
+  epochData = 0;
+  epochNData = 0;
 
   name = str;
   subscribe();
@@ -105,6 +121,21 @@ void GStatsAvg::reportValue() const
   Report::field("%s:v=%g:n=%lld", name, getDouble(), nData);
 }
 
+void GStatsAvg::snapshot()
+{
+  epochData  = data;
+  epochNData = nData;
+}
+
+void GStatsAvg::reportEpochValue(const char *epoch) const
+{
+  long long n = nData - epochNData;
+  if (n == 0)
+    return;
+
+  Report::field("Epoch(%s)_%s:v=%g:n=%lld", epoch, name, (double)(data - epochData) / n, n);
+}
+
 
 /*********************** GStatsPDF */
 
@@ -254,6 +285,29 @@ void GStats::report(const char *str)
   Report::field("END GStats::report %s", str);
 }
 
+void GStats::snapshotEpoch()
+{
+  if (store == 0)
+    return;
+
+  for(ContainerIter i = store->begin(); i != store->end(); i++) {
+    (*i)->prepareReport();
+    (*i)->snapshot();
+  }
+}
+
+// Only the stats that changed during the epoch are reported
+void GStats::reportEpoch(const char *epoch)
+{
+  if (store == 0)
+    return;
+
+  for(ContainerIter i = store->begin(); i != store->end(); i++) {
+    (*i)->prepareReport();
+    (*i)->reportEpochValue(epoch);
+  }
+}
+
 
 GStats *GStats::getRef(const char *str)
 {
@@ -61,6 +61,12 @@ protected:
   void unsubscribe();
 
   virtual void prepareReport() {}
+
+  // Statistics epochs: snapshot() keeps the value at the beginning of
+  // the epoch and reportEpochValue() prints the difference. Stats that
+  // do not implement them are left out of the epoch reports.
+  virtual void snapshot() {}
+  virtual void reportEpochValue(const char *epoch) const {}
   
 public:
   int gd;
@@ -68,6 +74,9 @@ public:
   static void report(const char *str);
   static GStats *getRef(const char *str);
 
+  static void snapshotEpoch();
+  static void reportEpoch(const char *epoch);
+
   GStats() {
   }
   virtual ~GStats();
@@ -88,7 +97,10 @@ public:
 class GStatsCntr : public GStats {
 private:
   long long data;
+  long long epochData;
 protected:
+  void snapshot();
+  void reportEpochValue(const char *epoch) const;
 public:
   GStatsCntr(const char *format,...);
 
@@ -126,9 +138,14 @@ private:
 protected:
   long long data;
   long long nData;
+  long long epochData;
+  long long epochNData;
+
+  void snapshot();
+  void reportEpochValue(const char *epoch) const;
 public:
   GStatsAvg(const char *format,...);
-  GStatsAvg() { }
+  GStatsAvg() : epochData(0), epochNData(0) { }
 
   virtual void sample(const int v) {
     data += v;
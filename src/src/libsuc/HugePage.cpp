@@ -0,0 +1,309 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2003 University of Illinois.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#include "HugePage.h"
+#include "ReportGen.h"
+
+HugePage::Region HugePage::regions[HugePage::MaxRegions];
+int              HugePage::nRegions = 0;
+size_t           HugePage::hugeSize = 0;
+int              HugePage::enabled  = -1;
+
+void  *HugeArena::freeList[HugeArena::MaxSize/8];
+char  *HugeArena::cur  = 0;
+size_t HugeArena::left = 0;
+
+static const char *kindName[] = { "hugetlb", "thp", "small" };
+
+size_t HugePage::getSize()
+{
+  if (hugeSize)
+    return hugeSize;
+
+  hugeSize = 2*1024*1024;
+
+  FILE *fp = fopen("/proc/meminfo", "r");
+  if (fp) {
+    char line[128];
+    unsigned long kb;
+    while (fgets(line, sizeof(line), fp)) {
+      if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1) {
+        hugeSize = kb * 1024;
+        break;
+      }
+    }
+    fclose(fp);
+  }
+
+  return hugeSize;
+}
+
+// Maps len bytes aligned to align (a multiple of the huge page size).
+// MAP_HUGETLB mappings are already aligned to the huge page size,
+// regular ones need it for the kernel to back them with huge pages.
+void *HugePage::mapAligned(size_t len, size_t align, bool huge, void **base, size_t *mlen)
+{
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  size_t extra = 0;
+
+#ifdef MAP_HUGETLB
+  if (huge)
+    flags |= MAP_HUGETLB;
+#endif
+  if (align > getSize() || !huge)
+    extra = align;
+
+  char *p = (char *)mmap(0, len + extra, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (p == (char *)MAP_FAILED)
+    return 0;
+
+  if (extra) {
+    // Trim the unaligned head and the tail (multiples of the huge page size)
+    char *a = (char *)(((uintptr_t)p + align - 1) & ~(uintptr_t)(align - 1));
+    if (a != p)
+      munmap(p, a - p);
+    if (a + len != p + len + extra)
+      munmap(a + len, (p + len + extra) - (a + len));
+    p = a;
+  }
+
+  *base = p;
+  *mlen = len;
+  return p;
+}
+
+void HugePage::add(const char *name, void *ptr, void *base, size_t size, size_t len, Kind kind)
+{
+  if (nRegions >= MaxRegions) {
+    fprintf(stderr, "HugePage: too many regions\n");
+    exit(-1);
+  }
+
+  Region &r = regions[nRegions++];
+  r.name = name;
+  r.ptr  = ptr;
+  r.base = base;
+  r.size = size;
+  r.len  = len;
+  r.kind = kind;
+}
+
+void *HugePage::alloc(size_t size, const char *name, size_t align)
+{
+  if (enabled < 0) {
+    const char *env = getenv("SESC_HUGEPAGES");
+    enabled = !(env && strcmp(env, "0") == 0);
+  }
+
+  size_t hsize = getSize();
+  if (align < hsize)
+    align = hsize;
+
+  size_t len = (size + hsize - 1) & ~(hsize - 1);
+  void *base;
+  size_t mlen;
+  void *p;
+
+  if (enabled) {
+#ifdef MAP_HUGETLB
+    // Fails unless the huge page pool has room for all of it
+    p = mapAligned(len, align, true, &base, &mlen);
+    if (p) {
+      add(name, p, base, size, mlen, HugeTLB);
+      return p;
+    }
+#endif
+
+    p = mapAligned(len, align, false, &base, &mlen);
+    if (p) {
+      Kind kind = Small;
+#ifdef MADV_HUGEPAGE
+      if (madvise(p, mlen, MADV_HUGEPAGE) == 0)
+        kind = Transparent;
+#endif
+      add(name, p, base, size, mlen, kind);
+      return p;
+    }
+  }
+
+  if (posix_memalign(&p, align, size) != 0)
+    return 0;
+
+  memset(p, 0, size);
+  add(name, p, 0, size, size, Small);
+  return p;
+}
+
+void HugePage::free(void *ptr)
+{
+  for(int i=0;i<nRegions;i++) {
+    if (regions[i].ptr != ptr)
+      continue;
+
+    if (regions[i].base)
+      munmap(regions[i].base, regions[i].len);
+    else
+      ::free(ptr);
+
+    regions[i] = regions[--nRegions];
+    return;
+  }
+
+  ::free(ptr);
+}
+
+// AnonHugePages of every mapping (transparent huge pages)
+void HugePage::readSmaps(std::vector<Mapping> &maps)
+{
+  FILE *fp = fopen("/proc/self/smaps", "r");
+  if (fp == 0)
+    return;
+
+  char line[256];
+  while (fgets(line, sizeof(line), fp)) {
+    unsigned long beg, end, kb;
+    char *dash  = strchr(line, '-');
+    char *space = strchr(line, ' ');
+    if (dash && space && dash < space && sscanf(line, "%lx-%lx ", &beg, &end) == 2) {
+      Mapping m;
+      m.beg    = beg;
+      m.end    = end;
+      m.backed = 0;
+      maps.push_back(m);
+    }else if (!maps.empty() && sscanf(line, "AnonHugePages: %lu kB", &kb) == 1) {
+      maps.back().backed += kb * 1024;
+    }
+  }
+  fclose(fp);
+}
+
+// Bytes of the region backed by huge pages right now
+size_t HugePage::getBacked(const Region &r, const std::vector<Mapping> &maps)
+{
+  if (r.kind == HugeTLB)
+    return r.len;
+  if (r.kind == Small)
+    return 0;
+
+  uintptr_t rBeg = (uintptr_t)r.base;
+  uintptr_t rEnd = rBeg + r.len;
+
+  size_t backed = 0;
+  for(size_t i=0;i<maps.size();i++) {
+    if (maps[i].beg < rEnd && maps[i].end > rBeg)
+      backed += maps[i].backed;
+  }
+
+  return backed > r.len ? r.len : backed;
+}
+
+// Regions with the same name (the arena chunks) are added together
+void HugePage::collect(std::vector<Summary> &sums)
+{
+  std::vector<Mapping> maps;
+  readSmaps(maps);
+
+  for(int i=0;i<nRegions;i++) {
+    size_t j;
+    for(j=0;j<sums.size();j++) {
+      if (strcmp(sums[j].name, regions[i].name) == 0)
+        break;
+    }
+    if (j == sums.size()) {
+      Summary s;
+      s.name   = regions[i].name;
+      s.kind   = regions[i].kind;
+      s.len    = 0;
+      s.backed = 0;
+      sums.push_back(s);
+    }
+    // Mixed kinds show the least huge one
+    if (regions[i].kind > sums[j].kind)
+      sums[j].kind = regions[i].kind;
+    sums[j].len    += regions[i].len;
+    sums[j].backed += getBacked(regions[i], maps);
+  }
+}
+
+void HugePage::dump(FILE *fp)
+{
+  std::vector<Summary> sums;
+  collect(sums);
+
+  size_t total  = 0;
+  size_t backed = 0;
+
+  for(size_t i=0;i<sums.size();i++) {
+    fprintf(fp, "HugePage: %-10s %8.1f MB %-7s %5.1f%% huge\n"
+            ,sums[i].name
+            ,sums[i].len / (1024.0 * 1024.0)
+            ,kindName[sums[i].kind]
+            ,sums[i].len ? 100.0 * sums[i].backed / sums[i].len : 0);
+    total  += sums[i].len;
+    backed += sums[i].backed;
+  }
+
+  if (!sums.empty())
+    fprintf(fp, "HugePage: %.1f MB, %.1f%% huge (%lu KB pages)\n"
+            ,total / (1024.0 * 1024.0)
+            ,total ? 100.0 * backed / total : 0
+            ,(unsigned long)(getSize() / 1024));
+}
+
+void HugePage::report()
+{
+  std::vector<Summary> sums;
+  collect(sums);
+
+  size_t total  = 0;
+  size_t backed = 0;
+
+  for(size_t i=0;i<sums.size();i++) {
+    Report::field("HugePage:name=%s:kind=%s:MB=%.1f:hugeMB=%.1f"
+                  ,sums[i].name
+                  ,kindName[sums[i].kind]
+                  ,sums[i].len / (1024.0 * 1024.0)
+                  ,sums[i].backed / (1024.0 * 1024.0));
+    total  += sums[i].len;
+    backed += sums[i].backed;
+  }
+
+  Report::field("HugePage:MB=%.1f:hugeMB=%.1f:pageKB=%lu"
+                ,total / (1024.0 * 1024.0)
+                ,backed / (1024.0 * 1024.0)
+                ,(unsigned long)(getSize() / 1024));
+}
+
+void HugeArena::refill()
+{
+  // The tail of the previous chunk is lost (less than MaxSize bytes)
+  cur = (char *)HugePage::alloc(ChunkSize, "nodes");
+  if (cur == 0) {
+    fprintf(stderr, "HugeArena: out of memory\n");
+    exit(-1);
+  }
+  left = ChunkSize;
+}
@@ -0,0 +1,187 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2003 University of Illinois.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef HUGEPAGE_H
+#define HUGEPAGE_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <new>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// Large, long lived host allocations (the simulated memory image, the
+// icode array, the TM conflict tables) are randomly accessed and
+// suffer lots of host TLB misses with 4KB pages. HugePage::alloc maps
+// them with explicit huge pages (MAP_HUGETLB) when the system has a
+// huge page pool, otherwise it asks for transparent huge pages
+// (madvise MADV_HUGEPAGE). The memory returned is zeroed.
+//
+// SESC_HUGEPAGES=0 in the environment disables both (plain
+// posix_memalign, as before).
+//
+/////////////////////////////////////////////////////////////////////////////
+
+class HugePage {
+public:
+  enum Kind {
+    HugeTLB = 0,   // explicit huge pages
+    Transparent,   // madvise(MADV_HUGEPAGE), backed as the kernel can
+    Small          // regular pages
+  };
+
+  // align (if not 0) must be a power of two
+  static void *alloc(size_t size, const char *name, size_t align = 0);
+  static void  free(void *ptr);
+
+  static size_t getSize();
+
+  // Coverage of each region: to a file (startup) and to the report
+  static void dump(FILE *fp);
+  static void report();
+
+private:
+  struct Region {
+    const char *name;
+    void       *ptr;
+    void       *base;   // mapping (may start before ptr)
+    size_t      size;   // requested
+    size_t      len;    // mapped
+    Kind        kind;
+  };
+
+  struct Mapping {
+    unsigned long beg;
+    unsigned long end;
+    size_t        backed;
+  };
+
+  struct Summary {
+    const char *name;
+    Kind        kind;
+    size_t      len;
+    size_t      backed;
+  };
+
+  // The HugeArena takes one per 2MB chunk
+  static const int MaxRegions = 16384;
+
+  static Region regions[MaxRegions];
+  static int    nRegions;
+  static size_t hugeSize;
+  static int    enabled;
+
+  static void  *mapAligned(size_t len, size_t align, bool huge, void **base, size_t *mlen);
+  static void   add(const char *name, void *ptr, void *base, size_t size, size_t len, Kind kind);
+  static void   readSmaps(std::vector<Mapping> &maps);
+  static size_t getBacked(const Region &r, const std::vector<Mapping> &maps);
+  static void   collect(std::vector<Summary> &sums);
+};
+
+// Small objects (STL nodes) carved from huge page chunks. One free list
+// per 8 byte size class.
+class HugeArena {
+private:
+  static const size_t ChunkSize = 2*1024*1024;
+  static const size_t MaxSize   = 256;
+
+  static void  *freeList[MaxSize/8];
+  static char  *cur;
+  static size_t left;
+
+  static void refill();
+public:
+  static void *alloc(size_t size) {
+    if (size > MaxSize)
+      return ::operator new(size);
+
+    int c = (size - 1) / 8;
+    void *p = freeList[c];
+    if (p) {
+      freeList[c] = *(void **)p;
+      return p;
+    }
+
+    size = (c + 1) * 8;
+    if (left < size)
+      refill();
+
+    p = cur;
+    cur  += size;
+    left -= size;
+    return p;
+  }
+
+  static void free(void *p, size_t size) {
+    if (size > MaxSize) {
+      ::operator delete(p);
+      return;
+    }
+
+    int c = (size - 1) / 8;
+    *(void **)p = freeList[c];
+    freeList[c] = p;
+  }
+};
+
+// STL allocator for node based containers (map, set) on the HugeArena
+template<class T>
+class HugePageAllocator {
+public:
+  typedef T         value_type;
+  typedef T        *pointer;
+  typedef const T  *const_pointer;
+  typedef T        &reference;
+  typedef const T  &const_reference;
+  typedef size_t    size_type;
+  typedef ptrdiff_t difference_type;
+
+  template<class U> struct rebind {
+    typedef HugePageAllocator<U> other;
+  };
+
+  HugePageAllocator() { }
+  template<class U> HugePageAllocator(const HugePageAllocator<U> &) { }
+
+  pointer       address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+
+  pointer allocate(size_type n, const void * = 0) {
+    return static_cast<pointer>(HugeArena::alloc(n * sizeof(T)));
+  }
+  void deallocate(pointer p, size_type n) {
+    HugeArena::free(p, n * sizeof(T));
+  }
+
+  size_type max_size() const { return ((size_t)-1) / sizeof(T); }
+
+  void construct(pointer p, const T &v) { new ((void *)p) T(v); }
+  void destroy(pointer p) { p->~T(); }
+};
+
+template<class T, class U>
+inline bool operator==(const HugePageAllocator<T> &, const HugePageAllocator<U> &) { return true; }
+
+template<class T, class U>
+inline bool operator!=(const HugePageAllocator<T> &, const HugePageAllocator<U> &) { return false; }
+
+#endif // HUGEPAGE_H
@@ -0,0 +1,124 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2003 University of Illinois.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include "SelfProf.h"
+
+#ifdef SESC_SELFPROF
+
+#include <stdlib.h>
+#include <sys/time.h>
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ReportGen.h"
+
+SelfProf::CBEntry SelfProf::cbTable[SelfProf::CBTableSize];
+SelfProf::CBEntry SelfProf::cbOverflow;
+int               SelfProf::nCBTypes = 0;
+
+SelfProf::Ticks SelfProf::phaseCalls[SelfProf::MaxPhase];
+SelfProf::Ticks SelfProf::phaseTicks[SelfProf::MaxPhase];
+SelfProf::Ticks SelfProf::nRetired = 0;
+
+static SelfProf::Ticks startTicks = SelfProf::now();
+
+static timeval getTime()
+{
+  timeval t;
+  gettimeofday(&t, 0);
+  return t;
+}
+static timeval startTime = getTime();
+
+static const char *phaseName[SelfProf::MaxPhase] = {
+  "fetch",
+  "issue",
+  "retire",
+  "transCoherence",
+  "transReport",
+  "profHooks"
+};
+
+bool SelfProf::moreTicks(const CBEntry *a, const CBEntry *b)
+{
+  return a->ticks > b->ticks;
+}
+
+void SelfProf::report()
+{
+  Ticks total = now() - startTicks;
+  if (total == 0)
+    total = 1;
+
+  timeval endTime = getTime();
+  double secs = (endTime.tv_sec - startTime.tv_sec)
+    + (endTime.tv_usec - startTime.tv_usec) / 1e6;
+
+  Report::field("SelfProf:cycles=%llu:secs=%.2f:nInst=%llu:KIPS=%.2f:cyclesPerInst=%.2f"
+                ,total
+                ,secs
+                ,nRetired
+                ,secs > 0 ? (nRetired / secs) / 1000 : 0
+                ,nRetired ? (double)total / nRetired : 0);
+
+  for(int i=0;i<MaxPhase;i++) {
+    Report::field("SelfProf:phase=%s:calls=%llu:cycles=%llu:pct=%.2f:cyclesPerInst=%.2f"
+                  ,phaseName[i]
+                  ,phaseCalls[i]
+                  ,phaseTicks[i]
+                  ,100.0 * phaseTicks[i] / total
+                  ,nRetired ? (double)phaseTicks[i] / nRetired : 0);
+  }
+
+  std::vector<const CBEntry *> cbs;
+  for(int i=0;i<CBTableSize;i++) {
+    if (cbTable[i].type)
+      cbs.push_back(&cbTable[i]);
+  }
+  std::sort(cbs.begin(), cbs.end(), moreTicks);
+
+  for(size_t i=0;i<cbs.size();i++) {
+    const char *mangled = cbs[i]->type->name();
+    int status;
+    char *name = abi::__cxa_demangle(mangled, 0, 0, &status);
+
+    // The name goes last, it has ':' and ',' in it
+    Report::field("SelfProf:cb:calls=%llu:cycles=%llu:pct=%.2f:cyclesPerCall=%.1f:name=%s"
+                  ,cbs[i]->calls
+                  ,cbs[i]->ticks
+                  ,100.0 * cbs[i]->ticks / total
+                  ,(double)cbs[i]->ticks / cbs[i]->calls
+                  ,status == 0 ? name : mangled);
+
+    free(name);
+  }
+
+  if (cbOverflow.calls) {
+    Report::field("SelfProf:cb:calls=%llu:cycles=%llu:pct=%.2f:name=other"
+                  ,cbOverflow.calls
+                  ,cbOverflow.ticks
+                  ,100.0 * cbOverflow.ticks / total);
+  }
+}
+
+#endif // SESC_SELFPROF
@@ -0,0 +1,150 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2003 University of Illinois.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef SELFPROF_H
+#define SELFPROF_H
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// Simulator self-profiling (configure --enable-selfprof). Host cycles
+// (rdtsc) and call counts are attributed to each callback type
+// dispatched by EventScheduler::advanceClock and to the pipeline/TM
+// phases below. The totals are dumped with the rest of the report (and
+// so also on SIGUSR1).
+//
+// Phases are inclusive: Retire includes TransReport and ProfHooks, and
+// TransCoherence is also counted inside whatever phase or callback
+// called it.
+//
+// Without SESC_SELFPROF all the SELFPROF_* macros are empty.
+//
+/////////////////////////////////////////////////////////////////////////////
+
+#ifdef SESC_SELFPROF
+
+#include <typeinfo>
+#include <time.h>
+
+class SelfProf {
+public:
+  typedef unsigned long long Ticks;
+
+  enum Phase {
+    Fetch = 0,
+    Issue,
+    Retire,
+    TransCoherence,
+    TransReport,
+    ProfHooks,
+    MaxPhase
+  };
+
+  static Ticks now() {
+#if defined(__i386__) || defined(__x86_64__)
+    unsigned int lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+    return (((Ticks)hi) << 32) | lo;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((Ticks)ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+  }
+
+  static void phase(Phase p, Ticks t) {
+    phaseCalls[p]++;
+    phaseTicks[p] += t;
+  }
+
+  static void callback(const std::type_info *type, Ticks t) {
+    CBEntry *e = findCB(type);
+    e->calls++;
+    e->ticks += t;
+  }
+
+  static void retired(int n) {
+    nRetired += n;
+  }
+
+  static void report();
+
+private:
+  struct CBEntry {
+    const std::type_info *type;
+    Ticks calls;
+    Ticks ticks;
+  };
+
+  // Open addressed by the type_info address. There are a few hundred
+  // callback instances in the whole simulator.
+  static const int CBTableSize = 1024;
+
+  static CBEntry cbTable[CBTableSize];
+  static CBEntry cbOverflow;
+  static int     nCBTypes;
+
+  static Ticks phaseCalls[MaxPhase];
+  static Ticks phaseTicks[MaxPhase];
+  static Ticks nRetired;
+
+  static bool moreTicks(const CBEntry *a, const CBEntry *b);
+
+  static CBEntry *findCB(const std::type_info *type) {
+    unsigned int h = (((unsigned long)type) >> 4) & (CBTableSize - 1);
+    while (cbTable[h].type != type) {
+      if (cbTable[h].type == 0) {
+        if (nCBTypes >= CBTableSize / 2)
+          return &cbOverflow;
+        nCBTypes++;
+        cbTable[h].type = type;
+        break;
+      }
+      h = (h + 1) & (CBTableSize - 1);
+    }
+    return &cbTable[h];
+  }
+};
+
+class SelfProfScope {
+private:
+  const SelfProf::Phase p;
+  const SelfProf::Ticks start;
+public:
+  SelfProfScope(SelfProf::Phase phase) : p(phase), start(SelfProf::now()) { }
+  ~SelfProfScope() {
+    SelfProf::phase(p, SelfProf::now() - start);
+  }
+};
+
+// Accounts the rest of the enclosing scope to the phase
+#define SELFPROF_PHASE(p)     SelfProfScope selfProfScope(SelfProf::p)
+#define SELFPROF_RETIRED(n)   SelfProf::retired(n)
+#define SELFPROF_REPORT()     SelfProf::report()
+
+#else // !SESC_SELFPROF
+
+#define SELFPROF_PHASE(p)
+#define SELFPROF_RETIRED(n)
+#define SELFPROF_REPORT()
+
+#endif // SESC_SELFPROF
+
+#endif // SELFPROF_H
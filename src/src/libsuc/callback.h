@@ -34,6 +34,7 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "TQueue.h"
 
 #include "Snippets.h"
+#include "SelfProf.h"
 
 #if defined(__sgi) && !defined(__GNUC__) 
 #pragma set woff 1681
@@ -115,7 +116,15 @@ public:
     EventScheduler *cb;
 
     while ((cb = cbQ.nextJob(globalClock)) ) {
+#ifdef SESC_SELFPROF
+      // call() may destroy the callback
+      const std::type_info *type = &typeid(*cb);
+      SelfProf::Ticks start = SelfProf::now();
       cb->call();
+      SelfProf::callback(type, SelfProf::now() - start);
+#else
+      cb->call();
+#endif
     }
     globalClock++;
   }
@@ -0,0 +1,385 @@
+/**
+ * @file
+ * @brief   This is the implementation for the per-thread execution time breakdown.
+ *
+ * @section LICENSE
+ * Copyright: See COPYING file that comes with this distribution
+ *
+ * @section DESCRIPTION
+ * C++ Implementation: transBreakdown
+ */
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "transBreakdown.h"
+#include "SescConf.h"
+
+transBreakdown *transBD = 0;
+
+static const char *stateName[TT_STATES] = { "NonTrans", "Useful", "Wasted", "Nack", "Backoff", "Stall", "Sync" };
+
+/**
+ * @ingroup transBreakdown
+ * @brief   Constructor
+ */
+transBreakdown::transBreakdown()
+{
+  enabled = 0;
+  if(SescConf->checkInt("TransactionalMemory","timeBreakdown"))
+    enabled = SescConf->getInt("TransactionalMemory","timeBreakdown");
+
+  nProcs = tmProcCount();
+  proc = tmAllocProcState<tmTimeProc>(nProcs);
+
+  for(int i = 0; i < nProcs; i++)
+  {
+    memset(&proc[i], 0, sizeof(tmTimeProc));
+    proc[i].state = TT_NONTRANS;
+    proc[i].resume = TT_NONTRANS;
+  }
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   Adds the cycles since the last event to the current state
+ *
+ * The cycles of a running transaction are held until it commits or aborts. A barrier
+ * wait ends at the last arrival of its round, the rest is non-transactional work.
+ * Nothing is charged outside of the thread lifetime (spawn to exit).
+ */
+void transBreakdown::charge(int pid)
+{
+  tmTimeProc &p = proc[pid];
+  Time_t now = globalClock;
+
+  if(!p.live)
+  {
+    p.since = now;
+    return;
+  }
+
+  if(p.state == TT_USEFUL)
+    p.pending += now - p.since;
+  else if(p.state == TT_SYNC && p.barrier)
+  {
+    tmBarrierEpisode &b = barriers[p.barrier];
+    Time_t end = p.since;
+    if(p.episode == b.episode)
+      end = b.last;
+    else if(p.episode + 1 == b.episode)
+      end = b.prevLast;
+
+    if(end < p.since)
+      end = p.since;
+    if(end > now)
+      end = now;
+
+    p.cycles[TT_SYNC] += end - p.since;
+    p.cycles[TT_NONTRANS] += now - end;
+    p.barrier = 0;
+    p.state = TT_NONTRANS;
+  }
+  else
+    p.cycles[p.state] += now - p.since;
+
+  p.since = now;
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   Closes the current interval and starts one in state
+ */
+void transBreakdown::enter(int pid, tmTimeState state)
+{
+  charge(pid);
+  proc[pid].state = state;
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   Thread pid is spawned, its interval starts (a reused pid adds to the old one)
+ */
+void transBreakdown::spawn(int pid)
+{
+  if(!isEnabled())
+    return;
+
+  tmTimeProc &p = proc[pid];
+  p.state = TT_NONTRANS;
+  p.resume = TT_NONTRANS;
+  p.barrier = 0;
+  p.pending = 0;
+  p.since = globalClock;
+  p.live = 1;
+  p.spawned = 1;
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   Thread pid exits, its interval ends. A transaction still running never committed.
+ */
+void transBreakdown::exit(int pid)
+{
+  if(!isEnabled())
+    return;
+
+  charge(pid);
+  proc[pid].cycles[TT_WASTED] += proc[pid].pending;
+  proc[pid].pending = 0;
+  proc[pid].live = 0;
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   An outermost transaction begins (or is replayed)
+ */
+void transBreakdown::begin(int pid)
+{
+  if(!isEnabled())
+    return;
+
+  enter(pid, TT_USEFUL);
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   pid stalls on a NACK
+ */
+void transBreakdown::nackBegin(int pid)
+{
+  if(!isEnabled() || proc[pid].state == TT_NACK)
+    return;
+
+  proc[pid].resume = proc[pid].state;
+  enter(pid, TT_NACK);
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   The NACK of pid finished, back to what it was doing
+ */
+void transBreakdown::nackFinish(int pid)
+{
+  if(!isEnabled() || proc[pid].state != TT_NACK)
+    return;
+
+  enter(pid, proc[pid].resume);
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   The transaction of pid stalls to commit
+ */
+void transBreakdown::commitStall(int pid)
+{
+  if(!isEnabled())
+    return;
+
+  enter(pid, TT_STALL);
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   The transaction of pid committed, its cycles were useful
+ */
+void transBreakdown::commit(int pid)
+{
+  if(!isEnabled())
+    return;
+
+  enter(pid, TT_NONTRANS);
+  proc[pid].cycles[TT_USEFUL] += proc[pid].pending;
+  proc[pid].pending = 0;
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   The transaction of pid aborted, its cycles were wasted. The abort stall follows.
+ */
+void transBreakdown::abort(int pid)
+{
+  if(!isEnabled())
+    return;
+
+  enter(pid, TT_STALL);
+  proc[pid].cycles[TT_WASTED] += proc[pid].pending;
+  proc[pid].pending = 0;
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   Cycles of the running transaction of pid so far (a nested level begins)
+ */
+Time_t transBreakdown::pendingCycles(int pid)
+{
+  if(!isEnabled())
+    return 0;
+
+  charge(pid);
+  return proc[pid].pending;
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   A closed nested level of pid aborted, the transactional cycles since it
+ *          began were wasted. The outermost transaction keeps running.
+ *
+ * @param pending pendingCycles() when the level began
+ */
+void transBreakdown::partialAbort(int pid, Time_t pending)
+{
+  if(!isEnabled())
+    return;
+
+  charge(pid);
+  if(proc[pid].pending <= pending)
+    return;
+
+  proc[pid].cycles[TT_WASTED] += proc[pid].pending - pending;
+  proc[pid].pending = pending;
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   pid backs off before it begins again
+ */
+void transBreakdown::backoff(int pid)
+{
+  if(!isEnabled())
+    return;
+
+  enter(pid, TT_BACKOFF);
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   pid found the lock taken and spins (outside of transactions only)
+ */
+void transBreakdown::lockWait(int pid)
+{
+  if(!isEnabled())
+    return;
+
+  charge(pid);
+  if(proc[pid].state != TT_NONTRANS)
+    return;
+
+  proc[pid].resume = TT_NONTRANS;
+  enter(pid, TT_SYNC);
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   pid got the lock it was spinning on
+ */
+void transBreakdown::lockAcquire(int pid)
+{
+  if(!isEnabled() || proc[pid].state != TT_SYNC || proc[pid].barrier)
+    return;
+
+  enter(pid, proc[pid].resume);
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   pid arrives at a barrier
+ *
+ * @param addr  Barrier counter
+ * @param count Counter value before the increment (0 starts a new round)
+ *
+ * The spin on the barrier flag is not seen, the wait is closed on the next event
+ * of the thread, when the last arrival of the round is known.
+ */
+void transBreakdown::barrierArrive(int pid, RAddr addr, int count)
+{
+  if(!isEnabled())
+    return;
+
+  charge(pid);
+  if(proc[pid].state != TT_NONTRANS)
+    return;
+
+  map<RAddr, tmBarrierEpisode>::iterator it = barriers.find(addr);
+  if(it == barriers.end())
+  {
+    tmBarrierEpisode b;
+    b.episode = 0;
+    b.last = globalClock;
+    b.prevLast = globalClock;
+    it = barriers.insert(make_pair(addr, b)).first;
+  }
+  else if(count == 0)
+  {
+    it->second.episode++;
+    it->second.prevLast = it->second.last;
+  }
+  it->second.last = globalClock;
+
+  enter(pid, TT_SYNC);
+  proc[pid].barrier = addr;
+  proc[pid].episode = it->second.episode;
+}
+
+/**
+ * @ingroup transBreakdown
+ * @brief   Prints the breakdown per thread (tableB) and for all of them (tableBT, tableBP)
+ *
+ * Every spawned thread is reported, from its spawn to its exit (or the end). A
+ * transaction still running at the end never committed, its cycles are wasted.
+ *
+ * @param out Report file
+ */
+void transBreakdown::report(FILE *out)
+{
+  if(!isEnabled() || out == NULL)
+    return;
+
+  Time_t total[TT_STATES];
+  memset(total, 0, sizeof(total));
+
+  fprintf(out, "#tableB,Pid");
+  for(int s = 0; s < TT_STATES; s++)
+    fprintf(out, ",%s", stateName[s]);
+  fprintf(out, "\n");
+
+  for(int i = 0; i < nProcs; i++)
+  {
+    tmTimeProc &p = proc[i];
+    if(!p.spawned)
+      continue;
+
+    charge(i);
+    p.cycles[TT_WASTED] += p.pending;
+    p.pending = 0;
+
+    fprintf(out, "tableB,%d", i);
+    for(int s = 0; s < TT_STATES; s++)
+    {
+      fprintf(out, ",%llu", p.cycles[s]);
+      total[s] += p.cycles[s];
+    }
+    fprintf(out, "\n");
+  }
+
+  Time_t sum = 0;
+  for(int s = 0; s < TT_STATES; s++)
+    sum += total[s];
+
+  fprintf(out, "#tableBT");
+  for(int s = 0; s < TT_STATES; s++)
+    fprintf(out, ",%s", stateName[s]);
+  fprintf(out, "\ntableBT");
+  for(int s = 0; s < TT_STATES; s++)
+    fprintf(out, ",%llu", total[s]);
+  fprintf(out, "\n");
+
+  fprintf(out, "#tableBP");
+  for(int s = 0; s < TT_STATES; s++)
+    fprintf(out, ",%s", stateName[s]);
+  fprintf(out, "\ntableBP");
+  for(int s = 0; s < TT_STATES; s++)
+    fprintf(out, ",%.2f", sum ? 100.0 * total[s] / sum : 0.0);
+  fprintf(out, "\n");
+}
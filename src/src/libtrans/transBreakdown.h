@@ -0,0 +1,117 @@
+/**
+ * @file
+ * @brief   This is the interface for the per-thread execution time breakdown.
+ *
+ * @section LICENSE
+ * Copyright: See COPYING file that comes with this distribution
+ *
+ * @section DESCRIPTION
+ * C++ Interface: transBreakdown \n
+ * Tags every cycle of every thread with what it was doing: non-transactional work,
+ * transactional work that later commits (useful) or aborts (wasted), NACK stalls,
+ * backoff after an abort, the commit/abort stall and barrier/lock waits. The state
+ * only changes on the TM events (begin, NACK, commit, abort...), so the cost is one
+ * subtraction per event, not per cycle.
+ */
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRANSACTION_BREAKDOWN
+#define TRANSACTION_BREAKDOWN
+
+#include <stdio.h>
+#include <map>
+#include "transCoherence.h"
+
+using namespace std;
+
+typedef uintptr_t RAddr;
+
+enum tmTimeState { TT_NONTRANS, TT_USEFUL, TT_WASTED, TT_NACK, TT_BACKOFF, TT_STALL, TT_SYNC, TT_STATES };
+
+struct tmTimeProc{
+  tmTimeState        state;                  //!< What the thread does since the last event
+  Time_t             since;                  //!< Cycle of the last event
+  Time_t             pending;                //!< Cycles of the running transaction, useful or wasted at its end
+  tmTimeState        resume;                 //!< State after the NACK or the lock wait
+  RAddr              barrier;                //!< Barrier waited on (0 if none)
+  unsigned long long episode;                //!< Episode of that barrier
+  int                live;                   //!< Between its spawn and its exit
+  int                spawned;                //!< Ever spawned (it is reported)
+  Time_t             cycles[TT_STATES];
+} __attribute__((aligned(TM_LINE_SIZE)));
+
+struct tmBarrierEpisode{
+  unsigned long long episode;                //!< Completed rounds of the barrier
+  Time_t             last;                   //!< Last arrival of the current round
+  Time_t             prevLast;               //!< Last arrival of the previous round
+};
+
+/**
+ * @ingroup transBreakdown
+ * @brief   Execution Time Breakdown
+ *
+ * Fed by transCoherence (begin, commit, abort, backoff), transReport (NACKs), the
+ * sesc_fetch_op substitution (locks and barriers) and OSSim (thread spawn and exit).
+ */
+class transBreakdown{
+  public:
+    transBreakdown();
+
+    bool isEnabled() const;
+
+    void spawn(int pid);
+    void exit(int pid);
+
+    void begin(int pid);
+    void nackBegin(int pid);
+    void nackFinish(int pid);
+    void commitStall(int pid);
+    void commit(int pid);
+    void abort(int pid);
+    void partialAbort(int pid, Time_t pending);
+    Time_t pendingCycles(int pid);
+    void backoff(int pid);
+
+    void lockWait(int pid);
+    void lockAcquire(int pid);
+    void barrierArrive(int pid, RAddr addr, int count);
+
+    void report(FILE *out);
+
+  private:
+    void charge(int pid);
+    void enter(int pid, tmTimeState state);
+
+    int enabled;
+
+    int nProcs;
+    tmTimeProc *proc;                                       //!< Per processor state, indexed by pid
+
+    map<RAddr, tmBarrierEpisode> barriers;
+};
+
+inline bool transBreakdown::isEnabled() const{
+  return enabled;
+}
+
+extern transBreakdown *transBD;
+#endif
+
+/**
+ * @enum    tmTimeState
+ * @ingroup transBreakdown
+ * Breakdown categories. TT_USEFUL is also the state of a running transaction.
+ */
+
+/**
+ * @struct  tmTimeProc
+ * @ingroup transBreakdown
+ * @brief   Per thread breakdown state
+ */
+
+/**
+ * @struct  tmBarrierEpisode
+ * @ingroup transBreakdown
+ * @brief   Arrivals at a barrier, to find when its waiters were released
+ */
@@ -15,12 +15,30 @@
 
 #include "transCache.h"
 
+vector<transactionCache::undoLog *> transactionCache::undoLogs;
+
 /**
  * @ingroup transCache
- * @brief Default constructor
+ * @brief Constructor
+ *
+ * @param pid   Owner thread (needed for the undo log)
+ * @param eager Eager versioning
  */
-transactionCache::transactionCache()
+transactionCache::transactionCache(int pid, bool eager)
+  : eager(eager)
+  , log(NULL)
+  , logMark(0)
+  , parent(NULL)
 {
+  if(!eager)
+    return;
+
+  if(pid >= (int)undoLogs.size())
+    undoLogs.resize(pid + 1, NULL);
+  if(undoLogs[pid] == NULL)
+    undoLogs[pid] = new undoLog;
+
+  log = undoLogs[pid];
 }
 
 /**
@@ -35,20 +53,20 @@ transactionCache::~transactionCache()
  * @ingroup transCache
  * @brief Word-size loads
  * 
- * @param addr Real address
- * @return     Memory value (int)
+ * @param addr    Real address
+ * @param inPlace Memory has the values of the transaction, no buffered word to look up
+ * @return        Memory value (int)
  *
  * Full description.
  */
-IntRegValue transactionCache::loadWord(RAddr addr)
+IntRegValue transactionCache::loadWord(RAddr addr, bool inPlace)
 {
    if(addr%4!=0)
       printf("Potential Memory LW Issue: %#10x\n",addr);
 
-   map<RAddr, IntRegValue>::iterator it;
-   it = memMap.find(addr);
-   if(it != memMap.end()){
-      return SWAP_WORD(it->second);
+   IntRegValue value;
+   if(!inPlace && findWord(addr, value)){
+      return SWAP_WORD(value);
    }
    else{
       return SWAP_WORD(*(int *)addr);
@@ -62,7 +80,7 @@ IntRegValue transactionCache::loadWord(RAddr addr)
  * @param addr Real address
  * @return     Memory value (int)
  */
-IntRegValue transactionCache::loadByte(RAddr addr)
+IntRegValue transactionCache::loadByte(RAddr addr, bool inPlace)
 {
   int z = 0;
   RAddr oaddr = addr;
@@ -72,11 +90,9 @@ IntRegValue transactionCache::loadByte(RAddr addr)
     z++;
   }
 
-  map<RAddr, IntRegValue>::iterator it;
-  it = memMap.find(addr);
-  if(it != memMap.end()){
+  IntRegValue mem;
+  if(!inPlace && findWord(addr, mem)){
 
-    int mem = it->second;
     int retVal = (mem >> (8 * z)) & 0xFF;
     return retVal;
   }
@@ -92,7 +108,7 @@ IntRegValue transactionCache::loadByte(RAddr addr)
  * @param addr    Real address
  * @param value   Memory value (int)
  */
-void transactionCache::storeByte(RAddr addr, IntRegValue value)
+void transactionCache::storeByte(RAddr addr, IntRegValue value, bool inPlace)
 {
   int z = 0;
   IntRegValue curMemValue;
@@ -103,12 +119,14 @@ void transactionCache::storeByte(RAddr addr, IntRegValue value)
     addr--;
     z++;
   }
+
+  if(inPlace){
+    logWord(addr);
+    *(unsigned char *)oaddr = value;
+    return;
+  }
   
-  map<RAddr, IntRegValue>::iterator it;
-  it = memMap.find(addr);
-  if(it != memMap.end())
-    curMemValue = it->second;
-  else
+  if(!findWord(addr, curMemValue))
     curMemValue = *(int *)addr;
 
 
@@ -122,7 +140,7 @@ void transactionCache::storeByte(RAddr addr, IntRegValue value)
  * @param addr    Real address
  * @param value   Memory value (int)
  */
-void transactionCache::storeHalfWord(RAddr addr, IntRegValue value)
+void transactionCache::storeHalfWord(RAddr addr, IntRegValue value, bool inPlace)
 {
   int z = 0;
   IntRegValue curMemValue;
@@ -137,11 +155,13 @@ void transactionCache::storeHalfWord(RAddr addr, IntRegValue value)
   if(z>2)
     printf("Potential Memory LDFP Issue: %#10x\n",addr);
 
-  map<RAddr, IntRegValue>::iterator it;
-  it = memMap.find(addr);
-  if(it != memMap.end())
-    curMemValue = it->second;
-  else
+  if(inPlace){
+    logWord(addr);
+    *(unsigned short *)oaddr = value;
+    return;
+  }
+
+  if(!findWord(addr, curMemValue))
     curMemValue = *(int *)addr;
 
   memMap[addr] = (value << (16 * z)) | (curMemValue & ~(0xff << (z * 16)));
@@ -154,11 +174,17 @@ void transactionCache::storeHalfWord(RAddr addr, IntRegValue value)
  * @param addr    Real address
  * @param value   Memory value (int)
  */
-void transactionCache::storeWord(RAddr addr, IntRegValue value)
+void transactionCache::storeWord(RAddr addr, IntRegValue value, bool inPlace)
 {
   if(addr%4!=0)
     printf("Potential Memory SW Issue: %#10x\n",addr);
 
+  if(inPlace){
+    logWord(addr);
+    *(IntRegValue *)addr = value;
+    return;
+  }
+
   memMap[addr]=value; 
 }
 
@@ -169,11 +195,17 @@ void transactionCache::storeWord(RAddr addr, IntRegValue value)
  * @param addr    Real address
  * @param value   Memory value (int)
  */
-void transactionCache::storeFPWord(RAddr addr, IntRegValue value)
+void transactionCache::storeFPWord(RAddr addr, IntRegValue value, bool inPlace)
 {
   if(addr%4!=0)
     printf("Potential Memory SFPW Issue: %#10x\n",addr);
 
+  if(inPlace){
+    logWord(addr);
+    *(IntRegValue *)addr = value;
+    return;
+  }
+
   memMap[addr]=value; 
 }
 
@@ -184,11 +216,19 @@ void transactionCache::storeFPWord(RAddr addr, IntRegValue value)
  * @param addr    Real address
  * @param value   Memory value (64b)
  */
-void transactionCache::storeDFP(RAddr addr, unsigned long long value)
+void transactionCache::storeDFP(RAddr addr, unsigned long long value, bool inPlace)
 {
   if(addr%4!=0)
     printf("Potential Memory SDFP Issue: %#10x\n",addr);
 
+  if(inPlace){
+    logWord(addr);
+    logWord(addr+4);
+    *(IntRegValue *)addr     = (int)(value & 0x00000000FFFFFFFF);
+    *(IntRegValue *)(addr+4) = (int)((value & 0xFFFFFFFF00000000LL) >> 32);
+    return;
+  }
+
   memMap[addr]=(int)(value & 0x00000000FFFFFFFF);
   memMap[addr+4]=(int)((value & 0xFFFFFFFF00000000LL) >> 32);
 }
@@ -200,14 +240,14 @@ void transactionCache::storeDFP(RAddr addr, unsigned long long value)
  * @param addr    Real address
  * @return        Memory value (double prec.)
  */
-double transactionCache::loadDFP(RAddr addr)
+double transactionCache::loadDFP(RAddr addr, bool inPlace)
 {
   if(addr%4!=0)
     printf("Potential Memory LDFP Issue: %#10x\n",addr);
 
   double retval;
-  unsigned int upper = loadWord(addr);
-  unsigned int lower = loadWord(addr+4);
+  unsigned int upper = loadWord(addr, inPlace);
+  unsigned int lower = loadWord(addr+4, inPlace);
 
   unsigned long long intval = (((unsigned long long)upper)<<32) + lower;
 
@@ -223,7 +263,7 @@ double transactionCache::loadDFP(RAddr addr)
  * @param addr Real address
  * @return     Memory value (int)
  */
-IntRegValue transactionCache::loadUnsignedHalfword(RAddr addr)
+IntRegValue transactionCache::loadUnsignedHalfword(RAddr addr, bool inPlace)
 {
   RAddr oaddr = addr;
   int z = 0;
@@ -236,10 +276,8 @@ IntRegValue transactionCache::loadUnsignedHalfword(RAddr addr)
   if(z>2)
     printf("Potential Memory LUHW Issue: %#10x\n",addr);
 
-  map<RAddr, IntRegValue>::iterator it;
-  it = memMap.find(addr);
-  if(it != memMap.end()){
-    int mem = it->second;
+  IntRegValue mem;
+  if(!inPlace && findWord(addr, mem)){
     int retVal = (mem >> (8 * z)) & 0xFFFF;
     return SWAP_SHORT(retVal);
   }
@@ -255,7 +293,7 @@ IntRegValue transactionCache::loadUnsignedHalfword(RAddr addr)
  * @param addr Real address
  * @return     Memory value (int)
  */
-IntRegValue transactionCache::loadHalfword(RAddr addr)
+IntRegValue transactionCache::loadHalfword(RAddr addr, bool inPlace)
 {
 
   RAddr oaddr = addr;
@@ -270,14 +308,12 @@ IntRegValue transactionCache::loadHalfword(RAddr addr)
   if(z>2)
     printf("Potential Memory LHW Issue: %#10x\n",addr);
 
-  map<RAddr, IntRegValue>::iterator it;
-  it = memMap.find(addr);
-  if(it != memMap.end()){
-    int mem = it->second;
+  IntRegValue mem;
+  if(!inPlace && findWord(addr, mem)){
     val = (mem >> (8 * z)) & 0xFFFF;
   }
   else{
-    val = *(unsigned short *) addr;
+    val = *(unsigned short *) oaddr;
   }
 
   val = SWAP_SHORT(val);
@@ -295,12 +331,12 @@ IntRegValue transactionCache::loadHalfword(RAddr addr)
  * @param addr    Real address
  * @return        Memory contents (float)
  */
-float transactionCache::loadFPWord(RAddr addr)
+float transactionCache::loadFPWord(RAddr addr, bool inPlace)
 {
   if(addr%4!=0)
     printf("Potential Memory LFPW Issue: %#10x\n",addr);
 
-  unsigned int intval = loadWord(addr);
+  unsigned int intval = loadWord(addr, inPlace);
 
   float fpval;
 
@@ -341,3 +377,82 @@ map<RAddr, IntRegValue>::iterator transactionCache::getEndIterator()
   return memMap.end();
 }
 
+
+/**
+ * @ingroup transCache
+ * @brief Buffered value of the word, in this cache or in the ones of the parents
+ *
+ * @param addr  Word address
+ * @param value Buffered value (if found)
+ * @return      Is the word buffered?
+ */
+bool transactionCache::findWord(RAddr addr, IntRegValue &value)
+{
+  for(transactionCache *c = this; c != NULL; c = c->parent)
+  {
+    map<RAddr, IntRegValue>::iterator it = c->memMap.find(addr);
+    if(it != c->memMap.end())
+    {
+      value = it->second;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @ingroup transCache
+ * @brief Stacks the cache of a closed nested transaction on the one of its parent
+ *
+ * @param parent Cache of the parent transaction
+ */
+void transactionCache::nest(transactionCache *parent)
+{
+  this->parent = parent;
+  if(log)
+    logMark = log->size();
+}
+
+/**
+ * @ingroup transCache
+ * @brief A closed nested transaction commits, its stores now belong to the parent
+ *
+ * The buffered words move to the parent cache. The undo log entries (eager)
+ * stay where they are, above the parent's mark.
+ */
+void transactionCache::merge()
+{
+  map<RAddr, IntRegValue>::iterator it;
+  for(it = memMap.begin(); it != memMap.end(); it++)
+    parent->memMap[it->first] = it->second;
+  memMap.clear();
+}
+
+/**
+ * @ingroup transCache
+ * @brief Undoes the in place stores (eager versioning)
+ *
+ * The log is replayed newest first, so each word ends with the value it
+ * had before the first store of the transaction. A nested transaction only
+ * replays its own entries.
+ */
+void transactionCache::rollback()
+{
+  if(log == NULL)
+    return;
+
+  for(size_t i = log->size(); i > logMark; i--)
+    *(IntRegValue *)(*log)[i - 1].addr = (*log)[i - 1].value;
+
+  log->resize(logMark);
+}
+
+/**
+ * @ingroup transCache
+ * @brief Drops the undo log (eager versioning), memory already has the new values
+ */
+void transactionCache::truncate()
+{
+  if(log)
+    log->clear();
+}
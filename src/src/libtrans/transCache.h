@@ -9,8 +9,11 @@
  *
  * @section DESCRIPTION
  * C++ Interface: transactionCache
- * Functional cache used to store transactional data. At the functional level, all models
- * operate similiar to L/L with an infinite size temporary cache. 
+ * Functional cache used to store transactional data. With lazy versioning the stores are
+ * buffered in an infinite size temporary cache and written to memory at commit. With eager
+ * versioning they update memory in place and the old values go to a per-thread undo log
+ * that is replayed on abort. A closed nested transaction has its own cache on top of its
+ * parent's, its buffered stores (its part of the undo log) go to the parent on commit.
  */
 /////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -19,6 +22,7 @@
 #define TRANSACTION_CACHE
 
 #include <map>
+#include <vector>
 #include "SescConf.h"
 
 /**
@@ -56,31 +60,64 @@ class transactionCache
 {
   public:
     /* Contructor */
-    transactionCache();
+    transactionCache(int pid = -1, bool eager = false);
 
-    IntRegValue loadWord(RAddr addr);
-    void storeWord(RAddr addr, IntRegValue value);
-    void storeHalfWord(RAddr addr, IntRegValue value);
-    void storeFPWord(RAddr addr, IntRegValue value);
-    void storeDFP(RAddr addr, unsigned long long value);
+    IntRegValue loadWord(RAddr addr, bool inPlace = false);
+    void storeWord(RAddr addr, IntRegValue value, bool inPlace = false);
+    void storeHalfWord(RAddr addr, IntRegValue value, bool inPlace = false);
+    void storeFPWord(RAddr addr, IntRegValue value, bool inPlace = false);
+    void storeDFP(RAddr addr, unsigned long long value, bool inPlace = false);
     RAddr findWordAddress(RAddr addr);
-    IntRegValue loadUnsignedHalfword(RAddr addr);
-    IntRegValue loadHalfword(RAddr addr);
-    IntRegValue loadByte(RAddr addr);
-    float loadFPWord(RAddr addr);
-    double loadDFP(RAddr addr);
-    void storeByte(RAddr addr, IntRegValue value);
+    IntRegValue loadUnsignedHalfword(RAddr addr, bool inPlace = false);
+    IntRegValue loadHalfword(RAddr addr, bool inPlace = false);
+    IntRegValue loadByte(RAddr addr, bool inPlace = false);
+    float loadFPWord(RAddr addr, bool inPlace = false);
+    double loadDFP(RAddr addr, bool inPlace = false);
+    void storeByte(RAddr addr, IntRegValue value, bool inPlace = false);
     void writeBuffer(char *buff,RAddr buffBegin, int count);
     void readBuffer(char *buff,RAddr buffBegin, int count);
 
     map<RAddr, IntRegValue>::iterator getBeginIterator();
     map<RAddr, IntRegValue>::iterator getEndIterator();
 
+    bool isEager() const { return eager; }
+    void rollback();
+    void truncate();
+
+    void nest(transactionCache *parent);
+    void merge();
+
     /* Deconstructor */
     ~transactionCache();
 
   private:
+    /**
+     * @brief Undo log entry: the aligned word before the first store of the entry
+     */
+    struct undoEntry {
+      RAddr       addr;
+      IntRegValue value;
+    };
+    typedef vector<undoEntry> undoLog;
+
+    //! One log per thread (indexed by pid), kept across transactions so its
+    //! storage is reused. Nested transactions share it, each one from its mark.
+    static vector<undoLog *>    undoLogs;
+
+    void logWord(RAddr addr) {
+      undoEntry e;
+      e.addr  = addr;
+      e.value = *(IntRegValue *)addr;
+      log->push_back(e);
+    }
+
+    bool findWord(RAddr addr, IntRegValue &value);
+
      map<RAddr, IntRegValue>     memMap; //!< The Memory Map
+     bool                        eager;  //!< Eager versioning (stores in place)
+     undoLog                    *log;    //!< Undo log of the owner thread (eager only)
+     size_t                      logMark;//!< Log entries of the outer transactions
+     transactionCache           *parent; //!< Cache of the parent (closed nesting)
 };
 
 #endif
@@ -13,12 +13,34 @@
 /////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <vector>
+
 #include "transCoherence.h"
 #include "ThreadContext.h"
 #include "transReport.h"
+#include "transBreakdown.h"
+#include "TransPrefetcher.h"
+#include "SescConf.h"
+#include "globals.h"
 
 transCoherence *transGCM = 0;
 
+/**
+ * @ingroup transCoherence
+ * @brief   Entries of the per processor TM state
+ *
+ * The state is indexed by pid, so it covers the configured cores as well as the
+ * process limit (mint -p).
+ */
+int tmProcCount()
+{
+  int n = SescConf->getRecordSize("","cpucore");
+  if(n < Max_nprocs)
+    n = Max_nprocs;
+  return n;
+}
+
 /**
  * @ingroup transCoherence
  * @brief   Global Coherence Module
@@ -40,6 +62,45 @@ transCoherence::transCoherence(FILE* out, int conflicts, int versioning, int cac
 
    utid = 0; // Set Global Transaction ID = 0
 
+  filterPrivate = 0;
+  if(SescConf->checkInt("TransactionalMemory","filterPrivate"))
+    filterPrivate = SescConf->getInt("TransactionalMemory","filterPrivate");
+
+  if(cacheLineSize <= 0 || (cacheLineSize & (cacheLineSize - 1)))
+  {
+    fprintf(stderr,"TransactionalMemory:cacheLineSize must be a power of two\n");
+    exit(0);
+  }
+
+  wordConflicts = 0;
+  if(SescConf->checkInt("TransactionalMemory","wordConflicts"))
+    wordConflicts = SescConf->getInt("TransactionalMemory","wordConflicts");
+  nAvoidedConflicts = 0;
+
+  //! One mask bit per word
+  if(wordConflicts && cacheLineSize > 4 * 32)
+  {
+    fprintf(stderr,"TransactionalMemory:wordConflicts supports lines of up to 128 bytes\n");
+    exit(0);
+  }
+
+  closedNesting = 0;
+  if(SescConf->checkInt("TransactionalMemory","closedNesting"))
+    closedNesting = SescConf->getInt("TransactionalMemory","closedNesting");
+
+  boundedCache = 0;
+  if(SescConf->checkInt("TransactionalMemory","boundedCache"))
+    boundedCache = SescConf->getInt("TransactionalMemory","boundedCache");
+
+  overflowFallback = OVERFLOW_SERIALIZE;
+  if(SescConf->checkInt("TransactionalMemory","overflowFallback"))
+    overflowFallback = SescConf->getInt("TransactionalMemory","overflowFallback");
+
+  serialOwner = -1;
+  nOverflows = 0;
+  nSerialized = 0;
+  nUnbounded = 0;
+
   // Eager/Eager
   if(versioning && conflictDetection)
   {
@@ -75,22 +136,468 @@ transCoherence::transCoherence(FILE* out, int conflicts, int versioning, int cac
     exit(0);
   }
 
-  for(int i = 0; i < MAX_CPU_COUNT; i++)
+  nProcs = tmProcCount();
+  proc = tmAllocProcState<struct tmProcState>(nProcs);
+  nestLevels.resize(nProcs);
+
+  for(int i = 0; i < nProcs; i++)
   {
-    transState[i].timestamp = ((~0ULL) - 1024);
-    transState[i].cycleFlag = 0;
-    transState[i].state = INVALID;
-    transState[i].beginPC = 0;
-    stallCycle[i] = 0;
-    abortCount[i] = 0;
-    abortReason[i].first = 0;
-    abortReason[i].second = 0;
-    tmDepth[i] = 0;
+    proc[i].transState.timestamp = ((~0ULL) - 1024);
+    proc[i].transState.cycleFlag = 0;
+    proc[i].transState.state = INVALID;
+    proc[i].transState.beginPC = 0;
+    proc[i].stallCycle = 0;
+    proc[i].abortCount = 0;
+    proc[i].abortReason.first = 0;
+    proc[i].abortReason.second = 0;
+    proc[i].overflowed = 0;
+    proc[i].abortLevel = 0;
+    proc[i].tmDepth = 0;
+    proc[i].cyclesOnCommit = 0;
+    proc[i].cyclesOnAbort = 0;
+    proc[i].cyclesOnNormal = 0;
+    proc[i].cyclesOnBegin = 0;
     currentCommitter = -1;
   }
 
 }
 
+/**
+ * @ingroup transCoherence
+ * @brief   Checks for an access to thread-private data
+ *
+ * @param pthread SESC thread pointer
+ * @param raddr   Real address
+ * @return Is the address in the thread's stack or in a private region?
+ */
+bool transCoherence::isPrivateAddr(thread_ptr pthread, RAddr raddr)
+{
+  RAddr stackBegin = pthread->virt2real(pthread->getStackAddr());
+  if(raddr >= stackBegin && raddr < stackBegin + pthread->getStackSize())
+    return true;
+
+  if(privateRegions.empty())
+    return false;
+
+  //! The last region that begins at or before raddr
+  map<RAddr, RAddr>::iterator it = privateRegions.upper_bound(raddr);
+  if(it == privateRegions.begin())
+    return false;
+  it--;
+
+  return raddr < it->second;
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   Marks [begin, end) as private
+ */
+void transCoherence::addPrivate(RAddr begin, RAddr end)
+{
+  if(end > begin)
+    privateRegions[begin] = end;
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   Removes the private region that starts at begin
+ */
+void transCoherence::removePrivate(RAddr begin)
+{
+  privateRegions.erase(begin);
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   Non-transactional write (a real lock acquire), every transaction that
+ *          read or wrote the cache line is forced to abort
+ *
+ * @param pid   Process ID of the writer
+ * @param raddr Real address
+ */
+void transCoherence::abortSharers(int pid, RAddr raddr)
+{
+  RAddr caddr = addrToCacheLine(raddr);
+
+  tmPermCache::iterator it = permCache.find(caddr);
+  if(it == permCache.end())
+    return;
+
+  tmSharers sharers = it->second.readers;
+  sharers.insert(it->second.writers.begin(), it->second.writers.end());
+
+  unsigned int word = wordBit(raddr);
+
+  tmSharers::iterator setIt;
+  for(setIt = sharers.begin(); setIt != sharers.end(); ++setIt)
+  {
+    if(*setIt == pid || proc[*setIt].tmDepth == 0)
+      continue;
+    if(!wordsOverlap(it->second, *setIt, word, false) && !wordsOverlap(it->second, *setIt, word, true))
+      continue;
+    forceAbort(*setIt, pid, caddr, nestLevel(*setIt, caddr));
+  }
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   Removes pid from the readers/writers of every tracked line
+ *
+ * @param pid   Process ID
+ */
+void transCoherence::releaseLines(int pid)
+{
+  tmPermCache::iterator it;
+  for(it = permCache.begin(); it != permCache.end(); ++it)
+  {
+    it->second.writers.erase(pid);
+    it->second.readers.erase(pid);
+    it->second.masks.erase(pid);
+  }
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   pid stops retrying and runs the section non-transactionally (lock
+ *          elision fallback), the last aborted attempt is discarded
+ *
+ * @param pid   Process ID
+ */
+void transCoherence::dropAttempt(int pid)
+{
+  releaseLines(pid);
+  nestClear(pid);
+
+  //!  Otherwise the stale timestamp and sharer entries keep NACKing other transactions
+  proc[pid].transState.state = INVALID;
+  proc[pid].transState.timestamp = ((~0ULL) - 1024);
+  proc[pid].transState.cycleFlag = 0;
+  proc[pid].tmDepth = 0;
+  proc[pid].abortCount = 0;
+  proc[pid].abortLevel = 0;
+  proc[pid].overflowed = 0;
+  if(serialOwner == pid)
+    serialOwner = -1;
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   A line read/written by the transaction was displaced from the private
+ *          cache, the transaction does not fit (bounded TM)
+ *
+ * @param pid   Process ID
+ * @param utid  Transaction that marked the line
+ * @param caddr Displaced line (physical address)
+ */
+void transCoherence::overflow(int pid, int utid, RAddr caddr)
+{
+  if(!tracksOverflow(pid, utid))
+    return;
+
+  forceAbort(pid, pid, caddr, 1);
+  proc[pid].overflowed = 1;
+  nOverflows++;
+
+  tmReport->reportOverflow(proc[pid].transState.utid, pid, caddr);
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   Begin of an outermost transaction with the overflow fallback
+ *
+ * @param pid   Process ID
+ * @return Can the transaction start?
+ *
+ * With OVERFLOW_SERIALIZE the retry of an overflowed transaction takes a global
+ * lock. Every transaction reads the lock, so the running ones abort, and no
+ * other transaction begins until the owner commits.
+ */
+bool transCoherence::serialBegin(int pid)
+{
+  if(serialOwner == pid)
+    return true;
+  if(serialOwner >= 0)
+    return false;
+  if(!proc[pid].overflowed || overflowFallback != OVERFLOW_SERIALIZE)
+    return true;
+
+  serialOwner = pid;
+  for(int i = 0; i < nProcs; i++)
+  {
+    if(i == pid || proc[i].tmDepth == 0)
+      continue;
+    if(proc[i].transState.state != RUNNING && proc[i].transState.state != NACKED)
+      continue;
+    forceAbort(i, pid, 0, 1);
+  }
+  return true;
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   The retry of an overflowed transaction committed, back to bounded
+ */
+void transCoherence::overflowCommit(int pid)
+{
+  if(!proc[pid].overflowed)
+    return;
+
+  proc[pid].overflowed = 0;
+  if(serialOwner == pid)
+  {
+    serialOwner = -1;
+    nSerialized++;
+  }
+  else
+    nUnbounded++;
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   Orders pid to abort, it notices on its next access
+ *
+ * @param pid   Process ID of the victim
+ * @param by    Process ID of the aborter
+ * @param caddr Conflicting cache line
+ * @param level Nesting level of the victim that has to restart
+ */
+void transCoherence::forceAbort(int pid, int by, RAddr caddr, int level)
+{
+  proc[pid].transState.state = DOABORT;
+  proc[pid].abortReason.first = by;
+  proc[pid].abortReason.second = caddr;
+  if(by != pid && caddr)
+    TransPrefetcher::txConflict(pid, caddr, false);
+
+  //!  Several conflicts before pid notices, the outermost one wins
+  if(proc[pid].abortLevel == 0 || level < proc[pid].abortLevel)
+    proc[pid].abortLevel = level;
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   Reports the abort ordered by forceAbort, partial if only nested levels are rolled back
+ */
+void transCoherence::reportForcedAbort(int pid, int tid)
+{
+  int level = restartLevel(pid);
+
+  if(level > 1)
+    tmReport->reportPartialAbort(proc[pid].transState.utid, pid, tid, proc[pid].abortReason.first, proc[pid].abortReason.second, level, nestLevels[pid][level - 1].begin);
+  else
+    tmReport->reportAbort(proc[pid].transState.utid,pid, tid, proc[pid].abortReason.first, proc[pid].abortReason.second, proc[pid].abortReason.second, proc[pid].transState.timestamp, 0);
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   Outermost nesting level of pid that read or wrote the line
+ *
+ * @param pid   Process ID
+ * @param caddr Cache line
+ * @return Level (1 unless the line was only accessed by nested transactions)
+ */
+int transCoherence::nestLevel(int pid, RAddr caddr)
+{
+  if(!closedNesting || proc[pid].tmDepth < 2)
+    return 1;
+
+  tmPermCache::iterator it = permCache.find(caddr);
+  if(it == permCache.end())
+    return 1;
+
+  //!  Level 1 keeps no delta, whatever is not in a nested delta belongs to it
+  tmNestLevels &levels = nestLevels[pid];
+  int readLevel = 0;
+  int writeLevel = 0;
+  for(int l = 2; l <= proc[pid].tmDepth; l++)
+  {
+    nestDelta &delta = levels[l - 1];
+    if(!readLevel && find(delta.reads.begin(), delta.reads.end(), caddr) != delta.reads.end())
+      readLevel = l;
+    if(!writeLevel && find(delta.writes.begin(), delta.writes.end(), caddr) != delta.writes.end())
+      writeLevel = l;
+  }
+
+  if(it->second.readers.count(pid) && !readLevel)
+    return 1;
+  if(it->second.writers.count(pid) && !writeLevel)
+    return 1;
+
+  if(readLevel && writeLevel)
+    return readLevel < writeLevel ? readLevel : writeLevel;
+  if(readLevel || writeLevel)
+    return readLevel + writeLevel;
+  return 1;
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   pid was added as reader (writer) of the line, record it for the
+ *          abort-replay prefetcher and in the running nested level
+ */
+void transCoherence::nestAccess(int pid, RAddr caddr, bool write)
+{
+  if(TransPrefetcher::isActive())
+    TransPrefetcher::txLine(pid, caddr, write);
+
+  if(!closedNesting || proc[pid].tmDepth < 2)
+    return;
+
+  nestDelta &delta = nestLevels[pid][proc[pid].tmDepth - 1];
+  if(write)
+    delta.writes.push_back(caddr);
+  else
+    delta.reads.push_back(caddr);
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   A nested transaction begins (tmDepth already incremented)
+ */
+void transCoherence::nestOpen(int pid)
+{
+  tmNestLevels &levels = nestLevels[pid];
+  if((int)levels.size() < proc[pid].tmDepth)
+    levels.resize(proc[pid].tmDepth);
+
+  levels[proc[pid].tmDepth - 1].reads.clear();
+  levels[proc[pid].tmDepth - 1].writes.clear();
+  levels[proc[pid].tmDepth - 1].begin = globalClock;
+  levels[proc[pid].tmDepth - 1].pending = transBD->pendingCycles(pid);
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   A nested transaction commits, its delta goes to the parent (before tmDepth is decremented)
+ */
+void transCoherence::nestCommit(int pid)
+{
+  int depth = proc[pid].tmDepth;
+  nestDelta &child = nestLevels[pid][depth - 1];
+
+  //!  The outermost level owns everything that is not in a delta
+  if(depth > 2)
+  {
+    nestDelta &parent = nestLevels[pid][depth - 2];
+    parent.reads.insert(parent.reads.end(), child.reads.begin(), child.reads.end());
+    parent.writes.insert(parent.writes.end(), child.writes.begin(), child.writes.end());
+  }
+
+  child.reads.clear();
+  child.writes.clear();
+
+  //!  A pending forced abort of the child now hits the parent
+  if(proc[pid].abortLevel >= depth)
+    proc[pid].abortLevel = depth - 1;
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   Partial abort, the cycles since level began are wasted. They are moved
+ *          out of the running outermost transaction so its commit does not count them
+ *          (the breakdown only moves its transactional cycles, NACKs and stalls stay).
+ *
+ * @param pid   Process ID
+ * @param level Nesting level that restarts (> 1)
+ */
+void transCoherence::nestWasted(int pid, int level)
+{
+  Time_t cycles = globalClock - nestLevels[pid][level - 1].begin;
+
+  proc[pid].cyclesOnAbort += cycles;
+  proc[pid].cyclesOnBegin += cycles;
+  transBD->partialAbort(pid, nestLevels[pid][level - 1].pending);
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   Partial abort, pid stops being a reader/writer of the lines added from level up
+ *
+ * @param pid   Process ID
+ * @param level Nesting level that restarts (> 1)
+ * @return Lines released from the write set
+ */
+int transCoherence::nestRollback(int pid, int level)
+{
+  int writeSetSize = 0;
+
+  for(int l = proc[pid].tmDepth; l >= level; l--)
+  {
+    nestDelta &delta = nestLevels[pid][l - 1];
+    tmPermCache::iterator it;
+
+    for(size_t i = 0; i < delta.reads.size(); i++)
+    {
+      it = permCache.find(delta.reads[i]);
+      if(it != permCache.end())
+        it->second.readers.erase(pid);
+    }
+    for(size_t i = 0; i < delta.writes.size(); i++)
+    {
+      it = permCache.find(delta.writes[i]);
+      if(it != permCache.end())
+        writeSetSize += it->second.writers.erase(pid);
+    }
+
+    //!  The word masks are kept while an outer level still holds the line
+    for(size_t i = 0; i < delta.reads.size() + delta.writes.size(); i++)
+    {
+      RAddr caddr = i < delta.reads.size() ? delta.reads[i] : delta.writes[i - delta.reads.size()];
+      it = permCache.find(caddr);
+      if(it != permCache.end() && !it->second.readers.count(pid) && !it->second.writers.count(pid))
+        it->second.masks.erase(pid);
+    }
+
+    delta.reads.clear();
+    delta.writes.clear();
+  }
+
+  return writeSetSize;
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   The outermost transaction finished, drop the deltas
+ */
+void transCoherence::nestClear(int pid)
+{
+  tmNestLevels &levels = nestLevels[pid];
+  for(size_t l = 0; l < levels.size(); l++)
+  {
+    levels[l].reads.clear();
+    levels[l].writes.clear();
+  }
+  proc[pid].abortLevel = 0;
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   Prints the word conflict (wordConflicts) and overflow (boundedCache) statistics
+ *
+ * @param out Report file
+ */
+void transCoherence::report(FILE *out)
+{
+  if(out == NULL)
+    return;
+
+  if(wordConflicts)
+  {
+    fprintf(out, "#tableW,AvoidedConflicts\n");
+    fprintf(out, "tableW,%llu\n", nAvoidedConflicts);
+  }
+
+  if(!boundedCache)
+    return;
+
+  fprintf(out, "#tableO,Overflows,Serialized,Unbounded,Fallback\n");
+  fprintf(out, "tableO,%llu,%llu,%llu,%s\n",
+          nOverflows,
+          nSerialized,
+          nUnbounded,
+          overflowFallback == OVERFLOW_SERIALIZE ? "serialize" : "unbounded");
+}
+
 /**
  * @ingroup transCoherence
  * @brief   Create new cache state reference with Read bit set
@@ -98,11 +605,12 @@ transCoherence::transCoherence(FILE* out, int conflicts, int versioning, int cac
  * @param pid   Process ID
  * @return     Cache state
  */
-struct cacheState transCoherence::newReadState(int pid)
+struct cacheState transCoherence::newReadState(int pid, unsigned int word)
 {
     struct cacheState tmp;
     tmp.state = R;
     tmp.readers.insert(pid);
+    recordWord(tmp, pid, word, false);
     return tmp;
 }
 
@@ -113,14 +621,81 @@ struct cacheState transCoherence::newReadState(int pid)
  * @param pid   Process ID
  * @return Cache state
  */
-struct cacheState transCoherence::newWriteState(int pid)
+struct cacheState transCoherence::newWriteState(int pid, unsigned int word)
 {
     struct cacheState tmp;
     tmp.state = W;
     tmp.writers.insert(pid);
+    recordWord(tmp, pid, word, true);
     return tmp;
 }
 
+/**
+ * @ingroup transCoherence
+ * @brief   Records the word accessed by pid (wordConflicts only)
+ */
+void transCoherence::recordWord(struct cacheState &per, int pid, unsigned int word, bool write)
+{
+  if(!wordConflicts)
+    return;
+
+  tmMasks::iterator it = per.masks.find(pid);
+  if(it == per.masks.end())
+  {
+    wordMasks m;
+    m.read = 0;
+    m.write = 0;
+    it = per.masks.insert(make_pair(pid, m)).first;
+  }
+
+  if(write)
+    it->second.write |= word;
+  else
+    it->second.read |= word;
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   Did other read (or write) any of the words? Always true at line granularity.
+ */
+bool transCoherence::wordsOverlap(struct cacheState &per, int other, unsigned int words, bool write)
+{
+  if(!wordConflicts)
+    return true;
+
+  tmMasks::iterator it = per.masks.find(other);
+  if(it == per.masks.end())
+    return false;
+
+  return ((write ? it->second.write : it->second.read) & words) != 0;
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   First sharer (other than pid) the access conflicts with
+ *
+ * @param per      Line state
+ * @param sharers  Readers (write false) or writers (write true) of the line
+ * @param pid      Process ID
+ * @param word     Word accessed
+ * @param write    Compare against the write masks
+ * @param lineConflict Set if there is a conflict at line granularity
+ * @return Conflicting process ID, -1 if none
+ */
+int transCoherence::conflictWith(struct cacheState &per, tmSharers &sharers, int pid, unsigned int word, bool write, bool &lineConflict)
+{
+  tmSharers::iterator it;
+  for(it = sharers.begin(); it != sharers.end(); ++it)
+  {
+    if(*it == pid)
+      continue;
+    lineConflict = true;
+    if(wordsOverlap(per, *it, word, write))
+      return *it;
+  }
+  return -1;
+}
+
 /**
  * @ingroup transCoherence
  * @brief check to see if thread has been ordered to abort
@@ -131,10 +706,10 @@ struct cacheState transCoherence::newWriteState(int pid)
  */
 bool transCoherence::checkAbort(int pid, int tid)
 {
-  if(transState[pid].state == DOABORT)
+  if(proc[pid].transState.state == DOABORT)
   {
-    tmReport->reportAbort(transState[pid].utid,pid, tid, abortReason[pid].first, abortReason[pid].second, abortReason[pid].second,transState[pid].timestamp, 0);
-    transState[pid].state = ABORTING;
+    reportForcedAbort(pid, tid);
+    proc[pid].transState.state = ABORTING;
     return true;
   }
   else
@@ -152,54 +727,75 @@ bool transCoherence::checkAbort(int pid, int tid)
  * @param pid   Process ID
  * @param tid   Thread ID
  * @param raddr Real address
+ * @param size  Bytes accessed
  * @return Coherency status
  */
-GCMRet transCoherence::readEE(int pid, int tid, RAddr raddr)
+GCMRet transCoherence::readEE(int pid, int tid, RAddr raddr, int size)
 {
   RAddr caddr = addrToCacheLine(raddr);
   GCMRet retval = SUCCESS;
 
-  map<RAddr, cacheState>::iterator it;
+  //!  If we have been forced to ABORT
+  if(proc[pid].transState.state == DOABORT)
+  {
+    reportForcedAbort(pid, tid);
+    proc[pid].transState.state = ABORTING;
+    return ABORT;
+  }
+
+  tmPermCache::iterator it;
   it = permCache.find(caddr);
 
+  unsigned int word = wordBit(raddr, size);
+
   //! If the cache line has been instantiated in our Map
   if(it != permCache.end()){
     struct cacheState per = it->second;
+    int nackPid = -1;
+    bool lineConflict = false;
     if(per.writers.size() >= 1 && (per.writers.count(pid) != 1))
-    {
-      int nackPid = *per.writers.begin();
+      nackPid = conflictWith(per, per.writers, pid, word, true, lineConflict);
+
+    if(nackPid < 0 && lineConflict)
+      nAvoidedConflicts++;
 
-      Time_t nackTimestamp = transState[nackPid].timestamp;
-      Time_t myTimestamp = transState[pid].timestamp;
+    if(nackPid >= 0)
+    {
+      Time_t nackTimestamp = proc[nackPid].transState.timestamp;
+      Time_t myTimestamp = proc[pid].transState.timestamp;
 
-      if(nackTimestamp <= myTimestamp && transState[pid].cycleFlag)
+      if(nackTimestamp <= myTimestamp && proc[pid].transState.cycleFlag)
       {
-        tmReport->reportNackLoad(transState[pid].utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
-        tmReport->reportAbort(transState[pid].utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
-        transState[pid].state = ABORTING;
+        tmReport->reportNackLoad(proc[pid].transState.utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
+        tmReport->reportAbort(proc[pid].transState.utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
+        TransPrefetcher::txConflict(pid, caddr, false);
+        proc[pid].transState.state = ABORTING;
         return ABORT;
       }
 
       if(nackTimestamp >= myTimestamp)
-        transState[nackPid].cycleFlag = 1;
+        proc[nackPid].transState.cycleFlag = 1;
 
-      tmReport->reportNackLoad(transState[pid].utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
-      transState[pid].state = NACKED;
+      tmReport->reportNackLoad(proc[pid].transState.utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
+      proc[pid].transState.state = NACKED;
       retval = NACK;
     }
     else{
-      per.readers.insert(pid);
-      tmReport->registerLoad(transState[pid].utid,transState[pid].beginPC,pid,tid,raddr,caddr,transState[pid].timestamp);
+      if(per.readers.insert(pid).second)
+        nestAccess(pid, caddr, false);
+      recordWord(per, pid, word, false);
+      tmReport->registerLoad(proc[pid].transState.utid,proc[pid].transState.beginPC,pid,tid,raddr,caddr,proc[pid].transState.timestamp);
       permCache[caddr] = per;
-      transState[pid].state = RUNNING;
+      proc[pid].transState.state = RUNNING;
       retval = SUCCESS;
     }
   }
   //! We haven't, so create a new one
   else{
-      tmReport->registerLoad(transState[pid].utid, transState[pid].beginPC,pid,tid,raddr,caddr,transState[pid].timestamp);
-      permCache[caddr] = newReadState(pid);
-      transState[pid].state = RUNNING;
+      tmReport->registerLoad(proc[pid].transState.utid, proc[pid].transState.beginPC,pid,tid,raddr,caddr,proc[pid].transState.timestamp);
+      permCache[caddr] = newReadState(pid, word);
+      nestAccess(pid, caddr, false);
+      proc[pid].transState.state = RUNNING;
       retval = SUCCESS;
   }
 
@@ -213,97 +809,86 @@ GCMRet transCoherence::readEE(int pid, int tid, RAddr raddr)
  * @param pid   Process ID
  * @param tid   Thread ID
  * @param raddr Real address
+ * @param size  Bytes accessed
  * @return Coherency status
  */
-GCMRet transCoherence::writeEE(int pid, int tid, RAddr raddr)
+GCMRet transCoherence::writeEE(int pid, int tid, RAddr raddr, int size)
 {
   RAddr caddr = addrToCacheLine(raddr);
   GCMRet retval = SUCCESS;
 
-  map<RAddr, cacheState>::iterator it;
+  //!  If we have been forced to ABORT
+  if(proc[pid].transState.state == DOABORT)
+  {
+    reportForcedAbort(pid, tid);
+    proc[pid].transState.state = ABORTING;
+    return ABORT;
+  }
+
+  tmPermCache::iterator it;
   it = permCache.find(caddr);
 
+  unsigned int word = wordBit(raddr, size);
+
   //! If the cache line has been instantiated in our Map
   if(it != permCache.end()){
     struct cacheState per = it->second;
+    int nackPid = -1;
+    bool lineConflict = false;
+
     //! If there is more than one reader, or there is a single reader who happens not to be us
     if(per.readers.size() > 1 || ((per.readers.size() == 1) && (per.readers.count(pid) != 1)))
+      nackPid = conflictWith(per, per.readers, pid, word, false, lineConflict);
+
+    //! Otherwise the same with the writers
+    if(nackPid < 0 && ((per.writers.size() > 1) || ((per.writers.size() == 1) && (per.writers.count(pid) != 1))))
+      nackPid = conflictWith(per, per.writers, pid, word, true, lineConflict);
+
+    if(nackPid < 0 && lineConflict)
+      nAvoidedConflicts++;
+
+    if(nackPid >= 0)
     {
-      set<int>::iterator it = per.readers.begin();
-      int nackPid = *it;
-      //!  Grab the first reader than isn't us
-      if(nackPid == pid)
-      {
-        ++it;
-        nackPid = *it;
-      }
       //!  Take our timestamp as well as the readers
-      Time_t nackTimestamp = transState[nackPid].timestamp;
-      Time_t myTimestamp = transState[pid].timestamp;
+      Time_t nackTimestamp = proc[nackPid].transState.timestamp;
+      Time_t myTimestamp = proc[pid].transState.timestamp;
 
       //!  If the process that is going to nack us is older than us, and we have cycle flag set, abort
-      if(nackTimestamp <= myTimestamp && transState[pid].cycleFlag)
+      if(nackTimestamp <= myTimestamp && proc[pid].transState.cycleFlag)
       {
-        tmReport->reportNackStore(transState[pid].utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
-        tmReport->reportAbort(transState[pid].utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
-        transState[pid].state = ABORTING;
+        tmReport->reportNackStore(proc[pid].transState.utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
+        tmReport->reportAbort(proc[pid].transState.utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
+        TransPrefetcher::txConflict(pid, caddr, true);
+        proc[pid].transState.state = ABORTING;
         return ABORT;
       }
 
       //!  If we are older than the guy we're nacking on, then set her cycle flag to indicate possible deadlock
       if(nackTimestamp >= myTimestamp)
-        transState[nackPid].cycleFlag = 1;
+        proc[nackPid].transState.cycleFlag = 1;
 
-      tmReport->reportNackStore(transState[pid].utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
+      tmReport->reportNackStore(proc[pid].transState.utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
 
-      transState[pid].state = NACKED;
-      retval = NACK;
-    }
-    else if((per.writers.size() > 1) || ((per.writers.size() == 1) && (per.writers.count(pid) != 1)))
-    {
-
-      set<int>::iterator it = per.writers.begin();
-      int nackPid = *it;
-
-      //!  Grab the first reader than isn't us
-      if(nackPid == pid)
-      {
-        ++it;
-        nackPid = *it;
-      }
-
-      Time_t nackTimestamp = transState[nackPid].timestamp;
-      Time_t myTimestamp = transState[pid].timestamp;
-
-      if(nackTimestamp <= myTimestamp && transState[pid].cycleFlag)
-      {
-        tmReport->reportNackStore(transState[pid].utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
-        tmReport->reportAbort(transState[pid].utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
-        transState[pid].state = ABORTING;
-        return ABORT;
-      }
-
-      if(nackTimestamp >= myTimestamp)
-        transState[nackPid].cycleFlag = 1;
-
-      tmReport->reportNackStore(transState[pid].utid,pid, tid, nackPid, raddr, caddr, myTimestamp, nackTimestamp);
-      transState[pid].state = NACKED;
+      proc[pid].transState.state = NACKED;
       retval = NACK;
     }
     else{
-      per.writers.insert(pid);
-      tmReport->registerStore(transState[pid].utid, transState[pid].beginPC,pid,tid,raddr,caddr,transState[pid].timestamp);
+      if(per.writers.insert(pid).second)
+        nestAccess(pid, caddr, true);
+      recordWord(per, pid, word, true);
+      tmReport->registerStore(proc[pid].transState.utid, proc[pid].transState.beginPC,pid,tid,raddr,caddr,proc[pid].transState.timestamp);
       permCache[caddr] = per;
-      transState[pid].state = RUNNING;
+      proc[pid].transState.state = RUNNING;
       retval = SUCCESS;
     }
 
   }
   //!  We haven't, so create a new one
   else{
-      tmReport->registerStore(transState[pid].utid,transState[pid].beginPC,pid,tid,raddr,caddr,transState[pid].timestamp);
-      permCache[caddr] = newWriteState(pid);
-      transState[pid].state = RUNNING;
+      tmReport->registerStore(proc[pid].transState.utid,proc[pid].transState.beginPC,pid,tid,raddr,caddr,proc[pid].transState.timestamp);
+      permCache[caddr] = newWriteState(pid, word);
+      nestAccess(pid, caddr, true);
+      proc[pid].transState.state = RUNNING;
       retval = SUCCESS;
   }
 
@@ -322,62 +907,74 @@ GCMFinalRet transCoherence::beginEE(int pid, icode_ptr picode)
 {
   struct GCMFinalRet retVal;
 
-  //!  Subsume all nested transactions for now
-  if(tmDepth[pid]>0)
+  //!  Subsume nested transactions, unless they are closed nested
+  if(proc[pid].tmDepth>0)
   {
-    //tmReport->registerBegin(transState[pid].utid,pid,tid,transState[pid].timestamp);
-    tmDepth[pid]++;
-    retVal.ret = IGNORE;
+    //tmReport->registerBegin(proc[pid].transState.utid,pid,tid,proc[pid].transState.timestamp);
+    proc[pid].tmDepth++;
+    if(closedNesting)
+    {
+      nestOpen(pid);
+      retVal.ret = SUCCESS;
+    }
+    else
+      retVal.ret = IGNORE;
     //!  This is a subsumed begin, set BCFlag = 2
     retVal.BCFlag = 2;
-    retVal.tuid = transState[pid].utid;
+    retVal.tuid = proc[pid].transState.utid;
     return retVal;
   }
   else
   {
     //!  If we had just aborted, we need to now invalidate all the memory addresses we touched
-    if(transState[pid].state == ABORTING)
+    if(proc[pid].transState.state == ABORTING)
     {
-      map<RAddr, cacheState>::iterator it;
-      for(it = permCache.begin(); it != permCache.end(); ++it)
-      {
-        it->second.writers.erase(pid);
-        it->second.readers.erase(pid);
-      }
-      transState[pid].state = ABORTED;
-      abortCount[pid]++;
+      releaseLines(pid);
+      proc[pid].transState.state = ABORTED;
+      proc[pid].abortCount++;
     }
 
     //!  If we just finished an abort, its time to backoff
-    if(transState[pid].state == ABORTED)
+    if(proc[pid].transState.state == ABORTED)
     {
-      retVal.abortCount = abortCount[pid];
+      retVal.abortCount = proc[pid].abortCount;
       retVal.ret = BACKOFF;
-      transState[pid].state = RUNNING;
+      proc[pid].transState.state = RUNNING;
+      transBD->backoff(pid);
+    }
+    //!  Another processor runs serialized after an overflow
+    else if(!serialBegin(pid))
+    {
+      retVal.abortCount = 1;
+      retVal.ret = BACKOFF;
+      transBD->backoff(pid);
     }
     else
     {
       //!  Pass whether this is the begining of an aborted replay back to the context
-      if(abortCount[pid]>0)
+      if(proc[pid].abortCount>0)
          retVal.BCFlag = 1;  //!  Replay
       else
         retVal.BCFlag = 0;
 
-      transState[pid].timestamp = globalClock;
-      transState[pid].beginPC = picode->addr;
-      transState[pid].cycleFlag = 0;
-      transState[pid].state = RUNNING;
-      transState[pid].utid = transCoherence::utid++;
+      proc[pid].transState.timestamp = globalClock;
+      proc[pid].transState.beginPC = picode->addr;
+      proc[pid].transState.cycleFlag = 0;
+      proc[pid].transState.state = RUNNING;
+      proc[pid].transState.utid = transCoherence::utid++;
 
-      tmDepth[pid]++;
+      proc[pid].tmDepth++;
+      nestClear(pid);
 
-      tmReport->registerBegin(transState[pid].utid,pid,picode->immed,picode->addr,transState[pid].timestamp);
+      tmReport->registerBegin(proc[pid].transState.utid,pid,picode->immed,picode->addr,proc[pid].transState.timestamp);
+      transBD->begin(pid);
+      TransPrefetcher::txBegin(pid, picode->addr);
 
       retVal.ret = SUCCESS;
-      retVal.tuid = transState[pid].utid;
+      retVal.tuid = proc[pid].transState.utid;
     }
 
-	cyclesOnBegin[pid] = globalClock;
+	proc[pid].cyclesOnBegin = globalClock;
     return retVal;
   }
 }
@@ -396,15 +993,29 @@ struct GCMFinalRet transCoherence::abortEE(thread_ptr pthread, int tid)
   struct GCMFinalRet retVal;
   int pid = pthread->getPid();
   int writeSetSize = 0;
-  transState[pid].timestamp = ((~0ULL) - 1024);
-  transState[pid].beginPC = 0;
-  stallCycle[pid] = 0;
-  transState[pid].cycleFlag = 0;
 
-  //!  We can't just decriment because we should be going back to the original begin, so tmDepth[pid] = 0
-  tmDepth[pid]=0;
+  //!  Closed nesting: only the nested levels that hold the conflicting line restart
+  retVal.level = restartLevel(pid);
+  proc[pid].abortLevel = 0;
+  if(retVal.level > 1)
+  {
+    nestWasted(pid, retVal.level);
+    retVal.writeSetSize = nestRollback(pid, retVal.level);
+    proc[pid].tmDepth = retVal.level - 1;
+    proc[pid].transState.state = RUNNING;
+    retVal.ret = SUCCESS;
+    return retVal;
+  }
+
+  proc[pid].transState.timestamp = ((~0ULL) - 1024);
+  proc[pid].transState.beginPC = 0;
+  proc[pid].stallCycle = 0;
+  proc[pid].transState.cycleFlag = 0;
 
-  map<RAddr, cacheState>::iterator it;
+  //!  We can't just decriment because we should be going back to the original begin, so proc[pid].tmDepth = 0
+  proc[pid].tmDepth=0;
+
+  tmPermCache::iterator it;
   for(it = permCache.begin(); it != permCache.end(); ++it)
     writeSetSize += it->second.writers.count(pid);
 
@@ -412,10 +1023,12 @@ struct GCMFinalRet transCoherence::abortEE(thread_ptr pthread, int tid)
 
 //   if((pthread->tmAbortMax < 0) || (pthread->tmAbortMax >= 0)&&(pthread->abortCount < pthread->tmAbortMax))
 //   {
-    transState[pid].state = ABORTING;    
+    proc[pid].transState.state = ABORTING;    
     retVal.ret = SUCCESS;
 
-	cyclesOnAbort[pid] += globalClock - cyclesOnBegin[pid];
+	proc[pid].cyclesOnAbort += globalClock - proc[pid].cyclesOnBegin;
+	transBD->abort(pid);
+	TransPrefetcher::txAbort(pid);
     return retVal;
 //   }
 //   else{
@@ -440,55 +1053,69 @@ struct GCMFinalRet transCoherence::commitEE(int pid, int tid)
   //!  Set the default BCFlag to 0, since the only other option for Commit is subsumed 2
   retVal.BCFlag = 0;
 
-  if(tmDepth[pid]>1)
+  if(proc[pid].tmDepth>1)
   {
-    //tmReport->registerCommit(transState[pid].utid,pid,tid,transState[pid].timestamp); // Register Commit in Report
-    tmDepth[pid]--;
-    retVal.ret = IGNORE;
+    //tmReport->registerCommit(proc[pid].transState.utid,pid,tid,proc[pid].transState.timestamp); // Register Commit in Report
+    if(closedNesting)
+    {
+      nestCommit(pid);
+      retVal.writeSetSize = 0;
+      retVal.ret = SUCCESS;
+    }
+    else
+      retVal.ret = IGNORE;
+    proc[pid].tmDepth--;
     //!  This commit is subsumed, set the BCFlag to 2
     retVal.BCFlag = 2;
-    retVal.tuid = transState[pid].utid;
+    retVal.tuid = proc[pid].transState.utid;
     return retVal;
   }
   else
   {
     //!  If we have already stalled for the commit, our state will be COMMITTING, Complete Commit
-    if(transState[pid].state == COMMITTING)
+    if(proc[pid].transState.state == COMMITTING)
     {
-       tmReport->registerCommit(transState[pid].utid,pid,tid,transState[pid].timestamp); //!  Register Commit in Report
+       tmReport->registerCommit(proc[pid].transState.utid,pid,tid,proc[pid].transState.timestamp); //!  Register Commit in Report
 
       int writeSetSize = 0;
-      transState[pid].timestamp = ((~0ULL) - 1024);
-      transState[pid].beginPC = 0;
-      stallCycle[pid] = 0;
-      transState[pid].cycleFlag = 0;
-      abortCount[pid] = 0;
-      tmDepth[pid] = 0;
-
-      map<RAddr, cacheState>::iterator it;
+      proc[pid].transState.timestamp = ((~0ULL) - 1024);
+      proc[pid].transState.beginPC = 0;
+      proc[pid].stallCycle = 0;
+      proc[pid].transState.cycleFlag = 0;
+      proc[pid].abortCount = 0;
+      proc[pid].tmDepth = 0;
+      nestClear(pid);
+
+      tmPermCache::iterator it;
       for(it = permCache.begin(); it != permCache.end(); ++it)
       {
         writeSetSize += it->second.writers.erase(pid);
         it->second.readers.erase(pid);
+        it->second.masks.erase(pid);
       }
 
+      overflowCommit(pid);
+
       retVal.writeSetSize = writeSetSize;
       retVal.ret = SUCCESS;
-      transState[pid].state = COMMITTED;
-      retVal.tuid = transState[pid].utid;
-	  cyclesOnCommit[pid] += globalClock - cyclesOnBegin[pid];
+      proc[pid].transState.state = COMMITTED;
+      retVal.tuid = proc[pid].transState.utid;
+	  proc[pid].cyclesOnCommit += globalClock - proc[pid].cyclesOnBegin;
+      transBD->commit(pid);
+      TransPrefetcher::txCommit(pid);
       return retVal;
     }
     else
     {
       int writeSetSize = 0;
-      map<RAddr, cacheState>::iterator it;
+      tmPermCache::iterator it;
       for(it = permCache.begin(); it != permCache.end(); ++it)
         writeSetSize += it->second.writers.count(pid);
-      transState[pid].state = COMMITTING;
+      proc[pid].transState.state = COMMITTING;
       retVal.writeSetSize = writeSetSize;
       retVal.ret = COMMIT_DELAY;
-      retVal.tuid = transState[pid].utid;
+      transBD->commitStall(pid);
+      retVal.tuid = proc[pid].transState.utid;
       return retVal;
     }
   }
@@ -513,39 +1140,45 @@ struct GCMFinalRet transCoherence::commitEE(int pid, int tid)
  * @param pid   Process ID
  * @param tid    Thread ID
  * @param raddr  Real address
+ * @param size   Bytes accessed
  * @return Coherency status
  */
-GCMRet transCoherence::readLL(int pid, int tid, RAddr raddr)
+GCMRet transCoherence::readLL(int pid, int tid, RAddr raddr, int size)
 {
   RAddr caddr = addrToCacheLine(raddr);
   GCMRet retval = SUCCESS;
 
   //!  If we have been forced to ABORT
-  if(transState[pid].state == DOABORT)
+  if(proc[pid].transState.state == DOABORT)
   {
-    tmReport->reportAbort(transState[pid].utid,pid, tid, abortReason[pid].first, abortReason[pid].second, abortReason[pid].second, transState[pid].timestamp, 0);
-    transState[pid].state = ABORTING;
+    reportForcedAbort(pid, tid);
+    proc[pid].transState.state = ABORTING;
     return ABORT;
   }
 
-  map<RAddr, cacheState>::iterator it;
+  tmPermCache::iterator it;
   it = permCache.find(caddr);
 
+  unsigned int word = wordBit(raddr, size);
+
   //!  If the cache line has been instantiated in our Map
   if(it != permCache.end()){
     struct cacheState per = it->second;
 
-      per.readers.insert(pid);
-      tmReport->registerLoad(transState[pid].utid, transState[pid].beginPC,pid,tid,raddr,caddr,transState[pid].timestamp);
+      if(per.readers.insert(pid).second)
+        nestAccess(pid, caddr, false);
+      recordWord(per, pid, word, false);
+      tmReport->registerLoad(proc[pid].transState.utid, proc[pid].transState.beginPC,pid,tid,raddr,caddr,proc[pid].transState.timestamp);
       permCache[caddr] = per;
-      transState[pid].state = RUNNING;
+      proc[pid].transState.state = RUNNING;
       retval = SUCCESS;
   }
   //!  We haven't, so create a new one
   else{
-      tmReport->registerLoad(transState[pid].utid, transState[pid].beginPC,pid,tid,raddr,caddr,transState[pid].timestamp);
-      permCache[caddr] = newReadState(pid);
-      transState[pid].state = RUNNING;
+      tmReport->registerLoad(proc[pid].transState.utid, proc[pid].transState.beginPC,pid,tid,raddr,caddr,proc[pid].transState.timestamp);
+      permCache[caddr] = newReadState(pid, word);
+      nestAccess(pid, caddr, false);
+      proc[pid].transState.state = RUNNING;
       retval = SUCCESS;
   }
 
@@ -566,38 +1199,44 @@ GCMRet transCoherence::readLL(int pid, int tid, RAddr raddr)
  * @param pid   Process ID
  * @param tid    Thread ID
  * @param raddr Real address
+ * @param size  Bytes accessed
  * @return Coherency status
  */
-GCMRet transCoherence::writeLL(int pid, int tid, RAddr raddr)
+GCMRet transCoherence::writeLL(int pid, int tid, RAddr raddr, int size)
 {
   RAddr caddr = addrToCacheLine(raddr);
   GCMRet retval = SUCCESS;
 
   //!  If we have been forced to ABORT
-  if(transState[pid].state == DOABORT)
+  if(proc[pid].transState.state == DOABORT)
   {
-    tmReport->reportAbort(transState[pid].utid,pid, tid, abortReason[pid].first, abortReason[pid].second, abortReason[pid].second,transState[pid].timestamp, 0);
-    transState[pid].state = ABORTING;
+    reportForcedAbort(pid, tid);
+    proc[pid].transState.state = ABORTING;
     return ABORT;
   }
 
-  map<RAddr, cacheState>::iterator it;
+  tmPermCache::iterator it;
   it = permCache.find(caddr);
 
+  unsigned int word = wordBit(raddr, size);
+
   //!  If the cache line has been instantiated in our Map
   if(it != permCache.end()){
     struct cacheState per = it->second;
-      per.writers.insert(pid);
-      tmReport->registerStore(transState[pid].utid,transState[pid].beginPC,pid,tid,raddr,caddr,transState[pid].timestamp);
+      if(per.writers.insert(pid).second)
+        nestAccess(pid, caddr, true);
+      recordWord(per, pid, word, true);
+      tmReport->registerStore(proc[pid].transState.utid,proc[pid].transState.beginPC,pid,tid,raddr,caddr,proc[pid].transState.timestamp);
       permCache[caddr] = per;
-      transState[pid].state = RUNNING;
+      proc[pid].transState.state = RUNNING;
       retval = SUCCESS;
   }
   //!  We haven't, so create a new one
   else{
-      tmReport->registerStore(transState[pid].utid,transState[pid].beginPC,pid,tid,raddr,caddr,transState[pid].timestamp);
-      permCache[caddr] = newWriteState(pid);
-      transState[pid].state = RUNNING;
+      tmReport->registerStore(proc[pid].transState.utid,proc[pid].transState.beginPC,pid,tid,raddr,caddr,proc[pid].transState.timestamp);
+      permCache[caddr] = newWriteState(pid, word);
+      nestAccess(pid, caddr, true);
+      proc[pid].transState.state = RUNNING;
       retval = SUCCESS;
   }
 
@@ -616,46 +1255,64 @@ GCMFinalRet transCoherence::beginLL(int pid, icode_ptr picode)
 {
   struct GCMFinalRet retVal;
 
-  //!  Subsume all nested transactions for now
-  if(tmDepth[pid]>0)
+  //!  Subsume nested transactions, unless they are closed nested
+  if(proc[pid].tmDepth>0)
   {
-    //tmReport->registerBegin(transState[pid].utid,pid,tid,transState[pid].timestamp);
-    tmDepth[pid]++;
-    retVal.ret = IGNORE;
+    //tmReport->registerBegin(proc[pid].transState.utid,pid,tid,proc[pid].transState.timestamp);
+    proc[pid].tmDepth++;
+    if(closedNesting)
+    {
+      nestOpen(pid);
+      retVal.ret = SUCCESS;
+    }
+    else
+      retVal.ret = IGNORE;
     //!  This begin is subsumed, set the BCFlag to 2
     retVal.BCFlag = 2;
-    retVal.tuid = transState[pid].utid;
+    retVal.tuid = proc[pid].transState.utid;
     return retVal;
   }
   else
   {
     //!  If we had just aborted, we need to now invalidate all the memory addresses we touched
-    if(transState[pid].state == ABORTING)
+    if(proc[pid].transState.state == ABORTING)
+    {
+      proc[pid].transState.state = ABORTED;
+      proc[pid].abortCount++;
+    }
+
+    //!  Another processor runs serialized after an overflow
+    if(!serialBegin(pid))
     {
-      transState[pid].state = ABORTED;
-      abortCount[pid]++;
+      retVal.abortCount = 1;
+      retVal.ret = BACKOFF;
+      transBD->backoff(pid);
+      return retVal;
     }
 
       //!  Pass whether this is the begining of an aborted replay back to the context
-      if(abortCount[pid]>0)
+      if(proc[pid].abortCount>0)
          retVal.BCFlag = 1;  //!  Replay
       else
         retVal.BCFlag = 0;
 
-      transState[pid].timestamp = globalClock;
-      transState[pid].beginPC = picode->addr;
-      transState[pid].cycleFlag = 0;
-      transState[pid].state = RUNNING;
-      transState[pid].utid = transCoherence::utid++;
+      proc[pid].transState.timestamp = globalClock;
+      proc[pid].transState.beginPC = picode->addr;
+      proc[pid].transState.cycleFlag = 0;
+      proc[pid].transState.state = RUNNING;
+      proc[pid].transState.utid = transCoherence::utid++;
 
 
-      tmDepth[pid]++;
+      proc[pid].tmDepth++;
+      nestClear(pid);
 
-      tmReport->registerBegin(transState[pid].utid,pid,picode->immed,picode->addr,transState[pid].timestamp);
+      tmReport->registerBegin(proc[pid].transState.utid,pid,picode->immed,picode->addr,proc[pid].transState.timestamp);
+      transBD->begin(pid);
+      TransPrefetcher::txBegin(pid, picode->addr);
 
       retVal.ret = SUCCESS;
-      retVal.tuid = transState[pid].utid;
-	  cyclesOnBegin[pid] = globalClock;
+      retVal.tuid = proc[pid].transState.utid;
+	  proc[pid].cyclesOnBegin = globalClock;
     }
 
   return retVal;
@@ -676,21 +1333,38 @@ struct GCMFinalRet transCoherence::abortLL(thread_ptr pthread, int tid)
 
   int pid = pthread->getPid();
   int writeSetSize = 0;
-  transState[pid].timestamp = ((~0ULL) - 1024);
-  transState[pid].beginPC = 0;
-  stallCycle[pid] = 0;
-  transState[pid].cycleFlag = 0;
 
-  //!  We can't just decriment because we should be going back to the original begin, so tmDepth[pid] = 0
-  tmDepth[pid]=0;
+  //!  Closed nesting: only the nested levels that hold the conflicting line restart
+  retVal.level = restartLevel(pid);
+  proc[pid].abortLevel = 0;
+  if(retVal.level > 1)
+  {
+    nestWasted(pid, retVal.level);
+    nestRollback(pid, retVal.level);
+    retVal.writeSetSize = 0;
+    proc[pid].tmDepth = retVal.level - 1;
+    proc[pid].transState.state = RUNNING;
+    retVal.ret = SUCCESS;
+    return retVal;
+  }
+
+  proc[pid].transState.timestamp = ((~0ULL) - 1024);
+  proc[pid].transState.beginPC = 0;
+  proc[pid].stallCycle = 0;
+  proc[pid].transState.cycleFlag = 0;
+
+  //!  We can't just decriment because we should be going back to the original begin, so proc[pid].tmDepth = 0
+  proc[pid].tmDepth=0;
 
   //!  Write set size doesn't matter for Lazy/Lazy abort
   retVal.writeSetSize = 0;
 
-  transState[pid].state = ABORTING;    
+  proc[pid].transState.state = ABORTING;    
   retVal.ret = SUCCESS;
 
-  cyclesOnAbort[pid] += globalClock - cyclesOnBegin[pid];
+  proc[pid].cyclesOnAbort += globalClock - proc[pid].cyclesOnBegin;
+  transBD->abort(pid);
+  TransPrefetcher::txAbort(pid);
   return retVal;
 
 
@@ -712,44 +1386,52 @@ struct GCMFinalRet transCoherence::commitLL(int pid, int tid)
   retVal.BCFlag = 0;
 
   //!  If we have been forced to ABORT
-  if(transState[pid].state == DOABORT)
+  if(proc[pid].transState.state == DOABORT)
   {
     retVal.ret = ABORT;
-    transState[pid].state = ABORTING;
-    tmReport->reportAbort(transState[pid].utid,pid, tid, abortReason[pid].first, abortReason[pid].second, abortReason[pid].second,transState[pid].timestamp, 0);
+    proc[pid].transState.state = ABORTING;
+    reportForcedAbort(pid, tid);
     return retVal;
   }
 
 
-  if(tmDepth[pid]>1)
+  if(proc[pid].tmDepth>1)
   {
-    //tmReport->registerCommit(transState[pid].utid,pid,tid,transState[pid].timestamp); // Register Commit in Report
-    tmDepth[pid]--;
-    retVal.ret = IGNORE;
+    //tmReport->registerCommit(proc[pid].transState.utid,pid,tid,proc[pid].transState.timestamp); // Register Commit in Report
+    if(closedNesting)
+    {
+      nestCommit(pid);
+      retVal.writeSetSize = 0;
+      retVal.ret = SUCCESS;
+    }
+    else
+      retVal.ret = IGNORE;
+    proc[pid].tmDepth--;
     //!  This is a subsumed commit, set BCFlag = 2
     retVal.BCFlag = 2;
-    retVal.tuid = transState[pid].utid;
+    retVal.tuid = proc[pid].transState.utid;
     return retVal;
   }
   else
   {
     //!  If we have already stalled for the commit, our state will be COMMITTING, Complete Commit
-    if(transState[pid].state == COMMITTING)
+    if(proc[pid].transState.state == COMMITTING)
     {
-       tmReport->registerCommit(transState[pid].utid,pid,tid,transState[pid].timestamp); //!  Register Commit in Report
+       tmReport->registerCommit(proc[pid].transState.utid,pid,tid,proc[pid].transState.timestamp); //!  Register Commit in Report
 
       int writeSetSize = 0;
       int didWrite = 0;
-      transState[pid].timestamp = ((~0ULL) - 1024);
-      transState[pid].beginPC = 0;
-      stallCycle[pid] = 0;
-      transState[pid].cycleFlag = 0;
-      abortCount[pid] = 0;
-      tmDepth[pid] = 0;
+      proc[pid].transState.timestamp = ((~0ULL) - 1024);
+      proc[pid].transState.beginPC = 0;
+      proc[pid].stallCycle = 0;
+      proc[pid].transState.cycleFlag = 0;
+      proc[pid].abortCount = 0;
+      proc[pid].tmDepth = 0;
+      nestClear(pid);
 
 
-      map<RAddr, cacheState>::iterator it;
-      set<int>::iterator setIt;
+      tmPermCache::iterator it;
+      tmSharers::iterator setIt;
 
       for(it = permCache.begin(); it != permCache.end(); ++it)
       {
@@ -760,57 +1442,100 @@ struct GCMFinalRet transCoherence::commitLL(int pid, int tid)
         {
           //!  Increase our write set
           writeSetSize++;
+
+          //!  The words we wrote (the whole line at line granularity)
+          unsigned int words = ~0U;
+          tmMasks::iterator mIt = it->second.masks.find(pid);
+          if(mIt != it->second.masks.end())
+            words = mIt->second.write;
+
+          vector<int> aborted;
+
           //!  Abort all who wrote to this
-          for(setIt = it->second.writers.begin(); setIt != it->second.writers.end(); ++setIt)
-            if(*setIt != pid)
+          for(setIt = it->second.writers.begin(); setIt != it->second.writers.end(); )
+          {
+            int other = *setIt++;
+            if(other == pid)
+              continue;
+            if(!wordsOverlap(it->second, other, words, true))
             {
-              transState[*setIt].state = DOABORT;
-              abortReason[*setIt].first =  pid;
-              abortReason[*setIt].second = (RAddr)it->first;
+              nAvoidedConflicts++;
+              continue;
             }
+            forceAbort(other, pid, it->first, nestLevel(other, it->first));
+            aborted.push_back(other);
+          }
           //!  Abort all who read from this
-          for(setIt = it->second.readers.begin(); setIt != it->second.readers.end(); ++setIt)
-            if(*setIt != pid)
+          for(setIt = it->second.readers.begin(); setIt != it->second.readers.end(); )
+          {
+            int other = *setIt++;
+            if(other == pid)
+              continue;
+            if(!wordsOverlap(it->second, other, words, false))
             {
-              transState[*setIt].state = DOABORT;
-              abortReason[*setIt].first =  pid;
-              abortReason[*setIt].second = (RAddr)it->first;
+              nAvoidedConflicts++;
+              continue;
             }
-
-          it->second.writers.clear();
-          it->second.readers.clear();
+            forceAbort(other, pid, it->first, nestLevel(other, it->first));
+            aborted.push_back(other);
+          }
+
+          //!  With word masks the sharers of other words stay
+          if(wordConflicts)
+          {
+            aborted.push_back(pid);
+            for(size_t i = 0; i < aborted.size(); i++)
+            {
+              it->second.writers.erase(aborted[i]);
+              it->second.readers.erase(aborted[i]);
+              it->second.masks.erase(aborted[i]);
+            }
+          }
+          else
+          {
+            it->second.writers.clear();
+            it->second.readers.clear();
+          }
         }
         else
+        {
           it->second.readers.erase(pid);
+          it->second.masks.erase(pid);
+        }
       }
 
       currentCommitter = -1;  //!  Allow other transaction to commit again
+      overflowCommit(pid);
+
       retVal.writeSetSize = writeSetSize;
       retVal.ret = SUCCESS;
-      transState[pid].state = COMMITTED;
-      retVal.tuid = transState[pid].utid;
-  	  cyclesOnCommit[pid] += globalClock - cyclesOnBegin[pid];
+      proc[pid].transState.state = COMMITTED;
+      retVal.tuid = proc[pid].transState.utid;
+  	  proc[pid].cyclesOnCommit += globalClock - proc[pid].cyclesOnBegin;
+      transBD->commit(pid);
+      TransPrefetcher::txCommit(pid);
       return retVal;
     }
     else if(currentCommitter >= 0)
     {
       retVal.ret = NACK;
-      transState[pid].state = NACKED;
-      tmReport->reportNackCommit(transState[pid].utid,pid, tid, currentCommitter, transState[pid].timestamp, transState[currentCommitter].timestamp);
+      proc[pid].transState.state = NACKED;
+      tmReport->reportNackCommit(proc[pid].transState.utid,pid, tid, currentCommitter, proc[pid].transState.timestamp, proc[currentCommitter].transState.timestamp);
       return retVal;
     }
     else
     {
-      tmReport->reportNackCommitFN(transState[pid].utid,pid,tid,transState[pid].timestamp); //!  Register Commit in Report
+      tmReport->reportNackCommitFN(proc[pid].transState.utid,pid,tid,proc[pid].transState.timestamp); //!  Register Commit in Report
       int writeSetSize = 0;
       currentCommitter = pid; //!  Stop other transactions from being able to commit
-      map<RAddr, cacheState>::iterator it;
+      tmPermCache::iterator it;
       for(it = permCache.begin(); it != permCache.end(); ++it)
         writeSetSize += it->second.writers.count(pid);
-      transState[pid].state = COMMITTING;
+      proc[pid].transState.state = COMMITTING;
       retVal.writeSetSize = writeSetSize;
       retVal.ret = COMMIT_DELAY;
-      retVal.tuid = transState[pid].utid;
+      transBD->commitStall(pid);
+      retVal.tuid = proc[pid].transState.utid;
       return retVal;
     }
   }
@@ -23,15 +23,23 @@
 
 #include <map>
 #include <set>
+#include <vector>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
 #include "icode.h"
+#include "SelfProf.h"
+#include "HugePage.h"
 
-#define MAX_CPU_COUNT 2048
+//! Per processor TM state is allocated on (and padded to) cache line boundaries
+#define TM_LINE_SIZE 64
 
 using namespace std;
 
 enum GCMRet { SUCCESS, NACK, ABORT, IGNORE, COMMIT_DELAY, BACKOFF };
 enum condition {INVALID, RUNNING, NACKED, ABORTING, ABORTED, COMMITTING, COMMITTED, DOABORT};
 enum perState { I, W, R };
+enum overflowPolicy { OVERFLOW_SERIALIZE, OVERFLOW_UNBOUNDED };
 
 typedef uintptr_t RAddr;
 typedef struct icode *icode_ptr;
@@ -42,17 +50,42 @@ struct GCMFinalRet{
   int writeSetSize;
   int abortCount;
   long long tuid;
+  int level;          //!< Abort: nesting level that restarts (1 is the outermost)
 
    //!< This allows tagging of DINST instructions with information as to whether the transaction is new, replayed, or subsumed
   int BCFlag;
 };
 
+//! The conflict tables are randomly accessed and grow large, their nodes live on huge pages
+typedef set<int, less<int>, HugePageAllocator<int> > tmSharers;
+
+//! Words of a line read/written by one processor (wordConflicts only)
+struct wordMasks{
+  unsigned int read;
+  unsigned int write;
+};
+
+typedef map<int, wordMasks, less<int>, HugePageAllocator<pair<const int, wordMasks> > > tmMasks;
+
 struct cacheState{
   perState state;
-  set<int> readers;
-  set<int> writers;
+  tmSharers readers;
+  tmSharers writers;
+  tmMasks   masks;
+};
+
+typedef map<RAddr, cacheState, less<RAddr>, HugePageAllocator<pair<const RAddr, cacheState> > > tmPermCache;
+
+//! Lines a nesting level added to the read/write sets (closedNesting only)
+struct nestDelta{
+  vector<RAddr> reads;
+  vector<RAddr> writes;
+  Time_t        begin;                         //!< Cycle the level began
+  Time_t        pending;                       //!< Transactional cycles of transBD when the level began
 };
 
+typedef vector<nestDelta> tmNestLevels;
+
 struct tmState{
   condition state;
   Time_t timestamp;
@@ -61,6 +94,43 @@ struct tmState{
   RAddr beginPC;
 };
 
+struct tmProcState{
+  struct tmState  transState;
+  Time_t          stallCycle;
+  int             tmDepth;
+  int             abortCount;
+  pair<int,RAddr> abortReason;
+  int             overflowed;     //!< Retrying after an overflow abort
+  int             abortLevel;     //!< Lowest nesting level hit by a forced abort (0 if none)
+
+  Time_t          cyclesOnCommit;
+  Time_t          cyclesOnAbort;
+  Time_t          cyclesOnNormal;
+  Time_t          cyclesOnBegin;
+} __attribute__((aligned(TM_LINE_SIZE)));
+
+int tmProcCount();
+
+/**
+ * @ingroup transCoherence
+ * @brief   Allocates n default constructed, cache line aligned entries. They live
+ *          for the whole simulation.
+ */
+template<class T> T *tmAllocProcState(int n)
+{
+  void *mem;
+  if(posix_memalign(&mem, TM_LINE_SIZE, n * sizeof(T)))
+  {
+    fprintf(stderr,"Unable to allocate the per processor TM state\n");
+    exit(1);
+  }
+
+  T *procState = (T *)mem;
+  for(int i = 0; i < n; i++)
+    new (&procState[i]) T();
+  return procState;
+}
+
 /**
  * @ingroup transCoherence
  * @brief   TM Coherency Manager
@@ -70,34 +140,30 @@ struct tmState{
  */
 class transCoherence{
   public:
-	Time_t cyclesOnCommit[MAX_CPU_COUNT];
-	Time_t cyclesOnAbort[MAX_CPU_COUNT];
-	Time_t cyclesOnNormal[MAX_CPU_COUNT];
-	Time_t cyclesOnBegin[MAX_CPU_COUNT];
     // Constructor
     transCoherence();
     transCoherence(FILE *out, int conflicts, int versioning, int cacheLineSize);
 
-    GCMRet readEE(int pid, int tid, RAddr raddr);
-    GCMRet writeEE(int pid, int tid, RAddr raddr);
+    GCMRet readEE(int pid, int tid, RAddr raddr, int size);
+    GCMRet writeEE(int pid, int tid, RAddr raddr, int size);
     struct GCMFinalRet abortEE(thread_ptr pthread, int tid);
     struct GCMFinalRet commitEE(int pid, int tid);
     struct GCMFinalRet beginEE(int pid, icode_ptr picode);
 
-    GCMRet readLL(int pid, int tid, RAddr raddr);
-    GCMRet writeLL(int pid, int tid, RAddr raddr);
+    GCMRet readLL(int pid, int tid, RAddr raddr, int size);
+    GCMRet writeLL(int pid, int tid, RAddr raddr, int size);
     struct GCMFinalRet abortLL(thread_ptr pthread, int tid);
     struct GCMFinalRet commitLL(int pid, int tid);
     struct GCMFinalRet beginLL(int pid, icode_ptr picode);
 
-    GCMRet read(int pid, int tid, RAddr raddr);
-    GCMRet write(int pid, int tid, RAddr raddr);
+    GCMRet read(int pid, int tid, RAddr raddr, int size = 4);
+    GCMRet write(int pid, int tid, RAddr raddr, int size = 4);
     struct GCMFinalRet abort(thread_ptr pthread, int tid);
     struct GCMFinalRet commit(int pid, int tid);
     struct GCMFinalRet begin(int pid, icode_ptr picode);
 
-    GCMRet (transCoherence::*readPtr)(int pid, int tid, RAddr raddr);
-    GCMRet (transCoherence::*writePtr)(int pid, int tid, RAddr raddr);
+    GCMRet (transCoherence::*readPtr)(int pid, int tid, RAddr raddr, int size);
+    GCMRet (transCoherence::*writePtr)(int pid, int tid, RAddr raddr, int size);
     struct GCMFinalRet (transCoherence::*abortPtr)(thread_ptr pthread, int tid);
     struct GCMFinalRet (transCoherence::*commitPtr)(int pid, int tid);
     struct GCMFinalRet (transCoherence::*beginPtr)(int pid,icode_ptr picode);
@@ -105,40 +171,96 @@ class transCoherence{
     bool checkAbort(int pid, int tid);
     int  getVersioning();
 
+    bool isPrivate(thread_ptr pthread, RAddr raddr);
+    void addPrivate(RAddr begin, RAddr end);
+    void removePrivate(RAddr begin);
+
+    void abortSharers(int pid, RAddr raddr);
+    void dropAttempt(int pid);
+
+    bool isBounded() { return boundedCache; }
+    long long getUtid(int pid) { return proc[pid].transState.utid; }
+    bool tracksOverflow(int pid, int utid);
+    void overflow(int pid, int utid, RAddr caddr);
+    void report(FILE *out);
+
     void stallUntil(int cpu,Time_t stall){
-      stallCycle[cpu] = globalClock + stall;
+      proc[cpu].stallCycle = globalClock + stall;
     }
 
     bool checkStall(int cpu){
       if(cpu < 0)
         return false;
       else
-        return stallCycle[cpu] >= globalClock;
+        return proc[cpu].stallCycle >= globalClock;
     }
 
     bool checkStallState(int cpu)
     {
-      return transState[cpu].state == NACKED;
+      return proc[cpu].transState.state == NACKED;
+    }
+
+    Time_t getCyclesOnCommit(int cpu){
+      return proc[cpu].cyclesOnCommit;
+    }
+
+    Time_t getCyclesOnAbort(int cpu){
+      return proc[cpu].cyclesOnAbort;
+    }
+
+    int getTransDepth(int cpu){
+      return proc[cpu].tmDepth;
+    }
+
+    //! Aborts of the current transaction since its last commit
+    int getAbortCount(int cpu){
+      return proc[cpu].abortCount;
     }
 
 
   private:
 
     RAddr addrToCacheLine(RAddr raddr);
-    struct cacheState newReadState(int pid);
-    struct cacheState newWriteState(int pid);
+    bool  isPrivateAddr(thread_ptr pthread, RAddr raddr);
+    struct cacheState newReadState(int pid, unsigned int word);
+    struct cacheState newWriteState(int pid, unsigned int word);
+    unsigned int wordBit(RAddr raddr, int size = 4);
+    int   conflictWith(struct cacheState &per, tmSharers &sharers, int pid, unsigned int word, bool write, bool &lineConflict);
+    bool  wordsOverlap(struct cacheState &per, int other, unsigned int words, bool write);
+    void  recordWord(struct cacheState &per, int pid, unsigned int word, bool write);
+    bool  serialBegin(int pid);
+    void  overflowCommit(int pid);
+    void  forceAbort(int pid, int by, RAddr caddr, int level);
+    void  reportForcedAbort(int pid, int tid);
+    int   restartLevel(int pid);
+    int   nestLevel(int pid, RAddr caddr);
+    void  nestAccess(int pid, RAddr caddr, bool write);
+    void  nestOpen(int pid);
+    void  nestCommit(int pid);
+    int   nestRollback(int pid, int level);
+    void  nestClear(int pid);
+    void  nestWasted(int pid, int level);
+    void  releaseLines(int pid);
 
     int conflictDetection;
     int versioning;
     int cacheLineSize;
+    int filterPrivate;                             //!< Private accesses are not tracked
+    int wordConflicts;                             //!< Conflicts at word granularity (per processor masks)
+    unsigned long long nAvoidedConflicts;          //!< Line conflicts that were not word conflicts
 
-    int tmDepth[MAX_CPU_COUNT];
-
-    int abortCount[MAX_CPU_COUNT];
+    int closedNesting;                             //!< Nested transactions abort/commit on their own
+    vector<tmNestLevels> nestLevels;               //!< Per processor, read/write set delta of each level
 
-    pair<int,RAddr> abortReason[MAX_CPU_COUNT];
+    int boundedCache;                              //!< Transactions must fit in the private SMPCache
+    int overflowFallback;                          //!< Retry policy after an overflow (overflowPolicy)
+    int serialOwner;                               //!< PID running serialized after an overflow (-1 if none)
+    unsigned long long nOverflows;
+    unsigned long long nSerialized;
+    unsigned long long nUnbounded;
 
-    Time_t stallCycle[MAX_CPU_COUNT];
+    int nProcs;                                    //!< Entries in proc
+    struct tmProcState *proc;                      //!< Per processor state, indexed by pid
 
     int currentCommitter;                          //!< PID of the currently committing processor
 
@@ -146,34 +268,50 @@ class transCoherence{
 
     FILE *out;
 
-    map<RAddr, cacheState>     permCache;          //!< The cache ownership
-    struct tmState             transState[MAX_CPU_COUNT];
+    tmPermCache                permCache;          //!< The cache ownership
+    map<RAddr, RAddr>          privateRegions;     //!< Regions marked private (begin -> end)
 };
 
 
 inline RAddr transCoherence::addrToCacheLine(RAddr raddr){
-    while(raddr%cacheLineSize != 0)
-      raddr = raddr-1;
-  return raddr;
+  return raddr & ~(RAddr)(cacheLineSize - 1);
+}
+
+//! Bits of the words of an access of size bytes at raddr in its line
+inline unsigned int transCoherence::wordBit(RAddr raddr, int size){
+  unsigned int words = (size + 3) >> 2;
+  return ((1U << words) - 1) << ((raddr & (cacheLineSize - 1)) >> 2);
 }
 
-inline GCMRet transCoherence::read(int pid, int tid, RAddr raddr){
-  return (this->*readPtr)(pid, tid, raddr);
+//! Level a forced abort restarts from, 1 (the outermost) unless only nested levels hold the line
+inline int transCoherence::restartLevel(int pid){
+  if(!closedNesting || proc[pid].abortLevel < 2 || proc[pid].abortLevel > proc[pid].tmDepth)
+    return 1;
+  return proc[pid].abortLevel;
 }
 
-inline GCMRet transCoherence::write(int pid, int tid, RAddr raddr){
-  return (this->*writePtr)(pid, tid, raddr);
+inline GCMRet transCoherence::read(int pid, int tid, RAddr raddr, int size){
+  SELFPROF_PHASE(TransCoherence);
+  return (this->*readPtr)(pid, tid, raddr, size);
+}
+
+inline GCMRet transCoherence::write(int pid, int tid, RAddr raddr, int size){
+  SELFPROF_PHASE(TransCoherence);
+  return (this->*writePtr)(pid, tid, raddr, size);
 }
 
 inline struct GCMFinalRet transCoherence::abort(thread_ptr pthread, int tid){
+  SELFPROF_PHASE(TransCoherence);
   return (this->*abortPtr)(pthread, tid);
 }
 
 inline struct GCMFinalRet transCoherence::commit(int pid, int tid){
+  SELFPROF_PHASE(TransCoherence);
   return (this->*commitPtr)(pid, tid);
 }
 
 inline struct GCMFinalRet transCoherence::begin(int pid, icode_ptr picode){
+  SELFPROF_PHASE(TransCoherence);
   return (this->*beginPtr)(pid, picode);
 }
 
@@ -181,6 +319,34 @@ inline int transCoherence::getVersioning(){
   return versioning;
 }
 
+/**
+ * @ingroup transCoherence
+ * @brief   Is utid the running transaction of pid, and can it still overflow?
+ *
+ * The timing model (SMPCache) runs behind the functional one, its marks may
+ * belong to a transaction that already finished. Retries after an overflow
+ * are not tracked (they run serialized or unbounded).
+ */
+inline bool transCoherence::tracksOverflow(int pid, int utid){
+  if(!boundedCache || pid < 0 || pid >= nProcs)
+    return false;
+  if(proc[pid].tmDepth == 0 || proc[pid].overflowed || (int)proc[pid].transState.utid != utid)
+    return false;
+  return proc[pid].transState.state == RUNNING || proc[pid].transState.state == NACKED;
+}
+
+/**
+ * @ingroup transCoherence
+ * @brief   Accesses to the thread's own stack or to a region marked private
+ *          (sesc_tm_private) are only buffered by the transaction, they never
+ *          conflict.
+ */
+inline bool transCoherence::isPrivate(thread_ptr pthread, RAddr raddr){
+  if(!filterPrivate)
+    return false;
+  return isPrivateAddr(pthread, raddr);
+}
+
 extern transCoherence *transGCM;
 extern Time_t globalClock;
 #endif
@@ -194,12 +360,24 @@ extern Time_t globalClock;
  * about the write set size for aborts/commits
  */
 
+/**
+ * @struct  tmProcState
+ * @ingroup transCoherence
+ * @brief   Per processor TM state, one cache line aligned entry per processor
+ */
+
 /**
  * @struct  cacheState
  * @ingroup transCoherence
  * @brief   Cache Line State Container (R/W)
  */
 
+/**
+ * @struct  nestDelta
+ * @ingroup transCoherence
+ * @brief   Lines first read/written by a nested transaction, released on its partial abort
+ */
+
 /**
  * @struct  tmState
  * @ingroup transCoherence
@@ -40,6 +40,7 @@ transactionContext::transactionContext()
  * @param picode Instruction code
  */
 transactionContext::transactionContext(thread_ptr pthread, icode_ptr picode)
+  : cache(pthread->getPid(), transGCM->getVersioning() == 1)
 {
   nackStallCycles = SescConf->getInt("TransactionalMemory","nackStallCycles");
 
@@ -110,7 +111,11 @@ void transactionContext::beginTransaction(thread_ptr pthread, icode_ptr picode)
     this->reg[32] = pthread->reg[32];
     this->depth = pthread->getTMdepth();
     if(this->depth > 0)
+    {
+      //! Closed nesting, the stores are buffered on top of the parent's
       this->parent = pthread->transContext;
+      this->cache.nest(&this->parent->cache);
+    }
     else
       this->parent = NULL;
 
@@ -166,39 +171,66 @@ void transactionContext::abortTransaction(thread_ptr pthread)
   struct GCMFinalRet retVal = transGCM->abort(pthread,this->tid);
 
   if(retVal.ret == SUCCESS){
-    int i;
-    pthread->abortCount++;
-    pthread->decTMdepth();
-
-    pthread->fcr31 = this->fcr31;
-    pthread->fcr0 = this->fcr0;
-    pthread->lo = this->lo;
-    pthread->hi = this->hi;
+    transactionContext *restart = this;
 
-    for(i = 0; i < 32; i++){
-      pthread->reg[i] = this->reg[i];
-      pthread->fp[i] = this->reg[i];
+    //! Closed nesting: the levels inside the one that restarts are dropped
+    while(restart->depth >= retVal.level)
+    {
+      transactionContext *child = restart;
+      restart = child->parent;
+      child->cache.rollback();
+      pthread->decTMdepth();
+      delete(child);
     }
-    pthread->reg[32] = this->reg[32];
-
-    if(pthread->getTMdepth() > 0)
-      pthread->transContext = this->parent;
-    else
-      pthread->transContext = NULL;
-
-      createStall(pthread,getRndDelay(abortBaseStallCycles + (abortVarStallCycles * retVal.writeSetSize)));
-
-      pthread->setPCIcode(tmBeginCode);
 
-      pthread->tmAborting = 1;
-
-      delete(this);
+    restart->restartTransaction(pthread, retVal.writeSetSize);
   }
   else{
       //pthread->setPCIcode(picode->next);
   }
 }
 
+/**
+ * @ingroup transContext
+ * @brief   Rolls back the transaction and restarts it from its begin
+ *
+ * @param pthread SESC thread pointer
+ * @param writeSetSize Lines written by the transaction (abort stall)
+ */
+void transactionContext::restartTransaction(thread_ptr pthread, int writeSetSize)
+{
+  int i;
+  pthread->abortCount++;
+  pthread->decTMdepth();
+
+  pthread->fcr31 = this->fcr31;
+  pthread->fcr0 = this->fcr0;
+  pthread->lo = this->lo;
+  pthread->hi = this->hi;
+
+  for(i = 0; i < 32; i++){
+    pthread->reg[i] = this->reg[i];
+    pthread->fp[i] = this->fp[i];
+  }
+  pthread->reg[32] = this->reg[32];
+
+  //! Eager versioning: put back the old memory values
+  this->cache.rollback();
+
+  if(pthread->getTMdepth() > 0)
+    pthread->transContext = this->parent;
+  else
+    pthread->transContext = NULL;
+
+  createStall(pthread,getRndDelay(abortBaseStallCycles + (abortVarStallCycles * writeSetSize)));
+
+  pthread->setPCIcode(tmBeginCode);
+
+  pthread->tmAborting = 1;
+
+  delete(this);
+}
+
 /**
  * @ingroup transContext
  * @brief   Commits a transaction
@@ -233,6 +265,18 @@ void transactionContext::commitTransaction(thread_ptr pthread, icode_ptr picode)
     pthread->tmNacking = 0;
     abortTransaction(pthread);
   }
+  //! Closed nesting: a nested transaction commits into its parent
+  else if(this->parent)
+  {
+    pthread->decTMdepth();
+    this->cache.merge();
+
+    pthread->tmBCFlag = retVal.BCFlag;
+    pthread->setPCIcode(picode->next);
+    pthread->transContext = this->parent;
+
+    delete(this);
+  }
   //! If we have already delayed, go ahead and finalize commit in memory
   else
   {
@@ -270,12 +314,17 @@ void transactionContext::commitTransaction(thread_ptr pthread, icode_ptr picode)
 
         }
       )
+    //! Eager versioning: memory is already up to date
+    this->cache.truncate();
+
     pthread->tmBCFlag = retVal.BCFlag;
     //!Move instruction pointer to next instruction
     pthread->setPCIcode(picode->next);
 
     if(pthread->tmDepth > 0)
       pthread->transContext = this->parent;
+    else
+      pthread->tmDispatch = 0; // Back to the plain ops
 
     delete(this);
 
@@ -292,7 +341,7 @@ void transactionContext::commitTransaction(thread_ptr pthread, icode_ptr picode)
  */
 void transactionContext::cacheLW(thread_ptr pthread, icode_ptr picode, RAddr raddr)
 {
-  GCMRet retval = transGCM->read(this->pid,this->tid,raddr);
+  GCMRet retval = gcmRead(pthread,raddr);
 
   switch(retval)
   {
@@ -326,7 +375,7 @@ void transactionContext::cacheLW(thread_ptr pthread, icode_ptr picode, RAddr rad
  */
 void transactionContext::cacheLUH(thread_ptr pthread, icode_ptr picode, RAddr raddr)
 {
-  GCMRet retval = transGCM->read(this->pid,this->tid,raddr);
+  GCMRet retval = gcmRead(pthread,raddr);
   switch(retval)
   {
     case NACK:
@@ -359,7 +408,7 @@ void transactionContext::cacheLUH(thread_ptr pthread, icode_ptr picode, RAddr ra
  */
 void transactionContext::cacheLHW(thread_ptr pthread, icode_ptr picode, RAddr raddr)
 {
-  GCMRet retval = transGCM->read(this->pid,this->tid,raddr);
+  GCMRet retval = gcmRead(pthread,raddr);
   switch(retval)
   {
     case NACK:
@@ -392,7 +441,7 @@ void transactionContext::cacheLHW(thread_ptr pthread, icode_ptr picode, RAddr ra
  */
 void transactionContext::cacheLUB(thread_ptr pthread, icode_ptr picode, RAddr raddr)
 {
-  GCMRet retval = transGCM->read(this->pid,this->tid,raddr);
+  GCMRet retval = gcmRead(pthread,raddr);
   switch(retval)
   {
     case NACK:
@@ -425,7 +474,7 @@ void transactionContext::cacheLUB(thread_ptr pthread, icode_ptr picode, RAddr ra
  */
 void transactionContext::cacheLB(thread_ptr pthread, icode_ptr picode, RAddr raddr)
 {
-  GCMRet retval = transGCM->read(this->pid,this->tid,raddr);
+  GCMRet retval = gcmRead(pthread,raddr);
   switch(retval)
   {
     case NACK:
@@ -458,7 +507,7 @@ void transactionContext::cacheLB(thread_ptr pthread, icode_ptr picode, RAddr rad
  */
 void transactionContext::cacheLWFP(thread_ptr pthread, icode_ptr picode, RAddr raddr)
 {
-  GCMRet retval = transGCM->read(this->pid,this->tid,raddr);
+  GCMRet retval = gcmRead(pthread,raddr);
   switch(retval)
   {
     case NACK:
@@ -491,7 +540,7 @@ void transactionContext::cacheLWFP(thread_ptr pthread, icode_ptr picode, RAddr r
 */
 void transactionContext::cacheLDFP(thread_ptr pthread, icode_ptr picode, RAddr raddr)
 {
-  GCMRet retval = transGCM->read(this->pid,this->tid,raddr);
+  GCMRet retval = gcmRead(pthread,raddr,8);
   switch(retval)
   {
     case NACK:
@@ -526,7 +575,7 @@ void transactionContext::cacheLDFP(thread_ptr pthread, icode_ptr picode, RAddr r
  */
 void transactionContext::cacheSB(thread_ptr pthread, icode_ptr picode, RAddr raddr, IntRegValue value)
 {
-  GCMRet retval = transGCM->write(this->pid,this->tid,raddr);
+  GCMRet retval = gcmWrite(pthread,raddr);
   switch(retval)
   {
     case NACK:
@@ -560,7 +609,7 @@ void transactionContext::cacheSB(thread_ptr pthread, icode_ptr picode, RAddr rad
 */
 void transactionContext::cacheSHW(thread_ptr pthread, icode_ptr picode, RAddr raddr, IntRegValue value)
 {
-  GCMRet retval = transGCM->write(this->pid,this->tid,raddr);
+  GCMRet retval = gcmWrite(pthread,raddr);
   switch(retval)
   {
     case NACK:
@@ -594,7 +643,7 @@ void transactionContext::cacheSHW(thread_ptr pthread, icode_ptr picode, RAddr ra
 */
 void transactionContext::cacheSW(thread_ptr pthread, icode_ptr picode, RAddr raddr, IntRegValue value)
 {
-  GCMRet retval = transGCM->write(this->pid,this->tid,raddr);
+  GCMRet retval = gcmWrite(pthread,raddr);
   switch(retval)
   {
     case NACK:
@@ -628,7 +677,7 @@ void transactionContext::cacheSW(thread_ptr pthread, icode_ptr picode, RAddr rad
  */
 void transactionContext::cacheSWFP(thread_ptr pthread, icode_ptr picode, RAddr raddr, IntRegValue value)
 {
-  GCMRet retval = transGCM->write(this->pid,this->tid,raddr);
+  GCMRet retval = gcmWrite(pthread,raddr);
   switch(retval)
   {
     case NACK:
@@ -662,7 +711,7 @@ void transactionContext::cacheSWFP(thread_ptr pthread, icode_ptr picode, RAddr r
 */
 void transactionContext::cacheSDFP(thread_ptr pthread, icode_ptr picode, RAddr raddr, unsigned long long value)
 {
-  GCMRet retval = transGCM->write(this->pid,this->tid,raddr);
+  GCMRet retval = gcmWrite(pthread,raddr,8);
   switch(retval)
   {
     case NACK:
@@ -792,6 +841,7 @@ void transactionContext::stallInstruction(thread_ptr pthread, icode_ptr picode,
 
   nextCode->instID = picode->instID;
   nextCode->func = picode->func;
+  nextCode->tmFunc = picode->tmFunc;
   nextCode->args[0] = picode->args[0];
   nextCode->args[1] = picode->args[1];
   nextCode->args[2] = picode->args[2];
@@ -20,6 +20,7 @@
 
 #include "transCache.h"
 #include "transCoherence.h"
+#include "transElision.h"
 #include "icode.h"
 
 typedef int32_t IntRegValue;
@@ -96,8 +97,12 @@ class transactionContext
     icode                 *nackInstruction;
 
   private:
+    GCMRet                gcmRead(thread_ptr pthread, RAddr raddr, int size = 4);
+    GCMRet                gcmWrite(thread_ptr pthread, RAddr raddr, int size = 4);
+    bool                  storeInPlace();
     void                  stallInstruction(thread_ptr pthread, icode_ptr picode, int stallLength);
     void                  createStall(thread_ptr pthread, int stallLength);
+    void                  restartTransaction(thread_ptr pthread, int writeSetSize);
     int                   getRndDelay(int delay);
 
     /* Variables */
@@ -156,52 +161,80 @@ inline transactionContext* transactionContext::getParentContext(){
   return this->parent;
 }
 
+/**
+ * @ingroup transContext
+ * @brief   Coherence requests, private data (and the lock->dummy stores of an
+ *          elided lock) is only buffered
+ */
+inline GCMRet transactionContext::gcmRead(thread_ptr pthread, RAddr raddr, int size){
+  if(transGCM->isPrivate(pthread, raddr))
+    return SUCCESS;
+  return transGCM->read(this->pid, this->tid, raddr, size);
+}
+
+inline GCMRet transactionContext::gcmWrite(thread_ptr pthread, RAddr raddr, int size){
+  if(transGCM->isPrivate(pthread, raddr) || transLE->isLockDummy(this->pid, raddr))
+    return SUCCESS;
+  return transGCM->write(this->pid, this->tid, raddr, size);
+}
+
+/**
+ * @ingroup transContext
+ * @brief   Eager versioning updates memory in place, except inside an elided
+ *          critical section: its forced aborts are only seen at the next
+ *          access, so the lock holder must never read its speculative values.
+ *          Otherwise nothing is buffered and the loads read memory directly.
+ */
+inline bool transactionContext::storeInPlace(){
+  return this->cache.isEager() && !transLE->isEliding(this->pid);
+}
+
 inline IntRegValue transactionContext::cacheLW(RAddr addr){
-  return this->cache.loadWord(addr);
+  return this->cache.loadWord(addr, storeInPlace());
 }
 
 inline void transactionContext::cacheSW(RAddr addr, IntRegValue value){
-  this->cache.storeWord(addr, value);
+  this->cache.storeWord(addr, value, storeInPlace());
 }
 
 inline void transactionContext::cacheSHW(RAddr addr, IntRegValue value){
-  this->cache.storeHalfWord(addr, value);
+  this->cache.storeHalfWord(addr, value, storeInPlace());
 }
 
 inline void transactionContext::cacheSWFP(RAddr addr, IntRegValue value){
-  this->cache.storeFPWord(addr, value);
+  this->cache.storeFPWord(addr, value, storeInPlace());
 }
 
 inline void transactionContext::cacheSDFP(RAddr addr, unsigned long long value){
-  this->cache.storeDFP(addr, value);
+  this->cache.storeDFP(addr, value, storeInPlace());
 }
 
 inline IntRegValue transactionContext::cacheLUH(RAddr addr){
-  return this->cache.loadUnsignedHalfword(addr);
+  return this->cache.loadUnsignedHalfword(addr, storeInPlace());
 }
 
 inline IntRegValue transactionContext::cacheLHW(RAddr addr){
-  return this->cache.loadHalfword(addr);
+  return this->cache.loadHalfword(addr, storeInPlace());
 }
 
 inline IntRegValue transactionContext::cacheLUB(RAddr addr){
-  return this->cache.loadByte(addr);
+  return this->cache.loadByte(addr, storeInPlace());
 }
 
 inline IntRegValue transactionContext::cacheLB(RAddr addr){
-  return this->cache.loadByte(addr);
+  return this->cache.loadByte(addr, storeInPlace());
 }
 
 inline float transactionContext::cacheLWFP(RAddr addr){
-  return this->cache.loadFPWord(addr);
+  return this->cache.loadFPWord(addr, storeInPlace());
 }
 
 inline double transactionContext::cacheLDFP(RAddr addr){
-  return this->cache.loadDFP(addr);
+  return this->cache.loadDFP(addr, storeInPlace());
 }
 
 inline void transactionContext::cacheSB(RAddr addr, IntRegValue value){
-  this->cache.storeByte(addr, value);
+  this->cache.storeByte(addr, value, storeInPlace());
 }
 
 // inline void transactionContext::cacheWriteBuffer(char *buff, RAddr buffBegin, int count){
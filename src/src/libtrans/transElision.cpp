@@ -0,0 +1,221 @@
+/**
+ * @file
+ * @brief   This is the implementation for the lock elision module.
+ *
+ * @section LICENSE
+ * Copyright: See COPYING file that comes with this distribution
+ *
+ * @section DESCRIPTION
+ * C++ Implementation: transElision
+ */
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "transElision.h"
+#include "transContext.h"
+#include "ThreadContext.h"
+#include "SescConf.h"
+#include "sescapi.h"
+
+transElision *transLE = 0;
+
+/**
+ * @ingroup transElision
+ * @brief   Constructor
+ */
+transElision::transElision()
+{
+  enabled = 0;
+  if(SescConf->checkInt("TransactionalMemory","lockElision"))
+    enabled = SescConf->getInt("TransactionalMemory","lockElision");
+
+  maxRetries = 4;
+  if(SescConf->checkInt("TransactionalMemory","lockElisionRetries"))
+    maxRetries = SescConf->getInt("TransactionalMemory","lockElisionRetries");
+
+  nProcs = tmProcCount();
+  state = tmAllocProcState<elisionState>(nProcs);
+
+  for(int i = 0; i < nProcs; i++)
+  {
+    state[i].lock = 0;
+    state[i].nest = 0;
+    state[i].retries = 0;
+  }
+}
+
+/**
+ * @ingroup transElision
+ * @brief   Statistics of a lock, created on first use
+ */
+elisionStats &transElision::getStats(RAddr raddr, int vaddr)
+{
+  map<RAddr, elisionStats>::iterator it = locks.find(raddr);
+  if(it != locks.end())
+    return it->second;
+
+  elisionStats &stats = locks[raddr];
+  stats.vaddr = vaddr;
+  stats.begins = 0;
+  stats.commits = 0;
+  stats.aborts = 0;
+  stats.fallbacks = 0;
+  return stats;
+}
+
+/**
+ * @ingroup transElision
+ * @brief   Aborts the elided section, execution restarts at the outermost acquire
+ */
+icode_ptr transElision::abortElided(thread_ptr pthread)
+{
+  pthread->transContext->abortTransaction(pthread);
+  return pthread->getPCIcode();
+}
+
+/**
+ * @ingroup transElision
+ * @brief   sesc_fetch_op(FetchSwapOp, lock, LOCKED)
+ *
+ * @param pthread SESC thread pointer
+ * @param picode  Instruction code of the call (the transaction restarts here)
+ * @param vaddr   Lock address
+ * @return Next instruction, NULL to do the real acquire
+ */
+icode_ptr transElision::lock(thread_ptr pthread, icode_ptr picode, int vaddr)
+{
+  int pid = pthread->getPid();
+  elisionState &st = state[pid];
+  RAddr raddr = pthread->virt2real(vaddr);
+  bool locked = (SWAP_WORD(*(int *)raddr) == LOCKED);
+
+  //! The elided section aborted and we are back at its acquire
+  if(st.nest > 0 && pthread->getTMdepth() == 0)
+  {
+    getStats(st.lock, vaddr).aborts++;
+    st.nest = 0;
+    st.retries++;
+  }
+
+  //! Nested lock, it joins the read set of the running elided section
+  if(st.nest > 0)
+  {
+    GCMRet retval = transGCM->read(pid, pthread->tmTid, raddr);
+    if(locked || (retval != SUCCESS && retval != IGNORE))
+      return abortElided(pthread);
+
+    getStats(raddr, vaddr);
+    st.nest++;
+    pthread->setRetVal(UNLOCKED);
+    return pthread->getRetIcode();
+  }
+
+  //! Locks inside user transactions are left alone
+  if(pthread->getTMdepth() > 0)
+    return NULL;
+
+  //! Somebody holds the lock for real, spin on it as usual
+  if(locked)
+    return NULL;
+
+  elisionStats &stats = getStats(raddr, vaddr);
+
+  if(st.retries >= maxRetries)
+  {
+    stats.fallbacks++;
+    st.retries = 0;
+    pthread->tmDispatch = 0;
+    transGCM->dropAttempt(pid);
+    transGCM->abortSharers(pid, raddr);
+    return NULL;
+  }
+
+  pthread->tmDispatch = 1;
+  new transactionContext(pthread, picode);
+
+  //! Backoff after an abort, the acquire is retried after the stall
+  if(pthread->getTMdepth() == 0)
+    return pthread->getPCIcode();
+
+  stats.begins++;
+  st.lock = raddr;
+  st.nest = 1;
+
+  GCMRet retval = transGCM->read(pid, pthread->tmTid, raddr);
+  if(retval != SUCCESS && retval != IGNORE)
+    return abortElided(pthread);
+
+  pthread->setRetVal(UNLOCKED);
+  return pthread->getRetIcode();
+}
+
+/**
+ * @ingroup transElision
+ * @brief   sesc_unlock_op(lock, UNLOCKED)
+ *
+ * @param pthread SESC thread pointer
+ * @param picode  Instruction code of the call
+ * @param vaddr   Lock address
+ * @return Next instruction, NULL to do the real release
+ */
+icode_ptr transElision::unlock(thread_ptr pthread, icode_ptr picode, int vaddr)
+{
+  elisionState &st = state[pthread->getPid()];
+
+  if(st.nest == 0)
+    return NULL;
+
+  if(st.nest > 1)
+  {
+    st.nest--;
+    return pthread->getRetIcode();
+  }
+
+  //! Eager conflict detection does not check for a forced abort on commit
+  if(pthread->transContext->checkAbort())
+    return abortElided(pthread);
+
+  pthread->transContext->commitTransaction(pthread, picode);
+
+  //! Commit delay/nack (the release is retried) or abort
+  if(pthread->getTMdepth() > 0 || pthread->tmAborting)
+    return pthread->getPCIcode();
+
+  map<RAddr, elisionStats>::iterator it = locks.find(st.lock);
+  if(it != locks.end())
+    it->second.commits++;
+
+  st.nest = 0;
+  st.retries = 0;
+  return pthread->getRetIcode();
+}
+
+/**
+ * @ingroup transElision
+ * @brief   Prints the elision statistics of every lock
+ *
+ * @param out Report file
+ */
+void transElision::report(FILE *out)
+{
+  if(!enabled || out == NULL)
+    return;
+
+  fprintf(out, "#tableE,Lock,Begins,Commits,Aborts,Fallbacks,SuccessRate,FallbackRate\n");
+
+  map<RAddr, elisionStats>::iterator it;
+  for(it = locks.begin(); it != locks.end(); ++it)
+  {
+    const elisionStats &stats = it->second;
+    unsigned long long sections = stats.commits + stats.fallbacks;
+
+    fprintf(out, "tableE,%#10x,%llu,%llu,%llu,%llu,%.2f,%.2f\n",
+            stats.vaddr,
+            stats.begins,
+            stats.commits,
+            stats.aborts,
+            stats.fallbacks,
+            sections ? (float)stats.commits / (float)sections : 0.0,
+            sections ? (float)stats.fallbacks / (float)sections : 0.0);
+  }
+}
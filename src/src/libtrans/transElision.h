@@ -0,0 +1,116 @@
+/**
+ * @file
+ * @brief   This is the interface for the lock elision module.
+ *
+ * @section LICENSE
+ * Copyright: See COPYING file that comes with this distribution
+ *
+ * @section DESCRIPTION
+ * C++ Interface: transElision \n
+ * Speculative lock elision for sesc_lock/sesc_unlock. The lock acquire begins a
+ * transaction (the lock word is added to its read set) instead of writing the lock,
+ * and the release commits it. After lockElisionRetries aborts the thread falls back
+ * to the real acquire, which aborts every transaction that elided the same lock.
+ */
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRANSACTION_ELISION
+#define TRANSACTION_ELISION
+
+#include <stdio.h>
+#include <map>
+#include "transCoherence.h"
+
+using namespace std;
+
+typedef uintptr_t RAddr;
+typedef struct icode *icode_ptr;
+typedef class ThreadContext *thread_ptr;
+
+struct elisionStats{
+  int vaddr;                  //!< Lock address as seen by the application
+  unsigned long long begins;  //!< Elided acquires (transactions started)
+  unsigned long long commits; //!< Critical sections that committed
+  unsigned long long aborts;  //!< Elided critical sections that aborted
+  unsigned long long fallbacks; //!< Real acquires after too many aborts
+};
+
+struct elisionState{
+  RAddr lock;                 //!< Outermost elided lock
+  int   nest;                 //!< Elided locks held (0 if not eliding)
+  int   retries;              //!< Consecutive aborts of this acquire
+} __attribute__((aligned(TM_LINE_SIZE)));
+
+/**
+ * @ingroup transElision
+ * @brief   Lock Elision Module
+ *
+ * Called from the sesc_fetch_op/sesc_unlock_op substitutions. lock and unlock return
+ * the next instruction, or NULL when the real lock operation has to run.
+ */
+class transElision{
+  public:
+    transElision();
+
+    bool      isEnabled() const;
+
+    icode_ptr lock(thread_ptr pthread, icode_ptr picode, int vaddr);
+    icode_ptr unlock(thread_ptr pthread, icode_ptr picode, int vaddr);
+
+    bool      isEliding(int pid) const;
+    bool      isLockDummy(int pid, RAddr raddr);
+
+    void      report(FILE *out);
+
+  private:
+    icode_ptr abortElided(thread_ptr pthread);
+    elisionStats &getStats(RAddr raddr, int vaddr);
+
+    int enabled;
+    int maxRetries;
+
+    int nProcs;
+    elisionState *state;                           //!< Per processor state, indexed by pid
+
+    map<RAddr, elisionStats> locks;                //!< Statistics per lock word
+};
+
+inline bool transElision::isEnabled() const{
+  return enabled;
+}
+
+/**
+ * @ingroup transElision
+ * @brief   pid runs an elided critical section
+ */
+inline bool transElision::isEliding(int pid) const{
+  return state[pid].nest > 0;
+}
+
+/**
+ * @ingroup transElision
+ * @brief   sesc_lock/sesc_unlock store to lock->dummy (the word after the lock) to
+ *          model the lock access. Inside an elided section that store is only buffered,
+ *          otherwise every elided critical section would write the lock line.
+ */
+inline bool transElision::isLockDummy(int pid, RAddr raddr){
+  if(state[pid].nest == 0)
+    return false;
+  return locks.find(raddr - sizeof(int)) != locks.end();
+}
+
+extern transElision *transLE;
+#endif
+
+/**
+ * @struct  elisionStats
+ * @ingroup transElision
+ * @brief   Per lock elision statistics
+ */
+
+/**
+ * @struct  elisionState
+ * @ingroup transElision
+ * @brief   Per thread elision state
+ */
@@ -0,0 +1,304 @@
+/**
+ * @file
+ * @brief   This is the implementation for the conflict hot-spot profiler.
+ *
+ * @section LICENSE
+ * Copyright: See COPYING file that comes with this distribution
+ *
+ * @section DESCRIPTION
+ * C++ Implementation: transHotSpot
+ */
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <string.h>
+
+#include "transHotSpot.h"
+#include "SescConf.h"
+
+transHotSpot *transHS = 0;
+
+/**
+ * @ingroup transHotSpot
+ * @brief   Constructor
+ */
+transHotSpot::transHotSpot()
+{
+  topK = 0;
+  if(SescConf->checkInt("TransactionalMemory","hotSpotTopK"))
+    topK = SescConf->getInt("TransactionalMemory","hotSpotTopK");
+
+  width = 1024;
+  if(SescConf->checkInt("TransactionalMemory","hotSpotWidth"))
+    width = SescConf->getInt("TransactionalMemory","hotSpotWidth");
+
+  depth = 4;
+  if(SescConf->checkInt("TransactionalMemory","hotSpotDepth"))
+    depth = SescConf->getInt("TransactionalMemory","hotSpotDepth");
+
+  if(topK > 0 && (width <= 0 || depth <= 0))
+  {
+    fprintf(stderr,"TransactionalMemory:hotSpotWidth and hotSpotDepth must be positive\n");
+    exit(0);
+  }
+
+  nEvents = 0;
+  memset(&total, 0, sizeof(total));
+
+  nProcs = tmProcCount();
+  proc = tmAllocProcState<hotSpotProc>(nProcs);
+
+  for(int i = 0; i < nProcs; i++)
+  {
+    proc[i].beginPC = 0;
+    proc[i].nacking = 0;
+    proc[i].nackBegin = 0;
+  }
+
+  if(topK <= 0)
+    return;
+
+  hotSpotCount zero;
+  memset(&zero, 0, sizeof(zero));
+  sketch.resize((size_t)width * depth, zero);
+  heap.reserve(topK);
+}
+
+/**
+ * @ingroup transHotSpot
+ * @brief   An outermost transaction begins (or is replayed)
+ */
+void transHotSpot::begin(int pid, RAddr pc)
+{
+  if(!isEnabled())
+    return;
+
+  proc[pid].beginPC = pc;
+}
+
+/**
+ * @ingroup transHotSpot
+ * @brief   pid stalls on a NACK from nackPid, the cycles are added when it finishes
+ */
+void transHotSpot::nackBegin(int pid, int nackPid, RAddr caddr)
+{
+  if(!isEnabled())
+    return;
+
+  proc[pid].nacking = 1;
+  proc[pid].nackKey.pc = proc[pid].beginPC;
+  proc[pid].nackKey.conflictPC = nackPid >= 0 && nackPid < nProcs ? proc[nackPid].beginPC : 0;
+  proc[pid].nackKey.caddr = caddr;
+  proc[pid].nackBegin = globalClock;
+}
+
+/**
+ * @ingroup transHotSpot
+ * @brief   The NACK of pid finished (granted, NACKed again or aborted)
+ */
+void transHotSpot::nackFinish(int pid)
+{
+  if(!isEnabled() || !proc[pid].nacking)
+    return;
+
+  proc[pid].nacking = 0;
+
+  hotSpotCount delta;
+  memset(&delta, 0, sizeof(delta));
+  delta.nacks = 1;
+  delta.nackCycles = globalClock - proc[pid].nackBegin;
+  add(proc[pid].nackKey, delta);
+}
+
+/**
+ * @ingroup transHotSpot
+ * @brief   pid aborts because of abortPid, the cycles since its begin are wasted
+ */
+void transHotSpot::abort(int pid, int abortPid, RAddr caddr, Time_t beginCycle)
+{
+  if(!isEnabled())
+    return;
+
+  hotSpotKey key;
+  key.pc = proc[pid].beginPC;
+  key.conflictPC = abortPid >= 0 && abortPid < nProcs ? proc[abortPid].beginPC : 0;
+  key.caddr = caddr;
+
+  hotSpotCount delta;
+  memset(&delta, 0, sizeof(delta));
+  delta.aborts = 1;
+  delta.abortCycles = beginCycle <= globalClock ? globalClock - beginCycle : 0;
+  add(key, delta);
+}
+
+/**
+ * @ingroup transHotSpot
+ * @brief   Counter of the key in a sketch row
+ */
+size_t transHotSpot::cell(const hotSpotKey &key, int row) const
+{
+  unsigned long long h = 0x9E3779B97F4A7C15ULL * (row + 1);
+  h ^= (unsigned long long)key.pc + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+  h ^= (unsigned long long)key.conflictPC + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+  h ^= (unsigned long long)key.caddr + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+
+  //!  Final mix (splitmix64)
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+  h ^= h >> 31;
+
+  return (size_t)row * width + (size_t)(h % width);
+}
+
+/**
+ * @ingroup transHotSpot
+ * @brief   Adds the event to the sketch and updates the top-K heap
+ *
+ * Each field of the estimate is the minimum over the rows. A tuple that is
+ * not in the heap replaces the minimum when its estimate is larger.
+ */
+void transHotSpot::add(const hotSpotKey &key, const hotSpotCount &delta)
+{
+  nEvents++;
+  total.aborts      += delta.aborts;
+  total.abortCycles += delta.abortCycles;
+  total.nacks       += delta.nacks;
+  total.nackCycles  += delta.nackCycles;
+
+  hotSpotCount est;
+  for(int r = 0; r < depth; r++)
+  {
+    hotSpotCount &c = sketch[cell(key, r)];
+    c.aborts      += delta.aborts;
+    c.abortCycles += delta.abortCycles;
+    c.nacks       += delta.nacks;
+    c.nackCycles  += delta.nackCycles;
+
+    if(r == 0)
+      est = c;
+    else
+    {
+      est.aborts      = min(est.aborts, c.aborts);
+      est.abortCycles = min(est.abortCycles, c.abortCycles);
+      est.nacks       = min(est.nacks, c.nacks);
+      est.nackCycles  = min(est.nackCycles, c.nackCycles);
+    }
+  }
+
+  for(size_t i = 0; i < heap.size(); i++)
+  {
+    hotSpotKey &k = heap[i].key;
+    if(k.pc == key.pc && k.conflictPC == key.conflictPC && k.caddr == key.caddr)
+    {
+      //!  Estimates only grow
+      heap[i].count = est;
+      siftDown(i);
+      return;
+    }
+  }
+
+  hotSpotEntry e;
+  e.key = key;
+  e.count = est;
+
+  if((int)heap.size() < topK)
+  {
+    heap.push_back(e);
+    siftUp(heap.size() - 1);
+  }
+  else if(wasted(est) > wasted(heap[0].count))
+  {
+    heap[0] = e;
+    siftDown(0);
+  }
+}
+
+/**
+ * @ingroup transHotSpot
+ * @brief   Moves up an entry whose estimate is smaller than its parent's
+ */
+void transHotSpot::siftUp(size_t i)
+{
+  while(i > 0)
+  {
+    size_t p = (i - 1) / 2;
+    if(wasted(heap[p].count) <= wasted(heap[i].count))
+      break;
+    swap(heap[p], heap[i]);
+    i = p;
+  }
+}
+
+/**
+ * @ingroup transHotSpot
+ * @brief   Moves down an entry whose estimate grew
+ */
+void transHotSpot::siftDown(size_t i)
+{
+  size_t n = heap.size();
+  while(true)
+  {
+    size_t l = 2 * i + 1;
+    size_t r = l + 1;
+    size_t m = i;
+    if(l < n && wasted(heap[l].count) < wasted(heap[m].count))
+      m = l;
+    if(r < n && wasted(heap[r].count) < wasted(heap[m].count))
+      m = r;
+    if(m == i)
+      break;
+    swap(heap[m], heap[i]);
+    i = m;
+  }
+}
+
+/**
+ * @ingroup transHotSpot
+ * @brief   Ranking order of the report
+ */
+bool transHotSpot::moreWasted(const hotSpotEntry &a, const hotSpotEntry &b)
+{
+  return wasted(a.count) > wasted(b.count);
+}
+
+/**
+ * @ingroup transHotSpot
+ * @brief   Prints the ranked conflict table (tableH) and the totals (tableHT)
+ *
+ * @param out Report file
+ */
+void transHotSpot::report(FILE *out)
+{
+  if(!isEnabled() || out == NULL)
+    return;
+
+  vector<hotSpotEntry> ranked(heap);
+  sort(ranked.begin(), ranked.end(), moreWasted);
+
+  fprintf(out, "#tableH,Rank,BeginPC,ConflictPC,Line,WastedCyc,AbortCyc,Aborts,NackCyc,Nacks\n");
+  for(size_t i = 0; i < ranked.size(); i++)
+  {
+    hotSpotEntry &e = ranked[i];
+    fprintf(out, "tableH,%d,%#10x,%#10x,%#10x,%llu,%llu,%llu,%llu,%llu\n",
+            (int)i + 1,
+            (unsigned int)e.key.pc,
+            (unsigned int)e.key.conflictPC,
+            (unsigned int)e.key.caddr,
+            wasted(e.count),
+            e.count.abortCycles,
+            e.count.aborts,
+            e.count.nackCycles,
+            e.count.nacks);
+  }
+
+  fprintf(out, "#tableHT,Events,WastedCyc,AbortCyc,Aborts,NackCyc,Nacks,SketchKB\n");
+  fprintf(out, "tableHT,%llu,%llu,%llu,%llu,%llu,%llu,%lu\n",
+          nEvents,
+          wasted(total),
+          total.abortCycles,
+          total.aborts,
+          total.nackCycles,
+          total.nacks,
+          (unsigned long)(sketch.size() * sizeof(hotSpotCount) / 1024));
+}
@@ -0,0 +1,130 @@
+/**
+ * @file
+ * @brief   This is the interface for the conflict hot-spot profiler.
+ *
+ * @section LICENSE
+ * Copyright: See COPYING file that comes with this distribution
+ *
+ * @section DESCRIPTION
+ * C++ Interface: transHotSpot \n
+ * Finds the few (static transaction, conflicting static transaction, cache line) tuples
+ * that waste most of the cycles on long runs. Every NACK and abort adds its cycles to a
+ * count-min sketch, and the hotSpotTopK tuples with the largest estimate are kept in a
+ * min-heap. The memory is fixed (hotSpotDepth x hotSpotWidth counters plus the heap),
+ * the counts are upper bounds.
+ */
+/////////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRANSACTION_HOTSPOT
+#define TRANSACTION_HOTSPOT
+
+#include <stdio.h>
+#include <vector>
+#include "transCoherence.h"
+
+using namespace std;
+
+typedef uintptr_t RAddr;
+
+struct hotSpotKey{
+  RAddr pc;                          //!< Begin PC of the transaction that waited/aborted
+  RAddr conflictPC;                  //!< Begin PC of the transaction it conflicted with
+  RAddr caddr;                       //!< Cache line (0 for a lazy commit NACK)
+};
+
+struct hotSpotCount{
+  unsigned long long aborts;
+  unsigned long long abortCycles;    //!< Cycles from the begin to the abort
+  unsigned long long nacks;
+  unsigned long long nackCycles;     //!< Cycles stalled on the NACK
+};
+
+struct hotSpotEntry{
+  hotSpotKey   key;
+  hotSpotCount count;                //!< Sketch estimate
+};
+
+struct hotSpotProc{
+  RAddr        beginPC;              //!< Begin PC of the running (or last) transaction
+  int          nacking;              //!< A NACK is open
+  hotSpotKey   nackKey;
+  Time_t       nackBegin;
+} __attribute__((aligned(TM_LINE_SIZE)));
+
+/**
+ * @ingroup transHotSpot
+ * @brief   Conflict Hot-Spot Profiler
+ *
+ * Fed by transReport, which sees every begin, NACK and abort.
+ */
+class transHotSpot{
+  public:
+    transHotSpot();
+
+    bool isEnabled() const;
+
+    void begin(int pid, RAddr pc);
+    void nackBegin(int pid, int nackPid, RAddr caddr);
+    void nackFinish(int pid);
+    void abort(int pid, int abortPid, RAddr caddr, Time_t beginCycle);
+
+    void report(FILE *out);
+
+  private:
+    void   add(const hotSpotKey &key, const hotSpotCount &delta);
+    size_t cell(const hotSpotKey &key, int row) const;
+    void   siftUp(size_t i);
+    void   siftDown(size_t i);
+
+    static unsigned long long wasted(const hotSpotCount &c);
+    static bool moreWasted(const hotSpotEntry &a, const hotSpotEntry &b);
+
+    int topK;                                      //!< Heap entries (0 disables the profiler)
+    int width;                                     //!< Counters per sketch row
+    int depth;                                     //!< Sketch rows (hash functions)
+
+    vector<hotSpotCount> sketch;                   //!< depth x width counters
+    vector<hotSpotEntry> heap;                     //!< Min-heap on the wasted cycles
+
+    unsigned long long nEvents;                    //!< NACKs and aborts added
+    hotSpotCount       total;                      //!< Exact totals
+
+    int nProcs;
+    hotSpotProc *proc;                             //!< Per processor state, indexed by pid
+};
+
+inline bool transHotSpot::isEnabled() const{
+  return topK > 0;
+}
+
+inline unsigned long long transHotSpot::wasted(const hotSpotCount &c){
+  return c.abortCycles + c.nackCycles;
+}
+
+extern transHotSpot *transHS;
+#endif
+
+/**
+ * @struct  hotSpotKey
+ * @ingroup transHotSpot
+ * @brief   Conflict tuple tracked by the profiler
+ */
+
+/**
+ * @struct  hotSpotCount
+ * @ingroup transHotSpot
+ * @brief   Wasted work of a tuple (one sketch counter)
+ */
+
+/**
+ * @struct  hotSpotEntry
+ * @ingroup transHotSpot
+ * @brief   Top-K heap entry
+ */
+
+/**
+ * @struct  hotSpotProc
+ * @ingroup transHotSpot
+ * @brief   Per thread profiler state
+ */
@@ -13,7 +13,11 @@
 /////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <vector>
+#include "ReportGen.h"
 #include "transReport.h"
+#include "transHotSpot.h"
+#include "transBreakdown.h"
 
 
 /**
@@ -63,6 +67,14 @@ transReport::transReport(const char *reportFileName)
     else
       printSummaryReport = 0;
 
+    closedNesting = 0;
+    if(SescConf->checkInt("TransactionalMemory","closedNesting"))
+      closedNesting = SescConf->getInt("TransactionalMemory","closedNesting");
+
+    boundedCache = 0;
+    if(SescConf->checkInt("TransactionalMemory","boundedCache"))
+      boundedCache = SescConf->getInt("TransactionalMemory","boundedCache");
+
     transactionalReport = 0;
     calculateFullReadWriteSet = 0;
     printTransactionalReportSummary = 0;
@@ -105,6 +117,8 @@ transReport::transReport(const char *reportFileName)
     summaryCommitCycleCount = 0;
     summaryAbortCount = 0;
     summaryAbortInstCount = 0;
+    summaryPartialAbortCount = 0;
+    summaryOverflowCount = 0;
 
     summaryUsefulNackCount = 0;
     summaryUsefulNackCycle = 0;
@@ -123,26 +137,30 @@ transReport::transReport(const char *reportFileName)
     summaryWriteSetSize = 0;
     summaryLoadCount = 0;
     summaryStoreCount = 0;
+    summaryGet(epochSummary);
 
-    for(i = 0; i < MAX_CPU_COUNT; i++)
+    nProcs = tmProcCount();
+    proc = tmAllocProcState<struct tmReportProc>(nProcs);
+
+    for(i = 0; i < nProcs; i++)
     {
-      nackingAddr[i] = 0;
-      nackingTimestamp[i] = 0;
-      nackingPid[i] = -1;
-      tmDepth[i] = 0;
+      proc[i].nackingAddr = 0;
+      proc[i].nackingTimestamp = 0;
+      proc[i].nackingPid = -1;
+      proc[i].tmDepth = 0;
 
-      summaryBeginCycle[i]=0;
-      summaryNackCycle[i]=0;
-      summaryTransFlag[i]=0;
+      proc[i].summaryBeginCycle=0;
+      proc[i].summaryNackCycle=0;
+      proc[i].summaryTransFlag=0;
 
       for(j = 0; j < 6; j++)
-        tempInstCount[i][j]=0;
+        proc[i].tempInstCount[j]=0;
       for(j = 0; j < 6; j++)
-        tempInstCountAbort[i][j]=0;
+        proc[i].tempInstCountAbort[j]=0;
 
-      transMemRefState[i] = 0;
+      proc[i].transMemRefState = 0;
 
-      committedInstCountByCpu[i] = 0;
+      proc[i].committedInstCountByCpu = 0;
     }
 
 
@@ -165,12 +183,12 @@ transReport::transReport(const char *reportFileName)
  */
 void transReport::reportCommit(int pid)
 {
-  struct transRef temp = commits[pid].front();
-  commits[pid].pop();
+  struct transRef temp = proc[pid].commits.front();
+  proc[pid].commits.pop();
 
-  tmDepth[pid]--;
+  proc[pid].tmDepth--;
   //! Right now we are subsuming nest transactions, so we need to check if this is a nested begin
-  if(tmDepth[pid] > 0)
+  if(proc[pid].tmDepth > 0)
   {
     if(printDetailedTrace)
       fprintf(outfile,"<Trans> tmTrace: CMSB :%lld:%d:9999:%d:%llu:%llu\n"
@@ -185,23 +203,23 @@ void transReport::reportCommit(int pid)
     if(printDetailedTrace)
       fprintf(outfile,"<Trans> tmTrace: CM   :%lld:%d:1005:%d:%d:%d:%d:%d:%d:%d:%llu:%llu\n"
                                           ,temp.utid,temp.pid,temp.tid
-                                          ,tempInstCount[pid][transLoad]
-                                          ,tempInstCount[pid][transStore]
-                                          ,tempInstCount[pid][transInt]
-                                          ,tempInstCount[pid][transFp]
-                                          ,tempInstCount[pid][transBJ]
-                                          ,tempInstCount[pid][transFence]
+                                          ,proc[pid].tempInstCount[transLoad]
+                                          ,proc[pid].tempInstCount[transStore]
+                                          ,proc[pid].tempInstCount[transInt]
+                                          ,proc[pid].tempInstCount[transFp]
+                                          ,proc[pid].tempInstCount[transBJ]
+                                          ,proc[pid].tempInstCount[transFence]
                                           ,temp.timestamp
                                           ,globalClock);
 
-   INSTCOUNT instCount = tempInstCount[pid][transLoad] + tempInstCount[pid][transStore];
-   instCount += tempInstCount[pid][transInt] + tempInstCount[pid][transFp] + tempInstCount[pid][transBJ] + tempInstCount[pid][transFence];
+   INSTCOUNT instCount = proc[pid].tempInstCount[transLoad] + proc[pid].tempInstCount[transStore];
+   instCount += proc[pid].tempInstCount[transInt] + proc[pid].tempInstCount[transFp] + proc[pid].tempInstCount[transBJ] + proc[pid].tempInstCount[transFence];
 
    if(printSummaryReport)
       summaryCommit(temp.pid,instCount,globalClock);
 
    if(transactionalReport)
-      transactionalCommit(temp.utid,instCount,globalClock,tempInstCount[pid][transFp]);
+      transactionalCommit(temp.utid,instCount,globalClock,proc[pid].tempInstCount[transFp]);
 
     if(recordTransMemRefs)
       transMemRef_newCommit(temp.pid);
@@ -228,12 +246,12 @@ void transReport::reportCommit(int pid)
  */
 void transReport::reportBegin(int pid, int cpu)
 {
-  struct transRef temp = begins[pid].front();
-  begins[pid].pop();
+  struct transRef temp = proc[pid].begins.front();
+  proc[pid].begins.pop();
 
-  tmDepth[pid]++;
+  proc[pid].tmDepth++;
   //! Right now we are subsuming nest transactions, so we need to check if this is a nested begin
-  if(tmDepth[pid] > 1)
+  if(proc[pid].tmDepth > 1)
   {
     if(printDetailedTrace)
       fprintf(outfile,"<Trans> tmTrace: BGSB :%lld:%d:9999:%d:%0#10x:%llu:%llu\n"
@@ -247,12 +265,12 @@ void transReport::reportBegin(int pid, int cpu)
   else
   {
     //! Reset the transactional Instruction Counter
-    tempInstCount[pid][0] = 0;
-    tempInstCount[pid][1] = 0;
-    tempInstCount[pid][2] = 0;
-    tempInstCount[pid][3] = 0;
-    tempInstCount[pid][4] = 0;
-    tempInstCount[pid][5] = 0;
+    proc[pid].tempInstCount[0] = 0;
+    proc[pid].tempInstCount[1] = 0;
+    proc[pid].tempInstCount[2] = 0;
+    proc[pid].tempInstCount[3] = 0;
+    proc[pid].tempInstCount[4] = 0;
+    proc[pid].tempInstCount[5] = 0;
 
     if(printDetailedTrace)
       fprintf(outfile,"<Trans> tmTrace: BG   :%lld:%d:1000:%d:%0#10x:%llu:%llu\n"
@@ -285,7 +303,7 @@ void transReport::reportBegin(int pid, int cpu)
  */
 void transReport::registerTransInst(int pid, transInstType type)
 {
-  tempInstCount[pid][type]++;
+  proc[pid].tempInstCount[type]++;
 }
 
 /**
@@ -302,7 +320,7 @@ void transReport::registerTransInst(int pid, transInstType type)
 void transReport::registerTransInstAbort(int pid, transInstType type)
 {
   if(type < 6)
-    tempInstCountAbort[pid][type]++;
+    proc[pid].tempInstCountAbort[type]++;
 }
 
 /**
@@ -317,6 +335,10 @@ void transReport::registerTransInstAbort(int pid, transInstType type)
  */
 void transReport::registerBegin(ID utid, int pid, int tid, RAddr PC, TIMESTAMP begin_timestamp)
 {
+  //! Rabbit mode never retires the instruction that pops the event
+  if(GFlow::isGoingRabbit())
+    return;
+
   struct transRef temp;
   temp.pid = pid;
   temp.tid = tid;
@@ -337,16 +359,17 @@ void transReport::registerBegin(ID utid, int pid, int tid, RAddr PC, TIMESTAMP b
 
     registerOut();
   }
-  if(tmDepth[pid] <= 1)
+  if(proc[pid].tmDepth <= 1)
   {
     //! Reset the transactional Abort Instruction Counter
     for(int j = 0; j < 6; j++)
-      tempInstCountAbort[pid][j] = 0;
+      proc[pid].tempInstCountAbort[j] = 0;
   }
-  begins[pid].push(temp);
-  nackingAddr[pid] = 0;
-  nackingTimestamp[pid] = 0;
-  nackingPid[pid] = -1;  
+  proc[pid].begins.push(temp);
+  transHS->begin(pid, PC);
+  proc[pid].nackingAddr = 0;
+  proc[pid].nackingTimestamp = 0;
+  proc[pid].nackingPid = -1;  
 }
 
 /**
@@ -360,6 +383,9 @@ void transReport::registerBegin(ID utid, int pid, int tid, RAddr PC, TIMESTAMP b
  */
 void transReport::registerCommit(ID utid,int pid, int tid, TIMESTAMP begin_timestamp)
 {
+  if(GFlow::isGoingRabbit())
+    return;
+
   struct transRef temp;
   temp.pid = pid;
   temp.tid = tid;
@@ -377,10 +403,10 @@ void transReport::registerCommit(ID utid,int pid, int tid, TIMESTAMP begin_times
 
     registerOut();
   }
-  commits[pid].push(temp);
-  nackingAddr[pid] = 0;
-  nackingTimestamp[pid] = 0;
-  nackingPid[pid] = -1;
+  proc[pid].commits.push(temp);
+  proc[pid].nackingAddr = 0;
+  proc[pid].nackingTimestamp = 0;
+  proc[pid].nackingPid = -1;
 }
 
 /**
@@ -400,14 +426,14 @@ void transReport::registerCommit(ID utid,int pid, int tid, TIMESTAMP begin_times
 void transReport::reportNackCommitFN(ID utid, int pid, int tid, unsigned long long begin_timestamp)
 {
   //! If we are able to commit in a Lazy approach and we were stalling, print NKFN
-  if(nackingPid[pid] != -1)
+  if(proc[pid].nackingPid != -1)
   {
     if(printDetailedTrace)
       fprintf(outfile,"<Trans> tmTrace: NKFN :%lld:%d:1008:%d:%d:%llu:%llu:%llu\n"
                                             ,utid,pid
                                             ,tid
-                                            ,nackingPid[pid]
-                                            ,nackingTimestamp[pid]
+                                            ,proc[pid].nackingPid
+                                            ,proc[pid].nackingTimestamp
                                             ,begin_timestamp
                                             ,globalClock);
     registerOut();
@@ -415,6 +441,9 @@ void transReport::reportNackCommitFN(ID utid, int pid, int tid, unsigned long lo
     if(printSummaryReport)
       summaryNackFinish(pid,globalClock);
 
+    transHS->nackFinish(pid);
+    transBD->nackFinish(pid);
+
     if(transactionalReport)
       transactionalNackFinish(utid, globalClock);
   }
@@ -428,9 +457,9 @@ void transReport::reportNackCommitFN(ID utid, int pid, int tid, unsigned long lo
  * @param pid  Process ID
  */
 void transReport::reportLoad(int pid){
-  struct memRef temp = loads[pid].front();
-  loads[pid].pop();
-  tempInstCount[pid][transLoad]++;
+  struct memRef temp = proc[pid].loads.front();
+  proc[pid].loads.pop();
+  proc[pid].tempInstCount[transLoad]++;
   if(printDetailedTrace)
     fprintf(outfile,"<Trans> tmTrace: LD   :%lld:%d:1001:%d:%#10x:%#10x:%llu:%llu\n"
                                             ,temp.utid
@@ -460,9 +489,9 @@ void transReport::reportLoad(int pid){
  * @param pid  Process ID
  */
 void transReport::reportStore(int pid){
-  struct memRef temp = stores[pid].front();
-  stores[pid].pop();
-  tempInstCount[pid][transStore]++;
+  struct memRef temp = proc[pid].stores.front();
+  proc[pid].stores.pop();
+  proc[pid].tempInstCount[transStore]++;
   if(printDetailedTrace)
     fprintf(outfile,"<Trans> tmTrace: ST   :%lld:%d:1002:%d:%#10x:%#10x:%llu:%llu\n"
                                             ,temp.utid
@@ -500,22 +529,28 @@ void transReport::reportStore(int pid){
  */
 void transReport::registerLoad(ID utid,RAddr beginPC, int pid, int tid, RAddr raddr,RAddr caddr, TIMESTAMP begin_timestamp)
 {
-  if(nackingAddr[pid] != 0)
+  if(GFlow::isGoingRabbit())
+    return;
+
+  if(proc[pid].nackingAddr != 0)
   {
     if(printDetailedTrace)
       fprintf(outfile,"<Trans> tmTrace: NKFN :%lld:%d:1006:%d:%d:%#10x:%llu:%llu:%llu\n"
                                             ,utid
                                             ,pid
                                             ,tid
-                                            ,nackingPid[pid]
-                                            ,nackingAddr[pid]
-                                            ,nackingTimestamp[pid]
+                                            ,proc[pid].nackingPid
+                                            ,proc[pid].nackingAddr
+                                            ,proc[pid].nackingTimestamp
                                             ,begin_timestamp
                                             ,globalClock);
 
     if(printSummaryReport)
       summaryNackFinish(pid,globalClock);
 
+    transHS->nackFinish(pid);
+    transBD->nackFinish(pid);
+
     if(transactionalReport)
       transactionalNackFinish(utid,globalClock);
 
@@ -530,10 +565,10 @@ void transReport::registerLoad(ID utid,RAddr beginPC, int pid, int tid, RAddr ra
   temp.tid = tid;
   temp.beginPC = beginPC;
   temp.timestamp = begin_timestamp;
-  loads[pid].push(temp);
-  nackingAddr[pid] = 0;
-  nackingTimestamp[pid] = 0;
-  nackingPid[pid] = -1;
+  proc[pid].loads.push(temp);
+  proc[pid].nackingAddr = 0;
+  proc[pid].nackingTimestamp = 0;
+  proc[pid].nackingPid = -1;
 }
 
 /**
@@ -550,22 +585,28 @@ void transReport::registerLoad(ID utid,RAddr beginPC, int pid, int tid, RAddr ra
  */
 void transReport::registerStore(ID utid,RAddr beginPC,int pid, int tid, RAddr raddr,RAddr caddr,TIMESTAMP begin_timestamp)
 {
-  if(nackingAddr[pid] != 0)
+  if(GFlow::isGoingRabbit())
+    return;
+
+  if(proc[pid].nackingAddr != 0)
   {
     if(printDetailedTrace)
       fprintf(outfile,"<Trans> tmTrace: NKFN :%lld:%d:1006:%d:%d:%#10x:%llu:%llu:%llu\n"
                                                 ,utid
                                                 ,pid
                                                 ,tid
-                                                ,nackingPid[pid]
-                                                ,nackingAddr[pid]
-                                                ,nackingTimestamp[pid]
+                                                ,proc[pid].nackingPid
+                                                ,proc[pid].nackingAddr
+                                                ,proc[pid].nackingTimestamp
                                                 ,begin_timestamp
                                                 ,globalClock);
 
     if(printSummaryReport)
       summaryNackFinish(pid,globalClock);
 
+    transHS->nackFinish(pid);
+    transBD->nackFinish(pid);
+
     if(transactionalReport)
       transactionalNackFinish(utid, globalClock);
 
@@ -581,10 +622,10 @@ void transReport::registerStore(ID utid,RAddr beginPC,int pid, int tid, RAddr ra
   temp.tid = tid;
   temp.beginPC = beginPC;
   temp.timestamp = begin_timestamp;
-  stores[pid].push(temp);
-  nackingAddr[pid] = 0;
-  nackingTimestamp[pid] = 0;
-  nackingPid[pid] = -1;
+  proc[pid].stores.push(temp);
+  proc[pid].nackingAddr = 0;
+  proc[pid].nackingTimestamp = 0;
+  proc[pid].nackingPid = -1;
 }
 
 /**
@@ -604,24 +645,27 @@ void transReport::reportNackLoad(ID utid,int pid, int tid, int nackPid, RAddr ra
 {
   //!  This will only print out the NACK if it is a new, unique NACK.  Note the timestamp must not be equal to ((~0ULL) - 1024) because this
   //!  1indicates that a transaction is in the process of ABORTING, but has yet to complete its ABORT.
-    if(printAllNacks || ((nackingAddr[pid] != caddr || nackingTimestamp[pid] != nackTimestamp || nackingPid[pid] != nackPid) && nackTimestamp != ((~0ULL) - 1024)))
+    if(printAllNacks || ((proc[pid].nackingAddr != caddr || proc[pid].nackingTimestamp != nackTimestamp || proc[pid].nackingPid != nackPid) && nackTimestamp != ((~0ULL) - 1024)))
     {
-      if(nackingAddr[pid] != 0)
+      if(proc[pid].nackingAddr != 0)
       {
         if(printDetailedTrace)
           fprintf(outfile,"<Trans> tmTrace: NKFN :%lld:%d:1006:%d:%d:%#10x:%llu:%llu:%llu\n"
                                                   ,utid
                                                   ,pid
                                                   ,tid
-                                                  ,nackingPid[pid]
-                                                  ,nackingAddr[pid]
-                                                  ,nackingTimestamp[pid]
+                                                  ,proc[pid].nackingPid
+                                                  ,proc[pid].nackingAddr
+                                                  ,proc[pid].nackingTimestamp
                                                   ,myTimestamp
                                                   ,globalClock);
 
         if(printSummaryReport)
           summaryNackFinish(pid,globalClock);
 
+        transHS->nackFinish(pid);
+        transBD->nackFinish(pid);
+
         if(transactionalReport)
             transactionalNackFinish(utid, globalClock);
 
@@ -643,12 +687,15 @@ void transReport::reportNackLoad(ID utid,int pid, int tid, int nackPid, RAddr ra
       if(printSummaryReport)
         summaryNackBegin(pid,globalClock);
 
+      transHS->nackBegin(pid, nackPid, caddr);
+      transBD->nackBegin(pid);
+
       if(transactionalReport)
          transactionalNackBegin(utid, tid, nackPid, caddr, globalClock);
 
-      nackingAddr[pid] = caddr;
-      nackingTimestamp[pid] = nackTimestamp;
-      nackingPid[pid] = nackPid;
+      proc[pid].nackingAddr = caddr;
+      proc[pid].nackingTimestamp = nackTimestamp;
+      proc[pid].nackingPid = nackPid;
       registerOut();
     }
 }
@@ -670,24 +717,27 @@ void transReport::reportNackStore(ID utid,int pid, int tid, int nackPid, RAddr r
 {
   //!  This will only print out the NACK if it is a new, unique NACK.  Note the timestamp must not be equal to ((~0ULL) - 1024) because this
   //!  indicates that a transaction is in the process of ABORTING, but has yet to complete its ABORT.  You can disable this check with printAllNacks.
-  if(printAllNacks || ((nackingAddr[pid] != caddr || nackingTimestamp[pid] != nackTimestamp || nackingPid[pid] != nackPid) && nackTimestamp != ((~0ULL) - 1024)))
+  if(printAllNacks || ((proc[pid].nackingAddr != caddr || proc[pid].nackingTimestamp != nackTimestamp || proc[pid].nackingPid != nackPid) && nackTimestamp != ((~0ULL) - 1024)))
   {
-    if(nackingAddr[pid] != 0)
+    if(proc[pid].nackingAddr != 0)
     {
       if(printDetailedTrace)
         fprintf(outfile,"<Trans> tmTrace: NKFN :%lld:%d:1006:%d:%d:%#10x:%llu:%llu:%llu\n"
                                                     ,utid
                                                     ,pid
                                                     ,tid
-                                                    ,nackingPid[pid]
-                                                    ,nackingAddr[pid]
-                                                    ,nackingTimestamp[pid]
+                                                    ,proc[pid].nackingPid
+                                                    ,proc[pid].nackingAddr
+                                                    ,proc[pid].nackingTimestamp
                                                     ,myTimestamp
                                                     ,globalClock);
 
       if(printSummaryReport)
         summaryNackFinish(pid,globalClock);
 
+      transHS->nackFinish(pid);
+      transBD->nackFinish(pid);
+
       if(transactionalReport)
          transactionalNackFinish(utid, globalClock);
 
@@ -708,12 +758,15 @@ void transReport::reportNackStore(ID utid,int pid, int tid, int nackPid, RAddr r
       if(printSummaryReport)
         summaryNackBegin(pid,globalClock);
 
+      transHS->nackBegin(pid, nackPid, caddr);
+      transBD->nackBegin(pid);
+
       if(transactionalReport)
          transactionalNackBegin(utid, tid, nackPid, caddr, globalClock);
 
-      nackingAddr[pid] = caddr;
-      nackingTimestamp[pid] = nackTimestamp;
-      nackingPid[pid] = nackPid;
+      proc[pid].nackingAddr = caddr;
+      proc[pid].nackingTimestamp = nackTimestamp;
+      proc[pid].nackingPid = nackPid;
       registerOut();
   }
 }
@@ -731,23 +784,26 @@ void transReport::reportNackStore(ID utid,int pid, int tid, int nackPid, RAddr r
  */
 void transReport::reportNackCommit(ID utid,int pid, int tid, int nackPid, TIMESTAMP myTimestamp, TIMESTAMP nackTimestamp)
 {
-  if(printAllNacks || ((nackingTimestamp[pid] != nackTimestamp || nackingPid[pid] != nackPid) && nackTimestamp != ((~0ULL) - 1024)))
+  if(printAllNacks || ((proc[pid].nackingTimestamp != nackTimestamp || proc[pid].nackingPid != nackPid) && nackTimestamp != ((~0ULL) - 1024)))
   {
-    if(nackingPid[pid] != -1)
+    if(proc[pid].nackingPid != -1)
     {
       if(printDetailedTrace)
         fprintf(outfile,"<Trans> tmTrace: NKFN :%lld:%d:1008:%d:%d:%llu:%llu:%llu\n"
                                                     ,utid
                                                     ,pid
                                                     ,tid
-                                                    ,nackingPid[pid]
-                                                    ,nackingTimestamp[pid]
+                                                    ,proc[pid].nackingPid
+                                                    ,proc[pid].nackingTimestamp
                                                     ,myTimestamp
                                                     ,globalClock);
 
       if(printSummaryReport)
         summaryNackFinish(pid,globalClock);
 
+      transHS->nackFinish(pid);
+      transBD->nackFinish(pid);
+
       if(transactionalReport)
          transactionalNackFinish(utid, globalClock);
 
@@ -766,15 +822,94 @@ void transReport::reportNackCommit(ID utid,int pid, int tid, int nackPid, TIMEST
       if(printSummaryReport)
         summaryNackBegin(pid,globalClock);
 
+      transHS->nackBegin(pid, nackPid, 0);
+      transBD->nackBegin(pid);
+
       if(transactionalReport)
          transactionalNackBegin(utid, tid, nackPid, 0, globalClock);
 
-      nackingTimestamp[pid] = nackTimestamp;
-      nackingPid[pid] = nackPid;
+      proc[pid].nackingTimestamp = nackTimestamp;
+      proc[pid].nackingPid = nackPid;
       registerOut();
   }
 }
 
+/**
+ * @ingroup transReport
+ * @brief   report overflow (bounded TM)
+ *
+ * @param utid    Unique Tx ID
+ * @param pid  Process ID
+ * @param caddr Displaced cache line (physical address)
+ *
+ * The transaction no longer fits in the private cache. The abort itself
+ * follows (AB with the pid as aborter) when the thread notices it.
+ */
+void transReport::reportOverflow(ID utid, int pid, RAddr caddr)
+{
+  if(printDetailedTrace)
+    fprintf(outfile,"<Trans> tmTrace: OVFL :%lld:%d:1009:%#10x:%llu\n"
+                                                    ,utid
+                                                    ,pid
+                                                    ,caddr
+                                                    ,globalClock);
+
+  if(printSummaryReport)
+    summaryOverflowCount++;
+
+  registerOut();
+}
+
+/**
+ * @ingroup transReport
+ * @brief   report partial abort (closed nesting)
+ *
+ * @param utid    Unique Tx ID
+ * @param pid  Process ID
+ * @param tid  ThreadID
+ * @param nackPid Process ID of the aborter
+ * @param caddr Cache address
+ * @param level Nesting level that restarts
+ * @param levelBegin Cycle that level began, the hot-spot profiler wastes the cycles since
+ *
+ * Only the nested transactions that accessed the line restart, the outer
+ * levels keep running. Not counted as an abort (AB) in the summary.
+ */
+void transReport::reportPartialAbort(ID utid, int pid, int tid, int nackPid, RAddr caddr, int level, Time_t levelBegin)
+{
+  //! A NACK in progress ends with the partial abort
+  if(proc[pid].nackingAddr != 0 || proc[pid].nackingPid != -1)
+  {
+    if(printSummaryReport)
+      summaryNackFinish(pid,globalClock);
+
+    transHS->nackFinish(pid);
+    transBD->nackFinish(pid);
+
+    if(transactionalReport)
+      transactionalNackFinish(utid, globalClock);
+  }
+  transHS->abort(pid, nackPid, caddr, levelBegin);
+
+  if(printDetailedTrace || printRealBCTimes)
+    fprintf(outfile,"<Trans> tmTrace: ABPT :%lld:%d:1010:%d:%d:%#10x:%d:%llu\n"
+                                                    ,utid
+                                                    ,pid
+                                                    ,tid
+                                                    ,nackPid
+                                                    ,caddr
+                                                    ,level
+                                                    ,globalClock);
+
+  if(printSummaryReport)
+    summaryPartialAbortCount++;
+
+  proc[pid].nackingAddr = 0;
+  proc[pid].nackingTimestamp = 0;
+  proc[pid].nackingPid = -1;
+  registerOut();
+}
+
 /**
  * @ingroup transReport
  * @brief   report abort
@@ -791,51 +926,59 @@ void transReport::reportNackCommit(ID utid,int pid, int tid, int nackPid, TIMEST
 void transReport::reportAbort(ID utid,int pid, int tid, int nackPid, RAddr raddr, RAddr caddr, TIMESTAMP myTimestamp, TIMESTAMP nackTimestamp)
 {
   //! Handle the case for the Eager approaches
-  if(nackingAddr[pid] != 0)
+  if(proc[pid].nackingAddr != 0)
   {
     if(printDetailedTrace)
       fprintf(outfile,"<Trans> tmTrace: NKFN :%lld:%d:1006:%d:%d:%#10x:%llu:%llu:%llu\n"
                                                     ,utid
                                                     ,pid
                                                     ,tid
-                                                    ,nackingPid[pid]
-                                                    ,nackingAddr[pid]
-                                                    ,nackingTimestamp[pid]
+                                                    ,proc[pid].nackingPid
+                                                    ,proc[pid].nackingAddr
+                                                    ,proc[pid].nackingTimestamp
                                                     ,myTimestamp
                                                     ,globalClock);
 
     if(printSummaryReport)
       summaryNackFinish(pid,globalClock);
 
+    transHS->nackFinish(pid);
+    transBD->nackFinish(pid);
+
     if(transactionalReport)
       transactionalNackFinish(utid, globalClock);
 
     registerOut();
   }  
   //! Handle the case for Lazy approaches
-  else if(nackingPid[pid] != -1)
+  else if(proc[pid].nackingPid != -1)
   {
     if(printDetailedTrace)
       fprintf(outfile,"<Trans> tmTrace: NKFN :%lld:%d:1008:%d:%d:%llu:%llu:%llu\n"
                                                     ,utid
                                                     ,pid
                                                     ,tid
-                                                    ,nackingPid[pid]
-                                                    ,nackingTimestamp[pid]
+                                                    ,proc[pid].nackingPid
+                                                    ,proc[pid].nackingTimestamp
                                                     ,myTimestamp
                                                     ,globalClock);
 
     if(printSummaryReport)
       summaryNackFinish(pid,globalClock);
 
+    transHS->nackFinish(pid);
+    transBD->nackFinish(pid);
+
     if(transactionalReport)
       transactionalNackFinish(utid, globalClock);
 
     registerOut();
   }
+  transHS->abort(pid, nackPid, caddr, myTimestamp);
+
   struct memRef temp;
   struct transRef transTemp;
-  tmDepth[pid]--;
+  proc[pid].tmDepth--;
   if(printDetailedTrace || printRealBCTimes)
     fprintf(outfile,"<Trans> tmTrace: AB   :%lld:%d:1004:%d:%d:%#10x:%#10x:%d:%d:%d:%d:%d:%d:%llu:%llu:%llu\n"
                                                     ,utid
@@ -844,18 +987,18 @@ void transReport::reportAbort(ID utid,int pid, int tid, int nackPid, RAddr raddr
                                                     ,nackPid
                                                     ,raddr
                                                     ,caddr
-                                                    ,tempInstCountAbort[pid][transLoad]
-                                                    ,tempInstCountAbort[pid][transStore]
-                                                    ,tempInstCountAbort[pid][transInt]
-                                                    ,tempInstCountAbort[pid][transFp]
-                                                    ,tempInstCountAbort[pid][transBJ]
-                                                    ,tempInstCountAbort[pid][transFence]
+                                                    ,proc[pid].tempInstCountAbort[transLoad]
+                                                    ,proc[pid].tempInstCountAbort[transStore]
+                                                    ,proc[pid].tempInstCountAbort[transInt]
+                                                    ,proc[pid].tempInstCountAbort[transFp]
+                                                    ,proc[pid].tempInstCountAbort[transBJ]
+                                                    ,proc[pid].tempInstCountAbort[transFence]
                                                     ,nackTimestamp
                                                     ,myTimestamp
                                                     ,globalClock);
 
-  INSTCOUNT instCount = tempInstCountAbort[pid][transLoad] + tempInstCountAbort[pid][transStore];
-  instCount += tempInstCountAbort[pid][transInt] + tempInstCountAbort[pid][transFp] + tempInstCountAbort[pid][transBJ] + tempInstCountAbort[pid][transFence];
+  INSTCOUNT instCount = proc[pid].tempInstCountAbort[transLoad] + proc[pid].tempInstCountAbort[transStore];
+  instCount += proc[pid].tempInstCountAbort[transInt] + proc[pid].tempInstCountAbort[transFp] + proc[pid].tempInstCountAbort[transBJ] + proc[pid].tempInstCountAbort[transFence];
   
   if(printSummaryReport)
     summaryAbort(pid,instCount);
@@ -864,9 +1007,9 @@ void transReport::reportAbort(ID utid,int pid, int tid, int nackPid, RAddr raddr
     transactionalAbort(utid, instCount);
 
 
-  nackingAddr[pid] = 0;
-  nackingTimestamp[pid] = 0;
-  nackingPid[pid] = -1;
+  proc[pid].nackingAddr = 0;
+  proc[pid].nackingTimestamp = 0;
+  proc[pid].nackingPid = -1;
   registerOut();
 }
 
@@ -1206,8 +1349,8 @@ void transReport::transactionalLoad(ID utid, RAddr addr)
     {
       int pid = transDataReport.find(utid)->second.pid;
 
-      INSTCOUNT instCount = tempInstCount[pid][transLoad] + tempInstCount[pid][transStore];
-      instCount += tempInstCount[pid][transInt] + tempInstCount[pid][transFp] + tempInstCount[pid][transBJ] + tempInstCount[pid][transFence];
+      INSTCOUNT instCount = proc[pid].tempInstCount[transLoad] + proc[pid].tempInstCount[transStore];
+      instCount += proc[pid].tempInstCount[transInt] + proc[pid].tempInstCount[transFp] + proc[pid].tempInstCount[transBJ] + proc[pid].tempInstCount[transFence];
 
       transDataReport.find(utid)->second.readSet[ addr ] = transDataReport.find(utid)->second.readSet[ addr ] = instCount;
     }
@@ -1234,8 +1377,8 @@ void transReport::transactionalStore(ID utid, RAddr addr)
     {
       int pid = transDataReport.find(utid)->second.pid;
 
-      INSTCOUNT instCount = tempInstCount[pid][transLoad] + tempInstCount[pid][transStore];
-      instCount += tempInstCount[pid][transInt] + tempInstCount[pid][transFp] + tempInstCount[pid][transBJ] + tempInstCount[pid][transFence];
+      INSTCOUNT instCount = proc[pid].tempInstCount[transLoad] + proc[pid].tempInstCount[transStore];
+      instCount += proc[pid].tempInstCount[transInt] + proc[pid].tempInstCount[transFp] + proc[pid].tempInstCount[transBJ] + proc[pid].tempInstCount[transFence];
 
       transDataReport.find(utid)->second.writeSet[ addr ] = transDataReport.find(utid)->second.writeSet[ addr ] = instCount;
     }
@@ -1252,11 +1395,11 @@ void transReport::transactionalStore(ID utid, RAddr addr)
  */
 void transReport::transactionalComplete()
 {
-    for ( unsigned int x = 0; x < MAX_CPU_COUNT; x++ )
+    for ( int x = 0; x < nProcs; x++ )
     {
-      if ( committedInstCountByCpu[x] > 0 )
+      if ( proc[x].committedInstCountByCpu > 0 )
       {
-        fprintf(outfile, "<Trans> tmReport:ENDINST:%d:%lld", x,committedInstCountByCpu[x]);
+        fprintf(outfile, "<Trans> tmReport:ENDINST:%d:%lld", x,proc[x].committedInstCountByCpu);
         fprintf(outfile, "\n");
       }
     }
@@ -1313,53 +1456,32 @@ void transReport::transactionalComplete()
 void transReport::transactionalCompleteSummary()
 {
 
-      unsigned long long commits[MAX_CPU_COUNT];
-      unsigned long long aborts[MAX_CPU_COUNT];
+      std::vector<unsigned long long> commits(nProcs, 0);
+      std::vector<unsigned long long> aborts(nProcs, 0);
 
-      unsigned long long commitReads[MAX_CPU_COUNT];
-      unsigned long long abortReads[MAX_CPU_COUNT];
+      std::vector<unsigned long long> commitReads(nProcs, 0);
+      std::vector<unsigned long long> abortReads(nProcs, 0);
 
-      unsigned long long commitReadSet[MAX_CPU_COUNT];
-      unsigned long long abortReadSet[MAX_CPU_COUNT];
+      std::vector<unsigned long long> commitReadSet(nProcs, 0);
+      std::vector<unsigned long long> abortReadSet(nProcs, 0);
 
-      unsigned long long commitWrites[MAX_CPU_COUNT];
-      unsigned long long abortWrites[MAX_CPU_COUNT];
+      std::vector<unsigned long long> commitWrites(nProcs, 0);
+      std::vector<unsigned long long> abortWrites(nProcs, 0);
 
-      unsigned long long commitWriteSet[MAX_CPU_COUNT];
-      unsigned long long abortWriteSet[MAX_CPU_COUNT];
+      std::vector<unsigned long long> commitWriteSet(nProcs, 0);
+      std::vector<unsigned long long> abortWriteSet(nProcs, 0);
 
-      unsigned long long commitInst[MAX_CPU_COUNT];
-      unsigned long long abortInst[MAX_CPU_COUNT];
+      std::vector<unsigned long long> commitInst(nProcs, 0);
+      std::vector<unsigned long long> abortInst(nProcs, 0);
 
-      unsigned long long commitCycles[MAX_CPU_COUNT];
-      unsigned long long abortCycles[MAX_CPU_COUNT];
+      std::vector<unsigned long long> commitCycles(nProcs, 0);
+      std::vector<unsigned long long> abortCycles(nProcs, 0);
 
-      unsigned long long commitNackCycles[MAX_CPU_COUNT];
-      unsigned long long abortNackCycles[MAX_CPU_COUNT];
+      std::vector<unsigned long long> commitNackCycles(nProcs, 0);
+      std::vector<unsigned long long> abortNackCycles(nProcs, 0);
 
       int x = 0;
 
-      for ( x = 0; x < MAX_CPU_COUNT; x++ )
-      {
-        commits[x] = 0;
-        aborts[x] = 0;
-        commitReads[x] = 0;
-        commitReadSet[x] = 0;
-        commitWrites[x] = 0;
-        commitWriteSet[x] = 0;
-        commitInst[x] = 0;
-        commitCycles[x] = 0;
-        commitNackCycles[x] = 0;
-
-        abortReads[x] = 0;
-        abortReadSet[x] = 0;
-        abortWrites[x] = 0;
-        abortWriteSet[x] = 0;
-        abortInst[x] = 0;
-        abortCycles[x] = 0;
-        abortNackCycles[x] = 0;
-      }
-
       std::map<unsigned long long, transData>::iterator iter;
       std::list<conflict>::iterator confListIt;
 
@@ -1407,7 +1529,7 @@ void transReport::transactionalCompleteSummary()
   fprintf(outfile,"\n\n");
   fprintf(outfile,"<Trans> tmReportSummary:CPU:TX_COUNT:COMMITS:ABORTS:CM_INST:CM_CYCLES:CM_NKCYCLES:AVG_CM_INST:AVG_CM_CYC:AVG_CM_READS:AVG_CM_READSET:AVG_CM_WRITES:AVG_CM_WRITESET:AVG_CM_NACKCYC:AB_INST:AB_CYCLES:AB_NKCYCLES:AVG_AB_INST:AVG_AB_CYC:AVG_AB_READS:AVG_AB_READSET:AVG_AB_WRITES:AVG_AB_WRITESET:AVG_AB_NACKCYC\n");
 
-  for ( x = 0; x < MAX_CPU_COUNT; x++ )
+  for ( x = 0; x < nProcs; x++ )
   {
     if ( aborts[x] + commits[x] > 0 )
     {
@@ -1479,10 +1601,10 @@ void transReport::summaryBegin(int pid, TIMESTAMP timestamp)
    *  support nested transactions.
   */
 
-  if(summaryTransFlag[pid]==1)
+  if(proc[pid].summaryTransFlag==1)
   {
 
-    unsigned long long cycleCount = timestamp - summaryBeginCycle[pid];
+    unsigned long long cycleCount = timestamp - proc[pid].summaryBeginCycle;
     summaryAbortCycleCount += cycleCount;
     
     if(cycleCount < summaryMinAbortCycleCount)
@@ -1492,16 +1614,16 @@ void transReport::summaryBegin(int pid, TIMESTAMP timestamp)
   }
   
 
-  summaryBeginCycle[pid] = timestamp;
-  summaryReadSet[pid].clear();
-  summaryWriteSet[pid].clear();
-  tempLoadCount[pid] = 0;
-  tempStoreCount[pid] = 0;
-  summaryTransFlag[pid]=1;
+  proc[pid].summaryBeginCycle = timestamp;
+  proc[pid].summaryReadSet.clear();
+  proc[pid].summaryWriteSet.clear();
+  proc[pid].tempLoadCount = 0;
+  proc[pid].tempStoreCount = 0;
+  proc[pid].summaryTransFlag=1;
 
 //  Commented this out because it needs to be handled by Abort/Commit because NACKs can happen before begin
-//   summaryNackCount[pid]=0;
-//   summaryNackCycleCount[pid]=0;
+//   proc[pid].summaryNackCount=0;
+//   proc[pid].summaryNackCycleCount=0;
 
 }
 
@@ -1524,7 +1646,7 @@ void transReport::summaryBegin(int pid, TIMESTAMP timestamp)
 void transReport::summaryCommit(int pid, INSTCOUNT instCount, TIMESTAMP timestamp)
 {
   summaryCommitCount++;
-  unsigned long long cycleCount = timestamp - summaryBeginCycle[pid];
+  unsigned long long cycleCount = timestamp - proc[pid].summaryBeginCycle;
   summaryCommitCycleCount += cycleCount;
 
   if(cycleCount < summaryMinCommitCycleCount)
@@ -1539,17 +1661,17 @@ void transReport::summaryCommit(int pid, INSTCOUNT instCount, TIMESTAMP timestam
 
   summaryCommitInstCount += instCount;
 
-  summaryReadSetSize += summaryReadSet[pid].size();
-  summaryWriteSetSize += summaryWriteSet[pid].size();
-  summaryLoadCount += tempLoadCount[pid];
-  summaryStoreCount += tempStoreCount[pid];
+  summaryReadSetSize += proc[pid].summaryReadSet.size();
+  summaryWriteSetSize += proc[pid].summaryWriteSet.size();
+  summaryLoadCount += proc[pid].tempLoadCount;
+  summaryStoreCount += proc[pid].tempStoreCount;
 
-  summaryTransFlag[pid]=0;
+  proc[pid].summaryTransFlag=0;
 
-  summaryUsefulNackCount += summaryNackCount[pid];
-   summaryNackCount[pid] = 0;
-  summaryUsefulNackCycle += summaryNackCycleCount[pid];
-   summaryNackCycleCount[pid] = 0;
+  summaryUsefulNackCount += proc[pid].summaryNackCount;
+   proc[pid].summaryNackCount = 0;
+  summaryUsefulNackCycle += proc[pid].summaryNackCycleCount;
+   proc[pid].summaryNackCycleCount = 0;
 
 }
 
@@ -1570,11 +1692,11 @@ void transReport::summaryAbort(int pid, INSTCOUNT instCount)
   summaryAbortCount++;
   summaryAbortInstCount += instCount;
 
-  summaryAbortedNackCount += summaryNackCount[pid];
-   summaryNackCount[pid] = 0;
-  summaryAbortedNackCycle += summaryNackCycleCount[pid];
+  summaryAbortedNackCount += proc[pid].summaryNackCount;
+   proc[pid].summaryNackCount = 0;
+  summaryAbortedNackCycle += proc[pid].summaryNackCycleCount;
 
-   summaryNackCycleCount[pid] = 0;
+   proc[pid].summaryNackCycleCount = 0;
 
 
 
@@ -1599,8 +1721,8 @@ void transReport::summaryAbort(int pid, INSTCOUNT instCount)
  */
 void transReport::summaryNackBegin(int pid, TIMESTAMP timestamp)
 {
-  summaryNackCycle[pid] = timestamp;
-  summaryNackCount[pid]++;
+  proc[pid].summaryNackCycle = timestamp;
+  proc[pid].summaryNackCount++;
 }
 
 /**
@@ -1616,8 +1738,8 @@ void transReport::summaryNackBegin(int pid, TIMESTAMP timestamp)
  */
 void transReport::summaryLoad(int pid, RAddr addr)
 {
-  summaryReadSet[pid].insert(addr);
-  tempLoadCount[pid]++;
+  proc[pid].summaryReadSet.insert(addr);
+  proc[pid].tempLoadCount++;
 }
 
 /**
@@ -1633,8 +1755,8 @@ void transReport::summaryLoad(int pid, RAddr addr)
  */
 void transReport::summaryStore(int pid, RAddr addr)
 {
-  summaryWriteSet[pid].insert(addr);
-  tempStoreCount[pid]++;
+  proc[pid].summaryWriteSet.insert(addr);
+  proc[pid].tempStoreCount++;
 }
 
 /**
@@ -1651,16 +1773,71 @@ void transReport::summaryStore(int pid, RAddr addr)
 void transReport::summaryNackFinish(int pid, TIMESTAMP timestamp)
 {
 
-  unsigned long long cycleCount = timestamp - summaryNackCycle[pid];
+  unsigned long long cycleCount = timestamp - proc[pid].summaryNackCycle;
 //   if(cycleCount == 0)
 //     cycleCount = 1;
 
 //   printf("SUMMARY PID:%d:%llu\n",pid,cycleCount);fflush(stdout);
   
-  summaryNackCycleCount[pid] += cycleCount;
+  proc[pid].summaryNackCycleCount += cycleCount;
 
 }
 
+/**
+ * @ingroup transReport
+ * @brief   Current values of the summary counters that an epoch reports
+ */
+void transReport::summaryGet(summaryCounters &c) const
+{
+  c.commits       = summaryCommitCount;
+  c.aborts        = summaryAbortCount;
+  c.partialAborts = summaryPartialAbortCount;
+  c.overflows     = summaryOverflowCount;
+  c.nacks         = summaryUsefulNackCount + summaryAbortedNackCount;
+  c.nackCycles    = summaryUsefulNackCycle + summaryAbortedNackCycle;
+  c.commitCycles  = summaryCommitCycleCount;
+  c.abortCycles   = summaryAbortCycleCount;
+  c.commitInsts   = summaryCommitInstCount;
+  c.abortInsts    = summaryAbortInstCount;
+}
+
+/**
+ * @ingroup transReport
+ * @brief   A stats epoch begins, its summary starts from the current counters
+ */
+void transReport::summarySnapshotEpoch()
+{
+  summaryGet(epochSummary);
+}
+
+/**
+ * @ingroup transReport
+ * @brief   Summary of the stats epoch that ends (counters since summarySnapshotEpoch)
+ *
+ * @param epoch Epoch name (report key)
+ */
+void transReport::summaryReportEpoch(const char *epoch)
+{
+  if(!printSummaryReport)
+    return;
+
+  summaryCounters now;
+  summaryGet(now);
+
+  Report::field("Epoch(%s)_TMSummary:commits=%llu:aborts=%llu:partialAborts=%llu:overflows=%llu:nacks=%llu:nackCycles=%llu:commitCycles=%llu:abortCycles=%llu:commitInsts=%llu:abortInsts=%llu"
+                ,epoch
+                ,now.commits       - epochSummary.commits
+                ,now.aborts        - epochSummary.aborts
+                ,now.partialAborts - epochSummary.partialAborts
+                ,now.overflows     - epochSummary.overflows
+                ,now.nacks         - epochSummary.nacks
+                ,now.nackCycles    - epochSummary.nackCycles
+                ,now.commitCycles  - epochSummary.commitCycles
+                ,now.abortCycles   - epochSummary.abortCycles
+                ,now.commitInsts   - epochSummary.commitInsts
+                ,now.abortInsts    - epochSummary.abortInsts);
+}
+
 /**
  * @ingroup transReport
  * @brief   global report output final results
@@ -1736,11 +1913,29 @@ void transReport::summaryComplete()
 
 
 
+    if(closedNesting)
+    {
+      fprintf(outfile, "#tableN,FullAbort,PartialAbort\n");
+      fprintf(outfile, "tableN,%llu,%llu\n", summaryAbortCount, summaryPartialAbortCount);
+    }
+
+    if(boundedCache)
+    {
+      fprintf(outfile, "#tableA,Abort,Conflict,Overflow\n");
+      fprintf(outfile, "tableA,%llu,%llu,%llu\n", summaryAbortCount, summaryAbortCount - summaryOverflowCount, summaryOverflowCount);
+    }
+
     fprintf(outfile, "\nGlobal Totals:\n" );
     fprintf(outfile, "          Trans ->   StatsInc: %7llu    Commit: %9llu    Abort: %8llu\n",
             summaryAbortCount + summaryCommitCount,
             summaryCommitCount,
             summaryAbortCount);
+    if(closedNesting)
+      fprintf(outfile, "          Nested->   Partial abort: %9llu\n", summaryPartialAbortCount);
+    if(boundedCache)
+      fprintf(outfile, "          Reason->   Conflict: %9llu    Overflow: %9llu\n",
+              summaryAbortCount - summaryOverflowCount,
+              summaryOverflowCount);
 
    //! Global statistics not reliable for parsing between useful/aborted nacks, just total
 
@@ -1812,10 +2007,10 @@ void transReport::transMemRef_newBegin(int pid, RAddr PC)
   //! Ensure that we have experienced a commit since the last begin
   //! for this pid (this ensures the previous transaction on
   //! this pid wasn't aborted).
-  if(transMemRefState[pid] == 0)
+  if(proc[pid].transMemRefState == 0)
   {
     //! Set the "running" state to true so that we can detect an abort
-    transMemRefState[pid] = 1;
+    proc[pid].transMemRefState = 1;
 
     //! First we will take care of LOADs
 
@@ -1880,7 +2075,7 @@ void transReport::transMemRef_newBegin(int pid, RAddr PC)
  */
 void transReport::transMemRef_newCommit(int pid)
 {
-  transMemRefState[pid] = 0;
+  proc[pid].transMemRefState = 0;
 }
 
 /**
@@ -2136,17 +2331,17 @@ void transReport::beginTMStats(INSTCOUNT insts)
 
 void transReport::incrementCommittedInstCountByCpu( int cpu )
 {
-  committedInstCountByCpu[cpu]++;
+  proc[cpu].committedInstCountByCpu++;
 }
 
 void transReport::addToCommittedInstCountByCpu( int cpu, INSTCOUNT count )
 {
-  committedInstCountByCpu[cpu] += count;
+  proc[cpu].committedInstCountByCpu += count;
 }
 
 INSTCOUNT transReport::getCommittedInstCountbyCpu( int cpu )
 {
-  return committedInstCountByCpu[cpu];
+  return proc[cpu].committedInstCountByCpu;
 }
 
 void transReport::reportBarrier ( int pid )
@@ -2157,7 +2352,7 @@ void transReport::reportBarrier ( int pid )
     {
       fprintf(outfile, "<Trans> tmReport:BARRIER:%d:%llu:%llu\n"
                                               ,pid
-                                              ,committedInstCountByCpu[pid]
+                                              ,proc[pid].committedInstCountByCpu
                                               ,globalClock);
     }
   }
@@ -25,8 +25,10 @@
 #include <time.h>
 #include <stdio.h>
 #include <queue>
+#include <set>
 #include "OSSim.h"
 #include "ExecutionFlow.h"
+#include "transCoherence.h"
 
 
 using namespace std;
@@ -54,6 +56,36 @@ struct transRef{
   TIMESTAMP timestamp;
 };
 
+struct tmReportProc{
+  // Events waiting for the instruction commit
+  std::queue<memRef> loads;
+  std::queue<memRef> stores;
+  std::queue<transRef> begins;
+  std::queue<transRef> commits;
+
+  RAddr nackingAddr;
+  unsigned long long nackingTimestamp;
+  int nackingPid;
+  int tmDepth;
+  int tempInstCount[6];
+  int tempInstCountAbort[6];
+
+  // Summary statistics
+  std::set<RAddr> summaryReadSet;
+  std::set<RAddr> summaryWriteSet;
+  unsigned long long tempLoadCount;
+  unsigned long long tempStoreCount;
+  unsigned long long summaryNackCount;
+  unsigned long long summaryNackCycleCount;
+  unsigned long long summaryBeginCycle;
+  unsigned long long summaryNackCycle;
+  unsigned long long summaryTempNackCycleCount; // Test Implementation for "Useful NACKs" Metric
+  unsigned long long summaryTransFlag;
+
+  int transMemRefState;
+  INSTCOUNT committedInstCountByCpu;
+} __attribute__((aligned(TM_LINE_SIZE)));
+
 /**
  * @ingroup transReport
  * @brief   Report Module
@@ -82,6 +114,8 @@ class transReport{
     void reportNackLoad(ID utid,int pid, int tid, int nackPid, RAddr raddr, RAddr caddr, TIMESTAMP myTimestamp, TIMESTAMP nackTimestamp);
     void reportNackCommit(ID utid,int pid, int tid, int nackPid, TIMESTAMP myTimestamp, TIMESTAMP nackTimestamp);
     void reportNackCommitFN(ID utid,int pid, int tid, TIMESTAMP begin_timestamp);
+    void reportOverflow(ID utid, int pid, RAddr caddr);
+    void reportPartialAbort(ID utid, int pid, int tid, int nackPid, RAddr caddr, int level, Time_t levelBegin);
 
     // The register functions are used within the fetch/execution cycle to queue the event
     // that will eventually print out in the instruction commit point
@@ -106,11 +140,9 @@ class transReport{
 
   private:
 
+    int nProcs;                 // Entries in proc
+    struct tmReportProc *proc;  // Per processor state, indexed by pid (or cpu)
 
-    std::queue<memRef> loads[MAX_CPU_COUNT];
-    std::queue<memRef> stores[MAX_CPU_COUNT];
-    std::queue<transRef> begins[MAX_CPU_COUNT];
-    std::queue<transRef> commits[MAX_CPU_COUNT];
 
     int outCount;       // Counter to fflush after a set number of prints
     int maxCount;
@@ -119,12 +151,6 @@ class transReport{
     int printRealBCTimes;
     int printAllNacks;
 
-    RAddr nackingAddr[MAX_CPU_COUNT];
-    unsigned long long nackingTimestamp[MAX_CPU_COUNT];
-    int nackingPid[MAX_CPU_COUNT];
-    int tmDepth[MAX_CPU_COUNT];
-    int tempInstCount[MAX_CPU_COUNT][6];
-    int tempInstCountAbort[MAX_CPU_COUNT][6];
 
    /************************************************************
     ***** Functions/Data Used For Transactional Statistics *****
@@ -191,6 +217,8 @@ class transReport{
    private:
 
     int printSummaryReport;
+    int closedNesting;
+    int boundedCache;
 
     unsigned long long summaryCommitCount;
     unsigned long long summaryCommitInstCount;
@@ -207,6 +235,8 @@ class transReport{
     unsigned long long summaryAbortCycleCount;
     unsigned long long summaryMinAbortCycleCount;
     unsigned long long summaryMaxAbortCycleCount;
+    unsigned long long summaryPartialAbortCount;  // Closed nesting, only nested levels restarted
+    unsigned long long summaryOverflowCount;      // Bounded TM, aborts because the transaction overflowed
 
 
     unsigned long long summaryReadSetSize;
@@ -214,28 +244,28 @@ class transReport{
     unsigned long long summaryLoadCount;
     unsigned long long summaryStoreCount;
 
-    std::set<RAddr> summaryReadSet[MAX_CPU_COUNT];
-    std::set<RAddr> summaryWriteSet[MAX_CPU_COUNT];
-    unsigned long long tempLoadCount[MAX_CPU_COUNT];
-    unsigned long long tempStoreCount[MAX_CPU_COUNT];
-
-    unsigned long long summaryNackCount[MAX_CPU_COUNT];
-    unsigned long long summaryNackCycleCount[MAX_CPU_COUNT];
-
     unsigned long long summaryUsefulNackCount;
     unsigned long long summaryUsefulNackCycle;
 
     unsigned long long summaryAbortedNackCount;
     unsigned long long summaryAbortedNackCycle;
 
-    unsigned long long summaryBeginCycle[MAX_CPU_COUNT];
-    unsigned long long summaryNackCycle[MAX_CPU_COUNT];
-
-    // Test Implementation for "Useful NACKs" Metric
-    unsigned long long summaryTempNackCycleCount[MAX_CPU_COUNT];
-    unsigned long long 
-
-    int summaryTransFlag[MAX_CPU_COUNT];
+    //! Summary counters at the begin of the stats epoch (sesc_stats_epoch)
+    struct summaryCounters{
+      unsigned long long commits;
+      unsigned long long aborts;
+      unsigned long long partialAborts;
+      unsigned long long overflows;
+      unsigned long long nacks;
+      unsigned long long nackCycles;
+      unsigned long long commitCycles;
+      unsigned long long abortCycles;
+      unsigned long long commitInsts;
+      unsigned long long abortInsts;
+    };
+    summaryCounters epochSummary;
+
+    void summaryGet(summaryCounters &c) const;
 
    public:
 
@@ -247,6 +277,8 @@ class transReport{
     void summaryLoad(int pid, RAddr addr);
     void summaryStore(int pid, RAddr addr);
     void summaryComplete();
+    void summarySnapshotEpoch();
+    void summaryReportEpoch(const char *epoch);
 
    unsigned long long return_summaryCommitCount(void) { return this->summaryCommitCount; }
    unsigned long long return_summaryReadSetSize(void) { return this->summaryReadSetSize; }
@@ -275,7 +307,6 @@ class transReport{
       std::map < RAddr, list < list < RAddr > > > transMemHistoryLoads;
       std::map < RAddr, list < list < RAddr > > > transMemHistoryStores;
 
-      int transMemRefState[MAX_CPU_COUNT];
       int recordTransMemRefs; // Flag to enable transMemRefs
 
       void transMemRef_newBegin(int pid, RAddr PC);
@@ -325,12 +356,6 @@ class transReport{
     ************************************************/
 
 
-    private:
-
-        INSTCOUNT   committedInstCountByCpu[MAX_CPU_COUNT];
-
-    public:
-
         void        incrementCommittedInstCountByCpu( int cpu );
         void        addToCommittedInstCountByCpu( int cpu, INSTCOUNT count );
         INSTCOUNT   getCommittedInstCountbyCpu( int cpu );
@@ -405,3 +430,10 @@ extern transReport *tmReport;
  *
  */
 
+/**
+ * @struct  tmReportProc
+ * @ingroup transReport
+ * @brief   Per processor report state, one cache line aligned entry per processor
+ *
+ */
+
@@ -0,0 +1,163 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2006 University California, Santa Cruz.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// RST ingestion throughput: the synchronous rstexample loop against the
+// RSTPipeline used by RSTReader (decompression on a background thread,
+// records consumed per flow).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+#include "rstf.h"
+#include "Rstzip.h"
+#include "RSTPipeline.h"
+
+const char usage[] = "rstBench [-d depth] <input-trace-file>";
+
+static double getTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec/1e6;
+}
+
+static Rstzip *openTrace(const char *ifname)
+{
+  Rstzip *rz = new Rstzip;
+  int rv = rz->open(ifname, "r", "verbose=0");
+  if (rv != RSTZIP_OK) {
+    fprintf(stderr, "ERROR: rstBench: Rstzip error opening input file %s\n", ifname);
+    exit(1);
+  }
+  return rz;
+}
+
+int main(int argc, char **argv)
+{
+  const char *ifname = NULL;
+  int depth = 4;
+
+  int i=1;
+  while(i<argc) {
+    const char *arg = argv[i++];
+    if (strcmp(arg, "-h") == 0) {
+      printf("Usage: %s\n", usage);
+      exit(0);
+    } else if (strcmp(arg, "-d") == 0 && i<argc) {
+      depth = atoi(argv[i++]);
+    } else if (ifname != NULL) {
+      fprintf(stderr, "ERROR: rstBench: input file %s already specified\nUsage: %s\n", ifname, usage);
+      exit(1);
+    } else {
+      ifname = arg;
+    }
+  }
+
+  if (ifname == NULL || depth < 2) {
+    printf("Usage: %s\n", usage);
+    exit(0);
+  }
+
+  // Synchronous decompression (same loop as rstexample)
+  Rstzip *rz = openTrace(ifname);
+
+  static rstf_unionT buf[rstzip_opt_buffersize];
+  long long syncInst = 0;
+  unsigned long long syncSum = 0;
+  int maxCpu = 0;
+
+  double start = getTime();
+  int nrecs;
+  while((nrecs = rz->decompress(buf, rstzip_opt_buffersize)) != 0) {
+    for (int j=0; j<nrecs; j++) {
+      rstf_unionT *rp = buf+j;
+      if (rp->proto.rtype != INSTR_T)
+        continue;
+      int cpuid = rstf_instrT_get_cpuid(&(rp->instr));
+      if (cpuid > maxCpu)
+        maxCpu = cpuid;
+      syncSum += rp->instr.pc_va;
+      syncInst++;
+    }
+  }
+  double syncTime = getTime() - start;
+
+  rz->close();
+  delete rz;
+
+  // Pipelined decompression, consumed round robin per flow the way the
+  // simulator would
+  int nFlows = maxCpu+1;
+  rz = openTrace(ifname);
+
+  long long pipeInst = 0;
+  unsigned long long pipeSum = 0;
+
+  start = getTime();
+  RSTPipeline *pipe = new RSTPipeline(rz, nFlows, depth, rstzip_opt_buffersize);
+  pipe->start();
+
+  bool *done = new bool[nFlows];
+  for(int f=0; f<nFlows; f++)
+    done[f] = false;
+  int nActive = nFlows;
+
+  while(nActive) {
+    for(int f=0; f<nFlows; f++) {
+      if (done[f])
+        continue;
+      for(int j=0; j<32; j++) {
+        RSTPipeline::Status st;
+        const rstf_instrT *ip = pipe->next(f, st);
+        if (ip == 0) {
+          if (st == RSTPipeline::EndOfTrace) {
+            done[f] = true;
+            nActive--;
+          }
+          break;
+        }
+        pipeSum += ip->pc_va;
+        pipeInst++;
+      }
+    }
+  }
+  pipe->stop();
+  double pipeTime = getTime() - start;
+
+  delete pipe;
+  delete [] done;
+  rz->close();
+  delete rz;
+
+  if (pipeInst != syncInst || pipeSum != syncSum) {
+    fprintf(stderr, "ERROR: rstBench: pipeline mismatch (%lld vs %lld instructions)\n", pipeInst, syncInst);
+    exit(1);
+  }
+
+  printf("rstBench: %lld instructions, %d flows, depth %d\n", syncInst, nFlows, depth);
+  printf("  sync    : %8.3f secs %10.2f MInst/s\n", syncTime, syncInst/syncTime/1e6);
+  printf("  pipeline: %8.3f secs %10.2f MInst/s\n", pipeTime, pipeInst/pipeTime/1e6);
+
+  return 0;
+}
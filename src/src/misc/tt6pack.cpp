@@ -0,0 +1,108 @@
+/*
+   SESC: Super ESCalar simulator
+   Copyright (C) 2006 University California, Santa Cruz.
+
+   Contributed by Jose Renau
+
+This file is part of SESC.
+
+SESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+SESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+SESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// Converts a TT6 trace directory into the packed fixed-width format (see
+// libll/PackedTrace.h). TT6Reader picks dir/thread_001.tt6p up
+// automatically, skipping the TT6 decoding at simulation time.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "TT6Reader.h"
+#include "PackedTrace.h"
+
+const char usage[] = "tt6pack <tt6-trace-dir> [output-file]";
+
+int main(int argc, char **argv)
+{
+  if (argc < 2 || argc > 3 || strcmp(argv[1], "-h") == 0) {
+    printf("Usage: %s\n", usage);
+    exit(0);
+  }
+
+  char ifname[1024];
+  char ofname[1024];
+  snprintf(ifname, sizeof(ifname), "%s/thread_001.tt6", argv[1]);
+  if (argc == 3)
+    snprintf(ofname, sizeof(ofname), "%s", argv[2]);
+  else
+    snprintf(ofname, sizeof(ofname), "%s/thread_001.tt6p", argv[1]);
+
+  TT6Reader reader;
+  reader.openTT6(ifname);
+
+  FILE *out = fopen(ofname, "wb");
+  if (out == 0) {
+    fprintf(stderr, "ERROR: tt6pack: can not create %s\n", ofname);
+    exit(1);
+  }
+
+  PackedTraceHeader h;
+  bzero(&h, sizeof(h));
+  strcpy(h.magic, PACKED_TRACE_MAGIC);
+  h.version    = PACKED_TRACE_VERSION;
+  h.recordSize = sizeof(PackedTraceRecord);
+  h.nRecords   = 0;
+  fwrite(&h, sizeof(h), 1, out); // nRecords patched at the end
+
+  static const int Buffer_Size = 4096;
+  static PackedTraceRecord buf[Buffer_Size];
+  int n = 0;
+
+  // Same TraceEntry reuse as TraceFlow, so dAddr carries over exactly
+  TraceEntry te;
+  while(1) {
+    reader.fillTraceEntry(&te, 0);
+    if (te.eot)
+      break;
+
+    PackedTraceRecord *r = &buf[n++];
+    r->iAddr     = te.iAddr;
+    r->nextIAddr = te.nextIAddr;
+    r->dAddr     = te.dAddr;
+    r->rawInst   = te.rawInst;
+
+    if (n == Buffer_Size) {
+      if (fwrite(buf, sizeof(PackedTraceRecord), n, out) != (size_t)n) {
+        fprintf(stderr, "ERROR: tt6pack: error writing %s\n", ofname);
+        exit(1);
+      }
+      h.nRecords += n;
+      n = 0;
+    }
+  }
+  if (n && fwrite(buf, sizeof(PackedTraceRecord), n, out) != (size_t)n) {
+    fprintf(stderr, "ERROR: tt6pack: error writing %s\n", ofname);
+    exit(1);
+  }
+  h.nRecords += n;
+
+  fseek(out, 0, SEEK_SET);
+  fwrite(&h, sizeof(h), 1, out);
+  fclose(out);
+
+  reader.closeTrace();
+
+  printf("tt6pack: %llu instructions written to %s\n", (unsigned long long)h.nRecords, ofname);
+
+  return 0;
+}